@@ -0,0 +1,151 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file arena.c
+ * @brief Implementation of arena (bump) allocator related functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "arena.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief Alignment of every allocation handed out by the arena
+ */
+#define ARENA_ALIGN (sizeof(void*) > sizeof(long long) ? sizeof(void*) \
+                                                        : sizeof(long long))
+
+/**
+ * @brief Size of the block header rounded up to the arena alignment
+ */
+#define ARENA_HEADER \
+  ((sizeof(arena_block) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+/**
+ * @brief This function will create an arena which hands out memory from large
+ * blocks of (at least) 'block_size' bytes and return it as a reference (not
+ * copy, thus need to be freed after usage). Every allocation of the arena is
+ * released at once by delete_arena(). If some error happens during creation,
+ * it will return NULL reference.
+ * @param block_size The size of each block requested from the system
+ * @return ARENA (reference, not copy) or 'NULL'
+ */
+ARENA create_arena(size_t block_size) {
+  // Create: Make space for arena
+  ARENA arena = (ARENA)calloc(1, sizeof(arena_element));
+  if (arena == NULL) return NULL;
+
+  // Configure: No block until the first allocation
+  arena->head = NULL;
+  arena->block_size = (block_size < 256) ? 256 : block_size;
+  arena->reserved = 0;
+
+  // Status: Return the arena's structure reference
+  return arena;
+}
+
+/**
+ * @brief This function will take the arena as an input and frees every block
+ * along with the arena itself. Returns 'true' if successfully deleted,
+ * otherwise returns 'false'.
+ * @param arena The arena's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_arena(ARENA arena) {
+  // Check: Whether the arena exist!
+  if (arena == NULL) return false;
+
+  // Clean: Free every block and then the arena
+  arena_block* block = arena->head;
+  while (block != NULL) {
+    arena_block* next = block->next;
+    free(block);
+    block = next;
+  }
+  free(arena);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will hand out 'size' bytes (aligned for any pointer or
+ * integer type) from the given arena. The memory can't be freed individually.
+ * Returns the reference of the memory, otherwise returns 'NULL' if out of
+ * memory.
+ * @param arena The arena's data structure reference
+ * @param size The number of bytes required
+ * @return void* (reference) or 'NULL'
+ */
+void* arena_alloc(ARENA arena, size_t size) {
+  // Check: Whether the arena exist!
+  if (arena == NULL) return NULL;
+
+  // Align: Keep every allocation aligned
+  size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+  // Check: Whether the current block has enough space left
+  arena_block* block = arena->head;
+  if (block == NULL || block->size - block->used < size) {
+    // Create: Make a new block, oversized requests get a block of their own
+    size_t capacity = (size > arena->block_size) ? size : arena->block_size;
+    block = (arena_block*)malloc(ARENA_HEADER + capacity);
+    if (block == NULL) return NULL;
+    block->used = 0;
+    block->size = capacity;
+    arena->reserved += ARENA_HEADER + capacity;
+
+    // Link: Oversized blocks go behind the current block to keep its space
+    if (capacity > arena->block_size && arena->head != NULL) {
+      block->next = arena->head->next;
+      arena->head->next = block;
+    } else {
+      block->next = arena->head;
+      arena->head = block;
+    }
+  }
+
+  // Allocate: Bump the used space of the block
+  void* memory = (char*)block + ARENA_HEADER + block->used;
+  block->used += size;
+
+  // Status: Handover the memory
+  return memory;
+}
@@ -0,0 +1,106 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file arena.h
+ * @brief Interface of arena (bump) allocator related functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Structure of a single block of the arena, the usable bytes follows
+ * the header directly
+ */
+typedef struct arena_block {
+  struct arena_block* next;
+  size_t used;
+  size_t size;
+} arena_block;
+
+/**
+ * @brief Structure of the arena
+ */
+typedef struct {
+  arena_block* head;
+  size_t block_size;
+  size_t reserved;
+} arena_element;
+
+/**
+ * @brief Arena's Data structure Reference
+ */
+#define ARENA arena_element*
+
+/**
+ * @brief This function will create an arena which hands out memory from large
+ * blocks of (at least) 'block_size' bytes and return it as a reference (not
+ * copy, thus need to be freed after usage). Every allocation of the arena is
+ * released at once by delete_arena(). If some error happens during creation,
+ * it will return NULL reference.
+ * @param block_size The size of each block requested from the system
+ * @return ARENA (reference, not copy) or 'NULL'
+ */
+ARENA create_arena(size_t block_size);
+
+/**
+ * @brief This function will take the arena as an input and frees every block
+ * along with the arena itself. Returns 'true' if successfully deleted,
+ * otherwise returns 'false'.
+ * @param arena The arena's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_arena(ARENA arena);
+
+/**
+ * @brief This function will hand out 'size' bytes (aligned for any pointer or
+ * integer type) from the given arena. The memory can't be freed individually.
+ * Returns the reference of the memory, otherwise returns 'NULL' if out of
+ * memory.
+ * @param arena The arena's data structure reference
+ * @param size The number of bytes required
+ * @return void* (reference) or 'NULL'
+ */
+void* arena_alloc(ARENA arena, size_t size);
+
+#endif
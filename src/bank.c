@@ -48,8 +48,37 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string.h>
 #include <time.h>
 
+#include "console.h"
 #include "cs50.h"
 
+/**
+ * @brief This function will return the current time of a monotonic clock in
+ * seconds.
+ */
+static double now_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief This function will return the milliseconds since the bank was
+ * created, the clock of the limits.
+ */
+static unsigned int now_millis(BANK bank) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &time);
+  return (unsigned int)((time.tv_sec + time.tv_nsec / 1e9 - bank->epoch) * 1e3);
+}
+
+/**
+ * @brief This function will hand the name pool's moved arena over to the
+ * bank's snapshot, the 'context' is the snapshot's structure reference.
+ */
+static void retire_names(void* context, void* memory) {
+  retire((SNAPSHOT)context, memory);
+}
+
 /**
  * @brief This function will create a bank (structure) of given name and return
  * it as a reference (not copy, thus need to be freed after usage). If some
@@ -61,14 +90,54 @@ BANK create_bank(string name) {
   // Create: Make space for bank
   BANK new_space = (BANK)calloc(1, sizeof(bank_element));
   if (new_space == NULL) {
-    printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
     return NULL;
   }
   // Configure: Initialize variables of bank
   new_space->name = name;
   new_space->accounts_quantity = 0;
   new_space->user_login_id = -1;
-  new_space->account = NULL;
+  new_space->account.id = NULL;
+  new_space->account.pin = NULL;
+  new_space->account.name = NULL;
+  new_space->account.amount = NULL;
+  new_space->account.limit = NULL;
+  new_space->account.generation = NULL;
+  new_space->account.capacity = 0;
+  new_space->index = create_radix();
+  new_space->names = create_names();
+  new_space->sync = create_snapshot();
+  new_space->journal = NULL;
+  new_space->shared = NULL;
+  new_space->pager = NULL;
+  new_space->closed.id = NULL;
+  new_space->closed.quantity = 0;
+  new_space->closed.capacity = 0;
+  new_space->rebuild = NULL;
+  new_space->hot_quantity = 0;
+  new_space->generations = 0;
+  new_space->limits.burst = 0;
+  new_space->limits.per_minute = 0;
+  new_space->limits.per_hour = 0;
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &time);
+  new_space->epoch = time.tv_sec + time.tv_nsec / 1e9;
+  new_space->vault = create_vault();
+  new_space->sketch = create_sketch();
+  if (new_space->index == NULL || new_space->names == NULL ||
+      new_space->sync == NULL || new_space->vault == NULL ||
+      new_space->sketch == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    delete_radix(new_space->index);
+    delete_names(new_space->names);
+    delete_snapshot(new_space->sync);
+    delete_vault(new_space->vault);
+    delete_sketch(new_space->sketch);
+    free(new_space);
+    return NULL;
+  }
+  new_space->names->retire = retire_names;
+  new_space->names->retire_context = new_space->sync;
 
   // Status: Return the bank's structure reference
   return new_space;
@@ -86,13 +155,1401 @@ bool delete_bank(BANK bank) {
   if (bank == NULL) return false;
 
   // Clean: Free the space allocated by bank's structure reference
-  free(bank->account);
+  delete_journal(bank->journal);
+  delete_radix(bank->index);
+  delete_names(bank->names);
+  free(bank->account.name);
+  free(bank->account.limit);
+  free(bank->account.generation);
+  if (bank->shared == NULL) {
+    free(bank->account.id);
+    free(bank->account.pin);
+    free(bank->account.amount);
+  }
+  detach_shared(bank->shared);
+  delete_pager(bank->pager);
+  for (unsigned int i = 0; i < bank->hot_quantity; i++)
+    delete_hot(bank->hot[i].balance);
+  free(bank->closed.id);
+  delete_vault(bank->vault);
+  delete_sketch(bank->sketch);
+  delete_snapshot(bank->sync);
   free(bank);
 
   // Status: Reached success
   return true;
 }
 
+/**
+ * @brief This function will move the (empty) account store of the bank into
+ * the shared bank file of the given 'path', created for (at most) 'capacity'
+ * accounts if it don't exist yet, thus every process attached to the same
+ * file works on the same accounts. The name index stays private to the
+ * process and catches up with the accounts added by the others. Returns
+ * 'true' if successfully attached, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the shared bank file
+ * @param capacity The number of accounts a new file can hold (0 for default)
+ * @return 'true' or 'false'
+ */
+bool share_bank(BANK bank, string path, unsigned int capacity) {
+  // Check: Wether the bank exist and has nothing of its own yet!
+  if (bank == NULL || path == NULL || bank->shared != NULL) return false;
+  if (bank->accounts_quantity > 0) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Bank already has accounts, thus can't be "
+        "shared.\n");
+    return false;
+  }
+
+  // Create: Map the file, the names of its accounts are interned locally
+  SHARED shared = attach_shared(path, capacity);
+  if (shared == NULL) return false;
+  name_ref* names = (name_ref*)calloc(shared->capacity, sizeof(name_ref));
+  limit_element* limits =
+      (limit_element*)calloc(shared->capacity, sizeof(limit_element));
+  unsigned int* generations =
+      (unsigned int*)calloc(shared->capacity, sizeof(unsigned int));
+  if (names == NULL || limits == NULL || generations == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    free(names);
+    free(limits);
+    free(generations);
+    detach_shared(shared);
+    return false;
+  }
+
+  // Configure: Every other column lives in the file (but the limits and
+  // generations, kept by every process on its own), so do the locks
+  free(bank->account.id);
+  free(bank->account.pin);
+  free(bank->account.name);
+  free(bank->account.amount);
+  free(bank->account.limit);
+  free(bank->account.generation);
+  bank->account.id = shared->id;
+  bank->account.pin = shared->pin;
+  bank->account.name = names;
+  bank->account.amount = shared->amount;
+  bank->account.limit = limits;
+  bank->account.generation = generations;
+  bank->account.capacity = shared->capacity;
+  bank->shared = shared;
+  share_snapshot(bank->sync, shared->header->stripe,
+                 &shared->header->append_lock);
+
+  // Status: Catch up with the accounts already there
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Attached to the shared bank file %s holding "
+      "%u account(s), %u at most.\n",
+      path, refresh_accounts(bank), shared->capacity);
+  return true;
+}
+
+/**
+ * @brief This function will intern and index the names of the accounts added
+ * by other processes sharing the bank, and publish them locally. The append
+ * lock must be held.
+ */
+static void catch_up(BANK bank) {
+  // Check: Wether the bank is shared!
+  if (bank->shared == NULL) return;
+
+  unsigned int quantity = atomic_load_explicit(&bank->shared->header->quantity,
+                                               memory_order_acquire);
+  for (unsigned int id = bank->accounts_quantity; id < quantity; id++) {
+    const char* text = bank->shared->name[id];
+    name_ref ref;
+    if (intern_name(bank->names, text, strnlen(text, SHARED_NAME), &ref) ==
+            false ||
+        radix_insert(bank->index, name_text(bank->names, &ref), id) == false)
+      return;
+    bank->account.name[id] = ref;
+    __atomic_store_n(&bank->accounts_quantity, id + 1, __ATOMIC_RELEASE);
+  }
+}
+
+/**
+ * @brief This function will let the caller append to the account store of the
+ * bank (and look up its name index), waiting for other appenders, even of
+ * other processes if the bank is shared. The accounts added by other
+ * processes are caught up first.
+ * @param bank The bank's data struture reference
+ */
+void lock_accounts(BANK bank) {
+  append_begin(bank->sync);
+  catch_up(bank);
+}
+
+/**
+ * @brief This function will let the next appender of the bank in.
+ * @param bank The bank's data struture reference
+ */
+void unlock_accounts(BANK bank) { append_end(bank->sync); }
+
+/**
+ * @brief This function will catch up with the accounts added by other
+ * processes sharing the bank (if any), e.g. before a scan over every
+ * account. Returns the number of accounts.
+ * @param bank The bank's data struture reference
+ * @return number of accounts
+ */
+unsigned int refresh_accounts(BANK bank) {
+  // Check: Wether the bank exist!
+  if (bank == NULL) return 0;
+
+  if (bank->shared != NULL) {
+    lock_accounts(bank);
+    unlock_accounts(bank);
+  }
+
+  // Fold: The striped balances, the scan sees every deposit so far
+  unsigned int hot = __atomic_load_n(&bank->hot_quantity, __ATOMIC_ACQUIRE);
+  for (unsigned int i = 0; i < hot; i++) {
+    write_begin(bank->sync, stripe_of(bank->hot[i].id));
+    fold_balance(bank, bank->hot[i].id);
+    write_end(bank->sync, stripe_of(bank->hot[i].id));
+  }
+  return __atomic_load_n(&bank->accounts_quantity, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief This function will find the striped balance of the account of the
+ * given 'id', hot accounts are only ever added. Returns the striped balance,
+ * otherwise returns 'NULL' if the account is not hot.
+ */
+static HOT find_hot(BANK bank, unsigned int id) {
+  unsigned int hot = __atomic_load_n(&bank->hot_quantity, __ATOMIC_ACQUIRE);
+  for (unsigned int i = 0; i < hot; i++)
+    if (bank->hot[i].id == id) return bank->hot[i].balance;
+  return NULL;
+}
+
+/**
+ * @brief This function will make the account of the given 'id' a hot account,
+ * from now on its deposits go to a striped balance (a stripe per thread)
+ * without taking any lock, and are folded into its balance by withdrawals,
+ * transactions and scans. Not available for a journaled, shared or paged
+ * bank (deposits are not journaled one by one). Returns 'true' if hot,
+ * otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @return 'true' or 'false'
+ */
+bool mark_hot_account(BANK bank, int id) {
+  // Check: Wether the bank exist, and deposits need not be journaled!
+  if (bank == NULL) return false;
+  if (bank->journal != NULL || bank->shared != NULL || bank->pager != NULL) {
+    console_printf(
+        "\e[38;5;196mFailure:\e[0m Not available for a journaled, shared or "
+        "paged bank.\n");
+    return false;
+  }
+
+  // Check: Wether the account is open and not hot already
+  lock_accounts(bank);
+  if (id < 0 || (unsigned int)id >= bank->accounts_quantity ||
+      bank->account.id[id] == BANK_CLOSED) {
+    unlock_accounts(bank);
+    console_printf("\e[38;5;196mError:\e[0m Account doesn't exist.\n");
+    return false;
+  }
+  if (find_hot(bank, id) != NULL) {
+    unlock_accounts(bank);
+    console_printf(
+        "\e[38;5;214mInfo:\e[0m Account \e[38;5;214mID %02d\e[0m is hot "
+        "already.\n",
+        id);
+    return true;
+  }
+  if (bank->hot_quantity == BANK_HOT_ACCOUNTS) {
+    unlock_accounts(bank);
+    console_printf(
+        "\e[38;5;196mError:\e[0m There can be at most %d hot accounts.\n",
+        BANK_HOT_ACCOUNTS);
+    return false;
+  }
+
+  // Create: The striped balance, then publish it
+  HOT balance = create_hot();
+  if (balance == NULL) {
+    unlock_accounts(bank);
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    return false;
+  }
+  bank->hot[bank->hot_quantity].id = id;
+  bank->hot[bank->hot_quantity].balance = balance;
+  __atomic_store_n(&bank->hot_quantity, bank->hot_quantity + 1,
+                   __ATOMIC_RELEASE);
+  unlock_accounts(bank);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will fold the striped balance of the account of the
+ * given 'id' (if hot) into its balance, e.g. before a withdrawal checks the
+ * balance. The stripe of the account must be held (or nobody else uses the
+ * bank, e.g. a forked child).
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ */
+void fold_balance(BANK bank, unsigned int id) {
+  HOT hot = find_hot(bank, id);
+  if (hot != NULL) bank->account.amount[id] += hot_drain(hot);
+}
+
+/**
+ * @brief This function will display the hot accounts of the bank, their
+ * deposits and how evenly they are spread over the stripes.
+ * @param bank The bank's data struture reference
+ */
+void display_hot(BANK bank) {
+  // Check: Wether there is any hot account
+  unsigned int hot = __atomic_load_n(&bank->hot_quantity, __ATOMIC_ACQUIRE);
+  if (hot == 0) {
+    console_printf("\e[38;5;214mInfo:\e[0m No account is hot.\n");
+    return;
+  }
+
+  // Display: Every hot account
+  for (unsigned int i = 0; i < hot; i++) {
+    long long unsigned int busiest;
+    long long unsigned int deposits = hot_deposits(bank->hot[i].balance,
+                                                   &busiest);
+    console_printf(
+        "\e[38;5;214m>\e[0m Account \e[38;5;214mID %02u\e[0m took "
+        "\e[38;5;214m%llu\e[0m deposit(s) over %d stripes (busiest %llu),\n"
+        "  \e[38;5;214mRs. %lld /-\e[0m not folded yet\n",
+        bank->hot[i].id, deposits, HOT_STRIPES, busiest,
+        hot_total(bank->hot[i].balance));
+  }
+}
+
+/**
+ * @brief This function will set the thresholds of the withdrawals of every
+ * account of the bank, 0 for no limit: a token bucket of 'burst' tokens
+ * gaining 'per_minute' tokens a minute (a withdrawal takes a token), and at
+ * most 'per_hour' withdrawals over the sliding hour. A bucket needs both
+ * 'burst' and 'per_minute' (or neither). The limits of an account live in a
+ * column of their own, 16 bytes per account, checked along every withdrawal
+ * (of any path, see debit_account) under its stripe lock. Returns 'true' if
+ * set, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param burst The tokens of a full bucket
+ * @param per_minute The tokens gained a minute
+ * @param per_hour The withdrawals allowed over the sliding hour
+ * @return 'true' or 'false'
+ */
+bool set_limits(BANK bank, unsigned int burst, unsigned int per_minute,
+                unsigned int per_hour) {
+  // Check: Wether the bank exist, and the thresholds make sense!
+  if (bank == NULL) return false;
+  if ((per_minute != 0 && burst == 0) || burst > 0xFFFFFF ||
+      per_hour > 0xFFFF) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m A bucket needs 1 to 16777215 tokens and "
+        "at most 65535 withdrawals an hour.\n");
+    return false;
+  }
+  if (burst != 0 && per_minute == 0) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m A bucket needs the tokens it gains a "
+        "minute too.\n");
+    return false;
+  }
+
+  // Configure: Writers are held out, every bucket is full again
+  lock_accounts(bank);
+  write_begin_all(bank->sync);
+  bank->limits.burst = burst;
+  bank->limits.per_minute = per_minute;
+  bank->limits.per_hour = per_hour;
+  if (bank->account.limit != NULL)
+    for (unsigned int id = 0; id < bank->accounts_quantity; id++)
+      bank->account.limit[id].spent = 0;
+  write_end_all(bank->sync);
+  unlock_accounts(bank);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will display the thresholds of the withdrawals, the
+ * limits of the account of the given 'id' (if any) and the accounts blocked
+ * the most.
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account (-1 if none)
+ */
+void display_limits(BANK bank, int id) {
+  // Check: Wether the withdrawals are limited at all
+  limit_config config = bank->limits;
+  if (config.per_minute == 0 && config.per_hour == 0) {
+    console_printf("\e[38;5;214mInfo:\e[0m The withdrawals are not limited.\n");
+    return;
+  }
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m A withdrawal takes a token of a bucket of "
+      "\e[38;5;214m%u\e[0m gaining \e[38;5;214m%u\e[0m a minute,\n"
+      "  at most \e[38;5;214m%u\e[0m withdrawal(s) an hour (0 for no "
+      "limit)\n",
+      config.burst, config.per_minute, config.per_hour);
+
+  // Copy: The limits of the account, and find the accounts blocked the most
+  unsigned int now = now_millis(bank);
+  int slot = read_enter(bank->sync);
+  unsigned int quantity =
+      __atomic_load_n(&bank->accounts_quantity, __ATOMIC_ACQUIRE);
+  limit_element* column = __atomic_load_n(&bank->account.limit,
+                                          __ATOMIC_ACQUIRE);
+  limit_element mine;
+  bool found = id >= 0 && (unsigned int)id < quantity;
+  if (found == true) {
+    unsigned int sequence;
+    do {
+      sequence = read_begin(bank->sync, stripe_of(id));
+      memcpy(&mine, &column[id], sizeof(limit_element));
+    } while (read_retry(bank->sync, stripe_of(id), sequence));
+  }
+  unsigned int top[5] = {0}, blocked[5] = {0};
+  long long unsigned int total = 0;
+  for (unsigned int i = 0; i < quantity; i++) {
+    unsigned int count = __atomic_load_n(&column[i].blocked, __ATOMIC_RELAXED);
+    total += count;
+    if (count <= blocked[4]) continue;
+    unsigned int k = 4;
+    for (; k > 0 && blocked[k - 1] < count; k--) {
+      blocked[k] = blocked[k - 1];
+      top[k] = top[k - 1];
+    }
+    blocked[k] = count;
+    top[k] = i;
+  }
+  read_exit(bank->sync, slot);
+
+  // Display: The account, then the accounts blocked the most
+  if (found == true)
+    console_printf(
+        "\e[38;5;214m>\e[0m Account \e[38;5;214mID %02d\e[0m has %u.%03u "
+        "token(s) left, %u withdrawal(s) over the hour,\n"
+        "  %u blocked\n",
+        id, limit_tokens(&config, &mine, now) / LIMIT_UNIT,
+        limit_tokens(&config, &mine, now) % LIMIT_UNIT,
+        limit_velocity(&mine, now), mine.blocked);
+  console_printf(
+      "\e[38;5;214m>\e[0m Blocked \e[38;5;214m%llu\e[0m withdrawal(s) in "
+      "all\n",
+      total);
+  for (unsigned int k = 0; k < 5 && blocked[k] > 0; k++)
+    console_printf("  Account ID %02u blocked %u time(s)\n", top[k],
+                   blocked[k]);
+}
+
+/**
+ * @brief This function will move the PINs and balances of the (empty) account
+ * store of the bank into the pages of the file of the given 'path', cached
+ * by a buffer pool of 'frames' pages, thus the bank may hold more accounts
+ * than the memory. The pages are loaded on demand (e.g. by login, deposit
+ * and withdraw). The ids, user names and the name index stay in memory.
+ * Returns 'true' if successfully paged, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the file of the pages (created or truncated)
+ * @param frames The number of frames of the buffer pool
+ * @return 'true' or 'false'
+ */
+bool page_bank(BANK bank, string path, unsigned int frames) {
+  // Check: Wether the bank exist and has nothing of its own yet!
+  if (bank == NULL || path == NULL || bank->pager != NULL ||
+      bank->shared != NULL)
+    return false;
+  if (bank->accounts_quantity > 0) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Bank already has accounts, thus can't be "
+        "paged.\n");
+    return false;
+  }
+
+  // Create: The buffer pool over the file
+  PAGER pager = create_pager(path, frames);
+  if (pager == NULL) return false;
+
+  // Configure: The PINs and balances live in the pages from now on
+  free(bank->account.pin);
+  free(bank->account.amount);
+  bank->account.pin = NULL;
+  bank->account.amount = NULL;
+  bank->pager = pager;
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Paging the accounts into %s through %u "
+      "frame(s) of %d bytes.\n",
+      path, pager->count, PAGER_PAGE);
+  return true;
+}
+
+/**
+ * @brief This function will check whether every column of the account store of
+ * the bank is in memory, as needed by the scans over every balance (e.g.
+ * interest, batches, scripts, transactions and export), and tell the user
+ * otherwise. Returns 'true' if in memory, otherwise returns 'false' if the
+ * bank is paged.
+ * @param bank The bank's data struture reference
+ * @return 'true' or 'false'
+ */
+bool resident_accounts(BANK bank) {
+  // Check: Wether the bank exist!
+  if (bank == NULL) return false;
+
+  if (bank->pager == NULL) return true;
+  console_printf(
+      "\e[38;5;196mFailure:\e[0m Not available while the accounts are "
+      "paged.\n");
+  return false;
+}
+
+/**
+ * @brief This function will return the record of the account of the given 'id'
+ * within its page, pinned into the buffer pool of the paged bank till
+ * released. Returns the record, otherwise returns 'NULL' if the page can't
+ * be loaded.
+ */
+static paged_account* pin_account(BANK bank, unsigned int id) {
+  char* page = pin_page(bank->pager, id / BANK_PAGED_RECORDS);
+  if (page == NULL) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't load the page of the account.\n");
+    return NULL;
+  }
+  return (paged_account*)page + id % BANK_PAGED_RECORDS;
+}
+
+/**
+ * @brief This function will return the balance of the account of the given
+ * 'id', within its pinned page if the bank is paged. Returns the balance,
+ * otherwise returns 'NULL' if the page can't be loaded.
+ */
+static long long int* get_balance(BANK bank, unsigned int id) {
+  if (bank->pager == NULL) return &bank->account.amount[id];
+  paged_account* record = pin_account(bank, id);
+  return (record != NULL) ? &record->amount : NULL;
+}
+
+/**
+ * @brief This function will release the balance returned by get_balance(), its
+ * page is unpinned (marked dirty if 'changed') if the bank is paged.
+ */
+static void release_balance(BANK bank, long long int* balance, bool changed) {
+  if (bank->pager != NULL) unpin_page(bank->pager, balance, changed);
+}
+
+/**
+ * @brief This function will move the given 'column' of 'size' bytes into a
+ * new space of 'capacity' bytes. Returns the new space, otherwise returns
+ * 'NULL' if out of memory.
+ */
+static void* move_column(const void* column, size_t size, size_t capacity) {
+  void* moved = malloc(capacity);
+  if (moved != NULL && column != NULL) memcpy(moved, column, size);
+  return moved;
+}
+
+/**
+ * @brief This function will move every column of the account store of the
+ * bank (but the paged ones) into new space of 'capacity' accounts, holding
+ * the first 'used' ones. Readers may still be inside the old columns, thus
+ * they are moved and retired rather than reallocated. The append lock must
+ * be held. Returns 'true' if moved, otherwise returns 'false'.
+ */
+static bool move_accounts(BANK bank, unsigned int capacity, unsigned int used) {
+  // Create: Space for every column in memory (PINs and balances are paged)
+  bool paged = bank->pager != NULL;
+  account_store moved;
+  moved.id = move_column(bank->account.id, sizeof(unsigned int) * used,
+                         sizeof(unsigned int) * capacity);
+  moved.pin = NULL;
+  moved.name = NULL;
+  moved.amount = NULL;
+  moved.limit = NULL;
+  moved.generation = NULL;
+  if (moved.id != NULL && paged == false)
+    moved.pin = move_column(bank->account.pin,
+                            sizeof(long long unsigned int) * used,
+                            sizeof(long long unsigned int) * capacity);
+  if (moved.id != NULL && (paged == true || moved.pin != NULL))
+    moved.name = move_column(bank->account.name, sizeof(name_ref) * used,
+                             sizeof(name_ref) * capacity);
+  if (moved.name != NULL && paged == false)
+    moved.amount = move_column(bank->account.amount,
+                               sizeof(long long int) * used,
+                               sizeof(long long int) * capacity);
+  if (moved.name != NULL && (paged == true || moved.amount != NULL))
+    moved.limit = move_column(bank->account.limit, sizeof(limit_element) * used,
+                              sizeof(limit_element) * capacity);
+  if (moved.limit != NULL)
+    moved.generation = move_column(bank->account.generation,
+                                   sizeof(unsigned int) * used,
+                                   sizeof(unsigned int) * capacity);
+  if (moved.generation == NULL) {
+    free(moved.id);
+    free(moved.pin);
+    free(moved.name);
+    free(moved.amount);
+    free(moved.limit);
+    return false;
+  }
+
+  // Move: Writers are held out while the balances, limits and generations are
+  // copied again
+  account_store old = bank->account;
+  write_begin_all(bank->sync);
+  if (old.amount != NULL)
+    memcpy(moved.amount, old.amount, sizeof(long long int) * used);
+  if (old.limit != NULL)
+    memcpy(moved.limit, old.limit, sizeof(limit_element) * used);
+  if (old.generation != NULL)
+    memcpy(moved.generation, old.generation, sizeof(unsigned int) * used);
+  __atomic_store_n(&bank->account.id, moved.id, __ATOMIC_RELEASE);
+  __atomic_store_n(&bank->account.pin, moved.pin, __ATOMIC_RELEASE);
+  __atomic_store_n(&bank->account.name, moved.name, __ATOMIC_RELEASE);
+  __atomic_store_n(&bank->account.amount, moved.amount, __ATOMIC_RELEASE);
+  __atomic_store_n(&bank->account.limit, moved.limit, __ATOMIC_RELEASE);
+  __atomic_store_n(&bank->account.generation, moved.generation,
+                   __ATOMIC_RELEASE);
+  bank->account.capacity = capacity;
+  write_end_all(bank->sync);
+
+  // Clean: Old columns once no reader can see them
+  retire(bank->sync, old.id);
+  retire(bank->sync, old.pin);
+  retire(bank->sync, old.name);
+  retire(bank->sync, old.amount);
+  retire(bank->sync, old.limit);
+  retire(bank->sync, old.generation);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will grow the account store of the bank to hold (at
+ * least) 'quantity' accounts (so the name column of a compaction in
+ * progress). The append lock must be held. Returns 'true' if there is enough
+ * space, otherwise returns 'false'.
+ */
+static bool grow_accounts(BANK bank, unsigned int quantity) {
+  // Check: Wether there is enough space already
+  if (quantity <= bank->account.capacity) return true;
+  if (bank->shared != NULL) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Shared bank file is full (%u accounts).\n",
+        bank->account.capacity);
+    return false;
+  }
+  unsigned int capacity =
+      (bank->account.capacity < 16) ? 16 : bank->account.capacity;
+  while (capacity < quantity)
+    capacity = (capacity > (unsigned int)-1 / 2) ? quantity : capacity * 2;
+
+  // Create: The name column of the compaction is private, thus reallocated
+  if (bank->rebuild != NULL) {
+    name_ref* name = (name_ref*)realloc(bank->rebuild->name,
+                                        sizeof(name_ref) * capacity);
+    if (name == NULL) return false;
+    bank->rebuild->name = name;
+  }
+  return move_accounts(bank, capacity, bank->accounts_quantity);
+}
+
+/**
+ * @brief This function will make sure the account store of the bank has space
+ * for (at least) 'quantity' accounts, growing every column geometrically.
+ * Returns 'true' if there is enough space, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param quantity The number of accounts the store must be able to hold
+ * @return 'true' or 'false'
+ */
+bool reserve_accounts(BANK bank, unsigned int quantity) {
+  // Check: Wether the bank exist!
+  if (bank == NULL) return false;
+
+  lock_accounts(bank);
+  bool status = grow_accounts(bank, quantity);
+  unlock_accounts(bank);
+  return status;
+}
+
+/**
+ * @brief This function will open the account of the given details in the slot
+ * of the given 'id', either the next one of the store or a closed one, and
+ * link its name (into the name storage being compacted too, if the cursor is
+ * beyond the slot). The append lock must be held. Returns the id, otherwise
+ * returns -1 if the user name already exist or out of memory.
+ */
+static int open_slot(BANK bank, unsigned int id, long long unsigned int pin,
+                     const char* name, unsigned int length,
+                     long long int amount) {
+  // Create: Make space for the account (and its page), intern and link its
+  // name
+  bool append = id == bank->accounts_quantity;
+  name_ref ref;
+  paged_account* record = NULL;
+  if (grow_accounts(bank, id + 1) == false ||
+      (bank->pager != NULL && (record = pin_account(bank, id)) == NULL) ||
+      intern_name(bank->names, name, length, &ref) == false ||
+      radix_insert(bank->index, name_text(bank->names, &ref), id) == false) {
+    if (record != NULL) unpin_page(bank->pager, record, false);
+    return -1;
+  }
+  name_rebuild* rebuild = bank->rebuild;
+  if (rebuild != NULL && id < rebuild->cursor &&
+      (intern_name(rebuild->names, name, length, &rebuild->name[id]) == false ||
+       radix_insert(rebuild->index,
+                    name_text(rebuild->names, &rebuild->name[id]),
+                    id) == false)) {
+    radix_remove(bank->index, name_text(bank->names, &ref));
+    if (record != NULL) unpin_page(bank->pager, record, false);
+    return -1;
+  }
+
+  // Configure: Initialize every column of the account (of a new generation,
+  // the sessions of the slot's former account can't touch it), then publish
+  write_begin(bank->sync, stripe_of(id));
+  __atomic_store_n(&bank->account.id[id], id, __ATOMIC_RELAXED);
+  bank->account.name[id] = ref;
+  memset(&bank->account.limit[id], 0, sizeof(limit_element));
+  __atomic_store_n(&bank->account.generation[id], ++bank->generations,
+                   __ATOMIC_RELAXED);
+  if (record != NULL) {
+    record->pin = pin;
+    record->amount = amount;
+  } else {
+    bank->account.pin[id] = pin;
+    bank->account.amount[id] = amount;
+  }
+  journal_create(bank->journal, id, pin, name, length, amount);
+  if (bank->shared != NULL) {
+    memset(bank->shared->name[id], 0, SHARED_NAME);
+    memcpy(bank->shared->name[id], name, length);
+  }
+  write_end(bank->sync, stripe_of(id));
+  if (record != NULL) unpin_page(bank->pager, record, true);
+  if (append && bank->shared != NULL)
+    atomic_store_explicit(&bank->shared->header->quantity, id + 1,
+                          memory_order_release);
+  if (append)
+    __atomic_store_n(&bank->accounts_quantity, id + 1, __ATOMIC_RELEASE);
+  return id;
+}
+
+/**
+ * @brief This function will append a new account of the given details to the
+ * account store and the name index of the bank, in the slot of the last
+ * closed account if any. The user name is interned into the bank's name
+ * pool, thus the caller keeps its own copy. Returns the id of the new
+ * account, otherwise returns -1 if the user name already exist or out of
+ * memory.
+ * @param bank The bank's data struture reference
+ * @param pin The stored PIN of the new account (hashed, see seal_pin, a PIN
+ * stored as is, of an older journal or checkpoint, gets hashed here)
+ * @param name The user name of the new account (need not to be terminated)
+ * @param length The number of bytes of the user name
+ * @param amount The opening balance of the new account
+ * @return id or -1
+ */
+int add_account(BANK bank, long long unsigned int pin, const char* name,
+                unsigned int length, long long int amount) {
+  // Check: Wether the bank and name exist!
+  if (bank == NULL || name == NULL) return -1;
+  if (bank->shared != NULL && length >= SHARED_NAME) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m User name of a shared bank can't exceed %d "
+        "characters.\n",
+        SHARED_NAME - 1);
+    return -1;
+  }
+
+  // Seal: A PIN stored as is, before taking the lock
+  if ((pin & VAULT_HASHED) == 0 && seal_pin(pin, &pin) == false) return -1;
+
+  // Create: In the last closed slot, otherwise at the end
+  lock_accounts(bank);
+  account_freelist* closed = &bank->closed;
+  bool reuse = closed->quantity > 0;
+  unsigned int id =
+      (reuse) ? closed->id[closed->quantity - 1] : bank->accounts_quantity;
+  int opened = open_slot(bank, id, pin, name, length, amount);
+  if (opened != -1 && reuse) closed->quantity--;
+  unlock_accounts(bank);
+
+  // Status: Id of the new account
+  return opened;
+}
+
+/**
+ * @brief This function will open a new account of the given details in the
+ * (closed) slot of the given 'id', e.g. when the reuse of the slot is
+ * recovered from the journal. Returns the id, otherwise returns -1 if the
+ * slot is not closed, the user name already exist or out of memory.
+ * @param bank The bank's data struture reference
+ * @param id The id of the closed account
+ * @param pin The stored PIN of the new account (hashed, see seal_pin, a PIN
+ * stored as is, of an older journal or checkpoint, gets hashed here)
+ * @param name The user name of the new account (need not to be terminated)
+ * @param length The number of bytes of the user name
+ * @param amount The opening balance of the new account
+ * @return id or -1
+ */
+int reopen_account(BANK bank, unsigned int id, long long unsigned int pin,
+                   const char* name, unsigned int length,
+                   long long int amount) {
+  // Check: Wether the bank and name exist!
+  if (bank == NULL || name == NULL) return -1;
+
+  // Seal: A PIN stored as is, before taking the lock
+  if ((pin & VAULT_HASHED) == 0 && seal_pin(pin, &pin) == false) return -1;
+
+  // Find: The slot on the freelist, the last closed ones are on top
+  lock_accounts(bank);
+  account_freelist* closed = &bank->closed;
+  unsigned int slot = closed->quantity;
+  while (slot > 0 && closed->id[slot - 1] != id) slot--;
+  int opened = -1;
+  if (slot > 0) opened = open_slot(bank, id, pin, name, length, amount);
+
+  // Remove: The slot from the freelist, keeping the order of the rest
+  if (opened != -1) {
+    memmove(&closed->id[slot - 1], &closed->id[slot],
+            sizeof(unsigned int) * (closed->quantity - slot));
+    closed->quantity--;
+  }
+  unlock_accounts(bank);
+  return opened;
+}
+
+/**
+ * @brief This function will put the slot of the given 'id' on the freelist.
+ * The append lock must be held. Returns 'true' if done, otherwise returns
+ * 'false' if out of memory.
+ */
+static bool free_slot(BANK bank, unsigned int id) {
+  account_freelist* closed = &bank->closed;
+  if (closed->quantity == closed->capacity) {
+    unsigned int capacity = (closed->capacity == 0) ? 16 : closed->capacity * 2;
+    unsigned int* ids =
+        (unsigned int*)realloc(closed->id, sizeof(unsigned int) * capacity);
+    if (ids == NULL) {
+      console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+      return false;
+    }
+    closed->id = ids;
+    closed->capacity = capacity;
+  }
+  closed->id[closed->quantity++] = id;
+  return true;
+}
+
+/**
+ * @brief This function will append a closed account (a free slot) to the
+ * account store, e.g. when a bank having closed accounts is restored.
+ * Returns the id of the slot, otherwise returns -1 if out of memory.
+ * @param bank The bank's data struture reference
+ * @return id or -1
+ */
+int add_closed_account(BANK bank) {
+  // Check: Wether the bank exist!
+  if (bank == NULL) return -1;
+
+  // Create: Make space for the slot, and put it on the freelist
+  lock_accounts(bank);
+  unsigned int id = bank->accounts_quantity;
+  long long int* balance = NULL;
+  if (grow_accounts(bank, id + 1) == false ||
+      (balance = get_balance(bank, id)) == NULL ||
+      free_slot(bank, id) == false) {
+    if (balance != NULL) release_balance(bank, balance, false);
+    unlock_accounts(bank);
+    return -1;
+  }
+
+  // Configure: The slot holds nothing, then publish it
+  write_begin(bank->sync, stripe_of(id));
+  bank->account.id[id] = BANK_CLOSED;
+  bank->account.name[id] = (name_ref){0};
+  bank->account.generation[id] = BANK_ANY_GENERATION;
+  *balance = 0;
+  write_end(bank->sync, stripe_of(id));
+  release_balance(bank, balance, true);
+  __atomic_store_n(&bank->accounts_quantity, id + 1, __ATOMIC_RELEASE);
+  unlock_accounts(bank);
+  return id;
+}
+
+/**
+ * @brief This function will close the account of the given 'id', whose balance
+ * must be nothing. Its user name is unlinked from the name index and its slot
+ * goes on the freelist, to be reused by the next new account. The account must
+ * be of the given 'generation' (see get_generation) and not hot. Returns 'true'
+ * if closed, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @return 'true' or 'false'
+ */
+bool close_account(BANK bank, int id, unsigned int generation) {
+  // Check: Wether the bank exist, and is not shared!
+  if (bank == NULL) return false;
+  if (bank->shared != NULL) {
+    console_printf(
+        "\e[38;5;196mFailure:\e[0m Accounts of a shared bank can't be "
+        "closed.\n");
+    return false;
+  }
+
+  // Check: Wether the account is open, and still the user's (a closed slot
+  // is only reused holding the append lock)
+  lock_accounts(bank);
+  if (id < 0 || (unsigned int)id >= bank->accounts_quantity ||
+      check_generation(bank, id, generation) == false) {
+    unlock_accounts(bank);
+    console_printf("\e[38;5;196mError:\e[0m Login required.\n");
+    return false;
+  }
+
+  // Check: Wether the account is hot, its striped balance takes deposits
+  // without any lock thus it is never unregistered (nor its slot reused)
+  if (find_hot(bank, id) != NULL) {
+    unlock_accounts(bank);
+    console_printf("\e[38;5;196mError:\e[0m A hot account can't be closed.\n");
+    return false;
+  }
+
+  // Check: Wether the balance is nothing, the slot can be freed
+  long long int* balance = get_balance(bank, id);
+  if (balance == NULL || free_slot(bank, id) == false) {
+    if (balance != NULL) release_balance(bank, balance, false);
+    unlock_accounts(bank);
+    return false;
+  }
+  write_begin(bank->sync, stripe_of(id));
+  if (*balance != 0) {
+    write_end(bank->sync, stripe_of(id));
+    release_balance(bank, balance, false);
+    bank->closed.quantity--;
+    unlock_accounts(bank);
+    console_printf(
+        "\e[38;5;196mError:\e[0m Withdraw the balance before closing the "
+        "account.\n");
+    return false;
+  }
+
+  // Close: Unlink the name (of the compaction too, if behind) and mark it
+  radix_remove(bank->index, name_text(bank->names, &bank->account.name[id]));
+  name_rebuild* rebuild = bank->rebuild;
+  if (rebuild != NULL && (unsigned int)id < rebuild->cursor) {
+    radix_remove(rebuild->index,
+                 name_text(rebuild->names, &rebuild->name[id]));
+    rebuild->name[id] = (name_ref){0};
+  }
+  __atomic_store_n(&bank->account.id[id], BANK_CLOSED, __ATOMIC_RELAXED);
+  bank->account.name[id] = (name_ref){0};
+  journal_close(bank->journal, id);
+  write_end(bank->sync, stripe_of(id));
+  release_balance(bank, balance, false);
+  unlock_accounts(bank);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will check whether the account of the given 'id' is
+ * still open and owned by the given user 'name', i.e. it is neither closed
+ * nor reused (it is still of the given 'generation') since the user logged
+ * in. Returns 'true' if so, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param name The user name of the logged in user
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @return 'true' or 'false'
+ */
+bool check_owner(BANK bank, int id, const char* name,
+                 unsigned int generation) {
+  // Check: Wether the bank and name exist!
+  if (bank == NULL || name == NULL || id < 0) return false;
+
+  // Compare: The name of a consistent view of the account
+  int slot = read_enter(bank->sync);
+  unsigned int stripe = stripe_of(id);
+  unsigned int sequence;
+  bool owned;
+  do {
+    sequence = read_begin(bank->sync, stripe);
+    owned = (unsigned int)id <
+                __atomic_load_n(&bank->accounts_quantity, __ATOMIC_ACQUIRE) &&
+            __atomic_load_n(
+                &__atomic_load_n(&bank->account.id, __ATOMIC_ACQUIRE)[id],
+                __ATOMIC_RELAXED) != BANK_CLOSED &&
+            (generation == BANK_ANY_GENERATION ||
+             __atomic_load_n(&__atomic_load_n(&bank->account.generation,
+                                              __ATOMIC_ACQUIRE)[id],
+                             __ATOMIC_RELAXED) == generation);
+    if (owned == false) break;
+    name_ref ref = __atomic_load_n(&bank->account.name, __ATOMIC_ACQUIRE)[id];
+    NAMES names = __atomic_load_n(&bank->names, __ATOMIC_ACQUIRE);
+    const char* text =
+        (ref.length < NAME_INLINE)
+            ? ref.small
+            : __atomic_load_n(&names->bytes, __ATOMIC_ACQUIRE) + ref.offset;
+    owned = strncmp(text, name, ref.length) == 0 && name[ref.length] == '\0';
+  } while (read_retry(bank->sync, stripe, sequence));
+  read_exit(bank->sync, slot);
+  return owned;
+}
+
+/**
+ * @brief This function will return the generation of the account of the given
+ * 'id', i.e. the number given to it when opened, which tells it apart from the
+ * accounts which had its slot before (a user logging in keeps it, see
+ * check_owner). Returns the generation, otherwise returns BANK_ANY_GENERATION
+ * if the account don't exist (or is of a shared bank).
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @return generation or BANK_ANY_GENERATION
+ */
+unsigned int get_generation(BANK bank, int id) {
+  // Check: Wether the bank exist!
+  if (bank == NULL || id < 0) return BANK_ANY_GENERATION;
+
+  // Read: The generation column, which may be moved meanwhile
+  int slot = read_enter(bank->sync);
+  unsigned int generation = BANK_ANY_GENERATION;
+  if ((unsigned int)id <
+      __atomic_load_n(&bank->accounts_quantity, __ATOMIC_ACQUIRE))
+    generation = __atomic_load_n(
+        &__atomic_load_n(&bank->account.generation, __ATOMIC_ACQUIRE)[id],
+        __ATOMIC_RELAXED);
+  read_exit(bank->sync, slot);
+  return generation;
+}
+
+/**
+ * @brief This function will check whether the account of the given 'id' is
+ * open and of the given 'generation', i.e. neither closed nor reused. The
+ * stripe of the account must be held. Returns 'true' if so, otherwise
+ * returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @return 'true' or 'false'
+ */
+bool check_generation(BANK bank, unsigned int id, unsigned int generation) {
+  return bank->account.id[id] != BANK_CLOSED &&
+         (generation == BANK_ANY_GENERATION ||
+          bank->account.generation[id] == generation);
+}
+
+/**
+ * @brief This function will debit the given 'amount' from the given 'balance'
+ * of the account of the given 'id' (the balance itself, or a working copy of
+ * it), just like every withdrawal whatever its path: the balance must be
+ * enough and the withdrawal within the limits of the account (see
+ * set_limits). The withdrawal is not counted in the analytics yet (see
+ * count_withdrawal), e.g. as a transaction may still be rolled back. The
+ * stripe of the account must be held, and its striped balance folded.
+ * Returns DEBIT_DONE if debited, otherwise returns DEBIT_NOT_ENOUGH or
+ * DEBIT_LIMITED (the balance is left as it is).
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param balance The balance of the account
+ * @param amount The (positive) amount which has to be debited
+ * @return DEBIT_DONE, DEBIT_NOT_ENOUGH or DEBIT_LIMITED
+ */
+int debit_balance(BANK bank, unsigned int id, long long int* balance,
+                  long long int amount) {
+  // Check: Wether the balance is enough, then the limits (if any)
+  if (amount > *balance) return DEBIT_NOT_ENOUGH;
+  if ((bank->limits.per_minute != 0 || bank->limits.per_hour != 0) &&
+      limit_take(&bank->limits, &bank->account.limit[id], now_millis(bank)) ==
+          false)
+    return DEBIT_LIMITED;
+
+  // Debit: The balance
+  *balance -= amount;
+  return DEBIT_DONE;
+}
+
+/**
+ * @brief This function will count a debited withdrawal of the given 'amount'
+ * from the account of the given 'id', leaving the given 'balance', in the
+ * analytics (and in the cash amounts too, if 'cash', see sketch.h). The
+ * function returns nothing.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param amount The amount withdrawn
+ * @param balance The balance left
+ * @param cash Whether the amount is withdrawn as cash
+ * @return void (nothing)
+ */
+void count_withdrawal(BANK bank, unsigned int id, long long int amount,
+                      long long int balance, bool cash) {
+  sketch_withdrawal(bank->sketch, id, amount, balance);
+  if (cash) sketch_cash(bank->sketch, amount);
+}
+
+/**
+ * @brief This function will debit the given 'amount' from the given 'balance'
+ * of the account of the given 'id' just like debit_balance, and count the
+ * debited withdrawal in the analytics right away (see count_withdrawal). The
+ * stripe of the account must be held, and its striped balance folded.
+ * Returns DEBIT_DONE if debited, otherwise returns DEBIT_NOT_ENOUGH or
+ * DEBIT_LIMITED (the balance is left as it is).
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param balance The balance of the account
+ * @param amount The (positive) amount which has to be debited
+ * @param cash Whether the amount is withdrawn as cash
+ * @return DEBIT_DONE, DEBIT_NOT_ENOUGH or DEBIT_LIMITED
+ */
+int debit_account(BANK bank, unsigned int id, long long int* balance,
+                  long long int amount, bool cash) {
+  // Debit: The balance, then count it in the analytics (their shards have
+  // locks of their own, taken after the stripe's)
+  int debited = debit_balance(bank, id, balance, amount);
+  if (debited == DEBIT_DONE) count_withdrawal(bank, id, amount, *balance, cash);
+  return debited;
+}
+
+/**
+ * @brief This function will compact the account store of the bank after
+ * closures: the closed accounts at the end are dropped (their slots are no
+ * more reused) and the columns shrink if mostly unused, then the name pool and
+ * name index are built again without the names of the closed accounts, a
+ * chunk of accounts at a time so that logins and new accounts wait for a
+ * chunk at most (deposits and withdrawals never wait). Returns 'true' if
+ * compacted, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @return 'true' or 'false'
+ */
+bool compact_accounts(BANK bank) {
+  // Check: Wether the bank exist, and is not shared!
+  if (bank == NULL) return false;
+  if (bank->shared != NULL) {
+    console_printf(
+        "\e[38;5;196mFailure:\e[0m A shared bank can't be compacted.\n");
+    return false;
+  }
+
+  // Check: Wether another compaction is in progress
+  lock_accounts(bank);
+  double start = now_seconds();
+  if (bank->rebuild != NULL) {
+    unlock_accounts(bank);
+    console_printf(
+        "\e[38;5;196mFailure:\e[0m The bank is being compacted already.\n");
+    return false;
+  }
+
+  // Drop: The closed accounts at the end, and their slots from the freelist
+  unsigned int quantity = bank->accounts_quantity;
+  while (quantity > 0 && bank->account.id[quantity - 1] == BANK_CLOSED)
+    quantity--;
+  unsigned int dropped = bank->accounts_quantity - quantity;
+  __atomic_store_n(&bank->accounts_quantity, quantity, __ATOMIC_RELEASE);
+  account_freelist* closed = &bank->closed;
+  unsigned int kept = 0;
+  for (unsigned int i = 0; i < closed->quantity; i++)
+    if (closed->id[i] < quantity) closed->id[kept++] = closed->id[i];
+  closed->quantity = kept;
+
+  // Shrink: The columns, if mostly unused
+  unsigned int capacity = bank->account.capacity;
+  while (capacity > 16 && quantity <= capacity / 4) capacity /= 2;
+  if (capacity < bank->account.capacity)
+    move_accounts(bank, capacity, quantity);
+
+  // Create: A name pool and index of its own, to be swapped in at the end
+  name_rebuild* rebuild = (name_rebuild*)malloc(sizeof(name_rebuild));
+  if (rebuild != NULL) {
+    rebuild->names = create_names();
+    rebuild->index = create_radix();
+    rebuild->name = (name_ref*)calloc(
+        (bank->account.capacity > 0) ? bank->account.capacity : 1,
+        sizeof(name_ref));
+    rebuild->cursor = 0;
+  }
+  if (rebuild == NULL || rebuild->names == NULL || rebuild->index == NULL ||
+      rebuild->name == NULL) {
+    if (rebuild != NULL) {
+      delete_names(rebuild->names);
+      delete_radix(rebuild->index);
+      free(rebuild->name);
+      free(rebuild);
+    }
+    unlock_accounts(bank);
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    return false;
+  }
+  bank->rebuild = rebuild;
+  unsigned int before = bank->names->used;
+  double pause = 0;
+
+  // Build: A chunk of accounts at a time, new and closed accounts behind the
+  // cursor are tracked by the append path
+  bool built = true;
+  while (built && rebuild->cursor < bank->accounts_quantity) {
+    unsigned int end = rebuild->cursor + BANK_COMPACT_CHUNK;
+    if (end > bank->accounts_quantity) end = bank->accounts_quantity;
+    for (unsigned int id = rebuild->cursor; built && id < end; id++) {
+      name_ref* ref = &rebuild->name[id];
+      *ref = (name_ref){0};
+      if (bank->account.id[id] == BANK_CLOSED) continue;
+      const char* text = name_text(bank->names, &bank->account.name[id]);
+      built = intern_name(rebuild->names, text, bank->account.name[id].length,
+                          ref) == true &&
+              radix_insert(rebuild->index, name_text(rebuild->names, ref),
+                           id) == true;
+    }
+    rebuild->cursor = end;
+    if (now_seconds() - start > pause) pause = now_seconds() - start;
+    unlock_accounts(bank);
+    lock_accounts(bank);
+    start = now_seconds();
+  }
+
+  // Swap: Writers are held out while the names move over
+  NAMES old_names = bank->names;
+  RADIX old_index = bank->index;
+  name_ref* old_name = bank->account.name;
+  if (built) {
+    rebuild->names->retire = retire_names;
+    rebuild->names->retire_context = bank->sync;
+    write_begin_all(bank->sync);
+    __atomic_store_n(&bank->names, rebuild->names, __ATOMIC_RELEASE);
+    __atomic_store_n(&bank->account.name, rebuild->name, __ATOMIC_RELEASE);
+    bank->index = rebuild->index;
+    write_end_all(bank->sync);
+
+    // Clean: The old names once no reader can see them
+    retire(bank->sync, old_name);
+    retire(bank->sync, old_names->bytes);
+    free(old_names->table);
+    retire(bank->sync, old_names);
+    delete_radix(old_index);
+  } else {
+    delete_names(rebuild->names);
+    delete_radix(rebuild->index);
+    free(rebuild->name);
+  }
+  unsigned int after = bank->names->used;
+  bank->rebuild = NULL;
+  free(rebuild);
+  if (now_seconds() - start > pause) pause = now_seconds() - start;
+  unlock_accounts(bank);
+
+  // Status: Whether compacted
+  if (built == false) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    return false;
+  }
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Compacted \e[38;5;214m%u\e[0m account(s), "
+      "dropped %u closed slot(s) at the end, names %u -> %u bytes, longest "
+      "pause %.3f ms.\n",
+      bank->accounts_quantity, dropped, before, after, pause * 1e3);
+  return true;
+}
+
+/**
+ * @brief This function will copy the details of the account of the given 'id'
+ * out of the account store into 'account'. Returns 'true' if the account
+ * exist, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param account The account's structure where the details are copied
+ * @return 'true' or 'false'
+ */
+bool get_account(BANK bank, unsigned int id, account_element* account) {
+  // Check: Wether the bank and account exist!
+  if (bank == NULL || account == NULL || id >= bank->accounts_quantity ||
+      bank->account.id[id] == BANK_CLOSED)
+    return false;
+
+  // Copy: Gather the row out of every column (and its page, if paged)
+  account->id = bank->account.id[id];
+  account->name = (string)name_text(bank->names, &bank->account.name[id]);
+  if (bank->pager == NULL) {
+    HOT hot = find_hot(bank, id);
+    account->pin = bank->account.pin[id];
+    account->amount =
+        bank->account.amount[id] + ((hot != NULL) ? hot_total(hot) : 0);
+    return true;
+  }
+  paged_account* record = pin_account(bank, id);
+  if (record == NULL) return false;
+  account->pin = record->pin;
+  account->amount = record->amount;
+  unpin_page(bank->pager, record, false);
+  return true;
+}
+
+/**
+ * @brief This function will copy a consistent view of the account of the given
+ * 'id' into 'account' without taking any write lock, thus concurrent writers
+ * are never stalled (the read is retried if a writer got in). The user name
+ * is copied into 'name' (of 'size' bytes, truncated if needed) which becomes
+ * the account's name. Returns 'true' if the account exist, otherwise returns
+ * 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param account The account's structure where the details are copied
+ * @param name The space where the user name is copied
+ * @param size The number of bytes of 'name'
+ * @return 'true' or 'false'
+ */
+bool snapshot_account(BANK bank, unsigned int id, account_element* account,
+                      char* name, unsigned int size) {
+  // Check: Wether the bank, account and space for name exist!
+  if (bank == NULL || account == NULL || name == NULL || size == 0)
+    return false;
+
+  // Enter: Memory seen from now on stays alive till the exit
+  int slot = read_enter(bank->sync);
+  bool found = false;
+  unsigned int stripe = stripe_of(id);
+  unsigned int sequence;
+  do {
+    sequence = read_begin(bank->sync, stripe);
+    found = id < __atomic_load_n(&bank->accounts_quantity, __ATOMIC_ACQUIRE);
+    if (found == false) break;
+
+    // Copy: Every column of the account
+    account->id = __atomic_load_n(
+        &__atomic_load_n(&bank->account.id, __ATOMIC_ACQUIRE)[id],
+        __ATOMIC_RELAXED);
+    found = account->id != BANK_CLOSED;
+    if (bank->pager != NULL) {
+      paged_account* record = pin_account(bank, id);
+      if ((found = record != NULL) == false) break;
+      account->pin = __atomic_load_n(&record->pin, __ATOMIC_RELAXED);
+      account->amount = __atomic_load_n(&record->amount, __ATOMIC_RELAXED);
+      unpin_page(bank->pager, record, false);
+    } else {
+      account->pin = __atomic_load_n(
+          &__atomic_load_n(&bank->account.pin, __ATOMIC_ACQUIRE)[id],
+          __ATOMIC_RELAXED);
+      account->amount = __atomic_load_n(
+          &__atomic_load_n(&bank->account.amount, __ATOMIC_ACQUIRE)[id],
+          __ATOMIC_RELAXED);
+      HOT hot = find_hot(bank, id);
+      if (hot != NULL) account->amount += hot_total(hot);
+    }
+    name_ref ref = __atomic_load_n(&bank->account.name, __ATOMIC_ACQUIRE)[id];
+
+    // Copy: The user name, names never change once interned (the pool may be
+    // swapped by a compaction, along with the name column)
+    NAMES names = __atomic_load_n(&bank->names, __ATOMIC_ACQUIRE);
+    const char* text =
+        (ref.length < NAME_INLINE)
+            ? ref.small
+            : __atomic_load_n(&names->bytes, __ATOMIC_ACQUIRE) + ref.offset;
+    unsigned int length = (ref.length < size) ? ref.length : size - 1;
+    memcpy(name, text, length);
+    name[length] = '\0';
+  } while (read_retry(bank->sync, stripe, sequence));
+  read_exit(bank->sync, slot);
+
+  // Status: Whether the account is found
+  account->name = name;
+  return found;
+}
+
+/**
+ * @brief This function will find the account owned by the given user 'name'
+ * (case sensitive) using the bank's name index. Returns the id of the
+ * account, otherwise returns -1 if the user name don't exist.
+ * @param bank The bank's data struture reference
+ * @param name The user name of the account
+ * @return id or -1
+ */
+int find_account(BANK bank, const char* name) {
+  // Check: Wether the bank and name exist!
+  if (bank == NULL || name == NULL) return -1;
+
+  // Find: The index is only changed under the append lock
+  lock_accounts(bank);
+  int found = radix_lookup(bank->index, name);
+  unlock_accounts(bank);
+  return found;
+}
+
+/**
+ * @brief This function will check the given 'pin' against the (hashed) PIN
+ * of the account of the given 'id', hashing it every time (see
+ * grant_token for the logins that follow). Returns 'true' if the account
+ * exist and the PIN matches, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param pin The PIN to be checked
+ * @return 'true' or 'false'
+ */
+bool check_pin(BANK bank, int id, long long unsigned int pin) {
+  // Check: Wether the account exist!
+  account_element account;
+  char name[1];
+  if (id < 0 ||
+      snapshot_account(bank, id, &account, name, sizeof(name)) == false)
+    return false;
+
+  // Status: Whether the PIN matches
+  return match_pin(account.pin, pin);
+}
+
+/**
+ * @brief This function will issue a session token to a login of the account
+ * of the given 'id' whose PIN just matched (see check_pin) and fill 'token'
+ * with it. Logging in again with the token (see check_token) costs no hash
+ * for VAULT_SECONDS since last used. Returns 'true' if issued, otherwise
+ * returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param token The token to be filled
+ * @return 'true' or 'false'
+ */
+bool grant_token(BANK bank, int id, long long unsigned int* token) {
+  // Check: Wether the account exist!
+  account_element account;
+  char name[1];
+  if (id < 0 ||
+      snapshot_account(bank, id, &account, name, sizeof(name)) == false)
+    return false;
+
+  // Status: Whether issued, for the PIN stored now
+  return issue_token(bank->vault, id, account.pin, token);
+}
+
+/**
+ * @brief This function will check the given session 'token' against the ones
+ * issued to the account of the given 'id' (see grant_token), without
+ * hashing. Returns 'true' if the account exist and the token is valid,
+ * otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param token The token to be checked
+ * @return 'true' or 'false'
+ */
+bool check_token(BANK bank, int id, long long unsigned int token) {
+  // Check: Wether the account exist!
+  account_element account;
+  char name[1];
+  if (id < 0 ||
+      snapshot_account(bank, id, &account, name, sizeof(name)) == false)
+    return false;
+
+  // Status: Whether valid, the PIN not changed since
+  return match_token(bank->vault, id, account.pin, token);
+}
+
 /**
  * @brief This function will log the user into the bank by updating the 'bank'
  * structure reference. Also some check happens here, e.g. wether the given
@@ -115,32 +1572,32 @@ bool login(BANK bank) {
   string user = get_string(
       "\e[38;5;214m>\e[0m Enter User Name (case sensitive) : \e[38;5;214m");
 
-  // Find: The username from existing accounts in bank
+  // Find: The username from the bank's name index
   // IF FOUND:
-  for (int i = 0; i < bank->accounts_quantity; i++) {
-    if (strcmp(user, bank->account[i].name) == 0) {
-      // Get: PIN for authorization
-      long long unsigned int PIN =
-          get_long_long("\e[38;5;214m>\e[0m Enter PIN: ");
-
-      // Authorize: Get the user access to bank account
-      if (PIN == bank->account[i].pin) {
-        bank->user_login_id = bank->account[i].id;
-        return true;
-      }
-
-      // Un-Authorize: PIN don't match, failed to login
-      else {
-        printf("\e[38;5;196mError:\e[0m Wrong PIN.\n");
-        return false;
-      }
+  int found = find_account(bank, user);
+  if (found != -1) {
+    // Get: PIN for authorization
+    long long unsigned int PIN =
+        get_long_long("\e[38;5;214m>\e[0m Enter PIN: ");
+
+    // Authorize: Get the user access to bank account
+    if (check_pin(bank, found, PIN) == true) {
+      bank->user_login_id = found;
+      sketch_user(bank->sketch, found);
+      return true;
+    }
+
+    // Un-Authorize: PIN don't match, failed to login
+    else {
+      console_printf("\e[38;5;196mError:\e[0m Wrong PIN.\n");
+      return false;
     }
   }
 
   // IF NOT FOUND
   // Warn: About creating new space
-  printf("\e[38;5;214mWarning:\e[0m Account does't exist!\n");
-  printf(
+  console_printf("\e[38;5;214mWarning:\e[0m Account does't exist!\n");
+  console_printf(
       "\e[38;5;214mInfo:\e[0m Creating new account with User Name "
       "\e[38;5;214m%s\e[0m.\n",
       user);
@@ -152,26 +1609,21 @@ bool login(BANK bank) {
 
   // Check: Do passwords confirmed
   if (PIN != C_PIN) {
-    printf("\e[38;5;196mError:\e[0m Passwords don't match.\n");
+    console_printf("\e[38;5;196mError:\e[0m Passwords don't match.\n");
     return false;
   }
 
-  // Create: Make space for new user
-  unsigned int cur_user = bank->accounts_quantity;
-  account_element* new_space = (account_element*)realloc(
-      bank->account, sizeof(account_element) * (cur_user + 1));
-  if (new_space == NULL) {
-    printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+  // Create: Make space for new user's bank account, its PIN is hashed
+  long long unsigned int stored;
+  int cur_user = (seal_pin(PIN, &stored) == true)
+                     ? add_account(bank, stored, user, strlen(user), 3210)
+                     : -1;
+  if (cur_user == -1) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
     return false;
   }
-  // Configure: Initialize variables of new user's bank account
-  bank->account = new_space;
-  bank->account[cur_user].id = cur_user;
-  bank->account[cur_user].pin = PIN;
-  bank->account[cur_user].name = user;
-  bank->account[cur_user].amount = 3210;
-  bank->accounts_quantity++;
   bank->user_login_id = cur_user;
+  sketch_user(bank->sketch, cur_user);
 
   // Status: Reached success
   return true;
@@ -192,112 +1644,211 @@ bool logout(BANK bank) {
 }
 
 /**
- * @brief This function will deposit the given 'amount' into the logged in
- * user's bank account. Returns 'true' if successfully deposited the given
- * 'amount', otherwise returns 'false'.
+ * @brief This function will deposit the given 'amount' into the bank account
+ * of the given 'id' (-1 if nobody is logged in), as long as it is of the given
+ * 'generation'. Returns 'true' if successfully deposited the given 'amount',
+ * otherwise returns 'false'.
  * @param bank The bank's data struture reference
- * @param amount The amount which has to be deposited into the logged in user's
- * bank account
+ * @param id The id of the logged in user's account
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @param amount The amount which has to be deposited into the account
  * @return 'true' or 'false'
  */
-bool deposit(BANK bank, long long int amount) {
+bool account_deposit(BANK bank, int id, unsigned int generation,
+                     long long int amount) {
   // Check: Wether the 'bank' exist!
   if (bank == NULL) return false;
 
   // Check: Wether the user is logged in
-  if (bank->user_login_id == -1) {
-    printf("\e[38;5;196mError:\e[0m Login required.\n");
+  if (id < 0 || (unsigned int)id >= __atomic_load_n(&bank->accounts_quantity,
+                                                    __ATOMIC_ACQUIRE)) {
+    console_printf("\e[38;5;196mError:\e[0m Login required.\n");
     return false;
   }
 
   // Check: Wether the amount is positive
   if (amount <= 0) {
-    printf("\e[38;5;196mError:\e[0m Amount must be in positive numeric.\n");
+    console_printf(
+        "\e[38;5;196mError:\e[0m Amount must be in positive numeric.\n");
     return false;
   }
 
-  // Deposit: Into the logged in user's bank account
-  unsigned int cur_user = bank->user_login_id;
-  bank->account[cur_user].amount += amount;
+  // Deposit: Into the striped balance of a hot account, without any lock
+  HOT hot = find_hot(bank, id);
+  if (hot != NULL) {
+    if (generation != BANK_ANY_GENERATION &&
+        get_generation(bank, id) != generation) {
+      console_printf("\e[38;5;196mError:\e[0m Login required.\n");
+      return false;
+    }
+    hot_deposit(hot, amount);
+    return true;
+  }
+
+  // Deposit: Into the logged in user's bank account, unless it is closed (or
+  // reused) since the user logged in
+  long long int* balance = get_balance(bank, id);
+  if (balance == NULL) return false;
+  write_begin(bank->sync, stripe_of(id));
+  if (check_generation(bank, id, generation) == false) {
+    write_end(bank->sync, stripe_of(id));
+    release_balance(bank, balance, false);
+    console_printf("\e[38;5;196mError:\e[0m Login required.\n");
+    return false;
+  }
+  *balance += amount;
+  journal_balances(bank->journal, id, balance, 1);
+  write_end(bank->sync, stripe_of(id));
+  release_balance(bank, balance, true);
 
   // Status: Reached success
   return true;
 }
 
 /**
- * @brief This function will withdraw the given 'amount' from the logged in
- * user's bank account. Returns 'true' if successfully withdrawn the given
- * 'amount' otherwise returns 'false'.
+ * @brief This function will deposit the given 'amount' into the logged in
+ * user's bank account. Returns 'true' if successfully deposited the given
+ * 'amount', otherwise returns 'false'.
  * @param bank The bank's data struture reference
- * @param amount The amount which has to be withdrawn from the logged in user's
+ * @param amount The amount which has to be deposited into the logged in user's
  * bank account
  * @return 'true' or 'false'
  */
-bool withdraw(BANK bank, long long int amount) {
-  // Check: Wether the 'bank' exist!
+bool deposit(BANK bank, long long int amount) {
   if (bank == NULL) return false;
+  return account_deposit(bank, bank->user_login_id, BANK_ANY_GENERATION,
+                         amount);
+}
+
+/**
+ * @brief This function will withdraw the given 'amount' (as 'cash' or not)
+ * from the bank account of the given 'id', as long as it is of the given
+ * 'generation'. Returns DEBIT_DONE, otherwise returns the reason why not.
+ */
+static int withdraw_account(BANK bank, int id, unsigned int generation,
+                            long long int amount, bool cash) {
+  // Check: Wether the 'bank' exist!
+  if (bank == NULL) return DEBIT_FAILED;
 
   // Check: Wether the user logged in
-  if (bank->user_login_id == -1) {
-    printf("\e[38;5;196mError:\e[0m Login required.\n");
-    return false;
+  if (id < 0 || (unsigned int)id >= __atomic_load_n(&bank->accounts_quantity,
+                                                    __ATOMIC_ACQUIRE)) {
+    console_printf("\e[38;5;196mError:\e[0m Login required.\n");
+    return DEBIT_NO_ACCOUNT;
   }
 
   // Check: Wether the amount is positive
   if (amount <= 0) {
-    printf("\e[38;5;196mError:\e[0m Amount must be in positive numeric.\n");
-    return false;
+    console_printf(
+        "\e[38;5;196mError:\e[0m Amount must be in positive numeric.\n");
+    return DEBIT_BAD_AMOUNT;
   }
 
-  // Check: Wether the user has enough amount to withdraw
-  unsigned int cur_user = bank->user_login_id;
-  if (amount > bank->account[cur_user].amount) {
-    printf("\e[38;5;196mError:\e[0m You don't have enough amount.\n");
-    return false;
+  // Check: Wether the account is still the user's (the limits of the
+  // account are fetched meanwhile, if any)
+  if (bank->limits.per_minute != 0 || bank->limits.per_hour != 0)
+    __builtin_prefetch(&bank->account.limit[id], 1);
+  long long int* balance = get_balance(bank, id);
+  if (balance == NULL) return DEBIT_FAILED;
+  write_begin(bank->sync, stripe_of(id));
+  if (check_generation(bank, id, generation) == false) {
+    write_end(bank->sync, stripe_of(id));
+    release_balance(bank, balance, false);
+    console_printf("\e[38;5;196mError:\e[0m Login required.\n");
+    return DEBIT_NO_ACCOUNT;
   }
 
-  // Withdraw: From the logged in user's bank account
-  bank->account[cur_user].amount -= amount;
+  // Withdraw: From the logged in user's bank account, if the balance is
+  // enough and the withdrawal within the limits
+  fold_balance(bank, id);
+  int debited = debit_account(bank, id, balance, amount, cash);
+  if (debited == DEBIT_DONE) journal_balances(bank->journal, id, balance, 1);
+  write_end(bank->sync, stripe_of(id));
+  release_balance(bank, balance, debited == DEBIT_DONE);
+  if (debited == DEBIT_NOT_ENOUGH)
+    console_printf("\e[38;5;196mError:\e[0m You don't have enough amount.\n");
+  if (debited == DEBIT_LIMITED)
+    console_printf(
+        "\e[38;5;196mError:\e[0m Too many withdrawals, try again later.\n");
+
+  // Status: Whether withdrawn
+  return debited;
+}
 
-  // Status: Reached success
-  return true;
+/**
+ * @brief This function will withdraw the given 'amount' from the bank account
+ * of the given 'id' (-1 if nobody is logged in), as long as it is of the given
+ * 'generation' (see debit_account). Returns DEBIT_DONE if successfully
+ * withdrawn the given 'amount', otherwise returns the reason why not.
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @param amount The amount which has to be withdrawn from the account
+ * @return DEBIT_DONE, DEBIT_NO_ACCOUNT, DEBIT_BAD_AMOUNT, DEBIT_NOT_ENOUGH,
+ * DEBIT_LIMITED or DEBIT_FAILED
+ */
+int account_withdraw(BANK bank, int id, unsigned int generation,
+                     long long int amount) {
+  return withdraw_account(bank, id, generation, amount, false);
 }
 
 /**
- * @brief This function will create a 'cash' of the given 'amount' and the
- * logged in user's bank account. Return the 'cash' structure reference (not
- * copy, thus need to be freed after usage) if successfully, otherwise returns
- * 'NULL'.
+ * @brief This function will withdraw the given 'amount' from the logged in
+ * user's bank account. Returns 'true' if successfully withdrawn the given
+ * 'amount' otherwise returns 'false'.
  * @param bank The bank's data struture reference
- * @param amount The cash amount for withdrawal from the logged in user's bank
- * account
+ * @param amount The amount which has to be withdrawn from the logged in user's
+ * bank account
+ * @return 'true' or 'false'
+ */
+bool withdraw(BANK bank, long long int amount) {
+  if (bank == NULL) return false;
+  return account_withdraw(bank, bank->user_login_id, BANK_ANY_GENERATION,
+                          amount) == DEBIT_DONE;
+}
+
+/**
+ * @brief This function will create a 'cash' of the given 'amount' and the bank
+ * account of the given 'id' (-1 if nobody is logged in). Return the 'cash'
+ * structure reference (not copy, thus need to be freed after usage) if
+ * successfully, otherwise returns 'NULL'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account
+ * @param amount The cash amount for withdrawal from the account
  * @return CASH (reference, not copy) or 'NULL'
  */
-CASH create_cash_withdraw(BANK bank, long long int amount) {
+CASH account_cash_withdraw(BANK bank, int id, long long int amount) {
   // Check: Wether the 'bank' exist
   if (bank == NULL) return NULL;
 
   // Check: Wether the user is logged in
-  if (bank->user_login_id == -1) {
-    printf("\e[38;5;196mError:\e[0m Login required.\n");
+  account_element account;
+  char name[1];
+  if (id < 0 ||
+      snapshot_account(bank, id, &account, name, sizeof(name)) == false) {
+    console_printf("\e[38;5;196mError:\e[0m Login required.\n");
     return NULL;
   }
 
   // Check: Wether the amount is positive
   if (amount <= 0) {
-    printf("\e[38;5;196mError:\e[0m Amount must be in positive numeric.\n");
+    console_printf(
+        "\e[38;5;196mError:\e[0m Amount must be in positive numeric.\n");
     return NULL;
   }
 
   // Check: Wether the user has enough amount to withdraw
-  unsigned int cur_user = bank->user_login_id;
-  if (amount > bank->account[cur_user].amount) {
-    printf("\e[38;5;196mError:\e[0m You don't have enough amount.\n");
+  if (amount > account.amount) {
+    console_printf("\e[38;5;196mError:\e[0m You don't have enough amount.\n");
     return NULL;
   }
 
   // Create: Make a new space for cash
   CASH cash = (CASH)calloc(1, sizeof(cash_element));
+  if (cash == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    return NULL;
+  }
 
   // Configure: Initialize the cash structure reference's new variables
   cash->amount = amount;
@@ -316,19 +1867,30 @@ CASH create_cash_withdraw(BANK bank, long long int amount) {
 }
 
 /**
- * @brief This function will update the cash structure reference (if any) by
- * minimizing the number of currency notes (aka maximizing the higher
- * denominations), and withdraw just like a simple withdraw happens from logged
- * in user's bank account. Returns 'true' if successfully withdrawn, otherwise
- * returns 'false'.
+ * @brief This function will create a 'cash' of the given 'amount' and the
+ * logged in user's bank account. Return the 'cash' structure reference (not
+ * copy, thus need to be freed after usage) if successfully, otherwise returns
+ * 'NULL'.
  * @param bank The bank's data struture reference
- * @param cash The 'cash' which has to be withdrawn from logged in user
- * @return 'true' or 'false'
+ * @param amount The cash amount for withdrawal from the logged in user's bank
+ * account
+ * @return CASH (reference, not copy) or 'NULL'
  */
-bool withdraw_cash(BANK bank, CASH cash) {
-  // Check: Whether 'bank' exist!
-  if (bank == NULL) return false;
+CASH create_cash_withdraw(BANK bank, long long int amount) {
+  if (bank == NULL) return NULL;
+  return account_cash_withdraw(bank, bank->user_login_id, amount);
+}
 
+/**
+ * @brief This function will complete the cash structure reference (if any) by
+ * minimizing the number of currency notes (aka maximizing the higher
+ * denominations) for whatever amount is remained after the preferred
+ * denominations. Returns 'true' if all the amount is converted to cash,
+ * otherwise returns 'false'.
+ * @param cash The 'cash' which has to be completed
+ * @return 'true' or 'false'
+ */
+bool complete_cash(CASH cash) {
   // Check: Whether 'cash' exist!
   if (cash == NULL) return false;
 
@@ -346,14 +1908,91 @@ bool withdraw_cash(BANK bank, CASH cash) {
   maximize(cash, 1);
 
   // Check: Do we have converted 'all the amount' to cash.
-  if (cash->remain != 0) return false;
+  return cash->remain == 0;
+}
 
-  // Withdraw the given 'amount' from logged in user's bank account.
-  unsigned int cur_user = bank->user_login_id;
-  bank->account[cur_user].amount -= cash->amount;
+/**
+ * @brief This function will fill the given 'cash' of the given 'amount' by
+ * maximizing the given 'denominations' in the order of preference (up to 'n'
+ * of them, 0 ends them) and completing the rest with the least notes, just
+ * like withdraw cash does but without displaying anything. Returns 'true' if
+ * filled, otherwise returns 'false' if a denomination don't exist.
+ * @param cash The 'cash' which has to be filled
+ * @param amount The amount of the cash
+ * @param denominations The denominations in the order of preference
+ * @param n The number of denominations
+ * @return 'true' or 'false'
+ */
+bool prefer_cash(CASH cash, long long int amount,
+                 const unsigned short denominations[], unsigned int n) {
+  // Check: Whether 'cash' exist!
+  if (cash == NULL) return false;
 
-  // Status: Success
-  return true;
+  // Configure: Nothing converted yet
+  memset(cash, 0, sizeof(cash_element));
+  cash->amount = amount;
+  cash->remain = (amount > 0) ? amount : 0;
+
+  // Maximize: The preferred denominations, then complete the rest
+  for (unsigned int i = 0; i < n && denominations[i] != 0; i++) {
+    switch (denominations[i]) {
+      case 1:
+      case 2:
+      case 5:
+      case 10:
+      case 50:
+      case 100:
+      case 500:
+      case 2000:
+        maximize(cash, denominations[i]);
+        break;
+      default:
+        return false;
+    }
+  }
+  return complete_cash(cash);
+}
+
+/**
+ * @brief This function will update the cash structure reference (if any) by
+ * minimizing the number of currency notes (aka maximizing the higher
+ * denominations), and withdraw just like a simple withdraw happens from the
+ * bank account of the given 'id' (of the given 'generation'). Returns
+ * DEBIT_DONE if successfully withdrawn, otherwise returns the reason why not.
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @param cash The 'cash' which has to be withdrawn from the account
+ * @return DEBIT_DONE, DEBIT_NO_ACCOUNT, DEBIT_BAD_AMOUNT, DEBIT_NOT_ENOUGH,
+ * DEBIT_LIMITED or DEBIT_FAILED
+ */
+int account_withdraw_cash(BANK bank, int id, unsigned int generation,
+                          CASH cash) {
+  // Check: Whether 'bank' exist!
+  if (bank == NULL) return DEBIT_FAILED;
+
+  // Check: Whether 'cash' exist and converted 'all the amount' to cash.
+  if (complete_cash(cash) == false) return DEBIT_BAD_AMOUNT;
+
+  // Withdraw the given 'amount' from logged in user's bank account,
+  // the balance may have changed since the cash was created.
+  return withdraw_account(bank, id, generation, cash->amount, true);
+}
+
+/**
+ * @brief This function will update the cash structure reference (if any) by
+ * minimizing the number of currency notes (aka maximizing the higher
+ * denominations), and withdraw just like a simple withdraw happens from logged
+ * in user's bank account. Returns 'true' if successfully withdrawn, otherwise
+ * returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param cash The 'cash' which has to be withdrawn from logged in user
+ * @return 'true' or 'false'
+ */
+bool withdraw_cash(BANK bank, CASH cash) {
+  if (bank == NULL) return false;
+  return account_withdraw_cash(bank, bank->user_login_id, BANK_ANY_GENERATION,
+                               cash) == DEBIT_DONE;
 }
 
 /**
@@ -420,13 +2059,51 @@ bool maximize(CASH cash, int denomination) {
   }
 
   // Check: Invalid denomination
-  printf(
+  console_printf(
       "\e[38;5;196mError:\e[0m Denomination \e[38;5;214mRs. %d/-\e[0m "
       "don't exist.\n",
       denomination);
   return false;
 }
 
+/**
+ * @brief This function will display a single match of find(), the 'context' is
+ * the bank's structure reference.
+ */
+static void display_match(int id, void* context) {
+  BANK bank = (BANK)context;
+  console_printf("  \e[38;5;214mID %02u\e[0m %s\n", bank->account.id[id],
+                 name_text(bank->names, &bank->account.name[id]));
+}
+
+/**
+ * @brief This function will find every account whose user name starts with the
+ * given 'prefix' (case insensitive) using the bank's name index and display
+ * each match as soon as it is found. Returns the number of matches.
+ * @param bank The bank's data struture reference
+ * @param prefix The starting part of the user names to be found
+ * @return number of matches
+ */
+unsigned int find(BANK bank, string prefix) {
+  // Check: Wether the bank and prefix exist!
+  if (bank == NULL || prefix == NULL) return 0;
+
+  // Find: Stream every match straight out of the index, which is only
+  // changed under the append lock
+  console_printf(
+      "\e[38;5;214m>\e[0m Accounts with User Name starting with "
+      "\e[38;5;214m%s\e[0m,\n",
+      prefix);
+  lock_accounts(bank);
+  unsigned int found =
+      radix_find_prefix(bank->index, prefix, true, display_match, bank);
+  unlock_accounts(bank);
+  if (found == 0) console_printf("  none\n");
+
+  // Status: Number of matches
+  return found;
+}
+
 /**
  * @brief This function will display significant details of 'cash' structure
  * reference with text decoration using escape characters. The function returns
@@ -439,7 +2116,7 @@ void display_cash(CASH cash) {
   if (cash == NULL) return;
 
   // Display: cash information
-  printf(
+  console_printf(
       "\e[38;5;214m>\e[0m You have got or withdrawn the cash of \n"
       "  total amount Rs. %llu/- having,\n"
       "  \e[38;5;214m%4d\e[0m number of Coin(s) of \e[38;5;214mRs. 1/-\e[0m\n"
@@ -457,32 +2134,49 @@ void display_cash(CASH cash) {
 }
 
 /**
- * @brief This function will display some of the details of the logged in user's
- * bank account with text decoration using escape characters. The function
- * returns nothing.
- * @param bank The 'bank' from which some details of logged in user's bank
- * account has to be displayed
+ * @brief This function will display some of the details of the bank account of
+ * the given 'id' (-1 if nobody is logged in) with text decoration using
+ * escape characters. The function returns nothing.
+ * @param bank The 'bank' from which some details of the account has to be
+ * displayed
+ * @param id The id of the logged in user's account
  * @return void (nothing)
  */
-void display(BANK bank) {
+void display_account(BANK bank, int id) {
   // Check: Wether the bank exist
   if (bank == NULL) return;
 
+  // Get: logged in user's account details, never blocking the writers
+  account_element account;
+  char name[256];
+  bool logged_in =
+      id >= 0 && snapshot_account(bank, id, &account, name, sizeof(name));
+
   // Display: logged in user's account details
-  printf(
+  console_printf(
       "\e[38;5;214m>\e[0m The Bank Name is \e[38;5;214m%s\e[0m, which is\n"
       "  currently under \e[38;5;214m%s's\e[0m control.\n",
-      bank->name,
-      (bank->user_login_id != -1) ? bank->account[bank->user_login_id].name
-                                  : "nobody");
-  if (bank->user_login_id != -1)
-    printf(
+      bank->name, (logged_in) ? account.name : "nobody");
+  if (logged_in)
+    console_printf(
         "\e[38;5;214m>\e[0m Account with \e[38;5;214mID %02u\e[0m is owned "
         "by,\n"
         "  the user \e[38;5;214m%s\e[0m who have \e[38;5;214mRs. %llu /-\e[0m\n"
         "  in his/her account\n",
-        bank->user_login_id, bank->account[bank->user_login_id].name,
-        bank->account[bank->user_login_id].amount);
+        account.id, account.name, account.amount);
+}
+
+/**
+ * @brief This function will display some of the details of the logged in user's
+ * bank account with text decoration using escape characters. The function
+ * returns nothing.
+ * @param bank The 'bank' from which some details of logged in user's bank
+ * account has to be displayed
+ * @return void (nothing)
+ */
+void display(BANK bank) {
+  if (bank == NULL) return;
+  display_account(bank, bank->user_login_id);
 }
 
 /**
@@ -492,10 +2186,20 @@ void display(BANK bank) {
  */
 void help() {
   // Display: help manual
-  printf(
+  console_printf(
       "\n"
       "\e[38;5;214m>\e[0m Command \e[38;5;214m$: login\e[0m\n"
       "             to proceed for login\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: resume\e[0m\n"
+      "             to login again by the session token of\n"
+      "             the last login (no PIN)\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: import\e[0m\n"
+      "             to import accounts from a CSV file of\n"
+      "             name,pin,balance rows\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: export (csv|bin)\e[0m\n"
+      "     e.g. $: export csv\n"
+      "             will export the id, name and balance of\n"
+      "             every account into a CSV (or binary) file\n"
       "\e[38;5;214m>\e[0m Command \e[38;5;214m$: deposit (amount)\e[0m\n"
       "     e.g. $: deposit 300\n"
       "             will deposit 300 into the logged in account\n"
@@ -512,6 +2216,58 @@ void help() {
       "             notes of denomination 50. Afterwards, will calculate\n"
       "             the optimal (here, minimum) number of notes to\n"
       "             complete the withdrawn amount and give it to user.\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: begin ... commit\e[0m\n"
+      "     e.g. $: begin withdraw 500 deposit 100 commit\n"
+      "             will buffer the operations in between and\n"
+      "             apply all of them at once (or none of them),\n"
+      "             use abort instead of commit to drop them\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: find (prefix)\e[0m\n"
+      "     e.g. $: find al\n"
+      "             will list the accounts whose user name\n"
+      "             starts with al (case insensitive)\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: interest (basis-points) "
+      "(fee)\e[0m\n"
+      "     e.g. $: interest 25 10\n"
+      "             will credit 0.25%% interest to every account\n"
+      "             and then charge a fee of 10 from it\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: script (run|check)\e[0m\n"
+      "     e.g. $: script run\n"
+      "             will run a file of deposit (account-id)\n"
+      "             (amount) and withdraw (account-id) (amount)\n"
+      "             lines in parallel, account by account, use\n"
+      "             check to compare it with a line by line run\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: checkpoint\e[0m\n"
+      "             to take a checkpoint of the bank in the\n"
+      "             background and show how long the last one\n"
+      "             took (if started with checkpoints)\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: pages\e[0m\n"
+      "             to show the hit rate and latency of the pages\n"
+      "             of the accounts (if started paged)\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: hot (account-id)\e[0m\n"
+      "     e.g. $: hot 7\n"
+      "             will spread the deposits into the account 7\n"
+      "             over a stripe per thread (if not journaled)\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: close\e[0m\n"
+      "             to close the logged in account (once its\n"
+      "             balance is withdrawn) and logout\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: compact\e[0m\n"
+      "             to drop the closed accounts at the end and\n"
+      "             rebuild the user names without the closed ones\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: order (account-id) (amount) "
+      "(seconds)\e[0m\n"
+      "     e.g. $: order 7 500 86400\n"
+      "             will transfer Rs. 500 from the logged in account\n"
+      "             to the account 7 every day, till either is closed\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: schedule\e[0m\n"
+      "             to show the standing orders and the timers\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: limits\e[0m\n"
+      "             to show the withdrawal limits, the tokens left\n"
+      "             to the logged in account and the accounts\n"
+      "             blocked the most (if started with limits)\n"
+      "\e[38;5;214m>\e[0m Command \e[38;5;214m$: analytics\e[0m\n"
+      "             to show the approximate distinct users per hour,\n"
+      "             quantiles of the balances and withdrawals and\n"
+      "             the cash amounts withdrawn the most\n"
       "\e[38;5;214m>\e[0m Command \e[38;5;214m$: show\e[0m\n"
       "             to show the status of the logged in account\n"
       "\e[38;5;214m>\e[0m Command \e[38;5;214m$: logout\e[0m\n"
@@ -48,9 +48,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "bank.h"
 #include "cs50.h"
+#include "hot.h"
+#include "journal.h"
+#include "limit.h"
+#include "names.h"
+#include "pager.h"
+#include "radix.h"
+#include "shared.h"
+#include "sketch.h"
+#include "snapshot.h"
+#include "vault.h"
 
 /**
- * @brief Structure of the user's bank account
+ * @brief Structure of the user's bank account, a copy of a single account of
+ * the account store (the name is valid until the store changes)
  */
 typedef struct {
   unsigned int id;
@@ -59,6 +70,101 @@ typedef struct {
   long long int amount;
 } account_element;
 
+/**
+ * @brief Structure of the account store, every field of the accounts lives in
+ * its own contiguous array (column) indexed by the account id, thus a scan
+ * over a single field (e.g. balances) reads nothing but that field
+ */
+typedef struct {
+  unsigned int* id;
+  long long unsigned int* pin;
+  name_ref* name;
+  long long int* amount;
+  limit_element* limit;
+  unsigned int* generation;
+  unsigned int capacity;
+} account_store;
+
+/**
+ * @brief Id (in the id column) of a closed account, its slot is free
+ */
+#define BANK_CLOSED ((unsigned int)-1)
+
+/**
+ * @brief The results of a debit of an account, e.g. a withdrawal
+ */
+enum {
+  DEBIT_DONE,
+  DEBIT_NO_ACCOUNT,
+  DEBIT_BAD_AMOUNT,
+  DEBIT_NOT_ENOUGH,
+  DEBIT_LIMITED,
+  DEBIT_FAILED
+};
+
+/**
+ * @brief Generation matching every account, e.g. for the callers which are
+ * not a logged in user (the accounts of a shared bank are all of it too)
+ */
+#define BANK_ANY_GENERATION 0
+
+/**
+ * @brief Number of accounts whose names are moved at a time by a compaction,
+ * holding the append lock
+ */
+#define BANK_COMPACT_CHUNK 4096
+
+/**
+ * @brief Structure of the freelist, i.e. the ids of the closed accounts whose
+ * slots are reused (the last closed first) by the new accounts
+ */
+typedef struct {
+  unsigned int* id;
+  unsigned int quantity;
+  unsigned int capacity;
+} account_freelist;
+
+/**
+ * @brief Structure of a compaction of the name storage in progress, i.e. the
+ * new name pool, name index and name column, filled in chunks of accounts up
+ * to the 'cursor' (the accounts opened or closed behind it meanwhile are
+ * moved right away)
+ */
+typedef struct {
+  NAMES names;
+  RADIX index;
+  name_ref* name;
+  unsigned int cursor;
+} name_rebuild;
+
+/**
+ * @brief Structure of the record of an account in a page of a paged bank,
+ * i.e. the columns which live on the disk rather than in memory
+ */
+typedef struct {
+  long long unsigned int pin;
+  long long int amount;
+} paged_account;
+
+/**
+ * @brief Number of account records in a page of a paged bank
+ */
+#define BANK_PAGED_RECORDS (PAGER_PAGE / sizeof(paged_account))
+
+/**
+ * @brief Most number of hot accounts of a bank
+ */
+#define BANK_HOT_ACCOUNTS 16
+
+/**
+ * @brief Structure of a hot account, i.e. an account taking deposits at such a
+ * rate that they go to its striped balance rather than its balance
+ */
+typedef struct {
+  unsigned int id;
+  HOT balance;
+} hot_account;
+
 /**
  * @brief Structure of the bank
  */
@@ -66,7 +172,22 @@ typedef struct {
   string name;
   unsigned int accounts_quantity;
   int user_login_id;
-  account_element* account;
+  account_store account;
+  RADIX index;
+  NAMES names;
+  SNAPSHOT sync;
+  JOURNAL journal;
+  SHARED shared;
+  PAGER pager;
+  account_freelist closed;
+  name_rebuild* rebuild;
+  hot_account hot[BANK_HOT_ACCOUNTS];
+  unsigned int hot_quantity;
+  unsigned int generations;
+  limit_config limits;
+  double epoch;
+  VAULT vault;
+  SKETCH sketch;
 } bank_element;
 
 /**
@@ -113,6 +234,371 @@ BANK create_bank(string name);
  */
 bool delete_bank(BANK bank);
 
+/**
+ * @brief This function will move the (empty) account store of the bank into
+ * the shared bank file of the given 'path', created for (at most) 'capacity'
+ * accounts if it don't exist yet, thus every process attached to the same
+ * file works on the same accounts. The name index stays private to the
+ * process and catches up with the accounts added by the others. Returns
+ * 'true' if successfully attached, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the shared bank file
+ * @param capacity The number of accounts a new file can hold (0 for default)
+ * @return 'true' or 'false'
+ */
+bool share_bank(BANK bank, string path, unsigned int capacity);
+
+/**
+ * @brief This function will move the PINs and balances of the (empty) account
+ * store of the bank into the pages of the file of the given 'path', cached
+ * by a buffer pool of 'frames' pages, thus the bank may hold more accounts
+ * than the memory. The pages are loaded on demand (e.g. by login, deposit
+ * and withdraw). The ids, user names and the name index stay in memory.
+ * Returns 'true' if successfully paged, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the file of the pages (created or truncated)
+ * @param frames The number of frames of the buffer pool
+ * @return 'true' or 'false'
+ */
+bool page_bank(BANK bank, string path, unsigned int frames);
+
+/**
+ * @brief This function will check whether every column of the account store of
+ * the bank is in memory, as needed by the scans over every balance (e.g.
+ * interest, batches, scripts, transactions and export), and tell the user
+ * otherwise. Returns 'true' if in memory, otherwise returns 'false' if the
+ * bank is paged.
+ * @param bank The bank's data struture reference
+ * @return 'true' or 'false'
+ */
+bool resident_accounts(BANK bank);
+
+/**
+ * @brief This function will let the caller append to the account store of the
+ * bank (and look up its name index), waiting for other appenders, even of
+ * other processes if the bank is shared. The accounts added by other
+ * processes are caught up first.
+ * @param bank The bank's data struture reference
+ */
+void lock_accounts(BANK bank);
+
+/**
+ * @brief This function will let the next appender of the bank in.
+ * @param bank The bank's data struture reference
+ */
+void unlock_accounts(BANK bank);
+
+/**
+ * @brief This function will catch up with the accounts added by other
+ * processes sharing the bank (if any) and fold the striped balances of the
+ * hot accounts, e.g. before a scan over every account. Returns the number of
+ * accounts.
+ * @param bank The bank's data struture reference
+ * @return number of accounts
+ */
+unsigned int refresh_accounts(BANK bank);
+
+/**
+ * @brief This function will make the account of the given 'id' a hot account,
+ * from now on its deposits go to a striped balance (a stripe per thread)
+ * without taking any lock, and are folded into its balance by withdrawals,
+ * transactions and scans. Not available for a journaled, shared or paged
+ * bank (deposits are not journaled one by one). Returns 'true' if hot,
+ * otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @return 'true' or 'false'
+ */
+bool mark_hot_account(BANK bank, int id);
+
+/**
+ * @brief This function will fold the striped balance of the account of the
+ * given 'id' (if hot) into its balance, e.g. before a withdrawal checks the
+ * balance. The stripe of the account must be held (or nobody else uses the
+ * bank, e.g. a forked child).
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ */
+void fold_balance(BANK bank, unsigned int id);
+
+/**
+ * @brief This function will display the hot accounts of the bank, their
+ * deposits and how evenly they are spread over the stripes.
+ * @param bank The bank's data struture reference
+ */
+void display_hot(BANK bank);
+
+/**
+ * @brief This function will set the thresholds of the withdrawals of every
+ * account of the bank, 0 for no limit: a token bucket of 'burst' tokens
+ * gaining 'per_minute' tokens a minute (a withdrawal takes a token), and at
+ * most 'per_hour' withdrawals over the sliding hour. A bucket needs both
+ * 'burst' and 'per_minute' (or neither). The limits of an account live in a
+ * column of their own, 16 bytes per account, checked along every withdrawal
+ * (of any path, see debit_account) under its stripe lock. Returns 'true' if
+ * set, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param burst The tokens of a full bucket
+ * @param per_minute The tokens gained a minute
+ * @param per_hour The withdrawals allowed over the sliding hour
+ * @return 'true' or 'false'
+ */
+bool set_limits(BANK bank, unsigned int burst, unsigned int per_minute,
+                unsigned int per_hour);
+
+/**
+ * @brief This function will display the thresholds of the withdrawals, the
+ * limits of the account of the given 'id' (if any) and the accounts blocked
+ * the most.
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account (-1 if none)
+ */
+void display_limits(BANK bank, int id);
+
+/**
+ * @brief This function will make sure the account store of the bank has space
+ * for (at least) 'quantity' accounts, growing every column geometrically.
+ * Returns 'true' if there is enough space, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param quantity The number of accounts the store must be able to hold
+ * @return 'true' or 'false'
+ */
+bool reserve_accounts(BANK bank, unsigned int quantity);
+
+/**
+ * @brief This function will append a new account of the given details to the
+ * account store and the name index of the bank. The user name is interned
+ * into the bank's name pool, thus the caller keeps its own copy. Returns the
+ * id of the new account, otherwise returns -1 if the user name already exist
+ * or out of memory.
+ * @param bank The bank's data struture reference
+ * @param pin The stored PIN of the new account (hashed, see seal_pin, a PIN
+ * stored as is, of an older journal or checkpoint, gets hashed here)
+ * @param name The user name of the new account (need not to be terminated)
+ * @param length The number of bytes of the user name
+ * @param amount The opening balance of the new account
+ * @return id or -1
+ */
+int add_account(BANK bank, long long unsigned int pin, const char* name,
+                unsigned int length, long long int amount);
+
+/**
+ * @brief This function will open a new account of the given details in the
+ * (closed) slot of the given 'id', e.g. when the reuse of the slot is
+ * recovered from the journal. Returns the id, otherwise returns -1 if the
+ * slot is not closed, the user name already exist or out of memory.
+ * @param bank The bank's data struture reference
+ * @param id The id of the closed account
+ * @param pin The stored PIN of the new account (hashed, see seal_pin, a PIN
+ * stored as is, of an older journal or checkpoint, gets hashed here)
+ * @param name The user name of the new account (need not to be terminated)
+ * @param length The number of bytes of the user name
+ * @param amount The opening balance of the new account
+ * @return id or -1
+ */
+int reopen_account(BANK bank, unsigned int id, long long unsigned int pin,
+                   const char* name, unsigned int length,
+                   long long int amount);
+
+/**
+ * @brief This function will append a closed account (a free slot) to the
+ * account store, e.g. when a bank having closed accounts is restored.
+ * Returns the id of the slot, otherwise returns -1 if out of memory.
+ * @param bank The bank's data struture reference
+ * @return id or -1
+ */
+int add_closed_account(BANK bank);
+
+/**
+ * @brief This function will close the account of the given 'id', whose balance
+ * must be nothing. Its user name is unlinked from the name index and its slot
+ * goes on the freelist, to be reused by the next new account. The account must
+ * be of the given 'generation' (see get_generation) and not hot. Returns 'true'
+ * if closed, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @return 'true' or 'false'
+ */
+bool close_account(BANK bank, int id, unsigned int generation);
+
+/**
+ * @brief This function will check whether the account of the given 'id' is
+ * still open and owned by the given user 'name', i.e. it is neither closed
+ * nor reused (it is still of the given 'generation') since the user logged
+ * in. Returns 'true' if so, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param name The user name of the logged in user
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @return 'true' or 'false'
+ */
+bool check_owner(BANK bank, int id, const char* name,
+                 unsigned int generation);
+
+/**
+ * @brief This function will return the generation of the account of the given
+ * 'id', i.e. the number given to it when opened, which tells it apart from the
+ * accounts which had its slot before (a user logging in keeps it, see
+ * check_owner). Returns the generation, otherwise returns BANK_ANY_GENERATION
+ * if the account don't exist (or is of a shared bank).
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @return generation or BANK_ANY_GENERATION
+ */
+unsigned int get_generation(BANK bank, int id);
+
+/**
+ * @brief This function will check whether the account of the given 'id' is
+ * open and of the given 'generation', i.e. neither closed nor reused. The
+ * stripe of the account must be held. Returns 'true' if so, otherwise
+ * returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @return 'true' or 'false'
+ */
+bool check_generation(BANK bank, unsigned int id, unsigned int generation);
+
+/**
+ * @brief This function will debit the given 'amount' from the given 'balance'
+ * of the account of the given 'id' (the balance itself, or a working copy of
+ * it), just like every withdrawal whatever its path: the balance must be
+ * enough and the withdrawal within the limits of the account (see
+ * set_limits). The withdrawal is not counted in the analytics yet (see
+ * count_withdrawal), e.g. as a transaction may still be rolled back. The
+ * stripe of the account must be held, and its striped balance folded.
+ * Returns DEBIT_DONE if debited, otherwise returns DEBIT_NOT_ENOUGH or
+ * DEBIT_LIMITED (the balance is left as it is).
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param balance The balance of the account
+ * @param amount The (positive) amount which has to be debited
+ * @return DEBIT_DONE, DEBIT_NOT_ENOUGH or DEBIT_LIMITED
+ */
+int debit_balance(BANK bank, unsigned int id, long long int* balance,
+                  long long int amount);
+
+/**
+ * @brief This function will count a debited withdrawal of the given 'amount'
+ * from the account of the given 'id', leaving the given 'balance', in the
+ * analytics (and in the cash amounts too, if 'cash', see sketch.h). The
+ * function returns nothing.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param amount The amount withdrawn
+ * @param balance The balance left
+ * @param cash Whether the amount is withdrawn as cash
+ * @return void (nothing)
+ */
+void count_withdrawal(BANK bank, unsigned int id, long long int amount,
+                      long long int balance, bool cash);
+
+/**
+ * @brief This function will debit the given 'amount' from the given 'balance'
+ * of the account of the given 'id' just like debit_balance, and count the
+ * debited withdrawal in the analytics right away (see count_withdrawal). The
+ * stripe of the account must be held, and its striped balance folded.
+ * Returns DEBIT_DONE if debited, otherwise returns DEBIT_NOT_ENOUGH or
+ * DEBIT_LIMITED (the balance is left as it is).
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param balance The balance of the account
+ * @param amount The (positive) amount which has to be debited
+ * @param cash Whether the amount is withdrawn as cash
+ * @return DEBIT_DONE, DEBIT_NOT_ENOUGH or DEBIT_LIMITED
+ */
+int debit_account(BANK bank, unsigned int id, long long int* balance,
+                  long long int amount, bool cash);
+
+/**
+ * @brief This function will compact the account store of the bank after
+ * closures: the closed accounts at the end are dropped (their slots are no
+ * more reused) and the columns shrink if mostly unused, then the name pool and
+ * name index are built again without the names of the closed accounts, a
+ * chunk of accounts at a time so that logins and new accounts wait for a
+ * chunk at most (deposits and withdrawals never wait). Returns 'true' if
+ * compacted, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @return 'true' or 'false'
+ */
+bool compact_accounts(BANK bank);
+
+/**
+ * @brief This function will copy the details of the account of the given 'id'
+ * out of the account store into 'account'. Returns 'true' if the account
+ * exist, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param account The account's structure where the details are copied
+ * @return 'true' or 'false'
+ */
+bool get_account(BANK bank, unsigned int id, account_element* account);
+
+/**
+ * @brief This function will copy a consistent view of the account of the given
+ * 'id' into 'account' without taking any write lock, thus concurrent writers
+ * are never stalled (the read is retried if a writer got in). The user name
+ * is copied into 'name' (of 'size' bytes, truncated if needed) which becomes
+ * the account's name. Returns 'true' if the account exist, otherwise returns
+ * 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param account The account's structure where the details are copied
+ * @param name The space where the user name is copied
+ * @param size The number of bytes of 'name'
+ * @return 'true' or 'false'
+ */
+bool snapshot_account(BANK bank, unsigned int id, account_element* account,
+                      char* name, unsigned int size);
+
+/**
+ * @brief This function will find the account owned by the given user 'name'
+ * (case sensitive) using the bank's name index. Returns the id of the
+ * account, otherwise returns -1 if the user name don't exist.
+ * @param bank The bank's data struture reference
+ * @param name The user name of the account
+ * @return id or -1
+ */
+int find_account(BANK bank, const char* name);
+
+/**
+ * @brief This function will check the given 'pin' against the (hashed) PIN
+ * of the account of the given 'id', hashing it every time (see
+ * grant_token for the logins that follow). Returns 'true' if the account
+ * exist and the PIN matches, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param pin The PIN to be checked
+ * @return 'true' or 'false'
+ */
+bool check_pin(BANK bank, int id, long long unsigned int pin);
+
+/**
+ * @brief This function will issue a session token to a login of the account
+ * of the given 'id' whose PIN just matched (see check_pin) and fill 'token'
+ * with it. Logging in again with the token (see check_token) costs no hash
+ * for VAULT_SECONDS since last used. Returns 'true' if issued, otherwise
+ * returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param token The token to be filled
+ * @return 'true' or 'false'
+ */
+bool grant_token(BANK bank, int id, long long unsigned int* token);
+
+/**
+ * @brief This function will check the given session 'token' against the ones
+ * issued to the account of the given 'id' (see grant_token), without
+ * hashing. Returns 'true' if the account exist and the token is valid,
+ * otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param token The token to be checked
+ * @return 'true' or 'false'
+ */
+bool check_token(BANK bank, int id, long long unsigned int token);
+
 /**
  * @brief This function will log the user into the bank by updating the 'bank'
  * structure reference. Also some check happens here, e.g. wether the given
@@ -136,6 +622,20 @@ bool login(BANK bank);
  */
 bool logout(BANK bank);
 
+/**
+ * @brief This function will deposit the given 'amount' into the bank account
+ * of the given 'id' (-1 if nobody is logged in), as long as it is of the given
+ * 'generation'. Returns 'true' if successfully deposited the given 'amount',
+ * otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @param amount The amount which has to be deposited into the account
+ * @return 'true' or 'false'
+ */
+bool account_deposit(BANK bank, int id, unsigned int generation,
+                     long long int amount);
+
 /**
  * @brief This function will deposit the given 'amount' into the logged in
  * user's bank account. Returns 'true' if successfully deposited the given
@@ -147,6 +647,21 @@ bool logout(BANK bank);
  */
 bool deposit(BANK bank, long long int amount);
 
+/**
+ * @brief This function will withdraw the given 'amount' from the bank account
+ * of the given 'id' (-1 if nobody is logged in), as long as it is of the given
+ * 'generation' (see debit_account). Returns DEBIT_DONE if successfully
+ * withdrawn the given 'amount', otherwise returns the reason why not.
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @param amount The amount which has to be withdrawn from the account
+ * @return DEBIT_DONE, DEBIT_NO_ACCOUNT, DEBIT_BAD_AMOUNT, DEBIT_NOT_ENOUGH,
+ * DEBIT_LIMITED or DEBIT_FAILED
+ */
+int account_withdraw(BANK bank, int id, unsigned int generation,
+                     long long int amount);
+
 /**
  * @brief This function will withdraw the given 'amount' from the logged in
  * user's bank account. Returns 'true' if successfully withdrawn the given
@@ -158,6 +673,18 @@ bool deposit(BANK bank, long long int amount);
  */
 bool withdraw(BANK bank, long long int amount);
 
+/**
+ * @brief This function will create a 'cash' of the given 'amount' and the bank
+ * account of the given 'id' (-1 if nobody is logged in). Return the 'cash'
+ * structure reference (not copy, thus need to be freed after usage) if
+ * successfully, otherwise returns 'NULL'.
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account
+ * @param amount The cash amount for withdrawal from the account
+ * @return CASH (reference, not copy) or 'NULL'
+ */
+CASH account_cash_withdraw(BANK bank, int id, long long int amount);
+
 /**
  * @brief This function will create a 'cash' of the given 'amount' and the
  * logged in user's bank account. Return the 'cash' structure reference (not
@@ -170,6 +697,48 @@ bool withdraw(BANK bank, long long int amount);
  */
 CASH create_cash_withdraw(BANK bank, long long int amount);
 
+/**
+ * @brief This function will complete the cash structure reference (if any) by
+ * minimizing the number of currency notes (aka maximizing the higher
+ * denominations) for whatever amount is remained after the preferred
+ * denominations. Returns 'true' if all the amount is converted to cash,
+ * otherwise returns 'false'.
+ * @param cash The 'cash' which has to be completed
+ * @return 'true' or 'false'
+ */
+bool complete_cash(CASH cash);
+
+/**
+ * @brief This function will fill the given 'cash' of the given 'amount' by
+ * maximizing the given 'denominations' in the order of preference (up to 'n'
+ * of them, 0 ends them) and completing the rest with the least notes, just
+ * like withdraw cash does but without displaying anything. Returns 'true' if
+ * filled, otherwise returns 'false' if a denomination don't exist.
+ * @param cash The 'cash' which has to be filled
+ * @param amount The amount of the cash
+ * @param denominations The denominations in the order of preference
+ * @param n The number of denominations
+ * @return 'true' or 'false'
+ */
+bool prefer_cash(CASH cash, long long int amount,
+                 const unsigned short denominations[], unsigned int n);
+
+/**
+ * @brief This function will update the cash structure reference (if any) by
+ * minimizing the number of currency notes (aka maximizing the higher
+ * denominations), and withdraw just like a simple withdraw happens from the
+ * bank account of the given 'id' (of the given 'generation'). Returns
+ * DEBIT_DONE if successfully withdrawn, otherwise returns the reason why not.
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account
+ * @param generation The generation of the account (or BANK_ANY_GENERATION)
+ * @param cash The 'cash' which has to be withdrawn from the account
+ * @return DEBIT_DONE, DEBIT_NO_ACCOUNT, DEBIT_BAD_AMOUNT, DEBIT_NOT_ENOUGH,
+ * DEBIT_LIMITED or DEBIT_FAILED
+ */
+int account_withdraw_cash(BANK bank, int id, unsigned int generation,
+                          CASH cash);
+
 /**
  * @brief This function will update the cash structure reference (if any) by
  * minimizing the number of currency notes (aka maximizing the higher
@@ -192,6 +761,16 @@ bool withdraw_cash(BANK bank, CASH cash);
  */
 bool maximize(CASH cash, int denomination);
 
+/**
+ * @brief This function will find every account whose user name starts with the
+ * given 'prefix' (case insensitive) using the bank's name index and display
+ * each match as soon as it is found. Returns the number of matches.
+ * @param bank The bank's data struture reference
+ * @param prefix The starting part of the user names to be found
+ * @return number of matches
+ */
+unsigned int find(BANK bank, string prefix);
+
 /**
  * @brief This function will display significant details of 'cash' structure
  * reference with text decoration using escape characters. The function returns
@@ -201,6 +780,17 @@ bool maximize(CASH cash, int denomination);
  */
 void display_cash(CASH cash);
 
+/**
+ * @brief This function will display some of the details of the bank account of
+ * the given 'id' (-1 if nobody is logged in) with text decoration using
+ * escape characters. The function returns nothing.
+ * @param bank The 'bank' from which some details of the account has to be
+ * displayed
+ * @param id The id of the logged in user's account
+ * @return void (nothing)
+ */
+void display_account(BANK bank, int id);
+
 /**
  * @brief This function will display some of the details of the logged in user's
  * bank account with text decoration using escape characters. The function
@@ -0,0 +1,375 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file batch.c
+ * @brief Implementation of batch (end-of-day and bulk operations) related
+ * functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "batch.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "console.h"
+#include "snapshot.h"
+
+/**
+ * @brief Maximum number of worker threads used for the batch
+ */
+#define BATCH_MAX_WORKERS 16
+
+/**
+ * @brief Number of balances processed as one contiguous block, a block never
+ * spans more than one stripe of the snapshot
+ */
+#define BATCH_BLOCK SNAPSHOT_SPAN
+
+/**
+ * @brief Structure of the work of a single batch thread
+ */
+typedef struct {
+  BANK bank;
+  unsigned int begin;
+  unsigned int end;
+  long long int rate;
+  long long int fee;
+  long long int interest;
+  long long int fees;
+} batch_chunk;
+
+/**
+ * @brief This function will return the current time of a monotonic clock in
+ * seconds.
+ */
+static double now_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief This function will apply the schedule to a contiguous block of
+ * 'quantity' balances in place and add up the interest credited and the fees
+ * charged. Written without branches on the data so that it vectorizes.
+ */
+static void apply_block(long long int* balance, unsigned int quantity,
+                        long long int rate, long long int fee,
+                        long long int* interest, long long int* fees) {
+  long long int credited = 0, charged = 0;
+  for (unsigned int i = 0; i < quantity; i++) {
+    // Interest: Split the balance so the product can't overflow
+    long long int amount = balance[i];
+    long long int quotient = amount / BATCH_RATE_SCALE;
+    long long int remainder = amount % BATCH_RATE_SCALE;
+    long long int gain = quotient * rate +
+                         (remainder * rate + BATCH_RATE_SCALE / 2) /
+                             BATCH_RATE_SCALE;
+    gain = (gain > LLONG_MAX - amount) ? LLONG_MAX - amount : gain;
+    amount += gain;
+
+    // Fee: Never beyond the balance
+    long long int cost = (amount < fee) ? amount : fee;
+    amount -= cost;
+
+    balance[i] = amount;
+    credited += gain;
+    charged += cost;
+  }
+  *interest += credited;
+  *fees += charged;
+}
+
+/**
+ * @brief This function is the body of a batch thread, it applies the schedule
+ * to the chunk handed over as 'argument' straight on the balance column,
+ * block by block, holding only the stripe of the block being written.
+ */
+static void* apply_chunk(void* argument) {
+  batch_chunk* chunk = (batch_chunk*)argument;
+  BANK bank = chunk->bank;
+  unsigned int first = chunk->begin;
+  while (first < chunk->end) {
+    // Split: Blocks are aligned to the stripes
+    unsigned int last = (first / BATCH_BLOCK + 1) * BATCH_BLOCK;
+    if (last > chunk->end || last < first) last = chunk->end;
+
+    // Apply: The column may move in between blocks
+    unsigned int stripe = stripe_of(first);
+    write_begin(bank->sync, stripe);
+    apply_block(bank->account.amount + first, last - first, chunk->rate,
+                chunk->fee, &chunk->interest, &chunk->fees);
+    journal_balances(bank->journal, first, bank->account.amount + first,
+                     last - first);
+    write_end(bank->sync, stripe);
+    first = last;
+  }
+  return NULL;
+}
+
+/**
+ * @brief This function will apply the end-of-day schedule to every account of
+ * the bank, i.e. credit the interest of 'rate' basis points (rounded half up
+ * to a whole rupee) and then charge the maintenance 'fee' (never beyond the
+ * balance, so no account goes negative). The accounts are split across worker
+ * threads and the balance column is processed in contiguous blocks, thus the
+ * inner loop vectorizes. Integer arithmetic makes the result independent of the
+ * number of threads. Returns 'true' if applied, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param rate The interest in basis points (0 to 10000)
+ * @param fee The maintenance fee to be charged from every account
+ * @return 'true' or 'false'
+ */
+bool apply_interest(BANK bank, long long int rate, long long int fee) {
+  // Check: Whether the bank exist and every balance is in memory!
+  if (bank == NULL || resident_accounts(bank) == false) return false;
+
+  // Check: Whether the schedule is valid
+  if (rate < 0 || rate > BATCH_RATE_SCALE || fee < 0) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Rate must be 0 to %d basis points and fee "
+        "can't be negative.\n",
+        BATCH_RATE_SCALE);
+    return false;
+  }
+  double start = now_seconds();
+  refresh_accounts(bank);
+
+  // Split: Accounts into one chunk per worker, at least a block each
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned int workers = (online > 0) ? online : 1;
+  if (workers > BATCH_MAX_WORKERS) workers = BATCH_MAX_WORKERS;
+  if (workers > bank->accounts_quantity / BATCH_BLOCK + 1)
+    workers = bank->accounts_quantity / BATCH_BLOCK + 1;
+  batch_chunk chunk[BATCH_MAX_WORKERS];
+  for (unsigned int i = 0; i < workers; i++) {
+    chunk[i].bank = bank;
+    chunk[i].begin =
+        (long long unsigned int)bank->accounts_quantity * i / workers;
+    chunk[i].end =
+        (long long unsigned int)bank->accounts_quantity * (i + 1) / workers;
+    chunk[i].rate = rate;
+    chunk[i].fee = fee;
+    chunk[i].interest = 0;
+    chunk[i].fees = 0;
+  }
+
+  // Apply: Every chunk in parallel (the first one on this thread)
+  pthread_t thread[BATCH_MAX_WORKERS];
+  bool spawned[BATCH_MAX_WORKERS] = {false};
+  for (unsigned int i = 1; i < workers; i++)
+    spawned[i] = pthread_create(&thread[i], NULL, apply_chunk, &chunk[i]) == 0;
+  apply_chunk(&chunk[0]);
+  long long int interest = chunk[0].interest, fees = chunk[0].fees;
+  for (unsigned int i = 1; i < workers; i++) {
+    if (spawned[i])
+      pthread_join(thread[i], NULL);
+    else
+      apply_chunk(&chunk[i]);
+    interest += chunk[i].interest;
+    fees += chunk[i].fees;
+  }
+
+  // Report: Totals and throughput of the whole batch
+  double elapsed = now_seconds() - start;
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Credited \e[38;5;214mRs. %lld/-\e[0m interest "
+      "and charged \e[38;5;214mRs. %lld/-\e[0m fees\n"
+      "  over %u account(s) using %u thread(s) in %.3f s\n"
+      "  (\e[38;5;214m%.0f\e[0m accounts/second).\n",
+      interest, fees, bank->accounts_quantity, workers, elapsed,
+      (elapsed > 0) ? bank->accounts_quantity / elapsed : 0.0);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will sort the 'n' operation indices of 'order' by the
+ * account id of their operation, a byte at a time starting from the least
+ * significant one. Being stable, the given order is kept within an account.
+ * The 'spare' must hold 'n' indices.
+ */
+static void sort_by_account(const batch_op ops[], unsigned int* order,
+                            unsigned int* spare, unsigned int n) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    // Count: Occurrences of each digit
+    unsigned int count[256] = {0};
+    for (unsigned int i = 0; i < n; i++)
+      count[(ops[order[i]].id >> shift) & 0xFF]++;
+
+    // Check: Nothing to move if every id shares the digit
+    if (count[(ops[order[0]].id >> shift) & 0xFF] == n) continue;
+
+    // Place: Every index after the smaller digits
+    unsigned int total = 0;
+    for (unsigned int d = 0; d < 256; d++) {
+      unsigned int quantity = count[d];
+      count[d] = total;
+      total += quantity;
+    }
+    for (unsigned int i = 0; i < n; i++)
+      spare[count[(ops[order[i]].id >> shift) & 0xFF]++] = order[i];
+    memcpy(order, spare, sizeof(unsigned int) * n);
+  }
+}
+
+/**
+ * @brief This function will apply the given 'n' deposits and withdrawals at
+ * once and fill 'results' (one per operation). Accounts and amounts are
+ * validated for the whole batch in a single (vectorizable) pass, afterwards
+ * the operations are grouped by account (keeping the given order within an
+ * account) and each group is applied holding its stripe once, checking the
+ * funds and limits as the group goes. Returns the number of operations done.
+ * @param bank The bank's data struture reference
+ * @param ops The operations to be applied
+ * @param n The number of operations
+ * @param results The result (BATCH_DONE, ...) of every operation
+ * @return number of operations done
+ */
+unsigned int bank_apply_batch(BANK bank, const batch_op ops[], unsigned int n,
+                              int results[]) {
+  // Check: Whether the bank, operations and results exist!
+  if (bank == NULL || ops == NULL || results == NULL || n == 0) return 0;
+  if (resident_accounts(bank) == false) {
+    for (unsigned int i = 0; i < n; i++) results[i] = BATCH_NO_MEMORY;
+    return 0;
+  }
+
+  // Create: Space for the signed changes and the grouping
+  long long int* change = (long long int*)malloc(sizeof(long long int) * n);
+  unsigned int* order = (unsigned int*)malloc(sizeof(unsigned int) * n);
+  unsigned int* spare = (unsigned int*)malloc(sizeof(unsigned int) * n);
+  if (change == NULL || order == NULL || spare == NULL) {
+    for (unsigned int i = 0; i < n; i++) results[i] = BATCH_NO_MEMORY;
+    free(change);
+    free(order);
+    free(spare);
+    return 0;
+  }
+
+  // Validate: Every operation at once, without branches on the data
+  unsigned int quantity = refresh_accounts(bank);
+  for (unsigned int i = 0; i < n; i++) {
+    int known = ops[i].id < quantity;
+    int typed = ops[i].type == BATCH_DEPOSIT ||
+                ops[i].type == BATCH_WITHDRAW ||
+                ops[i].type == BATCH_WITHDRAW_CASH;
+    int valid = known & typed & (ops[i].amount > 0);
+    results[i] = known ? (valid ? BATCH_DONE : BATCH_BAD_AMOUNT)
+                       : BATCH_NO_ACCOUNT;
+    long long int sign = (ops[i].type == BATCH_DEPOSIT) ? 1 : -1;
+    change[i] = valid * sign * ops[i].amount;
+  }
+
+  // Group: Operations of the same account next to each other
+  unsigned int valid = 0;
+  for (unsigned int i = 0; i < n; i++)
+    if (results[i] == BATCH_DONE) order[valid++] = i;
+  if (valid > 0) sort_by_account(ops, order, spare, valid);
+
+  // Apply: Each group holding its stripe once, in the given order
+  unsigned int done = 0;
+  for (unsigned int first = 0; first < valid;) {
+    unsigned int id = ops[order[first]].id;
+    unsigned int last = first;
+    while (last < valid && ops[order[last]].id == id) last++;
+
+    write_begin(bank->sync, stripe_of(id));
+    bool closed = bank->account.id[id] == BANK_CLOSED;
+    fold_balance(bank, id);
+    long long int balance = bank->account.amount[id];
+    for (unsigned int i = first; i < last; i++) {
+      unsigned int op = order[i];
+      if (closed) {
+        results[op] = BATCH_NO_ACCOUNT;
+        continue;
+      }
+      if (change[op] < 0)
+        results[op] = batch_withdraw(bank, id, &balance, -change[op],
+                                     ops[op].type == BATCH_WITHDRAW_CASH);
+      else
+        balance += change[op];
+      if (results[op] == BATCH_DONE) done++;
+    }
+    bank->account.amount[id] = balance;
+    if (closed == false)
+      journal_balances(bank->journal, id, &bank->account.amount[id], 1);
+    write_end(bank->sync, stripe_of(id));
+    first = last;
+  }
+
+  // Clean: Working space
+  free(change);
+  free(order);
+  free(spare);
+
+  // Status: Number of operations done
+  return done;
+}
+
+/**
+ * @brief This function will debit a withdrawal of a batch (or a script) from
+ * the given 'balance' of the account of the given 'id', just like any other
+ * withdrawal (see debit_account). The stripe of the account must be held.
+ * Returns BATCH_DONE, otherwise returns BATCH_NOT_ENOUGH or BATCH_LIMITED.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param balance The balance of the account
+ * @param amount The amount which has to be withdrawn
+ * @param cash Whether the amount is withdrawn as cash
+ * @return BATCH_DONE, BATCH_NOT_ENOUGH or BATCH_LIMITED
+ */
+int batch_withdraw(BANK bank, unsigned int id, long long int* balance,
+                   long long int amount, bool cash) {
+  switch (debit_account(bank, id, balance, amount, cash)) {
+    case DEBIT_DONE:
+      return BATCH_DONE;
+    case DEBIT_LIMITED:
+      return BATCH_LIMITED;
+    default:
+      return BATCH_NOT_ENOUGH;
+  }
+}
@@ -0,0 +1,131 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file batch.h
+ * @brief Interface of batch (end-of-day and bulk operations) related
+ * functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+
+#include "bank.h"
+
+/**
+ * @brief Rates are given in basis points, thus 10000 means 100%
+ */
+#define BATCH_RATE_SCALE 10000
+
+/**
+ * @brief Types of the operations of a batch (a cash withdrawal is debited as
+ * a withdrawal, its amount counted by the analytics of the cash too)
+ */
+enum { BATCH_DEPOSIT, BATCH_WITHDRAW, BATCH_WITHDRAW_CASH };
+
+/**
+ * @brief Results of the operations of a batch
+ */
+enum {
+  BATCH_DONE,
+  BATCH_NO_ACCOUNT,
+  BATCH_BAD_AMOUNT,
+  BATCH_NOT_ENOUGH,
+  BATCH_NO_MEMORY,
+  BATCH_LIMITED
+};
+
+/**
+ * @brief Structure of a single operation of a batch
+ */
+typedef struct {
+  unsigned int id;
+  int type;
+  long long int amount;
+} batch_op;
+
+/**
+ * @brief This function will apply the given 'n' deposits and withdrawals at
+ * once and fill 'results' (one per operation). Accounts and amounts are
+ * validated for the whole batch in a single (vectorizable) pass, afterwards
+ * the operations are grouped by account (keeping the given order within an
+ * account) and each group is applied holding its stripe once, checking the
+ * funds and limits as the group goes. Returns the number of operations done.
+ * @param bank The bank's data struture reference
+ * @param ops The operations to be applied
+ * @param n The number of operations
+ * @param results The result (BATCH_DONE, ...) of every operation
+ * @return number of operations done
+ */
+unsigned int bank_apply_batch(BANK bank, const batch_op ops[], unsigned int n,
+                              int results[]);
+
+/**
+ * @brief This function will debit a withdrawal of a batch (or a script) from
+ * the given 'balance' of the account of the given 'id', just like any other
+ * withdrawal (see debit_account). The stripe of the account must be held.
+ * Returns BATCH_DONE, otherwise returns BATCH_NOT_ENOUGH or BATCH_LIMITED.
+ * @param bank The bank's data struture reference
+ * @param id The id of the account
+ * @param balance The balance of the account
+ * @param amount The amount which has to be withdrawn
+ * @param cash Whether the amount is withdrawn as cash
+ * @return BATCH_DONE, BATCH_NOT_ENOUGH or BATCH_LIMITED
+ */
+int batch_withdraw(BANK bank, unsigned int id, long long int* balance,
+                   long long int amount, bool cash);
+
+/**
+ * @brief This function will apply the end-of-day schedule to every account of
+ * the bank, i.e. credit the interest of 'rate' basis points (rounded half up
+ * to a whole rupee) and then charge the maintenance 'fee' (never beyond the
+ * balance, so no account goes negative). The accounts are split across worker
+ * threads and the balance column is processed in contiguous blocks, thus the
+ * inner loop vectorizes. Integer arithmetic makes the result independent of the
+ * number of threads. Returns 'true' if applied, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param rate The interest in basis points (0 to 10000)
+ * @param fee The maintenance fee to be charged from every account
+ * @return 'true' or 'false'
+ */
+bool apply_interest(BANK bank, long long int rate, long long int fee);
+
+#endif
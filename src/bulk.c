@@ -0,0 +1,1067 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file bulk.c
+ * @brief Implementation of bulk (import/export) related functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#define _GNU_SOURCE
+
+#include "bulk.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "console.h"
+
+
+/**
+ * @brief Maximum number of worker threads used for parsing
+ */
+#define BULK_MAX_WORKERS 16
+
+/**
+ * @brief Minimum number of bytes worth handing over to a worker thread. Every
+ * row costs a PIN hash (about half a millisecond, see seal_pin), thus the
+ * import is bound by the hashing rather than the parsing, and a chunk of a
+ * few hundred rows already outweighs starting a thread
+ */
+#define BULK_MIN_CHUNK (1 << 14)
+
+/**
+ * @brief Size of the buffer used for writing exports
+ */
+#define BULK_WRITE_BUFFER (1 << 20)
+
+/**
+ * @brief Version of the binary export layout
+ */
+#define BULK_BINARY_VERSION 1
+
+/**
+ * @brief Version of the checkpoint layout
+ */
+#define BULK_CHECKPOINT_VERSION 1
+
+/**
+ * @brief Size of a chunk of the journal read at once by the recovery, larger
+ * than any record
+ */
+#define BULK_RECOVER_CHUNK (16 << 20)
+
+/**
+ * @brief Structure of a parsed CSV row, the name is a slice of the mapping
+ */
+typedef struct {
+  const char* name;
+  unsigned int length;
+  long long unsigned int pin;
+  long long int amount;
+} import_row;
+
+/**
+ * @brief Structure of the work of a single parser thread
+ */
+typedef struct {
+  const char* begin;
+  const char* end;
+  import_row* rows;
+  size_t quantity;
+  size_t capacity;
+  size_t rejected;
+  double hashing;
+  bool failed;
+} import_chunk;
+
+/**
+ * @brief This function will return the current time of a monotonic clock in
+ * seconds.
+ */
+static double now_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief This function will parse the unsigned decimal number in between
+ * 'begin' and 'end' into 'value'. Returns 'true' if the field is a number that
+ * fits in 18 digits, otherwise returns 'false'.
+ */
+static bool parse_number(const char* begin, const char* end,
+                         long long unsigned int* value) {
+  // Check: Non empty and can't overflow
+  if (begin == end || end - begin > 18) return false;
+
+  // Parse: Digit by digit
+  long long unsigned int result = 0;
+  for (const char* c = begin; c < end; c++) {
+    if (*c < '0' || *c > '9') return false;
+    result = result * 10 + (*c - '0');
+  }
+  *value = result;
+  return true;
+}
+
+/**
+ * @brief This function will parse a single "name,pin,balance" line in between
+ * 'begin' and 'end' into 'row', adding the seconds spent hashing its PIN to
+ * 'hashing'. Returns 'true' if parsed, otherwise returns 'false' for invalid
+ * rows.
+ */
+static bool parse_row(const char* begin, const char* end, import_row* row,
+                      double* hashing) {
+  // Split: Into three fields by commas
+  const char* first = memchr(begin, ',', end - begin);
+  if (first == NULL) return false;
+  const char* second = memchr(first + 1, ',', end - first - 1);
+  if (second == NULL) return false;
+
+  // Check: The name is not empty and can't hold the terminator
+  if (first == begin || memchr(begin, '\0', first - begin) != NULL)
+    return false;
+
+  // Parse: PIN and opening balance
+  long long unsigned int pin, amount;
+  if (parse_number(first + 1, second, &pin) == false) return false;
+  if (parse_number(second + 1, end, &amount) == false) return false;
+
+  // Configure: The name stays a slice of the mapping, the PIN is hashed
+  // (by every parser thread in parallel)
+  double start = now_seconds();
+  bool sealed = seal_pin(pin, &row->pin);
+  *hashing += now_seconds() - start;
+  if (sealed == false) return false;
+  row->name = begin;
+  row->length = first - begin;
+  row->amount = (long long int)amount;
+  return true;
+}
+
+/**
+ * @brief This function is the body of a parser thread, it parses every line of
+ * the chunk handed over as 'argument' into the chunk's own rows.
+ */
+static void* parse_chunk(void* argument) {
+  import_chunk* chunk = (import_chunk*)argument;
+  const char* line = chunk->begin;
+  while (line < chunk->end) {
+    // Find: The end of the line (and trim the carriage return, if any)
+    const char* next = memchr(line, '\n', chunk->end - line);
+    const char* end = (next == NULL) ? chunk->end : next;
+    const char* trim = (end > line && end[-1] == '\r') ? end - 1 : end;
+
+    if (trim > line) {
+      // Create: Make space for more rows
+      if (chunk->quantity == chunk->capacity) {
+        size_t capacity = (chunk->capacity == 0) ? 4096 : chunk->capacity * 2;
+        import_row* rows =
+            (import_row*)realloc(chunk->rows, sizeof(import_row) * capacity);
+        if (rows == NULL) {
+          chunk->failed = true;
+          return NULL;
+        }
+        chunk->rows = rows;
+        chunk->capacity = capacity;
+      }
+
+      // Parse: Single row
+      if (parse_row(line, trim, &chunk->rows[chunk->quantity],
+                    &chunk->hashing) == true)
+        chunk->quantity++;
+      else
+        chunk->rejected++;
+    }
+    line = end + 1;
+  }
+  return NULL;
+}
+
+/**
+ * @brief This function will import the accounts listed in the CSV file at the
+ * given 'path' (one "name,pin,balance" row per line, header optional) into
+ * the bank. The file is memory mapped and split into chunks parsed in
+ * parallel by worker threads, afterwards the account store and the name index
+ * are built in one pass. The PINs are hashed by the parser threads, which
+ * bounds the import (one thread per CPU, see BULK_MIN_CHUNK), thus the
+ * report includes the hashing time per PIN. Rows with invalid fields or
+ * already existing user names are rejected. Returns 'true' if the file is
+ * imported, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the CSV file
+ * @return 'true' or 'false'
+ */
+bool import_accounts(BANK bank, string path) {
+  // Check: Whether the bank and path exist!
+  if (bank == NULL || path == NULL) return false;
+  double start = now_seconds();
+
+  // Map: The whole file, read only
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't open \e[38;5;214m%s\e[0m.\n", path);
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) == -1 || info.st_size == 0) {
+    console_printf("\e[38;5;196mError:\e[0m Nothing to import.\n");
+    close(fd);
+    return false;
+  }
+  size_t size = info.st_size;
+  const char* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't map \e[38;5;214m%s\e[0m.\n", path);
+    return false;
+  }
+  madvise((void*)data, size, MADV_SEQUENTIAL);
+
+  // Skip: The header line, if any
+  const char* begin = data;
+  const char* end = data + size;
+  if (size >= 5 && strncmp(begin, "name,", 5) == 0) {
+    const char* next = memchr(begin, '\n', size);
+    begin = (next == NULL) ? end : next + 1;
+  }
+
+  // Split: Into chunks ending at line boundaries, one worker per CPU as
+  // hashing the PINs keeps every worker busy (see BULK_MIN_CHUNK)
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t workers = (online > 0) ? (size_t)online : 1;
+  size_t bytes = (size_t)(end - begin);
+  if (workers > BULK_MAX_WORKERS) workers = BULK_MAX_WORKERS;
+  if (workers > bytes / BULK_MIN_CHUNK + 1)
+    workers = bytes / BULK_MIN_CHUNK + 1;
+  import_chunk chunk[BULK_MAX_WORKERS];
+  memset(chunk, 0, sizeof(chunk));
+  const char* cut = begin;
+  for (size_t i = 0; i < workers; i++) {
+    chunk[i].begin = cut;
+    cut = (i + 1 == workers) ? end : begin + (end - begin) * (i + 1) / workers;
+    if (cut < chunk[i].begin) cut = chunk[i].begin;
+    const char* next = memchr(cut, '\n', end - cut);
+    cut = (next == NULL) ? end : next + 1;
+    chunk[i].end = cut;
+  }
+
+  // Parse: Every chunk in parallel (the first one on this thread)
+  pthread_t thread[BULK_MAX_WORKERS];
+  bool spawned[BULK_MAX_WORKERS] = {false};
+  for (size_t i = 1; i < workers; i++)
+    spawned[i] = pthread_create(&thread[i], NULL, parse_chunk, &chunk[i]) == 0;
+  parse_chunk(&chunk[0]);
+  for (size_t i = 1; i < workers; i++) {
+    if (spawned[i])
+      pthread_join(thread[i], NULL);
+    else
+      parse_chunk(&chunk[i]);
+  }
+
+  // Count: Rows parsed by every worker
+  size_t parsed = 0, rejected = 0;
+  double hashing = 0;
+  bool failed = false;
+  for (size_t i = 0; i < workers; i++) {
+    parsed += chunk[i].quantity;
+    rejected += chunk[i].rejected;
+    hashing += chunk[i].hashing;
+    failed = failed || chunk[i].failed;
+  }
+
+  // Create: Make space for every new account at once
+  unsigned int quantity = bank->accounts_quantity;
+  if (failed || parsed > (unsigned int)-1 / 2 - quantity ||
+      reserve_accounts(bank, quantity + parsed) == false) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    for (size_t i = 0; i < workers; i++) free(chunk[i].rows);
+    munmap((void*)data, size);
+    return false;
+  }
+
+  // Build: The account store and the name index in one pass
+  for (size_t i = 0; i < workers; i++) {
+    for (size_t r = 0; r < chunk[i].quantity; r++) {
+      import_row* row = &chunk[i].rows[r];
+      if (add_account(bank, row->pin, row->name, row->length, row->amount) ==
+          -1)
+        rejected++;
+    }
+    free(chunk[i].rows);
+  }
+  size_t imported = bank->accounts_quantity - quantity;
+  munmap((void*)data, size);
+
+  // Report: Throughput of the whole import, and the share of the hashing
+  double elapsed = now_seconds() - start;
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Imported \e[38;5;214m%zu\e[0m account(s), "
+      "rejected \e[38;5;214m%zu\e[0m row(s) using %zu thread(s)\n"
+      "  in %.3f s (\e[38;5;214m%.0f\e[0m rows/second), hashed %zu PIN(s)\n"
+      "  at %.3f ms each (%.3f s of thread time).\n",
+      imported, rejected, workers, elapsed,
+      (elapsed > 0) ? (imported + rejected) / elapsed : 0.0, parsed,
+      (parsed > 0) ? hashing * 1000 / parsed : 0.0, hashing);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief Structure of a buffered writer, the buffer is flushed by large writes
+ */
+typedef struct {
+  int fd;
+  char* buffer;
+  size_t used;
+  bool failed;
+} export_writer;
+
+/**
+ * @brief This function will write the buffered bytes of the writer out.
+ */
+static void flush_writer(export_writer* writer) {
+  size_t done = 0;
+  while (done < writer->used && writer->failed == false) {
+    ssize_t written = write(writer->fd, writer->buffer + done,
+                            writer->used - done);
+    if (written <= 0)
+      writer->failed = true;
+    else
+      done += written;
+  }
+  writer->used = 0;
+}
+
+/**
+ * @brief This function will append 'size' bytes to the writer's buffer,
+ * flushing it whenever it gets full.
+ */
+static void put_bytes(export_writer* writer, const void* bytes, size_t size) {
+  const char* from = (const char*)bytes;
+  while (size > 0) {
+    if (writer->used == BULK_WRITE_BUFFER) flush_writer(writer);
+    size_t part = BULK_WRITE_BUFFER - writer->used;
+    if (part > size) part = size;
+    memcpy(writer->buffer + writer->used, from, part);
+    writer->used += part;
+    from += part;
+    size -= part;
+  }
+}
+
+/**
+ * @brief This function will append the decimal form of 'value' to the writer.
+ */
+static void put_number(export_writer* writer, long long int value) {
+  char digits[24];
+  int length = snprintf(digits, sizeof(digits), "%lld", value);
+  put_bytes(writer, digits, length);
+}
+
+/**
+ * @brief This function will append the name to the writer as a CSV field,
+ * quoted only if it holds a comma, quote or line break.
+ */
+static void put_csv_field(export_writer* writer, const char* field) {
+  size_t length = strlen(field);
+  if (strpbrk(field, ",\"\r\n") == NULL) {
+    put_bytes(writer, field, length);
+    return;
+  }
+  put_bytes(writer, "\"", 1);
+  for (size_t i = 0; i < length; i++) {
+    if (field[i] == '"') put_bytes(writer, "\"", 1);
+    put_bytes(writer, &field[i], 1);
+  }
+  put_bytes(writer, "\"", 1);
+}
+
+/**
+ * @brief This function will stream every account of the bank as CSV rows.
+ */
+static void export_csv(BANK bank, export_writer* writer) {
+  const char header[] = "id,name,balance\n";
+  put_bytes(writer, header, sizeof(header) - 1);
+  for (unsigned int i = 0; i < bank->accounts_quantity; i++) {
+    if (bank->account.id[i] == BANK_CLOSED) continue;
+    put_number(writer, bank->account.id[i]);
+    put_bytes(writer, ",", 1);
+    put_csv_field(writer, name_text(bank->names, &bank->account.name[i]));
+    put_bytes(writer, ",", 1);
+    put_number(writer, bank->account.amount[i]);
+    put_bytes(writer, "\n", 1);
+  }
+}
+
+/**
+ * @brief This function will stream every account of the bank in the columnar
+ * binary layout, one column after another.
+ */
+static void export_binary(BANK bank, export_writer* writer) {
+  // Header: Magic, version and count
+  unsigned int version = BULK_BINARY_VERSION;
+  long long unsigned int count = bank->accounts_quantity;
+  put_bytes(writer, "TCXB", 4);
+  put_bytes(writer, &version, sizeof(version));
+  put_bytes(writer, &count, sizeof(count));
+
+  // Columns: ids and balances are copied straight out of the account store
+  put_bytes(writer, bank->account.id, sizeof(unsigned int) * count);
+  put_bytes(writer, bank->account.amount, sizeof(long long int) * count);
+
+  // Columns: name lengths and name bytes
+  for (unsigned int i = 0; i < bank->accounts_quantity; i++)
+    put_bytes(writer, &bank->account.name[i].length, sizeof(unsigned int));
+  for (unsigned int i = 0; i < bank->accounts_quantity; i++)
+    put_bytes(writer, name_text(bank->names, &bank->account.name[i]),
+              bank->account.name[i].length);
+}
+
+/**
+ * @brief This function will export the state of every account of the bank to
+ * the file at the given 'path' in the given 'format', either "csv" (one
+ * "id,name,balance" row per account) or "bin" (columnar, see below). Rows are
+ * streamed through a fixed size buffer with large writes, so memory use stays
+ * constant whatever the account count. The export runs in between commands,
+ * thus reads a consistent snapshot of the bank. Returns 'true' if exported,
+ * otherwise returns 'false'.
+ *
+ * Binary layout (native byte order): "TCXB", u32 version, u64 count, then the
+ * columns u32 id[count], i64 balance[count], u32 name_length[count] and the
+ * name bytes (without terminators) one after another. The id of a closed
+ * account is 4294967295 (its balance and name are empty), the CSV skips it.
+ * @param bank The bank's data struture reference
+ * @param path The path of the file to be written
+ * @param format The format of the file, "csv" or "bin"
+ * @return 'true' or 'false'
+ */
+bool export_accounts(BANK bank, string path, string format) {
+  // Check: Whether the bank, path and format exist, and every balance is in
+  // memory!
+  if (bank == NULL || path == NULL || format == NULL ||
+      resident_accounts(bank) == false)
+    return false;
+  bool binary = strcmp(format, "bin") == 0;
+  if (binary == false && strcmp(format, "csv") != 0) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Format \e[38;5;214m%s\e[0m don't exist.\n",
+        format);
+    return false;
+  }
+  double start = now_seconds();
+
+  // Create: The file and the fixed size buffer
+  export_writer writer = {-1, NULL, 0, false};
+  writer.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (writer.fd == -1) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't create \e[38;5;214m%s\e[0m.\n",
+        path);
+    return false;
+  }
+  writer.buffer = (char*)malloc(BULK_WRITE_BUFFER);
+  if (writer.buffer == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    close(writer.fd);
+    return false;
+  }
+
+  // Export: Stream every account, even the ones of other processes (if any)
+  refresh_accounts(bank);
+  if (binary)
+    export_binary(bank, &writer);
+  else
+    export_csv(bank, &writer);
+  flush_writer(&writer);
+  free(writer.buffer);
+  if (close(writer.fd) == -1) writer.failed = true;
+  if (writer.failed) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't write \e[38;5;214m%s\e[0m.\n",
+        path);
+    return false;
+  }
+
+  // Report: Throughput of the whole export
+  double elapsed = now_seconds() - start;
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Exported \e[38;5;214m%u\e[0m account(s) in "
+      "%.3f s (\e[38;5;214m%.0f\e[0m rows/second).\n",
+      bank->accounts_quantity, elapsed,
+      (elapsed > 0) ? bank->accounts_quantity / elapsed : 0.0);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will append a new account of the given details at the
+ * end of the account store, even if closed accounts could be reused (the ids
+ * being restored must not change). Returns the id of the new account,
+ * otherwise returns -1.
+ */
+static int append_account(BANK bank, long long unsigned int pin,
+                          const char* name, unsigned int length,
+                          long long int amount) {
+  if (bank->closed.quantity == 0)
+    return add_account(bank, pin, name, length, amount);
+  int id = add_closed_account(bank);
+  if (id == -1) return -1;
+  return reopen_account(bank, id, pin, name, length, amount);
+}
+
+/**
+ * @brief Structure of a run of balances of consecutive accounts, a slice of
+ * the chunk being recovered
+ */
+typedef struct {
+  unsigned int id;
+  unsigned int count;
+  const long long int* amounts;
+} recover_run;
+
+/**
+ * @brief Structure of the partition of a single recovery thread
+ */
+typedef struct {
+  BANK bank;
+  recover_run* runs;
+  size_t quantity;
+  size_t capacity;
+} recover_part;
+
+/**
+ * @brief Structure of the state of a recovery
+ */
+typedef struct {
+  BANK bank;
+  recover_part* parts;
+  unsigned int workers;
+  long long unsigned int accounts;
+  long long unsigned int balances;
+  bool stop;
+} recover_state;
+
+/**
+ * @brief This function will hand the run of 'count' balances from 'id' on
+ * over to the partitions, split by blocks of ids. Returns 'true' if handed
+ * over, otherwise returns 'false' if out of memory.
+ */
+static bool dispatch_run(recover_state* state, unsigned int id,
+                         unsigned int count, const long long int* amounts) {
+  while (count > 0) {
+    // Split: At the end of the block of the id
+    unsigned int part = SNAPSHOT_SPAN - id % SNAPSHOT_SPAN;
+    if (part > count) part = count;
+    recover_part* owner =
+        &state->parts[(id / SNAPSHOT_SPAN) % state->workers];
+
+    // Create: Make space for more runs
+    if (owner->quantity == owner->capacity) {
+      size_t capacity = (owner->capacity == 0) ? 4096 : owner->capacity * 2;
+      recover_run* runs =
+          (recover_run*)realloc(owner->runs, sizeof(recover_run) * capacity);
+      if (runs == NULL) return false;
+      owner->runs = runs;
+      owner->capacity = capacity;
+    }
+    owner->runs[owner->quantity++] = (recover_run){id, part, amounts};
+    state->balances += part;
+    id += part;
+    amounts += part;
+    count -= part;
+  }
+  return true;
+}
+
+/**
+ * @brief This function is the body of a recovery thread, it writes the runs
+ * of its partition in their order. Nobody else uses the bank meanwhile and
+ * the partitions hold distinct accounts, thus no lock is taken.
+ */
+static void* apply_part(void* argument) {
+  recover_part* part = (recover_part*)argument;
+  long long int* amount = part->bank->account.amount;
+  for (size_t i = 0; i < part->quantity; i++)
+    memcpy(amount + part->runs[i].id, part->runs[i].amounts,
+           sizeof(long long int) * part->runs[i].count);
+  part->quantity = 0;
+  return NULL;
+}
+
+/**
+ * @brief This function will apply the balances handed over to the partitions
+ * so far right away, e.g. before the account they belong to is closed.
+ */
+static void drain_parts(recover_state* state) {
+  for (unsigned int i = 0; i < state->workers; i++)
+    apply_part(&state->parts[i]);
+}
+
+/**
+ * @brief This function will parse the records of the chunk of 'size' bytes,
+ * creating the accounts right away and handing the balances over to the
+ * partitions. The parse stops at a partial record (left for the next chunk)
+ * or, for good, at a torn or invalid one. Returns the number of bytes parsed.
+ */
+static size_t parse_journal(recover_state* state, const char* chunk,
+                            size_t size) {
+  BANK bank = state->bank;
+  size_t used = 0;
+  while (size - used >= sizeof(journal_record)) {
+    // Check: The record is complete and not torn
+    journal_record header;
+    memcpy(&header, chunk + used, sizeof(journal_record));
+    if (header.type != JOURNAL_CREATE && header.type != JOURNAL_BALANCE &&
+        header.type != JOURNAL_ACCOUNTS && header.type != JOURNAL_CLOSE) {
+      state->stop = true;
+      break;
+    }
+    size_t record = sizeof(journal_record) + journal_body(&header);
+    if (record > size - used) break;
+    const char* body = chunk + used + sizeof(journal_record);
+    bool valid = journal_check(chunk + used, record) == header.check;
+
+    // Create: The account, it gets the next id or reuses a closed one (unless
+    // it is checkpointed), whose balances so far are applied first
+    if (valid && header.type == JOURNAL_CREATE &&
+        (header.id >= bank->accounts_quantity ||
+         bank->account.id[header.id] == BANK_CLOSED)) {
+      long long unsigned int pin;
+      memcpy(&pin, body, sizeof(pin));
+      if (header.id < bank->accounts_quantity) {
+        drain_parts(state);
+        valid = reopen_account(bank, header.id, pin, body + sizeof(pin),
+                               header.length, header.amount) == (int)header.id;
+      } else
+        valid = header.id == bank->accounts_quantity &&
+                append_account(bank, pin, body + sizeof(pin), header.length,
+                               header.amount) == (int)header.id;
+      state->accounts += valid;
+    }
+
+    // Close: The account, once its balances so far are applied
+    if (valid && header.type == JOURNAL_CLOSE) {
+      valid = header.id < bank->accounts_quantity;
+      if (valid) drain_parts(state);
+      if (valid && bank->account.id[header.id] != BANK_CLOSED)
+        valid = close_account(bank, header.id, BANK_ANY_GENERATION);
+    }
+
+    // Partition: The balances of known accounts
+    if (valid && header.type == JOURNAL_BALANCE) {
+      const long long int* amounts =
+          (const long long int*)(chunk + used + offsetof(journal_record,
+                                                         amount));
+      valid = header.id < bank->accounts_quantity &&
+              header.length < bank->accounts_quantity - header.id &&
+              dispatch_run(state, header.id, 1, amounts) &&
+              dispatch_run(state, header.id + 1, header.length,
+                           (const long long int*)body);
+    }
+    if (valid && header.type == JOURNAL_ACCOUNTS) {
+      const journal_entry* entries = (const journal_entry*)body;
+      for (unsigned int i = 0; i < header.length && valid; i++)
+        valid = entries[i].id < bank->accounts_quantity &&
+                dispatch_run(state, entries[i].id, 1, &entries[i].amount);
+    }
+
+    // Check: Stop for good at the first torn or invalid record
+    if (valid == false) {
+      state->stop = true;
+      break;
+    }
+    used += record;
+  }
+  return used;
+}
+
+/**
+ * @brief This function will read up to 'size' bytes from 'fd' into 'buffer',
+ * less only at the end of the file. Returns the number of bytes read,
+ * otherwise returns -1.
+ */
+static ssize_t read_chunk(int fd, char* buffer, size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t count = read(fd, buffer + done, size - done);
+    if (count == -1 && errno == EINTR) continue;
+    if (count == -1) return -1;
+    if (count == 0) break;
+    done += count;
+  }
+  return done;
+}
+
+/**
+ * @brief This function will recover the accounts of the bank from the journal
+ * at the given 'path' (nothing is done if it doesn't exist yet), from the given
+ * 'offset' on if the bank is loaded from a checkpoint taken there (accounts
+ * already loaded are not created again). The journal is read in large
+ * sequential chunks, every chunk is parsed once (creating the accounts it
+ * holds, in order) and its balances are partitioned by account id, a block of
+ * ids per worker thread. The workers then apply their partitions in parallel
+ * while the next chunk is read. Balances are absolute and the records of an
+ * account keep their order, thus the last one wins. A torn record at the end
+ * (e.g. a crash in between a write) is dropped from the file. Returns 'true' if
+ * recovered, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the journal file
+ * @param offset The position of the checkpoint in the journal (or 0)
+ * @return 'true' or 'false'
+ */
+bool recover_accounts(BANK bank, string path,
+                      long long unsigned int offset) {
+  // Check: Whether the bank and path exist!
+  if (bank == NULL || path == NULL) return false;
+  double start = now_seconds();
+
+  // Open: The journal, a new one has nothing to recover
+  int fd = open(path, O_RDWR | O_CLOEXEC);
+  if (fd == -1 && errno == ENOENT) return true;
+  struct stat info;
+  char header[8];
+  unsigned int version = JOURNAL_VERSION;
+  if (fd == -1 || fstat(fd, &info) == -1) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't open \e[38;5;214m%s\e[0m.\n", path);
+    if (fd != -1) close(fd);
+    return false;
+  }
+  if (info.st_size == 0) {
+    close(fd);
+    return true;
+  }
+  if (read_chunk(fd, header, sizeof(header)) != sizeof(header) ||
+      memcmp(header, "TCXJ", 4) != 0 ||
+      memcmp(header + 4, &version, sizeof(version)) != 0) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m \e[38;5;214m%s\e[0m is not a journal.\n",
+        path);
+    close(fd);
+    return false;
+  }
+  // Check: The checkpoint is not ahead of the journal, then skip up to it
+  if (offset > (long long unsigned int)info.st_size) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Journal \e[38;5;214m%s\e[0m is behind the "
+        "checkpoint.\n",
+        path);
+    close(fd);
+    return false;
+  }
+
+  // Check: The journal is not trimmed after the offset (see trim_journal),
+  // i.e. the checkpoint is not older than the one the journal is trimmed to
+  off_t from = (off_t)((offset > sizeof(header)) ? offset : sizeof(header));
+  off_t hole = lseek(fd, from, SEEK_HOLE);
+  if (hole != -1 && hole < info.st_size) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Journal \e[38;5;214m%s\e[0m is trimmed up "
+        "to a later checkpoint.\n",
+        path);
+    close(fd);
+    return false;
+  }
+  lseek(fd, sizeof(header), SEEK_SET);
+  long long unsigned int valid = sizeof(header);
+  if (offset > valid && lseek(fd, offset, SEEK_SET) == (off_t)offset)
+    valid = offset;
+  posix_fadvise(fd, valid, 0, POSIX_FADV_SEQUENTIAL);
+
+  // Create: Two chunks (one read while the other is applied) and partitions
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  recover_state state = {bank, NULL, (online > 0) ? online : 1, 0, 0, false};
+  if (state.workers > BULK_MAX_WORKERS) state.workers = BULK_MAX_WORKERS;
+  char* chunk[2] = {(char*)malloc(BULK_RECOVER_CHUNK),
+                    (char*)malloc(BULK_RECOVER_CHUNK)};
+  state.parts = (recover_part*)calloc(state.workers, sizeof(recover_part));
+  if (chunk[0] == NULL || chunk[1] == NULL || state.parts == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    free(chunk[0]);
+    free(chunk[1]);
+    free(state.parts);
+    close(fd);
+    return false;
+  }
+  for (unsigned int i = 0; i < state.workers; i++) state.parts[i].bank = bank;
+
+  // Recover: Chunk by chunk
+  long long unsigned int skipped = valid;
+  ssize_t filled = read_chunk(fd, chunk[0], BULK_RECOVER_CHUNK);
+  bool failed = filled == -1;
+  for (unsigned int current = 0; filled > 0 && state.stop == false;
+       current ^= 1) {
+    // Parse: Create the accounts and partition the balances
+    size_t used = parse_journal(&state, chunk[current], filled);
+    valid += used;
+
+    // Apply: Every partition in parallel
+    pthread_t thread[BULK_MAX_WORKERS];
+    bool spawned[BULK_MAX_WORKERS] = {false};
+    for (unsigned int i = 0; i < state.workers; i++)
+      spawned[i] =
+          pthread_create(&thread[i], NULL, apply_part, &state.parts[i]) == 0;
+
+    // Read: The next chunk meanwhile, after the partial record left over
+    size_t left = filled - used;
+    filled = 0;
+    if (state.stop == false) {
+      memcpy(chunk[current ^ 1], chunk[current] + used, left);
+      ssize_t count =
+          read_chunk(fd, chunk[current ^ 1] + left, BULK_RECOVER_CHUNK - left);
+      failed = count == -1;
+      state.stop = count <= 0 && left > 0;
+      filled = (count > 0) ? left + count : 0;
+    }
+
+    for (unsigned int i = 0; i < state.workers; i++)
+      if (spawned[i])
+        pthread_join(thread[i], NULL);
+      else
+        apply_part(&state.parts[i]);
+  }
+
+  // Clean: Working space
+  for (unsigned int i = 0; i < state.workers; i++) free(state.parts[i].runs);
+  free(state.parts);
+  free(chunk[0]);
+  free(chunk[1]);
+
+  // Truncate: The torn tail, thus new records follow the last valid one
+  if (failed == false && valid < (long long unsigned int)info.st_size) {
+    console_printf(
+        "\e[38;5;214mWarning:\e[0m Dropped \e[38;5;214m%llu\e[0m torn "
+        "byte(s) at the end of the journal.\n",
+        (long long unsigned int)info.st_size - valid);
+    failed = ftruncate(fd, valid) == -1;
+  }
+  close(fd);
+  if (failed) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't recover \e[38;5;214m%s\e[0m.\n",
+        path);
+    return false;
+  }
+
+  // Report: Recovery time per GB of journal
+  double elapsed = now_seconds() - start;
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Recovered \e[38;5;214m%llu\e[0m account(s) "
+      "and \e[38;5;214m%llu\e[0m balance(s)\n"
+      "  from %.1f MB of journal using %u thread(s) in %.3f s\n"
+      "  (\e[38;5;214m%.3f\e[0m seconds/GB).\n",
+      state.accounts, state.balances, (valid - skipped) / 1e6, state.workers,
+      elapsed, (valid > skipped) ? elapsed / ((valid - skipped) / 1e9) : 0.0);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will save the image of every account of the bank into
+ * the file at the given 'path' along with the 'position' of the journal it
+ * matches, streamed through the same buffered writer as the exports and
+ * flushed to the disk. It prints nothing and takes no lock, thus it is safe
+ * in a child process forked (from a consistent state) for the checkpoint.
+ * Returns 'true' if saved, otherwise returns 'false'.
+ *
+ * Layout (native byte order): "TCXC", u32 version, u64 count, u64 position,
+ * then the columns u64 pin[count], i64 balance[count], u32 name_length[count]
+ * and the name bytes (without terminators) one after another. The name
+ * length of a closed account is 4294967295 (it has no name bytes).
+ * @param bank The bank's data struture reference
+ * @param path The path of the file to be written
+ * @param position The position of the journal (or 0)
+ * @return 'true' or 'false'
+ */
+bool save_checkpoint(BANK bank, string path, long long unsigned int position) {
+  // Check: Whether the bank and path exist!
+  if (bank == NULL || path == NULL) return false;
+
+  // Create: The file and the fixed size buffer
+  export_writer writer = {-1, NULL, 0, false};
+  writer.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (writer.fd == -1) return false;
+  writer.buffer = (char*)malloc(BULK_WRITE_BUFFER);
+  if (writer.buffer == NULL) {
+    close(writer.fd);
+    return false;
+  }
+
+  // Header: Magic, version, count and position
+  unsigned int version = BULK_CHECKPOINT_VERSION;
+  long long unsigned int count = bank->accounts_quantity;
+  put_bytes(&writer, "TCXC", 4);
+  put_bytes(&writer, &version, sizeof(version));
+  put_bytes(&writer, &count, sizeof(count));
+  put_bytes(&writer, &position, sizeof(position));
+
+  // Columns: PINs and balances straight out of the account store, the
+  // striped balances folded in (the stripes are held by the parent)
+  for (unsigned int i = 0; i < bank->hot_quantity; i++)
+    if (bank->hot[i].id < count) fold_balance(bank, bank->hot[i].id);
+  put_bytes(&writer, bank->account.pin, sizeof(long long unsigned int) * count);
+  put_bytes(&writer, bank->account.amount, sizeof(long long int) * count);
+
+  // Columns: name lengths (none for the closed accounts) and name bytes
+  for (unsigned int i = 0; i < count; i++) {
+    unsigned int length = (bank->account.id[i] == BANK_CLOSED)
+                              ? BANK_CLOSED
+                              : bank->account.name[i].length;
+    put_bytes(&writer, &length, sizeof(unsigned int));
+  }
+  for (unsigned int i = 0; i < count; i++)
+    put_bytes(&writer, name_text(bank->names, &bank->account.name[i]),
+              bank->account.name[i].length);
+
+  // Flush: To the disk
+  flush_writer(&writer);
+  free(writer.buffer);
+  if (fsync(writer.fd) == -1) writer.failed = true;
+  if (close(writer.fd) == -1) writer.failed = true;
+
+  // Status: Whether saved
+  return writer.failed == false;
+}
+
+/**
+ * @brief This function will load the accounts of the checkpoint at the given
+ * 'path' into the (empty) bank and fill 'position' with the position of the
+ * journal it matches (nothing is loaded and the position is 0 if the
+ * checkpoint doesn't exist yet). Returns 'true' if loaded, otherwise returns
+ * 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the checkpoint file
+ * @param position The position of the journal to be filled
+ * @return 'true' or 'false'
+ */
+bool load_checkpoint(BANK bank, string path,
+                     long long unsigned int* position) {
+  // Check: Whether the bank, path and position exist!
+  if (bank == NULL || path == NULL || position == NULL) return false;
+  double start = now_seconds();
+  *position = 0;
+
+  // Map: The whole file, a new checkpoint has nothing to load
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1 && errno == ENOENT) return true;
+  struct stat info;
+  if (fd == -1 || fstat(fd, &info) == -1) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't open \e[38;5;214m%s\e[0m.\n", path);
+    if (fd != -1) close(fd);
+    return false;
+  }
+  size_t size = info.st_size;
+  const char* data = MAP_FAILED;
+  if (size > 0) data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't map \e[38;5;214m%s\e[0m.\n", path);
+    return false;
+  }
+  madvise((void*)data, size, MADV_SEQUENTIAL);
+
+  // Check: The header and the size of the columns
+  unsigned int version;
+  long long unsigned int count = 0;
+  bool valid = size >= 24 && memcmp(data, "TCXC", 4) == 0;
+  if (valid) {
+    memcpy(&version, data + 4, sizeof(version));
+    memcpy(&count, data + 8, sizeof(count));
+    memcpy(position, data + 16, sizeof(*position));
+    valid = version == BULK_CHECKPOINT_VERSION &&
+            count <= (unsigned int)-1 / 2 &&
+            (size - 24) / (8 + 8 + 4) >= count;
+  }
+  const char* pins = data + 24;
+  const char* amounts = pins + 8 * count;
+  const char* lengths = amounts + 8 * count;
+  const char* names = lengths + 4 * count;
+  const char* end = data + size;
+
+  // Create: Every account, in the order of their ids
+  if (valid) valid = reserve_accounts(bank, bank->accounts_quantity + count);
+  for (unsigned int i = 0; valid && i < count; i++) {
+    long long unsigned int pin;
+    long long int amount;
+    unsigned int length;
+    memcpy(&pin, pins + 8 * i, sizeof(pin));
+    memcpy(&amount, amounts + 8 * i, sizeof(amount));
+    memcpy(&length, lengths + 4 * i, sizeof(length));
+    if (length == BANK_CLOSED) {
+      valid = add_closed_account(bank) == (int)i;
+      continue;
+    }
+    valid = length <= (size_t)(end - names) &&
+            append_account(bank, pin, names, length, amount) == (int)i;
+    names += length;
+  }
+  munmap((void*)data, size);
+  if (valid == false) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m \e[38;5;214m%s\e[0m is not a valid "
+        "checkpoint.\n",
+        path);
+    return false;
+  }
+
+  // Report: Time of the whole load
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Loaded \e[38;5;214m%llu\e[0m account(s) from "
+      "the checkpoint in %.3f s.\n",
+      count, now_seconds() - start);
+
+  // Status: Reached success
+  return true;
+}
@@ -0,0 +1,142 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file bulk.h
+ * @brief Interface of bulk (import/export) related functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef BULK_H
+#define BULK_H
+
+#include <stdbool.h>
+
+#include "bank.h"
+#include "cs50.h"
+
+/**
+ * @brief This function will import the accounts listed in the CSV file at the
+ * given 'path' (one "name,pin,balance" row per line, header optional) into
+ * the bank. The file is memory mapped and split into chunks parsed in
+ * parallel by worker threads, afterwards the account store and the name index
+ * are built in one pass. The PINs are hashed by the parser threads, which
+ * bounds the import (one thread per CPU, see BULK_MIN_CHUNK), thus the
+ * report includes the hashing time per PIN. Rows with invalid fields or
+ * already existing user names are rejected. Returns 'true' if the file is
+ * imported, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the CSV file
+ * @return 'true' or 'false'
+ */
+bool import_accounts(BANK bank, string path);
+
+/**
+ * @brief This function will export the state of every account of the bank to
+ * the file at the given 'path' in the given 'format', either "csv" (one
+ * "id,name,balance" row per account) or "bin" (columnar, see below). Rows are
+ * streamed through a fixed size buffer with large writes, so memory use stays
+ * constant whatever the account count. The export runs in between commands,
+ * thus reads a consistent snapshot of the bank. Returns 'true' if exported,
+ * otherwise returns 'false'.
+ *
+ * Binary layout (native byte order): "TCXB", u32 version, u64 count, then the
+ * columns u32 id[count], i64 balance[count], u32 name_length[count] and the
+ * name bytes (without terminators) one after another. The id of a closed
+ * account is 4294967295 (its balance and name are empty), the CSV skips it.
+ * @param bank The bank's data struture reference
+ * @param path The path of the file to be written
+ * @param format The format of the file, "csv" or "bin"
+ * @return 'true' or 'false'
+ */
+bool export_accounts(BANK bank, string path, string format);
+
+/**
+ * @brief This function will recover the accounts of the bank from the journal
+ * at the given 'path' (nothing is done if it doesn't exist yet), from the given
+ * 'offset' on if the bank is loaded from a checkpoint taken there (accounts
+ * already loaded are not created again). The journal is read in large
+ * sequential chunks, every chunk is parsed once (creating the accounts it
+ * holds, in order) and its balances are partitioned by account id, a block of
+ * ids per worker thread. The workers then apply their partitions in parallel
+ * while the next chunk is read. Balances are absolute and the records of an
+ * account keep their order, thus the last one wins. A torn record at the end
+ * (e.g. a crash in between a write) is dropped from the file. Returns 'true' if
+ * recovered, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the journal file
+ * @param offset The position of the checkpoint in the journal (or 0)
+ * @return 'true' or 'false'
+ */
+bool recover_accounts(BANK bank, string path,
+                      long long unsigned int offset);
+
+/**
+ * @brief This function will save the image of every account of the bank into
+ * the file at the given 'path' along with the 'position' of the journal it
+ * matches, streamed through the same buffered writer as the exports and
+ * flushed to the disk. It prints nothing and takes no lock, thus it is safe
+ * in a child process forked (from a consistent state) for the checkpoint.
+ * Returns 'true' if saved, otherwise returns 'false'.
+ *
+ * Layout (native byte order): "TCXC", u32 version, u64 count, u64 position,
+ * then the columns u64 pin[count], i64 balance[count], u32 name_length[count]
+ * and the name bytes (without terminators) one after another. The name
+ * length of a closed account is 4294967295 (it has no name bytes).
+ * @param bank The bank's data struture reference
+ * @param path The path of the file to be written
+ * @param position The position of the journal (or 0)
+ * @return 'true' or 'false'
+ */
+bool save_checkpoint(BANK bank, string path, long long unsigned int position);
+
+/**
+ * @brief This function will load the accounts of the checkpoint at the given
+ * 'path' into the (empty) bank and fill 'position' with the position of the
+ * journal it matches (nothing is loaded and the position is 0 if the
+ * checkpoint doesn't exist yet). Returns 'true' if loaded, otherwise returns
+ * 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the checkpoint file
+ * @param position The position of the journal to be filled
+ * @return 'true' or 'false'
+ */
+bool load_checkpoint(BANK bank, string path,
+                     long long unsigned int* position);
+
+#endif
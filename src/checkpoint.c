@@ -0,0 +1,320 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file checkpoint.c
+ * @brief Background checkpoints of the bank, by fork() and copy-on-write
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "checkpoint.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bulk.h"
+#include "console.h"
+#include "snapshot.h"
+
+/**
+ * @brief Structure of the state of the checkpoints, the metrics are in
+ * seconds ('trimmed' is the position the journal is trimmed up to)
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_t thread;
+  bool running;
+  bool requested;
+  BANK bank;
+  string path;
+  unsigned int seconds;
+  unsigned int taken;
+  unsigned int failed;
+  double last_duration;
+  double last_pause;
+  double max_pause;
+  long long unsigned int trimmed;
+} checkpoint_state;
+
+/**
+ * @brief The checkpoints of the bank
+ */
+static checkpoint_state checkpoints = {.lock = PTHREAD_MUTEX_INITIALIZER,
+                                       .wake = PTHREAD_COND_INITIALIZER};
+
+/**
+ * @brief This function will return the current time of a monotonic clock in
+ * seconds.
+ */
+static double now_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief This function will flush the directory of the file at the given
+ * 'path', thus a rename into it is durable. Returns 'true' if flushed,
+ * otherwise returns 'false'.
+ */
+static bool sync_directory(const char* path) {
+  const char* slash = strrchr(path, '/');
+  char* directory = (slash == NULL) ? strdup(".")
+                                    : strndup(path, (slash == path)
+                                                        ? 1
+                                                        : slash - path);
+  int fd = (directory != NULL)
+               ? open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+               : -1;
+  free(directory);
+  bool synced = fd != -1 && fsync(fd) == 0;
+  if (fd != -1) close(fd);
+  return synced;
+}
+
+/**
+ * @brief This function will take a single checkpoint and fill how long the
+ * bank was paused, how long the whole checkpoint took and the position the
+ * journal is trimmed up to (left as is if not trimmed). Returns 'true' if
+ * taken, otherwise returns 'false'.
+ */
+static bool take_checkpoint(double* pause, double* duration,
+                            long long unsigned int* trimmed) {
+  BANK bank = checkpoints.bank;
+  size_t length = strlen(checkpoints.path);
+  char* partial = (char*)malloc(length + 9);
+  if (partial == NULL) return false;
+  memcpy(partial, checkpoints.path, length);
+  memcpy(partial + length, ".partial", 9);
+
+  // Pause: Writers are held out, thus the child sees a consistent bank
+  double start = now_seconds();
+  lock_accounts(bank);
+  write_begin_all(bank->sync);
+  long long unsigned int position = journal_position(bank->journal);
+  pid_t child = fork();
+  if (child == 0)
+    _exit((save_checkpoint(bank, partial, position) == true) ? 0 : 1);
+  write_end_all(bank->sync);
+  unlock_accounts(bank);
+  *pause = now_seconds() - start;
+
+  // Wait: For the child, the parent keeps serving meanwhile
+  int status = 0;
+  pid_t waited = (child != -1) ? waitpid(child, &status, 0) : -1;
+  while (child != -1 && waited == -1 && errno == EINTR)
+    waited = waitpid(child, &status, 0);
+
+  // Replace: The previous image, once the journal covers the new one
+  bool taken = waited == child && WIFEXITED(status) &&
+               WEXITSTATUS(status) == 0 &&
+               sync_journal(bank->journal) == true &&
+               rename(partial, checkpoints.path) == 0;
+  if (taken == false) unlink(partial);
+  free(partial);
+
+  // Trim: The journal up to the image, once the rename is durable too
+  if (taken == true && sync_directory(checkpoints.path) == true &&
+      trim_journal(bank->journal, position) == true)
+    *trimmed = position;
+  *duration = now_seconds() - start;
+  return taken;
+}
+
+/**
+ * @brief This function is the body of the checkpoint thread, it takes a
+ * checkpoint every period or on request till the checkpoints are stopped.
+ */
+static void* run_checkpoints(void* argument) {
+  (void)argument;
+  pthread_mutex_lock(&checkpoints.lock);
+  while (checkpoints.running == true) {
+    // Wait: For the period, a request or the stop
+    if (checkpoints.requested == false) {
+      if (checkpoints.seconds == 0) {
+        pthread_cond_wait(&checkpoints.wake, &checkpoints.lock);
+        continue;
+      }
+      struct timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_sec += checkpoints.seconds;
+      int waited = 0;
+      while (checkpoints.running == true &&
+             checkpoints.requested == false && waited != ETIMEDOUT)
+        waited = pthread_cond_timedwait(&checkpoints.wake, &checkpoints.lock,
+                                        &deadline);
+      if (checkpoints.running == false) break;
+    }
+    checkpoints.requested = false;
+
+    // Take: The checkpoint, without holding the state
+    pthread_mutex_unlock(&checkpoints.lock);
+    double pause = 0, duration = 0;
+    long long unsigned int trimmed = checkpoints.trimmed;
+    bool taken = take_checkpoint(&pause, &duration, &trimmed);
+    pthread_mutex_lock(&checkpoints.lock);
+    checkpoints.trimmed = trimmed;
+
+    // Measure: Duration and pause
+    if (taken == true) {
+      checkpoints.taken++;
+      checkpoints.last_duration = duration;
+      checkpoints.last_pause = pause;
+      if (pause > checkpoints.max_pause) checkpoints.max_pause = pause;
+    } else
+      checkpoints.failed++;
+  }
+  pthread_mutex_unlock(&checkpoints.lock);
+  return NULL;
+}
+
+/**
+ * @brief This function will start taking checkpoints of the bank into the
+ * file at the given 'path' every 'seconds' (only on request if 0) on a
+ * background thread. For a checkpoint the writers are held out just long
+ * enough to fork() a child process, which writes the image of the bank out of
+ * its copy-on-write pages while the parent keeps serving. The image replaces
+ * the previous one once written and the journal (if any) is durable up to the
+ * position it matches, then the journal is trimmed up to that position (see
+ * trim_journal). Returns 'true' if started, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the checkpoint file
+ * @param seconds The period of the checkpoints (0 for only on request)
+ * @return 'true' or 'false'
+ */
+bool start_checkpoints(BANK bank, string path, unsigned int seconds) {
+  // Check: Whether the bank and path exist, and not started yet!
+  if (bank == NULL || path == NULL) return false;
+  pthread_mutex_lock(&checkpoints.lock);
+  if (checkpoints.running == true) {
+    pthread_mutex_unlock(&checkpoints.lock);
+    return false;
+  }
+
+  // Configure: The state, then start the thread
+  checkpoints.bank = bank;
+  checkpoints.path = path;
+  checkpoints.seconds = seconds;
+  checkpoints.requested = false;
+  checkpoints.running = true;
+  if (pthread_create(&checkpoints.thread, NULL, run_checkpoints, NULL) != 0) {
+    checkpoints.running = false;
+    pthread_mutex_unlock(&checkpoints.lock);
+    console_printf("\e[38;5;196mError:\e[0m Can't start the checkpoints.\n");
+    return false;
+  }
+  pthread_mutex_unlock(&checkpoints.lock);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will stop taking checkpoints, waiting for the one
+ * being taken (if any). The function returns nothing.
+ * @return void (nothing)
+ */
+void stop_checkpoints() {
+  pthread_mutex_lock(&checkpoints.lock);
+  bool running = checkpoints.running;
+  checkpoints.running = false;
+  pthread_cond_signal(&checkpoints.wake);
+  pthread_mutex_unlock(&checkpoints.lock);
+  if (running == true) pthread_join(checkpoints.thread, NULL);
+}
+
+/**
+ * @brief This function will ask for a checkpoint right away. Returns 'true'
+ * if asked, otherwise returns 'false' if the checkpoints are not started.
+ * @return 'true' or 'false'
+ */
+bool request_checkpoint() {
+  pthread_mutex_lock(&checkpoints.lock);
+  bool running = checkpoints.running;
+  if (running == true) {
+    checkpoints.requested = true;
+    pthread_cond_signal(&checkpoints.wake);
+  }
+  pthread_mutex_unlock(&checkpoints.lock);
+  return running;
+}
+
+/**
+ * @brief This function will display the metrics of the checkpoints taken so
+ * far, i.e. how long the last one took and how long the bank was paused for
+ * it. The function returns nothing.
+ * @return void (nothing)
+ */
+void display_checkpoints() {
+  // Copy: The metrics as of now
+  pthread_mutex_lock(&checkpoints.lock);
+  unsigned int taken = checkpoints.taken, failed = checkpoints.failed;
+  double duration = checkpoints.last_duration;
+  double pause = checkpoints.last_pause, max_pause = checkpoints.max_pause;
+  long long unsigned int trimmed = checkpoints.trimmed;
+  pthread_mutex_unlock(&checkpoints.lock);
+
+  // Display: The metrics
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Taken \e[38;5;214m%u\e[0m checkpoint(s), "
+      "failed \e[38;5;214m%u\e[0m\n"
+      "  the last one took %.3f s with the bank paused for %.3f ms\n"
+      "  (\e[38;5;214m%.3f\e[0m ms at most), the journal is trimmed up to\n"
+      "  byte \e[38;5;214m%llu\e[0m.\n",
+      taken, failed, duration, pause * 1e3, max_pause * 1e3, trimmed);
+}
+
+/**
+ * @brief This function will return the number of checkpoints finished so
+ * far, taken or failed (e.g. to wait for a requested one).
+ * @return number of checkpoints
+ */
+unsigned int finished_checkpoints() {
+  pthread_mutex_lock(&checkpoints.lock);
+  unsigned int finished = checkpoints.taken + checkpoints.failed;
+  pthread_mutex_unlock(&checkpoints.lock);
+  return finished;
+}
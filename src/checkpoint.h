@@ -0,0 +1,99 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file checkpoint.h
+ * @brief Interface of the background checkpoints of the bank
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+
+#include "bank.h"
+#include "cs50.h"
+
+/**
+ * @brief This function will start taking checkpoints of the bank into the
+ * file at the given 'path' every 'seconds' (only on request if 0) on a
+ * background thread. For a checkpoint the writers are held out just long
+ * enough to fork() a child process, which writes the image of the bank out of
+ * its copy-on-write pages while the parent keeps serving. The image replaces
+ * the previous one once written and the journal (if any) is durable up to the
+ * position it matches, then the journal is trimmed up to that position (see
+ * trim_journal). Returns 'true' if started, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the checkpoint file
+ * @param seconds The period of the checkpoints (0 for only on request)
+ * @return 'true' or 'false'
+ */
+bool start_checkpoints(BANK bank, string path, unsigned int seconds);
+
+/**
+ * @brief This function will stop taking checkpoints, waiting for the one
+ * being taken (if any). The function returns nothing.
+ * @return void (nothing)
+ */
+void stop_checkpoints();
+
+/**
+ * @brief This function will ask for a checkpoint right away. Returns 'true'
+ * if asked, otherwise returns 'false' if the checkpoints are not started.
+ * @return 'true' or 'false'
+ */
+bool request_checkpoint();
+
+/**
+ * @brief This function will display the metrics of the checkpoints taken so
+ * far, i.e. how long the last one took and how long the bank was paused for
+ * it. The function returns nothing.
+ * @return void (nothing)
+ */
+void display_checkpoints();
+
+/**
+ * @brief This function will return the number of checkpoints finished so
+ * far, taken or failed (e.g. to wait for a requested one).
+ * @return number of checkpoints
+ */
+unsigned int finished_checkpoints();
+
+#endif
@@ -0,0 +1,85 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file console.h
+ * @brief Interface of the per-thread console output stream
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdio.h>
+
+/**
+ * @brief This function will return the stream where the calling thread prints
+ * its messages, i.e. the one of the session it is serving (standard output
+ * unless changed by 'set_console').
+ * @return FILE* (reference, not copy)
+ */
+FILE* console();
+
+/**
+ * @brief This function will make the given 'stream' the one where the calling
+ * thread prints its messages, thus a thread serving many sessions switches
+ * the stream before serving each of them. Passing 'NULL' restores the
+ * standard output. The function returns nothing.
+ * @param stream The stream where the messages are printed
+ * @return void (nothing)
+ */
+void set_console(FILE* stream);
+
+/**
+ * @brief This function will return a stream which discards everything printed
+ * into it, e.g. for the sessions whose replies are not text.
+ * @return FILE* (reference, not copy)
+ */
+FILE* null_console();
+
+/**
+ * @brief This function will print the formatted message (just like printf)
+ * to the calling thread's console stream. Returns the number of bytes
+ * printed, otherwise returns a negative number.
+ * @param format The format of the message, followed by its arguments
+ * @return number of bytes or negative
+ */
+int console_printf(const char* format, ...)
+    __attribute__((format(printf, 1, 2)));
+
+#endif
@@ -0,0 +1,165 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file hot.c
+ * @brief Implementation of the striped balances of the hot accounts
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#include "hot.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief The stripe of the calling thread (-1 till its first deposit)
+ */
+static _Thread_local int stripe_of_thread = -1;
+
+/**
+ * @brief The stripe of the next thread making its first deposit
+ */
+static atomic_uint next_stripe = 0;
+
+/**
+ * @brief This function will create a striped balance holding nothing and
+ * return it as a reference (not copy, thus need to be freed after usage). If
+ * some error happens during creation, it will return NULL reference.
+ * @return HOT (reference, not copy) or 'NULL'
+ */
+HOT create_hot() {
+  // Create: Make space for the stripes, each on a cache line of its own
+  HOT hot = (HOT)aligned_alloc(64, sizeof(hot_element));
+  if (hot == NULL) return NULL;
+
+  // Configure: Every stripe holds nothing
+  for (unsigned int i = 0; i < HOT_STRIPES; i++) {
+    atomic_init(&hot->stripe[i].amount, 0);
+    atomic_init(&hot->stripe[i].deposits, 0);
+  }
+
+  // Status: Return the striped balance's structure reference
+  return hot;
+}
+
+/**
+ * @brief This function will take the striped balance as an input and frees
+ * it. Returns 'true' if successfully deleted, otherwise returns 'false'.
+ * @param hot The striped balance's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_hot(HOT hot) {
+  // Check: Whether the striped balance exist!
+  if (hot == NULL) return false;
+
+  // Clean: The stripes
+  free(hot);
+  return true;
+}
+
+/**
+ * @brief This function will add the given (positive) 'amount' to the stripe
+ * of the calling thread, without any lock. The function returns nothing.
+ * @param hot The striped balance's data structure reference
+ * @param amount The amount deposited
+ * @return void (nothing)
+ */
+void hot_deposit(HOT hot, long long int amount) {
+  // Get: The stripe of the thread, threads are spread in turn
+  if (stripe_of_thread == -1)
+    stripe_of_thread = atomic_fetch_add_explicit(&next_stripe, 1,
+                                                 memory_order_relaxed) %
+                       HOT_STRIPES;
+
+  // Deposit: Into the stripe, its cache line stays with this thread
+  hot_stripe* stripe = &hot->stripe[stripe_of_thread];
+  atomic_fetch_add_explicit(&stripe->amount, amount, memory_order_release);
+  atomic_fetch_add_explicit(&stripe->deposits, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief This function will add up every stripe, i.e. the deposits not yet
+ * folded (some being made meanwhile may be missed). Returns the total.
+ * @param hot The striped balance's data structure reference
+ * @return total of the stripes
+ */
+long long int hot_total(HOT hot) {
+  long long int total = 0;
+  for (unsigned int i = 0; i < HOT_STRIPES; i++)
+    total +=
+        atomic_load_explicit(&hot->stripe[i].amount, memory_order_acquire);
+  return total;
+}
+
+/**
+ * @brief This function will take every stripe out (leaving nothing behind),
+ * thus a deposit is either taken or left for the next drain, never both.
+ * Returns the total taken.
+ * @param hot The striped balance's data structure reference
+ * @return total taken out of the stripes
+ */
+long long int hot_drain(HOT hot) {
+  long long int total = 0;
+  for (unsigned int i = 0; i < HOT_STRIPES; i++)
+    if (atomic_load_explicit(&hot->stripe[i].amount, memory_order_relaxed) !=
+        0)
+      total += atomic_exchange_explicit(&hot->stripe[i].amount, 0,
+                                        memory_order_acq_rel);
+  return total;
+}
+
+/**
+ * @brief This function will return the number of deposits made into the
+ * striped balance so far, and fill 'busiest' with that of its busiest stripe.
+ * @param hot The striped balance's data structure reference
+ * @param busiest The deposits of the busiest stripe to be filled
+ * @return number of deposits
+ */
+long long unsigned int hot_deposits(HOT hot,
+                                    long long unsigned int* busiest) {
+  long long unsigned int total = 0;
+  *busiest = 0;
+  for (unsigned int i = 0; i < HOT_STRIPES; i++) {
+    long long unsigned int deposits =
+        atomic_load_explicit(&hot->stripe[i].deposits, memory_order_relaxed);
+    if (deposits > *busiest) *busiest = deposits;
+    total += deposits;
+  }
+  return total;
+}
@@ -0,0 +1,133 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file hot.h
+ * @brief Interface of the striped balances of the hot accounts
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef HOT_H
+#define HOT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/**
+ * @brief Number of stripes (sub-balances) of a hot account
+ */
+#define HOT_STRIPES 16
+
+/**
+ * @brief Structure of a stripe, a sub-balance on a cache line of its own
+ */
+typedef struct {
+  _Alignas(64) atomic_llong amount;
+  atomic_ullong deposits;
+} hot_stripe;
+
+/**
+ * @brief Structure of the striped balance of a hot account, i.e. the deposits
+ * not yet folded into the balance of the account. Every thread deposits into
+ * a stripe of its own (threads are spread over the stripes in turn), thus
+ * concurrent deposits don't contend on a single balance. Stripes only ever
+ * grow by deposits, the withdrawals fold them into the balance first.
+ */
+typedef struct {
+  hot_stripe stripe[HOT_STRIPES];
+} hot_element;
+
+/**
+ * @brief Striped balance's Data structure Reference
+ */
+#define HOT hot_element*
+
+/**
+ * @brief This function will create a striped balance holding nothing and
+ * return it as a reference (not copy, thus need to be freed after usage). If
+ * some error happens during creation, it will return NULL reference.
+ * @return HOT (reference, not copy) or 'NULL'
+ */
+HOT create_hot();
+
+/**
+ * @brief This function will take the striped balance as an input and frees
+ * it. Returns 'true' if successfully deleted, otherwise returns 'false'.
+ * @param hot The striped balance's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_hot(HOT hot);
+
+/**
+ * @brief This function will add the given (positive) 'amount' to the stripe
+ * of the calling thread, without any lock. The function returns nothing.
+ * @param hot The striped balance's data structure reference
+ * @param amount The amount deposited
+ * @return void (nothing)
+ */
+void hot_deposit(HOT hot, long long int amount);
+
+/**
+ * @brief This function will add up every stripe, i.e. the deposits not yet
+ * folded (some being made meanwhile may be missed). Returns the total.
+ * @param hot The striped balance's data structure reference
+ * @return total of the stripes
+ */
+long long int hot_total(HOT hot);
+
+/**
+ * @brief This function will take every stripe out (leaving nothing behind),
+ * thus a deposit is either taken or left for the next drain, never both.
+ * Returns the total taken.
+ * @param hot The striped balance's data structure reference
+ * @return total taken out of the stripes
+ */
+long long int hot_drain(HOT hot);
+
+/**
+ * @brief This function will return the number of deposits made into the
+ * striped balance so far, and fill 'busiest' with that of its busiest stripe.
+ * @param hot The striped balance's data structure reference
+ * @param busiest The deposits of the busiest stripe to be filled
+ * @return number of deposits
+ */
+long long unsigned int hot_deposits(HOT hot,
+                                    long long unsigned int* busiest);
+
+#endif
@@ -0,0 +1,456 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file journal.c
+ * @brief Durable operation journal of the bank
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#define _GNU_SOURCE
+
+#include "journal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "console.h"
+
+/**
+ * @brief This function will write the buffered records of the journal out,
+ * the caller holds the journal's lock. Returns 'true' if written, otherwise
+ * returns 'false' (and the journal fails from now on).
+ */
+static bool write_out(JOURNAL journal) {
+  size_t done = 0;
+  while (done < journal->used) {
+    ssize_t written = write(journal->fd, journal->buffer + done,
+                            journal->used - done);
+    if (written == -1 && errno == EINTR) continue;
+    if (written <= 0) {
+      __atomic_store_n(&journal->failed, true, __ATOMIC_RELEASE);
+      journal->used = 0;
+      return false;
+    }
+    done += written;
+  }
+  __atomic_store_n(&journal->written, journal->written + journal->used,
+                   __ATOMIC_RELEASE);
+  journal->used = 0;
+  return true;
+}
+
+/**
+ * @brief This function will make space for a record of 'size' bytes at the
+ * end of the buffer, the caller holds the journal's lock. Returns the space,
+ * otherwise returns 'NULL' if the journal failed (a record never exceeds the
+ * buffer, thus the recovery can read it in a single chunk).
+ */
+static char* reserve(JOURNAL journal, size_t size) {
+  if (size > JOURNAL_BUFFER)
+    __atomic_store_n(&journal->failed, true, __ATOMIC_RELEASE);
+  if (journal->failed == true) return NULL;
+  if (journal->used + size > JOURNAL_BUFFER && write_out(journal) == false)
+    return NULL;
+  char* space = journal->buffer + journal->used;
+  journal->used += size;
+  journal->appended += size;
+  return space;
+}
+
+/**
+ * @brief This function will return the hash of the record of 'size' bytes
+ * (header and body) at 'record', taken with its 'check' as 0.
+ * @param record The record
+ * @param size The number of bytes of the record
+ * @return hash
+ */
+unsigned int journal_check(const void* record, size_t size) {
+  // Configure: The header without its check
+  journal_record header;
+  memcpy(&header, record, sizeof(journal_record));
+  header.check = 0;
+
+  // Hash: Word by word (every record is a multiple of 8 bytes)
+  long long unsigned int hash = 0xCBF29CE484222325ULL, word;
+  const char* bytes = (const char*)record;
+  for (size_t i = 0; i < size; i += 8) {
+    if (i < sizeof(journal_record))
+      memcpy(&word, (const char*)&header + i, 8);
+    else
+      memcpy(&word, bytes + i, 8);
+    hash = (hash ^ word) * 0x100000001B3ULL;
+  }
+  return (unsigned int)(hash ^ (hash >> 32));
+}
+
+/**
+ * @brief This function will return the size of the body of the given record
+ * header in bytes.
+ * @param record The header of the record
+ * @return size
+ */
+size_t journal_body(const journal_record* record) {
+  if (record->type == JOURNAL_CREATE)
+    return sizeof(long long unsigned int) + ((record->length + 7) & ~7ULL);
+  if (record->type == JOURNAL_ACCOUNTS)
+    return sizeof(journal_entry) * (size_t)record->length;
+  return sizeof(long long int) * (size_t)record->length;
+}
+
+/**
+ * @brief This function will open the journal file at the given 'path' for
+ * appending (creating it, with its header, if needed) and return it as a
+ * reference (not copy, thus need to be freed after usage). If some error
+ * happens during creation, it will return NULL reference.
+ * @param path The path of the journal file
+ * @return JOURNAL (reference, not copy) or 'NULL'
+ */
+JOURNAL create_journal(const char* path) {
+  // Check: Whether the path exist!
+  if (path == NULL) return NULL;
+
+  // Open: The file, appending only
+  int fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+  struct stat info;
+  if (fd == -1 || fstat(fd, &info) == -1) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't open \e[38;5;214m%s\e[0m.\n", path);
+    if (fd != -1) close(fd);
+    return NULL;
+  }
+
+  // Check: The header of an existing journal, otherwise write it
+  char header[8];
+  unsigned int version = JOURNAL_VERSION;
+  if (info.st_size > 0) {
+    if (pread(fd, header, sizeof(header), 0) != sizeof(header) ||
+        memcmp(header, "TCXJ", 4) != 0 ||
+        memcmp(header + 4, &version, sizeof(version)) != 0) {
+      console_printf(
+          "\e[38;5;196mError:\e[0m \e[38;5;214m%s\e[0m is not a journal.\n",
+          path);
+      close(fd);
+      return NULL;
+    }
+  } else {
+    memcpy(header, "TCXJ", 4);
+    memcpy(header + 4, &version, sizeof(version));
+    if (write(fd, header, sizeof(header)) != sizeof(header) ||
+        fsync(fd) == -1) {
+      console_printf(
+          "\e[38;5;196mError:\e[0m Can't write \e[38;5;214m%s\e[0m.\n", path);
+      close(fd);
+      return NULL;
+    }
+  }
+
+  // Create: Make space for the journal and its buffer
+  JOURNAL journal = (JOURNAL)calloc(1, sizeof(journal_element));
+  char* buffer = (char*)malloc(JOURNAL_BUFFER);
+  if (journal == NULL || buffer == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    free(journal);
+    free(buffer);
+    close(fd);
+    return NULL;
+  }
+
+  // Configure: Initialize variables of the journal
+  journal->fd = fd;
+  pthread_mutex_init(&journal->lock, NULL);
+  pthread_mutex_init(&journal->flush_lock, NULL);
+  journal->buffer = buffer;
+  journal->used = 0;
+  journal->appended = (info.st_size > 0)
+                          ? (long long unsigned int)info.st_size
+                          : sizeof(header);
+  journal->written = journal->appended;
+  journal->synced = journal->appended;
+  journal->failed = false;
+  journal->reported = false;
+  journal->trimmed = 0;
+
+  // Status: Return the journal's structure reference
+  return journal;
+}
+
+/**
+ * @brief This function will sync and close the given journal. Returns 'true'
+ * if every record reached the file, otherwise returns 'false'.
+ * @param journal The journal's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_journal(JOURNAL journal) {
+  // Check: Whether the journal exist!
+  if (journal == NULL) return false;
+
+  // Clean: Sync the remainder and free the journal
+  bool synced = sync_journal(journal);
+  close(journal->fd);
+  pthread_mutex_destroy(&journal->lock);
+  pthread_mutex_destroy(&journal->flush_lock);
+  free(journal->buffer);
+  free(journal);
+
+  // Status: Whether every record reached the file
+  return synced;
+}
+
+/**
+ * @brief This function will append the creation of the account 'id' of the
+ * given details. Nothing is done if the journal is 'NULL'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @param id The id of the new account
+ * @param pin The PIN of the new account
+ * @param name The user name of the new account (need not to be terminated)
+ * @param length The number of bytes of the user name
+ * @param amount The opening balance of the new account
+ */
+void journal_create(JOURNAL journal, unsigned int id,
+                    long long unsigned int pin, const char* name,
+                    unsigned int length, long long int amount) {
+  // Check: Whether the journal exist!
+  if (journal == NULL) return;
+
+  // Configure: Header of the record
+  journal_record header = {JOURNAL_CREATE, id, amount, length, 0};
+  size_t size = sizeof(journal_record) + journal_body(&header);
+
+  // Append: Header, PIN and the padded name
+  pthread_mutex_lock(&journal->lock);
+  char* record = reserve(journal, size);
+  if (record != NULL) {
+    memset(record, 0, size);
+    memcpy(record, &header, sizeof(journal_record));
+    memcpy(record + sizeof(journal_record), &pin, sizeof(pin));
+    memcpy(record + sizeof(journal_record) + sizeof(pin), name, length);
+    header.check = journal_check(record, size);
+    memcpy(record, &header, sizeof(journal_record));
+  }
+  pthread_mutex_unlock(&journal->lock);
+}
+
+/**
+ * @brief This function will append the closure of the account 'id', its slot
+ * is reused by the next creation. Nothing is done if the journal is 'NULL'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @param id The id of the closed account
+ */
+void journal_close(JOURNAL journal, unsigned int id) {
+  // Check: Whether the journal exist!
+  if (journal == NULL) return;
+
+  // Append: The header alone
+  journal_record header = {JOURNAL_CLOSE, id, 0, 0, 0};
+  pthread_mutex_lock(&journal->lock);
+  char* record = reserve(journal, sizeof(journal_record));
+  if (record != NULL) {
+    memcpy(record, &header, sizeof(journal_record));
+    header.check = journal_check(record, sizeof(journal_record));
+    memcpy(record, &header, sizeof(journal_record));
+  }
+  pthread_mutex_unlock(&journal->lock);
+}
+
+/**
+ * @brief This function will append the new balances of the 'count'
+ * consecutive accounts from 'id' on, given by 'amounts'. The caller holds
+ * the stripe of the accounts, thus the records of an account are in the order
+ * of its changes. Nothing is done if the journal is 'NULL'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @param id The id of the first account
+ * @param amounts The new balances
+ * @param count The number of accounts
+ */
+void journal_balances(JOURNAL journal, unsigned int id,
+                      const long long int amounts[], unsigned int count) {
+  // Check: Whether the journal exist!
+  if (journal == NULL || count == 0) return;
+
+  pthread_mutex_lock(&journal->lock);
+  while (count > 0) {
+    // Configure: Header of the record, at most a range of balances
+    unsigned int part = (count > JOURNAL_RANGE) ? JOURNAL_RANGE : count;
+    journal_record header = {JOURNAL_BALANCE, id, amounts[0], part - 1, 0};
+    size_t size = sizeof(journal_record) + journal_body(&header);
+
+    // Append: Header and the rest of the balances
+    char* record = reserve(journal, size);
+    if (record == NULL) break;
+    memcpy(record, &header, sizeof(journal_record));
+    memcpy(record + sizeof(journal_record), amounts + 1,
+           sizeof(long long int) * (part - 1));
+    header.check = journal_check(record, size);
+    memcpy(record, &header, sizeof(journal_record));
+    id += part;
+    amounts += part;
+    count -= part;
+  }
+  pthread_mutex_unlock(&journal->lock);
+}
+
+/**
+ * @brief This function will append the new balances of the 'count' given
+ * accounts as a single record, thus they are recovered all or none. The
+ * caller holds the stripes of the accounts. Nothing is done if the journal is
+ * 'NULL'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @param entries The accounts and their new balances
+ * @param count The number of entries
+ */
+void journal_accounts(JOURNAL journal, const journal_entry entries[],
+                      unsigned int count) {
+  // Check: Whether the journal exist!
+  if (journal == NULL || count == 0) return;
+
+  // Configure: Header of the record
+  journal_record header = {JOURNAL_ACCOUNTS, 0, 0, count, 0};
+  size_t size = sizeof(journal_record) + journal_body(&header);
+
+  // Append: Header and every entry
+  pthread_mutex_lock(&journal->lock);
+  char* record = reserve(journal, size);
+  if (record != NULL) {
+    memcpy(record, &header, sizeof(journal_record));
+    memcpy(record + sizeof(journal_record), entries,
+           sizeof(journal_entry) * count);
+    header.check = journal_check(record, size);
+    memcpy(record, &header, sizeof(journal_record));
+  }
+  pthread_mutex_unlock(&journal->lock);
+}
+
+/**
+ * @brief This function will return the position of the end of the journal,
+ * i.e. the offset in the file where the next record will be.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @return position (0 if the journal is 'NULL')
+ */
+long long unsigned int journal_position(JOURNAL journal) {
+  // Check: Whether the journal exist!
+  if (journal == NULL) return 0;
+
+  pthread_mutex_lock(&journal->lock);
+  long long unsigned int position = journal->appended;
+  pthread_mutex_unlock(&journal->lock);
+  return position;
+}
+
+/**
+ * @brief This function will make every record appended so far durable, i.e.
+ * written and flushed to the disk. Returns 'true' if durable (or the journal
+ * is 'NULL'), otherwise returns 'false'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @return 'true' or 'false'
+ */
+bool sync_journal(JOURNAL journal) {
+  // Check: Whether the journal exist!
+  if (journal == NULL) return true;
+
+  // Write: The buffered records
+  pthread_mutex_lock(&journal->lock);
+  if (journal->used > 0) write_out(journal);
+  long long unsigned int target = journal->written;
+  pthread_mutex_unlock(&journal->lock);
+
+  // Flush: Unless a concurrent sync already covered these records
+  pthread_mutex_lock(&journal->flush_lock);
+  if (journal->synced < target &&
+      __atomic_load_n(&journal->failed, __ATOMIC_ACQUIRE) == false) {
+    long long unsigned int covered =
+        __atomic_load_n(&journal->written, __ATOMIC_ACQUIRE);
+    if (fdatasync(journal->fd) == 0)
+      journal->synced = covered;
+    else
+      __atomic_store_n(&journal->failed, true, __ATOMIC_RELEASE);
+  }
+  bool durable = journal->synced >= target &&
+                 __atomic_load_n(&journal->failed, __ATOMIC_ACQUIRE) == false;
+
+  // Report: A failed journal, once
+  if (durable == false && journal->reported == false) {
+    journal->reported = true;
+    console_printf(
+        "\e[38;5;196mError:\e[0m Journal can't be written, changes are not "
+        "durable anymore.\n");
+  }
+  pthread_mutex_unlock(&journal->flush_lock);
+
+  // Status: Whether the records are durable
+  return durable;
+}
+
+/**
+ * @brief This function will release the disk blocks of the records before
+ * the given 'position', once a durable checkpoint covers them, by punching a
+ * hole into the file (whole blocks only, the first one keeps the header).
+ * The positions don't change, thus the journal is still recovered from the
+ * position of the checkpoint, but no more from an older one (see
+ * recover_accounts). Returns 'true' if trimmed (or nothing to trim, or the
+ * file system can't punch holes), otherwise returns 'false'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @param position The position of the durable checkpoint
+ * @return 'true' or 'false'
+ */
+bool trim_journal(JOURNAL journal, long long unsigned int position) {
+  // Check: Whether the journal exist!
+  if (journal == NULL) return true;
+
+  // Find: The whole blocks in between the last trim and the position
+  struct stat info;
+  if (fstat(journal->fd, &info) == -1) return false;
+  long long unsigned int block = (info.st_blksize > 0) ? info.st_blksize : 4096;
+  long long unsigned int from = (journal->trimmed > block) ? journal->trimmed
+                                                           : block;
+  long long unsigned int to = position / block * block;
+  if (to <= from) return true;
+
+  // Trim: The blocks, the file keeps its size
+#ifdef FALLOC_FL_PUNCH_HOLE
+  if (fallocate(journal->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                (off_t)from, (off_t)(to - from)) == -1)
+    return errno == EOPNOTSUPP;
+  __atomic_store_n(&journal->trimmed, to, __ATOMIC_RELAXED);
+#endif
+  return true;
+}
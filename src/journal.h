@@ -0,0 +1,250 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file journal.h
+ * @brief Interface of the durable operation journal of the bank
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Version of the journal file, written after its "TCXJ" magic
+ */
+#define JOURNAL_VERSION 1
+
+/**
+ * @brief Number of bytes buffered before the journal is written to its file
+ */
+#define JOURNAL_BUFFER (1 << 20)
+
+/**
+ * @brief Maximum number of balances of a single record, thus a record always
+ * fits in a chunk of the recovery
+ */
+#define JOURNAL_RANGE 4096
+
+/**
+ * @brief Types of the records of the journal
+ */
+enum {
+  JOURNAL_CREATE = 0x4A430001,
+  JOURNAL_BALANCE = 0x4A430002,
+  JOURNAL_ACCOUNTS = 0x4A430003,
+  JOURNAL_CLOSE = 0x4A430004
+};
+
+/**
+ * @brief Structure of the header of a record, followed by its body.
+ *
+ * A creation carries the PIN (u64) and 'length' bytes of the user name
+ * (padded to 8 bytes), the opening balance is the 'amount'. A balance carries
+ * the new balance of the account 'id' as the 'amount' followed by 'length'
+ * more balances (i64) of the accounts right after it. A group carries
+ * 'length' entries (u64 id, i64 balance) of any accounts which are replayed
+ * all or none, e.g. a committed transaction. A closure carries nothing but
+ * the 'id' of the account. Balances are absolute, thus
+ * replaying the last record of an account is enough. The 'check' is a
+ * hash of the whole record (taken with the 'check' as 0), so a torn record at
+ * the end of the file is told apart from a complete one.
+ */
+typedef struct {
+  unsigned int type;
+  unsigned int id;
+  long long int amount;
+  unsigned int length;
+  unsigned int check;
+} journal_record;
+
+/**
+ * @brief Structure of an entry of a group of balances
+ */
+typedef struct {
+  long long unsigned int id;
+  long long int amount;
+} journal_entry;
+
+/**
+ * @brief Structure of the journal, records are appended into the buffer
+ * (under 'lock') and written out once it fills up or on a sync. Positions
+ * ('appended', 'written' and 'synced') are offsets in the file. A sync
+ * writes and flushes the file (under 'flush_lock') only if its records are
+ * not flushed yet, thus the sessions syncing at the same time share a single
+ * flush (group commit). The records before 'trimmed' are released from the
+ * disk (see trim_journal).
+ */
+typedef struct {
+  int fd;
+  pthread_mutex_t lock;
+  pthread_mutex_t flush_lock;
+  char* buffer;
+  size_t used;
+  long long unsigned int appended;
+  long long unsigned int written;
+  long long unsigned int synced;
+  bool failed;
+  bool reported;
+  long long unsigned int trimmed;
+} journal_element;
+
+/**
+ * @brief Journal's Data structure Reference
+ */
+#define JOURNAL journal_element*
+
+/**
+ * @brief This function will open the journal file at the given 'path' for
+ * appending (creating it, with its header, if needed) and return it as a
+ * reference (not copy, thus need to be freed after usage). If some error
+ * happens during creation, it will return NULL reference.
+ * @param path The path of the journal file
+ * @return JOURNAL (reference, not copy) or 'NULL'
+ */
+JOURNAL create_journal(const char* path);
+
+/**
+ * @brief This function will sync and close the given journal. Returns 'true'
+ * if every record reached the file, otherwise returns 'false'.
+ * @param journal The journal's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_journal(JOURNAL journal);
+
+/**
+ * @brief This function will append the creation of the account 'id' of the
+ * given details. Nothing is done if the journal is 'NULL'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @param id The id of the new account
+ * @param pin The PIN of the new account
+ * @param name The user name of the new account (need not to be terminated)
+ * @param length The number of bytes of the user name
+ * @param amount The opening balance of the new account
+ */
+void journal_create(JOURNAL journal, unsigned int id,
+                    long long unsigned int pin, const char* name,
+                    unsigned int length, long long int amount);
+
+/**
+ * @brief This function will append the closure of the account 'id', its slot
+ * is reused by the next creation. Nothing is done if the journal is 'NULL'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @param id The id of the closed account
+ */
+void journal_close(JOURNAL journal, unsigned int id);
+
+/**
+ * @brief This function will append the new balances of the 'count'
+ * consecutive accounts from 'id' on, given by 'amounts'. The caller holds
+ * the stripe of the accounts, thus the records of an account are in the order
+ * of its changes. Nothing is done if the journal is 'NULL'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @param id The id of the first account
+ * @param amounts The new balances
+ * @param count The number of accounts
+ */
+void journal_balances(JOURNAL journal, unsigned int id,
+                      const long long int amounts[], unsigned int count);
+
+/**
+ * @brief This function will append the new balances of the 'count' given
+ * accounts as a single record, thus they are recovered all or none. The
+ * caller holds the stripes of the accounts. Nothing is done if the journal is
+ * 'NULL'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @param entries The accounts and their new balances
+ * @param count The number of entries
+ */
+void journal_accounts(JOURNAL journal, const journal_entry entries[],
+                      unsigned int count);
+
+/**
+ * @brief This function will return the position of the end of the journal,
+ * i.e. the offset in the file where the next record will be.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @return position (0 if the journal is 'NULL')
+ */
+long long unsigned int journal_position(JOURNAL journal);
+
+/**
+ * @brief This function will make every record appended so far durable, i.e.
+ * written and flushed to the disk. Returns 'true' if durable (or the journal
+ * is 'NULL'), otherwise returns 'false'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @return 'true' or 'false'
+ */
+bool sync_journal(JOURNAL journal);
+
+/**
+ * @brief This function will release the disk blocks of the records before
+ * the given 'position', once a durable checkpoint covers them, by punching a
+ * hole into the file (whole blocks only, the first one keeps the header).
+ * The positions don't change, thus the journal is still recovered from the
+ * position of the checkpoint, but no more from an older one (see
+ * recover_accounts). Returns 'true' if trimmed (or nothing to trim, or the
+ * file system can't punch holes), otherwise returns 'false'.
+ * @param journal The journal's data structure reference (or 'NULL')
+ * @param position The position of the durable checkpoint
+ * @return 'true' or 'false'
+ */
+bool trim_journal(JOURNAL journal, long long unsigned int position);
+
+/**
+ * @brief This function will return the hash of the record of 'size' bytes
+ * (header and body) at 'record', taken with its 'check' as 0.
+ * @param record The record
+ * @param size The number of bytes of the record
+ * @return hash
+ */
+unsigned int journal_check(const void* record, size_t size);
+
+/**
+ * @brief This function will return the size of the body of the given record
+ * header in bytes.
+ * @param record The header of the record
+ * @return size
+ */
+size_t journal_body(const journal_record* record);
+
+#endif
@@ -0,0 +1,143 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file limit.c
+ * @brief Withdrawal limits of the accounts
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#include "limit.h"
+
+/**
+ * @brief This function will return the fractions of a token spent out of the
+ * bucket at 'now', i.e. those spent as of the stamp less the refill since.
+ */
+static unsigned int spent_at(const limit_config* config,
+                             const limit_element* limit, unsigned int now) {
+  long long unsigned int refill = (long long unsigned int)(now - limit->stamp) *
+                                  config->per_minute * LIMIT_UNIT / 60000;
+  return (refill >= limit->spent) ? 0 : limit->spent - (unsigned int)refill;
+}
+
+/**
+ * @brief This function will return the withdrawals of the previous and the
+ * current window as of 'now', the windows may have moved on since the last
+ * withdrawal.
+ */
+static void windows_at(const limit_element* limit, unsigned int now,
+                       unsigned int* previous, unsigned int* current) {
+  unsigned short window = (unsigned short)(now / LIMIT_WINDOW);
+  if (window == limit->window) {
+    *previous = limit->previous;
+    *current = limit->current;
+  } else {
+    *previous =
+        (window == (unsigned short)(limit->window + 1)) ? limit->current : 0;
+    *current = 0;
+  }
+}
+
+/**
+ * @brief This function will take a withdrawal out of the limits of an
+ * account at 'now' (milliseconds), unless it is over a threshold (it is
+ * counted as blocked then). Returns 'true' if allowed, otherwise returns
+ * 'false'.
+ * @param config The thresholds
+ * @param limit The limits of the account
+ * @param now The current time in milliseconds
+ * @return 'true' or 'false'
+ */
+bool limit_take(const limit_config* config, LIMIT limit, unsigned int now) {
+  // Check: The bucket holds a token
+  unsigned int spent = spent_at(config, limit, now);
+  bool allowed = config->per_minute == 0 ||
+                 (long long unsigned int)spent + LIMIT_UNIT <=
+                     (long long unsigned int)config->burst * LIMIT_UNIT;
+
+  // Check: The velocity over the sliding hour is below the threshold
+  unsigned int previous, current;
+  windows_at(limit, now, &previous, &current);
+  if (allowed == true && config->per_hour != 0)
+    allowed = limit_velocity(limit, now) < config->per_hour &&
+              current < 0xFFFF;
+  if (allowed == false) {
+    if (limit->blocked < 0xFFFF) limit->blocked++;
+    return false;
+  }
+
+  // Take: A token and a withdrawal of the current window
+  limit->stamp = now;
+  limit->spent = (config->per_minute == 0) ? 0 : spent + LIMIT_UNIT;
+  limit->window = (unsigned short)(now / LIMIT_WINDOW);
+  limit->previous = (unsigned short)previous;
+  limit->current = (unsigned short)(current + 1);
+  return true;
+}
+
+/**
+ * @brief This function will return the tokens left in the bucket of an
+ * account at 'now' (milliseconds), in fractions of a token (LIMIT_UNIT).
+ * @param config The thresholds
+ * @param limit The limits of the account
+ * @param now The current time in milliseconds
+ * @return fractions of a token
+ */
+unsigned int limit_tokens(const limit_config* config,
+                          const limit_element* limit, unsigned int now) {
+  long long unsigned int full =
+      (long long unsigned int)config->burst * LIMIT_UNIT;
+  unsigned int spent = spent_at(config, limit, now);
+  return (spent >= full) ? 0 : (unsigned int)(full - spent);
+}
+
+/**
+ * @brief This function will return the withdrawals of an account over the
+ * sliding hour till 'now' (milliseconds), estimated out of the current and
+ * previous windows.
+ * @param limit The limits of the account
+ * @param now The current time in milliseconds
+ * @return number of withdrawals
+ */
+unsigned int limit_velocity(const limit_element* limit, unsigned int now) {
+  unsigned int previous, current;
+  windows_at(limit, now, &previous, &current);
+  long long unsigned int left = LIMIT_WINDOW - now % LIMIT_WINDOW;
+  return current + (unsigned int)(previous * left / LIMIT_WINDOW);
+}
@@ -0,0 +1,128 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file limit.h
+ * @brief Interface of the withdrawal limits of the accounts
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef LIMIT_H
+#define LIMIT_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Fractions of a token of the token bucket
+ */
+#define LIMIT_UNIT 1000
+
+/**
+ * @brief Milliseconds of the sliding window of the velocity
+ */
+#define LIMIT_WINDOW 3600000
+
+/**
+ * @brief Structure of the limits of an account (16 bytes, four of them per
+ * cache line). 'spent' is the fractions of a token taken out of the full
+ * bucket as of 'stamp' (milliseconds), 'current' and 'previous' are the
+ * withdrawals of the current and previous 'window' of the velocity, and
+ * 'blocked' is the withdrawals refused. All zeros means a full bucket and no
+ * withdrawals, thus a new account is just zeroed.
+ */
+typedef struct {
+  unsigned int stamp;
+  unsigned int spent;
+  unsigned short window;
+  unsigned short current;
+  unsigned short previous;
+  unsigned short blocked;
+} limit_element;
+
+/**
+ * @brief Structure of the thresholds of the limits, 0 for no limit. The
+ * bucket holds 'burst' tokens and gains 'per_minute' tokens a minute, a
+ * withdrawal takes a token, and at most 'per_hour' withdrawals are allowed
+ * over the sliding hour.
+ */
+typedef struct {
+  unsigned int burst;
+  unsigned int per_minute;
+  unsigned int per_hour;
+} limit_config;
+
+/**
+ * @brief Limits' Data structure Reference
+ */
+#define LIMIT limit_element*
+
+/**
+ * @brief This function will take a withdrawal out of the limits of an
+ * account at 'now' (milliseconds), unless it is over a threshold (it is
+ * counted as blocked then). Returns 'true' if allowed, otherwise returns
+ * 'false'.
+ * @param config The thresholds
+ * @param limit The limits of the account
+ * @param now The current time in milliseconds
+ * @return 'true' or 'false'
+ */
+bool limit_take(const limit_config* config, LIMIT limit, unsigned int now);
+
+/**
+ * @brief This function will return the tokens left in the bucket of an
+ * account at 'now' (milliseconds), in fractions of a token (LIMIT_UNIT).
+ * @param config The thresholds
+ * @param limit The limits of the account
+ * @param now The current time in milliseconds
+ * @return fractions of a token
+ */
+unsigned int limit_tokens(const limit_config* config,
+                          const limit_element* limit, unsigned int now);
+
+/**
+ * @brief This function will return the withdrawals of an account over the
+ * sliding hour till 'now' (milliseconds), estimated out of the current and
+ * previous windows.
+ * @param limit The limits of the account
+ * @param now The current time in milliseconds
+ * @return number of withdrawals
+ */
+unsigned int limit_velocity(const limit_element* limit, unsigned int now);
+
+#endif
@@ -8,7 +8,7 @@
  * License
  * @date Last updated on July 2022
 ///////////////////////////////////////////////////////////////////////////////
-//     -> Compilation   $: gcc cs50.c bank.c token.c main.c                  //
+//     -> Compilation   $: gcc *.c -pthread                                  //
 //     -> Memory Check  $: valgrind ./a.out                                  //
 //     -> Time Check    $: time ./a.out                                      //
 //     -> Simple Run    $: ./a.out                                           //
@@ -47,24 +47,30 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ******************************************************************************/
 
 #include <ctype.h>
+#include <poll.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "bank.h"
+#include "batch.h"
+#include "bulk.h"
+#include "checkpoint.h"
+#include "console.h"
 #include "cs50.h"
-#include "token.h"
-
-/**
- * @brief This function will take bank's structure reference and the list of
- * commands as tokens and perform the various computational task by creating the
- * environment. Return true when done with execution and don't want to exit.
- * Returns false when done with the execution and wanted to exit.
- * @param my_bank  The bank's data structure reference
- * @param list The token's data structure reference
- * @return 'true' or 'false'
- */
-bool recognize_and_perform(BANK my_bank, TOKEN_LIST list);
+#include "registry.h"
+#include "ring.h"
+#include "schedule.h"
+#include "script.h"
+#include "server.h"
+#include "session.h"
+#include "wire.h"
 
 /**
  * @brief This function will print the bank's icon using simple character
@@ -79,15 +85,115 @@ void GUI_icon();
 void GUI_head();
 
 /**
- * @brief This function will take the bank's reference structure as an input,
- * prompt the user to type commands, pass then covert it into the tokens with
- * some lower level recognition and handover the Token's list reference (since
- * it is just reference, thus needed to be freed after usage). For this purpose
- * it uses mutiple/nested calling to other library functions.
- * @param my_bank The bank's reference structure
- * @return TOKEN_LIST (reference) or NULL
+ * @brief This function will take the interruption (e.g. Ctrl+C) while serving
+ * the socket or the ring, and stop serving.
+ * @param signal The number of the signal
+ */
+void interrupt(int signal);
+
+/**
+ * @brief This function will measure the cost of the hashed PINs on a bank of
+ * the given number of 'accounts': creating an account (hashing its PIN), the
+ * first login of every account (hashing again, and issued a session token),
+ * the 'logins' logins resumed by the session tokens (never hashing) and the
+ * commands of a logged in session (never hashing). Returns 'true' if every
+ * PIN and token matched (and a wrong one didn't), otherwise returns 'false'.
+ * @param accounts The number of accounts
+ * @param logins The number of resumed logins (and of commands)
+ * @return 'true' or 'false'
+ */
+bool measure_logins(unsigned int accounts, unsigned int logins);
+
+/**
+ * @brief This function will measure the full-bank scans, the sum of the
+ * balances and the count of the balances over a threshold, repeated 'rounds'
+ * times over a bank of the given number of 'accounts', on the balance column
+ * of the account store and on a copy of the accounts laid out as an array of
+ * rows (the layout before the columns). Returns 'true' if both layouts agree,
+ * otherwise returns 'false'.
+ * @param accounts The number of accounts
+ * @param rounds The number of scans of each kind
+ * @return 'true' or 'false'
+ */
+bool measure_scans(unsigned int accounts, unsigned int rounds);
+
+/**
+ * @brief This function will measure a mix of 95% reads (of a random account)
+ * and 5% writes (a deposit of Rs. 1 into a random account) by the given
+ * number of 'threads', each making 'operations' operations on a bank of the
+ * given number of 'accounts'. The reads are made through the snapshot (never
+ * taking a lock), then through the writers' lock as the baseline. Returns
+ * 'true' if every deposit is accounted for, otherwise returns 'false'.
+ * @param accounts The number of accounts
+ * @param threads The number of threads
+ * @param operations The number of operations of each thread
+ * @return 'true' or 'false'
+ */
+bool measure_reads(unsigned int accounts, unsigned int threads,
+                   unsigned int operations);
+
+/**
+ * @brief This function will measure the deposits into a single account by the
+ * given number of 'threads', each making 'deposits' deposits of Rs. 1 while
+ * another thread withdraws Rs. 1 from it, first into its balance (under its
+ * stripe lock) and then into the striped balance of a hot account. Returns
+ * 'true' if the balance adds up every time, otherwise returns 'false'.
+ * @param threads The number of depositing threads
+ * @param deposits The number of deposits of each thread
+ * @return 'true' or 'false'
+ */
+bool measure_deposits(unsigned int threads, unsigned int deposits);
+
+/**
+ * @brief This function will load the socket front end (served by a thread of
+ * this process) with the given number of 'connections', each logging into an
+ * account of its own and then sending 'requests' deposits one after another
+ * (waiting for the reply to each), and measure the requests per second of
+ * the given serving 'model', or of every model if negative. Returns 'true'
+ * if every request got its reply, otherwise returns 'false'.
+ * @param connections The number of connections
+ * @param requests The number of deposits of each connection
+ * @param model The model of serving (SERVER_URING, SERVER_EPOLL,
+ * SERVER_BLOCKING) or negative for every model
+ * @return 'true' or 'false'
  */
-TOKEN_LIST get_clean_input(BANK my_bank);
+bool measure_load(unsigned int connections, unsigned int requests, int model);
+
+/**
+ * @brief This function will measure the deposits (of Rs. 1 into random
+ * accounts of a bank of the given number of 'accounts') submitted through
+ * the shared memory rings (served by a thread of this process), pipelined
+ * as far as the rings take, against the same number of 'commands' fed as
+ * text lines to a logged in session. Returns 'true' if every deposit landed
+ * on a balance, otherwise returns 'false'.
+ * @param accounts The number of accounts
+ * @param commands The number of deposits of each path
+ * @return 'true' or 'false'
+ */
+bool measure_rings(unsigned int accounts, unsigned int commands);
+
+/**
+ * @brief This function will measure the buffer pool of a paged bank of the
+ * given number of 'accounts' through the given number of 'frames', by a
+ * Zipfian (s = 1) mix of 'operations' logins (the look up of the account
+ * and its stored PIN, not hashed), deposits and withdrawals, the popular
+ * accounts spread over the pages at random. Returns 'true' if every
+ * operation found its account, otherwise returns 'false'.
+ * @param accounts The number of accounts
+ * @param frames The number of frames of the buffer pool
+ * @param operations The number of operations of the mix
+ * @return 'true' or 'false'
+ */
+bool measure_pages(unsigned int accounts, unsigned int frames,
+                   unsigned int operations);
+
+/**
+ * @brief This function will run the regression checks of the bank and print
+ * the outcome of each. Returns 'true' if every check passed, otherwise
+ * returns 'false'.
+ * @return 'true' or 'false'
+ */
+bool run_checks();
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -99,36 +205,246 @@ TOKEN_LIST get_clean_input(BANK my_bank);
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-int main() {
+int main(int argc, string argv[]) {
   /////////////////////////////////////////////////////////////////////////////
   // 1. Setup the Space and GUI
   /////////////////////////////////////////////////////////////////////////////
   GUI_icon();
+
+  /////////////////////////////////////////////////////////////////////////////
+  //    Or simulate a network of banks (a bank registry) instead, if asked
+  //    $: ./a.out network (banks) (workers) (transfers) [accounts]
+  /////////////////////////////////////////////////////////////////////////////
+  if (argc > 4 && strcmp(argv[1], "network") == 0) {
+    REGISTRY registry = create_registry(
+        atoi(argv[2]), (argc > 5) ? atoi(argv[5]) : 100, atoi(argv[3]));
+    bool ran = run_transfers(registry, strtoull(argv[4], NULL, 10));
+    if (ran == true)
+      printf("\e[38;5;40mSuccess:\e[0m The money of the network adds up!\n");
+    delete_registry(registry);
+    return (ran == true) ? 0 : 1;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  //    Or measure the logins and commands over the hashed PINs, if asked
+  //    $: ./a.out logins (accounts) (logins)
+  /////////////////////////////////////////////////////////////////////////////
+  if (argc > 3 && strcmp(argv[1], "logins") == 0)
+    return (measure_logins(atoi(argv[2]), atoi(argv[3])) == true) ? 0 : 1;
+
+  /////////////////////////////////////////////////////////////////////////////
+  //    Or measure the scans of the balance column against rows, if asked
+  //    $: ./a.out scans (accounts) (rounds)
+  /////////////////////////////////////////////////////////////////////////////
+  if (argc > 3 && strcmp(argv[1], "scans") == 0)
+    return (measure_scans(atoi(argv[2]), atoi(argv[3])) == true) ? 0 : 1;
+
+  /////////////////////////////////////////////////////////////////////////////
+  //    Or measure the snapshot reads under 5% writes, if asked
+  //    $: ./a.out reads (accounts) (threads) (operations)
+  /////////////////////////////////////////////////////////////////////////////
+  if (argc > 4 && strcmp(argv[1], "reads") == 0)
+    return (measure_reads(atoi(argv[2]), atoi(argv[3]), atoi(argv[4])) == true)
+               ? 0
+               : 1;
+
+  /////////////////////////////////////////////////////////////////////////////
+  //    Or measure the deposits into a hot account against a plain one, if
+  //    asked
+  //    $: ./a.out deposits (threads) (deposits)
+  /////////////////////////////////////////////////////////////////////////////
+  if (argc > 3 && strcmp(argv[1], "deposits") == 0)
+    return (measure_deposits(atoi(argv[2]), atoi(argv[3])) == true) ? 0 : 1;
+
+  /////////////////////////////////////////////////////////////////////////////
+  //    Or load the socket front end, with every model or the given one, if
+  //    asked
+  //    $: ./a.out load (connections) (requests) [uring|epoll|blocking]
+  /////////////////////////////////////////////////////////////////////////////
+  if (argc > 3 && strcmp(argv[1], "load") == 0) {
+    int model = -1;
+    if (argc > 4 && strcmp(argv[4], "uring") == 0) model = SERVER_URING;
+    if (argc > 4 && strcmp(argv[4], "epoll") == 0) model = SERVER_EPOLL;
+    if (argc > 4 && strcmp(argv[4], "blocking") == 0) model = SERVER_BLOCKING;
+    return (measure_load(atoi(argv[2]), atoi(argv[3]), model) == true) ? 0 : 1;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  //    Or measure the rings against the text commands, if asked
+  //    $: ./a.out rings (accounts) (commands)
+  /////////////////////////////////////////////////////////////////////////////
+  if (argc > 3 && strcmp(argv[1], "rings") == 0)
+    return (measure_rings(atoi(argv[2]), atoi(argv[3])) == true) ? 0 : 1;
+
+  /////////////////////////////////////////////////////////////////////////////
+  //    Or measure the buffer pool of a paged bank under a Zipfian mix, if
+  //    asked
+  //    $: ./a.out pages (accounts) (frames) (operations)
+  /////////////////////////////////////////////////////////////////////////////
+  if (argc > 4 && strcmp(argv[1], "pages") == 0)
+    return (measure_pages(atoi(argv[2]), atoi(argv[3]), atoi(argv[4])) == true)
+               ? 0
+               : 1;
+
+  /////////////////////////////////////////////////////////////////////////////
+  //    Or run the regression checks, if asked
+  //    $: ./a.out check
+  /////////////////////////////////////////////////////////////////////////////
+  if (argc > 1 && strcmp(argv[1], "check") == 0)
+    return (run_checks() == true) ? 0 : 1;
   BANK my_bank = create_bank(get_string("\tEnter Bank name: \e[38;5;32m"));
   GUI_head();
 
   /////////////////////////////////////////////////////////////////////////////
-  // 2. Setup the Environment for operations
-  //    A. Get the input from the user
-  //    B. Scan and perform appropriate operation
-  //       * Build the environment
-  //       * Get the input as a string
-  //       * Split the string and recognize the nature
-  //       * Match with the available operation and link the data
-  //         otherwise simply ignore it.
-  //       * Pass the data to the respected function
-  //       * Track the return status and prompt
-  //    C. Clean up the input memory
+  // 2. Recover the bank from its checkpoint and journal, and keep them, or
+  //    attach it to the file shared with other processes, if asked (before
+  //    serving, if asked too)
+  //    $: ./a.out [checkpoint (image-path) (seconds)] [journal (path)] ...
+  //    $: ./a.out [shared (file-path) [capacity]] ...
+  //    Or page the accounts out to the disk, if asked
+  //    $: ./a.out [paged (file-path) (frames)] ...
+  //    Then start the timers, logging out the sessions idle for too long, and
+  //    limit the withdrawals of every account, if asked
+  //    $: ./a.out [idle (seconds)] ...
+  //    $: ./a.out [limits (burst) (per-minute) (per-hour)] ...
+  /////////////////////////////////////////////////////////////////////////////
+  string image = NULL, journal = NULL, shared = NULL, paged = NULL;
+  unsigned int seconds = 0, capacity = 0, frames = 0, idle = 0;
+  bool limited = false;
+  unsigned int burst = 0, per_minute = 0, per_hour = 0;
+  while (argc > 2) {
+    if (argc > 4 && strcmp(argv[1], "limits") == 0) {
+      limited = true;
+      burst = atoi(argv[2]);
+      per_minute = atoi(argv[3]);
+      per_hour = atoi(argv[4]);
+      argc -= 4;
+      argv += 4;
+    } else if (strcmp(argv[1], "idle") == 0) {
+      idle = atoi(argv[2]);
+      argc -= 2;
+      argv += 2;
+    } else if (argc > 3 && strcmp(argv[1], "paged") == 0) {
+      paged = argv[2];
+      frames = atoi(argv[3]);
+      argc -= 3;
+      argv += 3;
+    } else if (strcmp(argv[1], "shared") == 0) {
+      shared = argv[2];
+      bool sized = argc > 3 && isdigit((unsigned char)argv[3][0]);
+      if (sized) capacity = atoi(argv[3]);
+      argc -= (sized) ? 3 : 2;
+      argv += (sized) ? 3 : 2;
+    } else if (strcmp(argv[1], "journal") == 0) {
+      journal = argv[2];
+      argc -= 2;
+      argv += 2;
+    } else if (argc > 3 && strcmp(argv[1], "checkpoint") == 0) {
+      image = argv[2];
+      seconds = atoi(argv[3]);
+      argc -= 3;
+      argv += 3;
+    } else
+      break;
+  }
+  if (shared != NULL && (image != NULL || journal != NULL)) {
+    printf(
+        "\e[38;5;196mError:\e[0m Shared bank can't be checkpointed or "
+        "journaled by a single process.\n");
+    delete_bank(my_bank);
+    return 1;
+  }
+  if (paged != NULL && (shared != NULL || image != NULL || journal != NULL ||
+                        (argc > 1 && strcmp(argv[1], "ring") == 0))) {
+    printf(
+        "\e[38;5;196mError:\e[0m Paged bank can't be shared, checkpointed, "
+        "journaled or served over the rings.\n");
+    delete_bank(my_bank);
+    return 1;
+  }
+  long long unsigned int position = 0;
+  if ((limited == true &&
+       set_limits(my_bank, burst, per_minute, per_hour) == false) ||
+      (paged != NULL && page_bank(my_bank, paged, frames) == false) ||
+      (shared != NULL && share_bank(my_bank, shared, capacity) == false) ||
+      (image != NULL && load_checkpoint(my_bank, image, &position) == false) ||
+      (journal != NULL &&
+       (recover_accounts(my_bank, journal, position) == false ||
+        (my_bank->journal = create_journal(journal)) == NULL)) ||
+      (image != NULL && start_checkpoints(my_bank, image, seconds) == false)) {
+    delete_bank(my_bank);
+    return 1;
+  }
+  if (start_schedule(my_bank, idle) == false) {
+    stop_checkpoints();
+    delete_bank(my_bank);
+    return 1;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // 3. Serve the terminals over the socket instead, if asked
+  //    $: ./a.out serve (socket-path) [uring|epoll|blocking] [threads]
+  /////////////////////////////////////////////////////////////////////////////
+  if (argc > 2 && strcmp(argv[1], "serve") == 0) {
+    int model = SERVER_URING;
+    if (argc > 3 && strcmp(argv[3], "epoll") == 0) model = SERVER_EPOLL;
+    if (argc > 3 && strcmp(argv[3], "blocking") == 0) model = SERVER_BLOCKING;
+    signal(SIGINT, interrupt);
+    signal(SIGTERM, interrupt);
+    bool served =
+        serve(my_bank, argv[2], model, (argc > 4) ? atoi(argv[4]) : 0);
+    stop_schedule();
+    stop_checkpoints();
+    delete_bank(my_bank);
+    return (served == true) ? 0 : 1;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  //    Or the colocated processes over the shared memory rings, if asked
+  //    $: ./a.out ring (shared-memory-name) [accounts-csv]
+  /////////////////////////////////////////////////////////////////////////////
+  if (argc > 2 && strcmp(argv[1], "ring") == 0) {
+    if (argc > 3) import_accounts(my_bank, argv[3]);
+    RING ring = create_ring(argv[2]);
+    if (ring != NULL) {
+      signal(SIGINT, interrupt);
+      signal(SIGTERM, interrupt);
+      printf(
+          "\e[38;5;214mInfo:\e[0m Serving \e[38;5;214m%s\e[0m at shared "
+          "memory \e[38;5;214m%s\e[0m.\n",
+          my_bank->name, argv[2]);
+      fflush(stdout);
+      printf("\e[38;5;214mInfo:\e[0m Served %llu command(s).\n",
+             serve_ring(my_bank, ring));
+      delete_ring(ring);
+    }
+    stop_schedule();
+    stop_checkpoints();
+    delete_bank(my_bank);
+    return (ring != NULL) ? 0 : 1;
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // 4. Setup the Environment for operations
+  //    A. Prompt for whatever the session is waiting for
+  //    B. Get the input from the user, a single line
+  //    C. Feed it to the session, which scan and perform appropriate
+  //       operation (see session.c) and pause on prompts (e.g. PIN)
+  //       instead of waiting for the input by itself
   /////////////////////////////////////////////////////////////////////////////
   bool loop = true;
+  SESSION session = create_session(my_bank, stdout, true);
   while (loop) {
-    TOKEN_LIST input = get_clean_input(my_bank);
-    loop = recognize_and_perform(my_bank, input);
+    session_prompt(session);
+    loop = session_feed(session, get_string(NULL));
   }
 
   /////////////////////////////////////////////////////////////////////////////
-  // 3. Clean up remainder and done!
+  // 5. Clean up remainder and done!
   /////////////////////////////////////////////////////////////////////////////
+  delete_session(session);
+  stop_schedule();
+  stop_checkpoints();
   delete_bank(my_bank);
   return 0;
 }
@@ -144,244 +460,1395 @@ int main() {
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
- * @brief This function will take bank's structure reference and the list of
- * commands as tokens and perform the various computational task by creating the
- * environment. Return true when done with execution and don't want to exit.
- * Returns false when done with the execution and wanted to exit.
- * @param my_bank  The bank's data structure reference
- * @param list The token's data structure reference
+ * @brief This function will take the interruption (e.g. Ctrl+C) while serving
+ * the socket or the ring, and stop serving.
+ * @param signal The number of the signal
+ */
+void interrupt(int signal) {
+  (void)signal;
+  stop_serving();
+  stop_ring();
+}
+
+/**
+ * @brief This function will return the current time of a monotonic clock in
+ * seconds.
+ */
+static double now_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief This function will measure the cost of the hashed PINs on a bank of
+ * the given number of 'accounts': creating an account (hashing its PIN), the
+ * first login of every account (hashing again, and issued a session token),
+ * the 'logins' logins resumed by the session tokens (never hashing) and the
+ * commands of a logged in session (never hashing). Returns 'true' if every
+ * PIN and token matched (and a wrong one didn't), otherwise returns 'false'.
+ * @param accounts The number of accounts
+ * @param logins The number of resumed logins (and of commands)
  * @return 'true' or 'false'
  */
-bool recognize_and_perform(BANK my_bank, TOKEN_LIST list) {
-  enum {
-    FREE,
-    HOLD_BY_DEPOSIT,
-    HOLD_BY_WITHDRAW,
-    HOLD_BY_WITHDRAW_CASH,
-    HOLD_BY_WITHDRAW_CASH_MAXIMIZE
-  };
-  int environment = FREE;
-  int scanned_token = 0;
-  CASH cash = NULL;
-  bool return_status = true;
-  while (scanned_token <= list->quantity) {
-    /////////////////////////////////////////////////////////////////////////
-    // At end, inform correction for previous incomplete commands
-    /////////////////////////////////////////////////////////////////////////
-    if (scanned_token == list->quantity) {
-      if (environment != FREE)
-        printf("\e[38;5;196mFailure:\e[0m Incomplete operation and command.\n");
-      if (environment == HOLD_BY_DEPOSIT)
-        printf("Usage \e[38;5;214m$: deposit (amount)\e[0m\n");
-      if (environment == HOLD_BY_WITHDRAW)
-        printf("Usage \e[38;5;214m$: withdraw (amount)\e[0m\n");
-      if (environment == HOLD_BY_WITHDRAW_CASH ||
-          environment == HOLD_BY_WITHDRAW_CASH_MAXIMIZE)
-        printf(
-            "Usage \e[38;5;214m$: withdraw cash (amount) (note-denom...) "
-            "done\e[0m\n");
-      break;
-    }
+bool measure_logins(unsigned int accounts, unsigned int logins) {
+  // Check: Wether there is anything to measure!
+  if (accounts == 0 || logins == 0) return false;
+  BANK bank = create_bank("Bench");
+  long long unsigned int* tokens = (long long unsigned int*)calloc(
+      accounts, sizeof(long long unsigned int));
+  if (bank == NULL || tokens == NULL) {
+    free(tokens);
+    delete_bank(bank);
+    return false;
+  }
 
-    /////////////////////////////////////////////////////////////////////////
-    // Command $: exit
-    /////////////////////////////////////////////////////////////////////////
-    if (strcmp(list->tokens[scanned_token].get, "exit") == 0 &&
-        environment == FREE) {
-      return_status = false;
-      break;
-    }
+  // Create: Every account, its PIN is hashed
+  bool matched = true;
+  char user[32];
+  double start = now_seconds();
+  for (unsigned int i = 0; i < accounts && matched == true; i++) {
+    long long unsigned int stored;
+    int length = snprintf(user, sizeof(user), "user%u", i);
+    matched = seal_pin(1000 + i, &stored) == true &&
+              add_account(bank, stored, user, length, 3210) == (int)i;
+  }
+  double created = now_seconds() - start;
+
+  // Login: First of every account (hashed), then resumed ones (by token)
+  start = now_seconds();
+  for (unsigned int i = 0; i < accounts && matched == true; i++)
+    matched = check_pin(bank, i, 1000 + i) == true &&
+              grant_token(bank, i, &tokens[i]) == true;
+  double first = now_seconds() - start;
+  start = now_seconds();
+  for (unsigned int i = 0; i < logins && matched == true; i++)
+    matched = check_token(bank, i % accounts, tokens[i % accounts]);
+  double resumed = now_seconds() - start;
+  if (check_pin(bank, 0, 999) == true ||
+      check_token(bank, 0, tokens[0] ^ 1) == true)
+    matched = false;
+
+  // Command: Deposits and withdrawals of the logged in session
+  start = now_seconds();
+  for (unsigned int i = 0; i < logins && matched == true; i++)
+    matched =
+        account_deposit(bank, i % accounts, BANK_ANY_GENERATION, 1) == true &&
+        account_withdraw(bank, i % accounts, BANK_ANY_GENERATION, 1) ==
+            DEBIT_DONE;
+  double commands = now_seconds() - start;
 
-    /////////////////////////////////////////////////////////////////////////
-    // Command $: help
-    /////////////////////////////////////////////////////////////////////////
-    if (strcmp(list->tokens[scanned_token].get, "help") == 0 &&
-        environment == FREE) {
-      help();
-      scanned_token++;
-      continue;
+  // Report: The cost of each
+  if (matched == true)
+    printf(
+        "\e[38;5;214mInfo:\e[0m %u account(s), %u resumed login(s) and "
+        "command(s), %d KB per hash\n"
+        "  account created  \e[38;5;214m%10.2f\e[0m us\n"
+        "  first login      \e[38;5;214m%10.2f\e[0m us\n"
+        "  resumed login    \e[38;5;214m%10.2f\e[0m us (%llu hit(s), %llu "
+        "miss(es))\n"
+        "  command          \e[38;5;214m%10.2f\e[0m us\n",
+        accounts, logins, (int)(VAULT_WORDS * 8 / 1024),
+        created / accounts * 1e6, first / accounts * 1e6,
+        resumed / logins * 1e6, bank->vault->hits, bank->vault->misses,
+        commands / (2.0 * logins) * 1e6);
+  else
+    printf("\e[38;5;196mError:\e[0m A PIN or token didn't match.\n");
+  free(tokens);
+  delete_bank(bank);
+  return matched;
+}
+
+/**
+ * @brief This function will create a bank of the given number of 'accounts'
+ * (named "user0", "user1", ...) for the measurements, sharing a single hashed
+ * PIN (1234) as hashing every PIN would take longer than the measurement.
+ * Returns the bank, otherwise returns 'NULL'.
+ */
+static BANK create_bench_bank(unsigned int accounts) {
+  BANK bank = create_bank("Bench");
+  long long unsigned int stored;
+  if (bank == NULL || seal_pin(1234, &stored) == false ||
+      reserve_accounts(bank, accounts) == false) {
+    delete_bank(bank);
+    return NULL;
+  }
+  char user[32];
+  for (unsigned int i = 0; i < accounts; i++) {
+    int length = snprintf(user, sizeof(user), "user%u", i);
+    if (add_account(bank, stored, user, length, (i * 7919ULL) % 10000) !=
+        (int)i) {
+      delete_bank(bank);
+      return NULL;
     }
+  }
+  return bank;
+}
 
-    /////////////////////////////////////////////////////////////////////////
-    // Command $: login
-    /////////////////////////////////////////////////////////////////////////
-    if (strcmp(list->tokens[scanned_token].get, "login") == 0 &&
-        environment == FREE) {
-      if (login(my_bank) == true)
-        printf("\e[38;5;40mSuccess:\e[0m You have logged into the account!\n");
-      else
-        printf("\e[38;5;196mFailure:\e[0m Not logged in! Try again.\n");
-      scanned_token++;
-      continue;
+/**
+ * @brief This function will measure the full-bank scans, the sum of the
+ * balances and the count of the balances over a threshold, repeated 'rounds'
+ * times over a bank of the given number of 'accounts', on the balance column
+ * of the account store and on a copy of the accounts laid out as an array of
+ * rows (the layout before the columns). Returns 'true' if both layouts agree,
+ * otherwise returns 'false'.
+ * @param accounts The number of accounts
+ * @param rounds The number of scans of each kind
+ * @return 'true' or 'false'
+ */
+bool measure_scans(unsigned int accounts, unsigned int rounds) {
+  // Check: Wether there is anything to measure!
+  if (accounts == 0 || rounds == 0) return false;
+  BANK bank = create_bench_bank(accounts);
+  account_element* rows =
+      (account_element*)malloc((size_t)accounts * sizeof(account_element));
+  if (bank == NULL || rows == NULL) {
+    printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    delete_bank(bank);
+    free(rows);
+    return false;
+  }
+  for (unsigned int i = 0; i < accounts; i++) get_account(bank, i, &rows[i]);
+
+  // Scan: Every kind over each layout, the compiler may not merge the rounds
+  const long long int* column = bank->account.amount;
+  long long int sum[2] = {0}, over[2] = {0};
+  double elapsed[2][2];
+  double start = now_seconds();
+  for (unsigned int r = 0; r < rounds; r++) {
+    __asm__ volatile("" ::: "memory");
+    for (unsigned int i = 0; i < accounts; i++) sum[0] += column[i];
+  }
+  elapsed[0][0] = now_seconds() - start;
+  start = now_seconds();
+  for (unsigned int r = 0; r < rounds; r++) {
+    __asm__ volatile("" ::: "memory");
+    for (unsigned int i = 0; i < accounts; i++) sum[1] += rows[i].amount;
+  }
+  elapsed[1][0] = now_seconds() - start;
+  start = now_seconds();
+  for (unsigned int r = 0; r < rounds; r++) {
+    __asm__ volatile("" ::: "memory");
+    for (unsigned int i = 0; i < accounts; i++) over[0] += column[i] >= 5000;
+  }
+  elapsed[0][1] = now_seconds() - start;
+  start = now_seconds();
+  for (unsigned int r = 0; r < rounds; r++) {
+    __asm__ volatile("" ::: "memory");
+    for (unsigned int i = 0; i < accounts; i++)
+      over[1] += rows[i].amount >= 5000;
+  }
+  elapsed[1][1] = now_seconds() - start;
+
+  // Report: The time per account and the accounts per second of each
+  bool agreed = sum[0] == sum[1] && over[0] == over[1];
+  double scanned = (double)accounts * rounds;
+  if (agreed == true)
+    printf(
+        "\e[38;5;214mInfo:\e[0m %u account(s), %u round(s) of each scan\n"
+        "  sum    columns \e[38;5;214m%8.3f\e[0m ns/account (%7.1f M/s), "
+        "rows %8.3f ns/account (%7.1f M/s)\n"
+        "  filter columns \e[38;5;214m%8.3f\e[0m ns/account (%7.1f M/s), "
+        "rows %8.3f ns/account (%7.1f M/s)\n",
+        accounts, rounds, elapsed[0][0] / scanned * 1e9,
+        scanned / elapsed[0][0] / 1e6, elapsed[1][0] / scanned * 1e9,
+        scanned / elapsed[1][0] / 1e6, elapsed[0][1] / scanned * 1e9,
+        scanned / elapsed[0][1] / 1e6, elapsed[1][1] / scanned * 1e9,
+        scanned / elapsed[1][1] / 1e6);
+  else
+    printf("\e[38;5;196mError:\e[0m The layouts don't agree.\n");
+  free(rows);
+  delete_bank(bank);
+  return agreed;
+}
+
+/**
+ * @brief Structure of a thread of the read measurement
+ */
+typedef struct {
+  pthread_t thread;
+  BANK bank;
+  unsigned int accounts;
+  unsigned int operations;
+  unsigned int seed;
+  bool locked;
+  long long unsigned int deposits;
+  double writing;
+  double longest_write;
+} reads_worker;
+
+/**
+ * @brief This function will run the operations of a thread of the read
+ * measurement, reading through the snapshot or under the writers' lock.
+ */
+static void* run_reads(void* argument) {
+  reads_worker* worker = (reads_worker*)argument;
+  BANK bank = worker->bank;
+  set_console(null_console());
+  account_element account;
+  char name[64];
+  for (unsigned int i = 0; i < worker->operations; i++) {
+    unsigned int id = rand_r(&worker->seed) % worker->accounts;
+
+    // Write: One operation in twenty, timing how long the writer took
+    if (rand_r(&worker->seed) % 20 == 0) {
+      double start = now_seconds();
+      if (account_deposit(bank, id, BANK_ANY_GENERATION, 1) == true)
+        worker->deposits++;
+      double took = now_seconds() - start;
+      worker->writing += took;
+      if (took > worker->longest_write) worker->longest_write = took;
     }
 
-    /////////////////////////////////////////////////////////////////////////
-    // Command $: logout
-    /////////////////////////////////////////////////////////////////////////
-    if (strcmp(list->tokens[scanned_token].get, "logout") == 0 &&
-        environment == FREE) {
-      if (logout(my_bank) == true)
-        printf(
-            "\e[38;5;40mSuccess:\e[0m You have logged out of the account!\n");
-      else
-        printf("\e[38;5;196mFailure:\e[0m Not logged out! Try again.\n");
-      scanned_token++;
-      continue;
+    // Read: Through the snapshot, or holding the writers out of the stripe
+    // (copying the name too, as the snapshot does)
+    else if (worker->locked == false)
+      snapshot_account(bank, id, &account, name, sizeof(name));
+    else {
+      write_begin(bank->sync, stripe_of(id));
+      if (get_account(bank, id, &account) == true)
+        snprintf(name, sizeof(name), "%s", account.name);
+      write_end(bank->sync, stripe_of(id));
     }
+  }
+  return NULL;
+}
 
-    /////////////////////////////////////////////////////////////////////////
-    // Command $: deposit (amount)
-    /////////////////////////////////////////////////////////////////////////
-    if (strcmp(list->tokens[scanned_token].get, "deposit") == 0 &&
-        environment == FREE) {
-      environment = HOLD_BY_DEPOSIT;
-      scanned_token++;
-      continue;
+/**
+ * @brief This function will measure a mix of 95% reads (of a random account)
+ * and 5% writes (a deposit of Rs. 1 into a random account) by the given
+ * number of 'threads', each making 'operations' operations on a bank of the
+ * given number of 'accounts'. The reads are made through the snapshot (never
+ * taking a lock), then through the writers' lock as the baseline. Returns
+ * 'true' if every deposit is accounted for, otherwise returns 'false'.
+ * @param accounts The number of accounts
+ * @param threads The number of threads
+ * @param operations The number of operations of each thread
+ * @return 'true' or 'false'
+ */
+bool measure_reads(unsigned int accounts, unsigned int threads,
+                   unsigned int operations) {
+  // Check: Wether there is anything to measure!
+  if (accounts == 0 || threads == 0 || threads > 256 || operations == 0)
+    return false;
+  BANK bank = create_bench_bank(accounts);
+  reads_worker* workers = (reads_worker*)calloc(threads, sizeof(reads_worker));
+  if (bank == NULL || workers == NULL) {
+    printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    delete_bank(bank);
+    free(workers);
+    return false;
+  }
+  long long int before = 0;
+  for (unsigned int i = 0; i < accounts; i++)
+    before += bank->account.amount[i];
+
+  // Run: The snapshot reads first, then the locked ones
+  long long unsigned int deposits = 0;
+  double elapsed[2], writing[2] = {0}, longest[2] = {0};
+  long long unsigned int written[2] = {0};
+  for (unsigned int round = 0; round < 2; round++) {
+    double start = now_seconds();
+    unsigned int created = 0;
+    for (; created < threads; created++) {
+      reads_worker* worker = &workers[created];
+      worker->bank = bank;
+      worker->accounts = accounts;
+      worker->operations = operations;
+      worker->seed = created * 2 + round + 1;
+      worker->locked = round == 1;
+      worker->deposits = 0;
+      worker->writing = 0;
+      worker->longest_write = 0;
+      if (pthread_create(&worker->thread, NULL, run_reads, worker) != 0) break;
     }
-    if (environment == HOLD_BY_DEPOSIT) {
-      if (list->tokens[scanned_token].is_numeric == true) {
-        if (deposit(my_bank, atoll(list->tokens[scanned_token].get)) == true)
-          printf(
-              "\e[38;5;40mSuccess:\e[0m You have deposited into the "
-              "account!\n");
-        else
-          printf(
-              "\e[38;5;196mFailure:\e[0m Something went wrong! Try again.\n");
-        environment = FREE;
-      }
-      scanned_token++;
-      continue;
+    for (unsigned int i = 0; i < created; i++) {
+      pthread_join(workers[i].thread, NULL);
+      deposits += workers[i].deposits;
+      written[round] += workers[i].deposits;
+      writing[round] += workers[i].writing;
+      if (workers[i].longest_write > longest[round])
+        longest[round] = workers[i].longest_write;
     }
+    elapsed[round] = now_seconds() - start;
+    if (created < threads) {
+      printf("\e[38;5;196mError:\e[0m Couldn't start the threads.\n");
+      free(workers);
+      delete_bank(bank);
+      return false;
+    }
+  }
+
+  // Check: Every deposit landed on a balance
+  long long int after = 0;
+  for (unsigned int i = 0; i < accounts; i++)
+    after += bank->account.amount[i];
+  bool counted = after - before == (long long int)deposits;
+
+  // Report: The operations per second and the longest write of each
+  double total = (double)threads * operations;
+  if (counted == true)
+    printf(
+        "\e[38;5;214mInfo:\e[0m %u account(s), %u thread(s) of %u "
+        "operation(s), 95%% reads and 5%% deposits\n"
+        "  snapshot reads \e[38;5;214m%10.0f\e[0m op/s, write %6.3f us "
+        "(longest %8.1f us)\n"
+        "  locked reads   \e[38;5;214m%10.0f\e[0m op/s, write %6.3f us "
+        "(longest %8.1f us)\n",
+        accounts, threads, operations, total / elapsed[0],
+        writing[0] / (written[0] + !written[0]) * 1e6, longest[0] * 1e6,
+        total / elapsed[1], writing[1] / (written[1] + !written[1]) * 1e6,
+        longest[1] * 1e6);
+  else
+    printf("\e[38;5;196mError:\e[0m The deposits don't add up.\n");
+  free(workers);
+  delete_bank(bank);
+  return counted;
+}
+
+/**
+ * @brief Structure of a thread of the deposit measurement, either depositing
+ * Rs. 1 'deposits' times or withdrawing Rs. 1 while 'running' is set
+ */
+typedef struct {
+  pthread_t thread;
+  BANK bank;
+  unsigned int deposits;
+  const bool* running;
+  long long unsigned int done;
+} deposits_worker;
+
+/**
+ * @brief This function will run the deposits of a thread of the deposit
+ * measurement into the first account.
+ */
+static void* run_deposits(void* argument) {
+  deposits_worker* worker = (deposits_worker*)argument;
+  set_console(null_console());
+  for (unsigned int i = 0; i < worker->deposits; i++)
+    if (account_deposit(worker->bank, 0, BANK_ANY_GENERATION, 1) == true)
+      worker->done++;
+  return NULL;
+}
+
+/**
+ * @brief This function will run the withdrawals of the deposit measurement
+ * from the first account, as long as the depositors run.
+ */
+static void* run_withdrawals(void* argument) {
+  deposits_worker* worker = (deposits_worker*)argument;
+  set_console(null_console());
+  while (__atomic_load_n(worker->running, __ATOMIC_ACQUIRE) == true)
+    if (account_withdraw(worker->bank, 0, BANK_ANY_GENERATION, 1) ==
+        DEBIT_DONE)
+      worker->done++;
+  return NULL;
+}
 
-    /////////////////////////////////////////////////////////////////////////
-    // Command $: withdraw (amount)
-    /////////////////////////////////////////////////////////////////////////
-    if (strcmp(list->tokens[scanned_token].get, "withdraw") == 0 &&
-        environment == FREE) {
-      environment = HOLD_BY_WITHDRAW;
+/**
+ * @brief This function will measure the deposits into a single account by the
+ * given number of 'threads', each making 'deposits' deposits of Rs. 1 while
+ * another thread withdraws Rs. 1 from it, first into its balance (under its
+ * stripe lock) and then into the striped balance of a hot account. Returns
+ * 'true' if the balance adds up every time, otherwise returns 'false'.
+ * @param threads The number of depositing threads
+ * @param deposits The number of deposits of each thread
+ * @return 'true' or 'false'
+ */
+bool measure_deposits(unsigned int threads, unsigned int deposits) {
+  // Check: Wether there is anything to measure!
+  if (threads == 0 || threads > 256 || deposits == 0) return false;
+  BANK bank = create_bench_bank(16);
+  deposits_worker* workers =
+      (deposits_worker*)calloc(threads + 1, sizeof(deposits_worker));
+  if (bank == NULL || workers == NULL) {
+    printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    delete_bank(bank);
+    free(workers);
+    return false;
+  }
 
-      // Continue
-      scanned_token++;
-      continue;
+  // Run: Into the balance first, then into the striped balance
+  bool added = true;
+  double elapsed[2];
+  long long unsigned int withdrawn[2];
+  for (unsigned int round = 0; round < 2 && added == true; round++) {
+    if (round == 1) added = mark_hot_account(bank, 0);
+    long long int before = bank->account.amount[0];
+    bool running = true;
+    double start = now_seconds();
+    unsigned int created = 0;
+    for (; created <= threads && added == true; created++) {
+      deposits_worker* worker = &workers[created];
+      worker->bank = bank;
+      worker->deposits = deposits;
+      worker->running = &running;
+      worker->done = 0;
+      if (pthread_create(&worker->thread, NULL,
+                         (created == threads) ? run_withdrawals : run_deposits,
+                         worker) != 0)
+        break;
+    }
+    long long unsigned int deposited = 0;
+    for (unsigned int i = 0; i < created && i < threads; i++) {
+      pthread_join(workers[i].thread, NULL);
+      deposited += workers[i].done;
     }
+    elapsed[round] = now_seconds() - start;
+    __atomic_store_n(&running, false, __ATOMIC_RELEASE);
+    if (created > threads) pthread_join(workers[threads].thread, NULL);
+    if (created <= threads) {
+      printf("\e[38;5;196mError:\e[0m Couldn't start the threads.\n");
+      added = false;
+      break;
+    }
+
+    // Check: Every deposit and withdrawal landed on the balance
+    withdrawn[round] = workers[threads].done;
+    refresh_accounts(bank);
+    added = deposited == (long long unsigned int)threads * deposits &&
+            bank->account.amount[0] ==
+                before + (long long int)deposited -
+                    (long long int)withdrawn[round];
+  }
+
+  // Report: The deposits per second of each
+  double total = (double)threads * deposits;
+  if (added == true)
+    printf(
+        "\e[38;5;214mInfo:\e[0m %u thread(s) of %u deposit(s) into one "
+        "account, a thread withdrawing from it\n"
+        "  balance         \e[38;5;214m%10.0f\e[0m deposit/s (%llu "
+        "withdrawal(s))\n"
+        "  striped balance \e[38;5;214m%10.0f\e[0m deposit/s (%llu "
+        "withdrawal(s))\n",
+        threads, deposits, total / elapsed[0], withdrawn[0],
+        total / elapsed[1], withdrawn[1]);
+  else
+    printf("\e[38;5;196mError:\e[0m The balance doesn't add up.\n");
+  free(workers);
+  delete_bank(bank);
+  return added;
+}
+
+/**
+ * @brief Structure of a client connection of the load measurement, 'done' is
+ * the number of lines replied (-1 till greeted) and 'tail' the last bytes
+ * received, to tell a complete reply (ending with a prompt)
+ */
+typedef struct {
+  int fd;
+  int done;
+  bool waiting;
+  char tail[16];
+  unsigned int tail_length;
+} load_client;
+
+/**
+ * @brief Structure of the server thread of the load measurement
+ */
+typedef struct {
+  BANK bank;
+  const char* path;
+  int model;
+  bool served;
+} load_server;
+
+/**
+ * @brief This function will serve the socket of the load measurement.
+ */
+static void* run_server(void* argument) {
+  load_server* server = (load_server*)argument;
+  set_console(null_console());
+  server->served = serve(server->bank, server->path, server->model, 0);
+  return NULL;
+}
+
+/**
+ * @brief This function will tell whether the bytes received so far by a
+ * client end with a prompt (of a command, a user name or a PIN).
+ */
+static bool ends_with_prompt(const load_client* client) {
+  static const char* prompts[] = {"$: \e[0m", "PIN: ", ": \e[38;5;214m"};
+  for (unsigned int i = 0; i < 3; i++) {
+    size_t length = strlen(prompts[i]);
+    if (client->tail_length >= length &&
+        memcmp(client->tail + client->tail_length - length, prompts[i],
+               length) == 0)
+      return true;
+  }
+  return false;
+}
 
-    if (environment == HOLD_BY_WITHDRAW) {
-      // If numeric
-      if (list->tokens[scanned_token].is_numeric == true) {
-        if (withdraw(my_bank, atoll(list->tokens[scanned_token].get)) == true)
-          printf(
-              "\e[38;5;40mSuccess:\e[0m You have withdrawn from the "
-              "account!\n");
+/**
+ * @brief This function will drive the clients till each has got the replies
+ * of 'lines' lines: "login", its user name, its PIN, then deposits. Returns
+ * 'true' if done, otherwise returns 'false' if the server went silent.
+ */
+static bool drive_clients(load_client* clients, unsigned int count,
+                          int lines, struct pollfd* polled,
+                          unsigned int* index) {
+  char buffer[4096];
+  while (true) {
+    // Send: The next line of every client not waiting for a reply
+    unsigned int waiting = 0;
+    for (unsigned int i = 0; i < count; i++) {
+      load_client* client = &clients[i];
+      if (client->waiting == false && client->done < lines) {
+        int length;
+        if (client->done == 0)
+          length = snprintf(buffer, sizeof(buffer), "login\n");
+        else if (client->done == 1)
+          length = snprintf(buffer, sizeof(buffer), "user%u\n", i);
+        else if (client->done == 2)
+          length = snprintf(buffer, sizeof(buffer), "1234\n");
         else
-          printf(
-              "\e[38;5;196mFailure:\e[0m Something went wrong! Try again.\n");
-        environment = FREE;
+          length = snprintf(buffer, sizeof(buffer), "deposit 1\n");
+        if (send(client->fd, buffer, length, MSG_NOSIGNAL) != length)
+          return false;
+        client->waiting = true;
+        client->tail_length = 0;
       }
-
-      // If alphabetic
-      if (list->tokens[scanned_token].is_alpha == true) {
-        if (strcmp(list->tokens[scanned_token].get, "cash") == 0) {
-          environment = HOLD_BY_WITHDRAW_CASH;
-        }
+      if (client->waiting == true) {
+        polled[waiting].fd = client->fd;
+        polled[waiting].events = POLLIN;
+        index[waiting++] = i;
       }
-
-      // Continue
-      scanned_token++;
-      continue;
     }
+    if (waiting == 0) return true;
 
-    /////////////////////////////////////////////////////////////////////////
-    // Command $: withdraw cash (amount) (note-denom...) done
-    /////////////////////////////////////////////////////////////////////////
-    if (environment == HOLD_BY_WITHDRAW_CASH) {
-      // If numeric
-      if (list->tokens[scanned_token].is_numeric == true) {
-        cash = create_cash_withdraw(my_bank,
-                                    atoll(list->tokens[scanned_token].get));
-        environment = HOLD_BY_WITHDRAW_CASH_MAXIMIZE;
+    // Receive: The replies at hand, a prompt ends a reply
+    if (poll(polled, waiting, 10000) <= 0) return false;
+    for (unsigned int k = 0; k < waiting; k++) {
+      if ((polled[k].revents & (POLLIN | POLLHUP)) == 0) continue;
+      load_client* client = &clients[index[k]];
+      ssize_t got = recv(client->fd, buffer, sizeof(buffer), 0);
+      if (got <= 0) return false;
+      size_t take = (got > 16) ? 16 : (size_t)got;
+      size_t keep = 16 - take;
+      if (keep > client->tail_length) keep = client->tail_length;
+      memmove(client->tail, client->tail + client->tail_length - keep, keep);
+      memcpy(client->tail + keep, buffer + got - take, take);
+      client->tail_length = keep + take;
+      if (ends_with_prompt(client) == true) {
+        client->waiting = false;
+        client->done++;
       }
+    }
+  }
+}
+
+/**
+ * @brief This function will load the socket front end (served by a thread of
+ * this process) with the given number of 'connections', each logging into an
+ * account of its own and then sending 'requests' deposits one after another
+ * (waiting for the reply to each), and measure the requests per second of
+ * the given serving 'model', or of every model if negative. Returns 'true'
+ * if every request got its reply, otherwise returns 'false'.
+ * @param connections The number of connections
+ * @param requests The number of deposits of each connection
+ * @param model The model of serving (SERVER_URING, SERVER_EPOLL,
+ * SERVER_BLOCKING) or negative for every model
+ * @return 'true' or 'false'
+ */
+bool measure_load(unsigned int connections, unsigned int requests,
+                  int model) {
+  // Check: Wether there is anything to measure!
+  if (connections == 0 || requests == 0) return false;
+  BANK bank = create_bench_bank(connections);
+  load_client* clients =
+      (load_client*)calloc(connections, sizeof(load_client));
+  struct pollfd* polled =
+      (struct pollfd*)calloc(connections, sizeof(struct pollfd));
+  unsigned int* index = (unsigned int*)calloc(connections, sizeof(unsigned));
+  if (bank == NULL || clients == NULL || polled == NULL || index == NULL) {
+    printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    delete_bank(bank);
+    free(clients);
+    free(polled);
+    free(index);
+    return false;
+  }
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/transaction-load-%d.sock", (int)getpid());
+  struct sockaddr_un address = {0};
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, path);
+  printf("\e[38;5;214mInfo:\e[0m %u connection(s) of %u deposit(s) each\n",
+         connections, requests);
 
-      // Continue
-      scanned_token++;
-      continue;
+  // Run: Every model asked, on a server thread of its own
+  static const char* names[] = {"io_uring", "epoll", "blocking"};
+  bool replied = true;
+  for (int m = 0; m < 3 && replied == true; m++) {
+    if (model >= 0 && m != model) continue;
+    load_server server = {bank, path, m, false};
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, run_server, &server) != 0) {
+      replied = false;
+      break;
     }
 
-    if (environment == HOLD_BY_WITHDRAW_CASH_MAXIMIZE) {
-      // If numeric
-      if (list->tokens[scanned_token].is_numeric == true) {
-        if (maximize(cash, atoi(list->tokens[scanned_token].get)) == true)
-          printf("\e[38;5;40mSuccess:\e[0m maximized Rs. %d/- notes!\n",
-                 atoi(list->tokens[scanned_token].get));
+    // Connect: Every client, once the socket is served
+    unsigned int connected = 0;
+    for (unsigned int tries = 0; connected < connections && tries < 2000;) {
+      load_client* client = &clients[connected];
+      memset(client, 0, sizeof(load_client));
+      client->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (client->fd != -1 &&
+          connect(client->fd, (struct sockaddr*)&address, sizeof(address)) ==
+              0) {
+        client->done = -1;
+        client->waiting = true;
+        connected++;
+        continue;
       }
+      if (client->fd != -1) close(client->fd);
+      tries++;
+      usleep(1000);
+    }
 
-      // If alphabetic
-      if (list->tokens[scanned_token].is_alpha == true) {
-        if (strcmp(list->tokens[scanned_token].get, "done") == 0) {
-          if (withdraw_cash(my_bank, cash) == true) {
-            printf(
-                "\e[38;5;40mSuccess:\e[0m You have withdrawn from the "
-                "account!\n");
-            display_cash(cash);
-          } else
-            printf(
-                "\e[38;5;196mFailure:\e[0m Something went wrong! Try "
-                "again.\n");
-
-          environment = FREE;
-        }
-      }
+    // Drive: The logins first, then the timed deposits
+    replied = connected == connections &&
+              drive_clients(clients, connections, 3, polled, index) == true;
+    double start = now_seconds();
+    replied = replied == true &&
+              drive_clients(clients, connections, 3 + requests, polled,
+                            index) == true;
+    double elapsed = now_seconds() - start;
+    for (unsigned int i = 0; i < connected; i++) close(clients[i].fd);
+    stop_serving();
+    pthread_join(thread, NULL);
 
-      // Continue
-      scanned_token++;
-      continue;
-    }
+    // Report: The requests per second and the mean round trip
+    double total = (double)connections * requests;
+    if (replied == true)
+      printf(
+          "  %-8s \e[38;5;214m%10.0f\e[0m req/s, round trip %8.1f us\n",
+          names[m], total / elapsed, elapsed / requests * 1e6);
+    else
+      printf("\e[38;5;196mError:\e[0m The %s server didn't reply.\n",
+             names[m]);
+  }
+  free(clients);
+  free(polled);
+  free(index);
+  delete_bank(bank);
+  return replied;
+}
+
+/**
+ * @brief Structure of the engine thread of the ring measurement
+ */
+typedef struct {
+  BANK bank;
+  RING ring;
+} rings_engine;
+
+/**
+ * @brief This function will serve the rings of the ring measurement.
+ */
+static void* run_engine(void* argument) {
+  rings_engine* engine = (rings_engine*)argument;
+  set_console(null_console());
+  serve_ring(engine->bank, engine->ring);
+  return NULL;
+}
+
+/**
+ * @brief This function will measure the deposits (of Rs. 1 into random
+ * accounts of a bank of the given number of 'accounts') submitted through
+ * the shared memory rings (served by a thread of this process), pipelined
+ * as far as the rings take, against the same number of 'commands' fed as
+ * text lines to a logged in session. Returns 'true' if every deposit landed
+ * on a balance, otherwise returns 'false'.
+ * @param accounts The number of accounts
+ * @param commands The number of deposits of each path
+ * @return 'true' or 'false'
+ */
+bool measure_rings(unsigned int accounts, unsigned int commands) {
+  // Check: Wether there is anything to measure!
+  if (accounts == 0 || commands == 0) return false;
+  BANK bank = create_bench_bank(accounts);
+  char name[64];
+  snprintf(name, sizeof(name), "/transaction-rings-%d", (int)getpid());
+  rings_engine engine = {bank, (bank != NULL) ? create_ring(name) : NULL};
+  RING client = (engine.ring != NULL) ? attach_ring(name) : NULL;
+  SESSION session =
+      (bank != NULL) ? create_session(bank, null_console(), false) : NULL;
+  pthread_t thread;
+  if (client == NULL || session == NULL ||
+      pthread_create(&thread, NULL, run_engine, &engine) != 0) {
+    printf("\e[38;5;196mError:\e[0m Couldn't set up the rings.\n");
+    delete_session(session);
+    delete_ring(client);
+    delete_ring(engine.ring);
+    delete_bank(bank);
+    return false;
+  }
+  long long int before = 0;
+  for (unsigned int i = 0; i < accounts; i++)
+    before += bank->account.amount[i];
 
-    /////////////////////////////////////////////////////////////////////////
-    // Command $: show
-    /////////////////////////////////////////////////////////////////////////
-    if (strcmp(list->tokens[scanned_token].get, "show") == 0 &&
-        environment == FREE) {
-      display(my_bank);
-      scanned_token++;
-      continue;
+  // Submit: As many deposits as the ring takes, then take the replies
+  unsigned int seed = 1;
+  long long unsigned int submitted = 0, received = 0, done = 0;
+  ring_command command = {0};
+  ring_reply reply;
+  command.operation = RING_DEPOSIT;
+  command.amount = 1;
+  double start = now_seconds();
+  while (received < commands) {
+    bool moved = false;
+    while (submitted < commands) {
+      command.tag = submitted;
+      command.account = rand_r(&seed) % accounts;
+      if (ring_submit(client, &command) == false) break;
+      submitted++;
+      moved = true;
+    }
+    while (ring_receive(client, &reply) == true) {
+      done += reply.result == BATCH_DONE;
+      received++;
+      moved = true;
     }
+    if (moved == false) sched_yield();
+  }
+  double ring_elapsed = now_seconds() - start;
+  stop_ring();
+  pthread_join(thread, NULL);
+
+  // Feed: The same deposits as text lines to a logged in session
+  session_feed(session, "login");
+  session_feed(session, "user0");
+  session_feed(session, "1234");
+  start = now_seconds();
+  for (unsigned int i = 0; i < commands; i++)
+    session_feed(session, "deposit 1");
+  double text_elapsed = now_seconds() - start;
 
-    /////////////////////////////////////////////////////////////////////////
-    // Command $: (any, not listed above))
-    // Just ignore them!
-    /////////////////////////////////////////////////////////////////////////
-    scanned_token++;
+  // Check: Every deposit landed on a balance
+  long long int after = 0;
+  for (unsigned int i = 0; i < accounts; i++)
+    after += bank->account.amount[i];
+  bool landed = done == commands && after - before == 2LL * commands;
+
+  // Report: The deposits per second of each path
+  if (landed == true)
+    printf(
+        "\e[38;5;214mInfo:\e[0m %u account(s), %u deposit(s) of each path\n"
+        "  rings \e[38;5;214m%10.0f\e[0m op/s\n"
+        "  text  \e[38;5;214m%10.0f\e[0m op/s\n",
+        accounts, commands, commands / ring_elapsed, commands / text_elapsed);
+  else
+    printf("\e[38;5;196mError:\e[0m The deposits don't add up.\n");
+  delete_session(session);
+  delete_ring(client);
+  delete_ring(engine.ring);
+  delete_bank(bank);
+  return landed;
+}
+
+/**
+ * @brief This function will return the rank (0 the most popular) of a
+ * Zipfian draw, out of the cumulative weights 'cdf' of the 'count' ranks.
+ */
+static unsigned int draw_rank(const double* cdf, unsigned int count,
+                              unsigned int* seed) {
+  double u = rand_r(seed) / (RAND_MAX + 1.0);
+  unsigned int low = 0, high = count - 1;
+  while (low < high) {
+    unsigned int middle = low + (high - low) / 2;
+    if (cdf[middle] <= u)
+      low = middle + 1;
+    else
+      high = middle;
   }
+  return low;
+}
 
-  // Clean up remainder and return the status
-  if (cash != NULL) {
-    free(cash);
-    cash = NULL;
+/**
+ * @brief This function will measure the buffer pool of a paged bank of the
+ * given number of 'accounts' through the given number of 'frames', by a
+ * Zipfian (s = 1) mix of 'operations' logins (the look up of the account
+ * and its stored PIN, not hashed), deposits and withdrawals, the popular
+ * accounts spread over the pages at random. Returns 'true' if every
+ * operation found its account, otherwise returns 'false'.
+ * @param accounts The number of accounts
+ * @param frames The number of frames of the buffer pool
+ * @param operations The number of operations of the mix
+ * @return 'true' or 'false'
+ */
+bool measure_pages(unsigned int accounts, unsigned int frames,
+                   unsigned int operations) {
+  // Check: Wether there is anything to measure!
+  if (accounts == 0 || frames == 0 || operations == 0) return false;
+  BANK bank = create_bank("Bench");
+  double* cdf = (double*)malloc(sizeof(double) * accounts);
+  unsigned int* ids = (unsigned int*)malloc(sizeof(unsigned int) * accounts);
+  long long unsigned int stored;
+  char path[] = "/tmp/transaction-console-XXXXXX";
+  int fd = (bank != NULL && cdf != NULL && ids != NULL) ? mkstemp(path) : -1;
+  if (fd != -1) close(fd);
+  bool passed = fd != -1 && seal_pin(1234, &stored) == true &&
+                page_bank(bank, path, frames) == true;
+
+  // Create: Every account, through the pages
+  char user[32];
+  for (unsigned int i = 0; passed == true && i < accounts; i++) {
+    int length = snprintf(user, sizeof(user), "user%u", i);
+    passed = add_account(bank, stored, user, length, 3210) == (int)i;
+  }
+
+  // Configure: The weights 1/rank, and the ids of the ranks shuffled
+  double total = 0;
+  for (unsigned int i = 0; passed == true && i < accounts; i++) {
+    total += 1.0 / (i + 1);
+    cdf[i] = total;
+    ids[i] = i;
   }
-  if (list != NULL) {
-    free_tokens(list);
-    list = NULL;
+  unsigned int seed = 1;
+  for (unsigned int i = 0; passed == true && i < accounts; i++) {
+    cdf[i] /= total;
+    unsigned int j = i + rand_r(&seed) % (accounts - i);
+    unsigned int id = ids[i];
+    ids[i] = ids[j];
+    ids[j] = id;
   }
-  return return_status;
+
+  // Drive: 20% logins, 40% deposits and 40% withdrawals
+  long long unsigned int hits = (passed) ? bank->pager->hits : 0;
+  long long unsigned int misses = (passed) ? bank->pager->misses : 0;
+  double start = now_seconds();
+  for (unsigned int i = 0; passed == true && i < operations; i++) {
+    unsigned int id = ids[draw_rank(cdf, accounts, &seed)];
+    unsigned int kind = rand_r(&seed) % 5;
+    account_element account;
+    if (kind == 0) {
+      int length = snprintf(user, sizeof(user), "user%u", id);
+      passed = length > 0 && find_account(bank, user) == (int)id &&
+               snapshot_account(bank, id, &account, user, sizeof(user)) ==
+                   true;
+    } else if (kind < 3)
+      passed = account_deposit(bank, id, BANK_ANY_GENERATION, 1) == true;
+    else
+      passed = account_withdraw(bank, id, BANK_ANY_GENERATION, 1) !=
+               DEBIT_NO_ACCOUNT;
+  }
+  double elapsed = now_seconds() - start;
+
+  // Report: The mix, then the pool over the creation and the mix
+  if (passed == true) {
+    hits = bank->pager->hits - hits;
+    misses = bank->pager->misses - misses;
+    printf(
+        "\e[38;5;214mInfo:\e[0m %u operation(s) over %u account(s) in "
+        "%.3f s (\e[38;5;214m%.0f\e[0m operations/second), hit rate of the "
+        "mix \e[38;5;214m%.2f%%\e[0m\n",
+        operations, accounts, elapsed,
+        (elapsed > 0) ? operations / elapsed : 0.0,
+        (hits + misses > 0) ? 100.0 * hits / (hits + misses) : 0.0);
+    display_pager(bank->pager);
+  } else
+    printf("\e[38;5;196mError:\e[0m An account couldn't be paged.\n");
+  if (fd != -1) unlink(path);
+  free(ids);
+  free(cdf);
+  delete_bank(bank);
+  return passed;
+}
+
+/**
+ * @brief This function will feed the given 'lines' (up to a NULL one) to the
+ * session, one at a time, printing nothing (a session prints to the console
+ * of the thread only while fed).
+ */
+static void feed_lines(SESSION session, const char* const lines[]) {
+  for (unsigned int i = 0; lines[i] != NULL; i++) {
+    session_feed(session, lines[i]);
+    set_console(null_console());
+  }
+}
+
+/**
+ * @brief This function will check that a session logged into an account which
+ * is closed meanwhile, its slot reused by a new account of the same user
+ * name, can't touch the new account: neither by its commands, nor by a
+ * deposit, withdrawal or transaction of its generation. Returns 'true' if so,
+ * otherwise returns 'false'.
+ */
+static bool check_reuse() {
+  BANK bank = create_bank("Check");
+  SESSION stale =
+      (bank != NULL) ? create_session(bank, null_console(), false) : NULL;
+  SESSION owner =
+      (bank != NULL) ? create_session(bank, null_console(), false) : NULL;
+  bool passed = stale != NULL && owner != NULL;
+
+  // Login: Both sessions into the same account, a transaction touching it
+  const char* const create[] = {"login", "alice", "1111", "1111", NULL};
+  const char* const login[] = {"login", "alice", "1111", NULL};
+  TXN txn = NULL;
+  int id = -1;
+  unsigned int generation = BANK_ANY_GENERATION;
+  if (passed == true) {
+    feed_lines(stale, create);
+    feed_lines(owner, login);
+    id = stale->user_login_id;
+    generation = stale->user_generation;
+    txn = begin_transaction();
+    passed = id != -1 && owner->user_login_id == id &&
+             txn_deposit(txn, bank, id, generation, 5) == true;
+  }
+
+  // Reuse: The other session closes the account, a new one takes its slot
+  const char* const close[] = {"withdraw 3210", "close", NULL};
+  const char* const reopen[] = {"login", "alice", "2222", "2222", NULL};
+  if (passed == true) {
+    feed_lines(owner, close);
+    feed_lines(owner, reopen);
+    passed = owner->user_login_id == id &&
+             owner->user_generation != generation;
+  }
+
+  // Check: Nothing of the stale session lands on the new account
+  const char* const withdraw[] = {"withdraw 100", NULL};
+  account_element account;
+  if (passed == true) {
+    passed = account_deposit(bank, id, generation, 1) == false &&
+             account_withdraw(bank, id, generation, 1) == DEBIT_NO_ACCOUNT &&
+             close_account(bank, id, generation) == false &&
+             commit_transaction(txn, bank) == false;
+    feed_lines(stale, withdraw);
+    passed = passed && stale->user_login_id == -1 &&
+             get_account(bank, id, &account) == true && account.amount == 3210;
+  } else
+    abort_transaction(txn);
+  delete_session(stale);
+  delete_session(owner);
+  delete_bank(bank);
+  return passed;
+}
+
+/**
+ * @brief This function will check that a hot account can't be closed, thus
+ * its slot (and striped balance) is never taken by a new account. Returns
+ * 'true' if so, otherwise returns 'false'.
+ */
+static bool check_hot_close() {
+  BANK bank = create_bench_bank(2);
+  if (bank == NULL) return false;
+  account_element account;
+  bool passed = mark_hot_account(bank, 1) == true &&
+                get_account(bank, 1, &account) == true &&
+                account_withdraw(bank, 1, BANK_ANY_GENERATION,
+                                 account.amount) == DEBIT_DONE &&
+                close_account(bank, 1, BANK_ANY_GENERATION) == false &&
+                account_deposit(bank, 1, BANK_ANY_GENERATION, 7) == true &&
+                refresh_accounts(bank) == 2 &&
+                get_account(bank, 1, &account) == true &&
+                account.amount == 7 && account.id == 1;
+  delete_bank(bank);
+  return passed;
 }
 
 /**
- * @brief This function will take the bank's reference structure as an input,
- * prompt the user to type commands, pass then covert it into the tokens with
- * some lower level recognition and handover the Token's list reference (since
- * it is just reference, thus needed to be freed after usage). For this purpose
- * it uses mutiple/nested calling to other library functions.
- * @param my_bank The bank's reference structure
- * @return TOKEN_LIST (reference) or NULL
+ * @brief This function will check that the withdrawals of an account are
+ * limited whatever their path: a transaction withdrawing beyond the tokens
+ * of the account commits nothing (and takes no token), then the plain
+ * withdrawals, a batch and a binary client are refused once the tokens are
+ * taken. A bucket without the tokens it gains a minute is refused too.
+ * Returns 'true' if so, otherwise returns 'false'.
  */
-TOKEN_LIST get_clean_input(BANK my_bank) {
-  if (my_bank->user_login_id == -1)
-    return get_tokens(
-        get_string("\e[38;5;32mGuest@%s $: \e[0m", my_bank->name));
+static bool check_limits() {
+  BANK bank = create_bench_bank(2);
+  char* frames = NULL;
+  size_t size = 0;
+  FILE* out = open_memstream(&frames, &size);
+  SESSION session =
+      (bank != NULL && out != NULL) ? create_session(bank, out, false) : NULL;
+  bool passed = session != NULL && set_limits(bank, 2, 0, 0) == false &&
+                set_limits(bank, 2, 1, 0) == true;
+
+  // Drain: Through a transaction of three withdrawals, then two plain ones
+  TXN txn = begin_transaction();
+  for (unsigned int i = 0; i < 3 && passed == true; i++)
+    passed =
+        txn_withdraw(txn, bank, 1, BANK_ANY_GENERATION, 1, false) == true;
+  if (passed == true)
+    passed = commit_transaction(txn, bank) == false &&
+             bank->account.amount[1] == 7919 &&
+             account_withdraw(bank, 1, BANK_ANY_GENERATION, 1) == DEBIT_DONE &&
+             account_withdraw(bank, 1, BANK_ANY_GENERATION, 1) == DEBIT_DONE &&
+             account_withdraw(bank, 1, BANK_ANY_GENERATION, 1) ==
+                 DEBIT_LIMITED;
   else
-    return get_tokens(get_string("\e[38;5;32m%s@%s $: \e[0m",
-                                 my_bank->account[my_bank->user_login_id].name,
-                                 my_bank->name));
+    abort_transaction(txn);
+
+  // Check: A batch and a binary client are refused too
+  batch_op ops[2] = {{1, BATCH_WITHDRAW, 1}, {1, BATCH_DEPOSIT, 1}};
+  int results[2];
+  if (passed == true)
+    passed = bank_apply_batch(bank, ops, 2, results) == 1 &&
+             results[0] == BATCH_LIMITED && results[1] == BATCH_DONE;
+  wire_request request;
+  wire_response response;
+  memset(&request, 0, sizeof(request));
+  request.magic = WIRE_MAGIC;
+  request.length = sizeof(request);
+  request.command = WIRE_LOGIN;
+  request.amount = 1234;
+  request.text_length = snprintf(request.text, sizeof(request.text), "user1");
+  if (passed == true) {
+    session_request(session, &request);
+    request.command = WIRE_WITHDRAW;
+    request.amount = 1;
+    session_request(session, &request);
+    set_console(null_console());
+    fflush(out);
+    passed = size >= sizeof(response);
+  }
+  if (passed == true) {
+    memcpy(&response, frames + size - sizeof(response), sizeof(response));
+    passed = response.result == WIRE_LIMITED && response.balance == 7918;
+  }
+  delete_session(session);
+  if (out != NULL) fclose(out);
+  free(frames);
+  delete_bank(bank);
+  return passed;
+}
+
+/**
+ * @brief This function will check that the analytics count the withdrawals
+ * whatever their path: a plain one, a transaction, a batch and a binary
+ * client, the ones in cash counted as cash too, but not the withdrawals of a
+ * transaction rolled back. Returns 'true' if so, otherwise returns 'false'.
+ */
+static bool check_analytics() {
+  BANK bank = create_bench_bank(2);
+  char* frames = NULL;
+  size_t size = 0;
+  FILE* out = open_memstream(&frames, &size);
+  SESSION session =
+      (bank != NULL && out != NULL) ? create_session(bank, out, false) : NULL;
+  bool passed = session != NULL && bank->sketch != NULL &&
+                account_withdraw(bank, 1, BANK_ANY_GENERATION, 1) ==
+                    DEBIT_DONE;
+
+  // Withdraw: Through a transaction, a batch and a binary client
+  TXN txn = begin_transaction();
+  if (passed == true)
+    passed =
+        txn_withdraw(txn, bank, 1, BANK_ANY_GENERATION, 2, false) == true &&
+        txn_withdraw(txn, bank, 1, BANK_ANY_GENERATION, 3, true) == true;
+  if (passed == true)
+    passed = commit_transaction(txn, bank) == true;
+  else
+    abort_transaction(txn);
+  batch_op ops[2] = {{1, BATCH_WITHDRAW, 4}, {1, BATCH_WITHDRAW_CASH, 5}};
+  int results[2];
+  if (passed == true) passed = bank_apply_batch(bank, ops, 2, results) == 2;
+  wire_request request;
+  memset(&request, 0, sizeof(request));
+  request.magic = WIRE_MAGIC;
+  request.length = sizeof(request);
+  request.command = WIRE_LOGIN;
+  request.amount = 1234;
+  request.text_length = snprintf(request.text, sizeof(request.text), "user1");
+  if (passed == true) {
+    session_request(session, &request);
+    request.command = WIRE_WITHDRAW_CASH;
+    request.amount = 6;
+    session_request(session, &request);
+    set_console(null_console());
+  }
+
+  // Roll back: A transaction whose second withdrawal can't be taken anymore
+  txn = begin_transaction();
+  if (passed == true)
+    passed =
+        txn_withdraw(txn, bank, 1, BANK_ANY_GENERATION, 1, false) == true &&
+        txn_withdraw(txn, bank, 1, BANK_ANY_GENERATION, 2, true) == true &&
+        account_withdraw(bank, 1, BANK_ANY_GENERATION, 7919 - 21 - 2) ==
+            DEBIT_DONE &&
+        commit_transaction(txn, bank) == false;
+  else
+    abort_transaction(txn);
+
+  // Count: Every withdrawal but the rolled back ones, three in cash
+  long long unsigned int withdrawals = 0, cash = 0;
+  for (unsigned int i = 0; passed == true && i < SKETCH_SHARDS; i++) {
+    withdrawals += bank->sketch->shard[i].withdrawals.count;
+    for (unsigned int c = 0; c < SKETCH_COUNTERS; c++)
+      cash += bank->sketch->shard[i].cash[c].count;
+  }
+  passed = passed == true && withdrawals == 7 && cash == 3 &&
+           bank->account.amount[1] == 2;
+  delete_session(session);
+  if (out != NULL) fclose(out);
+  free(frames);
+  delete_bank(bank);
+  return passed;
+}
+
+/**
+ * @brief This function will check the determinism of the script executor on
+ * a generated script (deposits and withdrawals of random accounts, some of
+ * them unknown, many rejected for lack of funds): the pool and a line by line
+ * run agree on copies of the balances (see check_script), and running it on
+ * the bank leaves the balances of a line by line run. Returns 'true' if so,
+ * otherwise returns 'false'.
+ */
+static bool check_script_runs() {
+  const unsigned int accounts = 2000, operations = 50000;
+  BANK bank = create_bench_bank(accounts);
+  long long int* expected =
+      (long long int*)malloc(sizeof(long long int) * accounts);
+  char path[] = "/tmp/transaction-console-XXXXXX";
+  int fd = (bank != NULL && expected != NULL) ? mkstemp(path) : -1;
+  FILE* script = (fd != -1) ? fdopen(fd, "w") : NULL;
+  bool passed = script != NULL;
+  if (passed == true)
+    memcpy(expected, bank->account.amount, sizeof(long long int) * accounts);
+
+  // Generate: The script, its line by line outcome along
+  unsigned int seed = 1;
+  for (unsigned int i = 0; passed == true && i < operations; i++) {
+    unsigned int id = rand_r(&seed) % (accounts + accounts / 4);
+    long long int amount = rand_r(&seed) % 5000 + 1;
+    bool deposit = rand_r(&seed) % 5 < 2;
+    fprintf(script, "%s %u %lld\n", (deposit) ? "deposit" : "withdraw", id,
+            amount);
+    if (id >= accounts) continue;
+    if (deposit)
+      expected[id] += amount;
+    else if (expected[id] >= amount)
+      expected[id] -= amount;
+  }
+  if (script != NULL && fclose(script) != 0) passed = false;
+  if (script == NULL && fd != -1) close(fd);
+
+  // Check: The pool against line by line, then the run on the bank
+  passed = passed == true && check_script(bank, path) == true &&
+           run_script(bank, path) == true &&
+           memcmp(expected, bank->account.amount,
+                  sizeof(long long int) * accounts) == 0;
+  if (fd != -1) unlink(path);
+  free(expected);
+  delete_bank(bank);
+  return passed;
+}
+
+/**
+ * @brief This function will check that a connection (a session which is not
+ * the operator's) is refused every operator command, the bulk frames of a
+ * binary client too, and none of them takes effect. Returns 'true' if so,
+ * otherwise returns 'false'.
+ */
+static bool check_guest() {
+  BANK bank = create_bench_bank(2);
+  char* output = NULL;
+  size_t size = 0;
+  FILE* out = open_memstream(&output, &size);
+  SESSION guest =
+      (bank != NULL && out != NULL) ? create_session(bank, out, false) : NULL;
+  bool passed = guest != NULL;
+
+  // Feed: Every operator command, each refused once
+  const char* const commands[] = {
+      "import", "export csv", "interest 100 50", "script run", "compact",
+      "hot 1", "checkpoint", "schedule", NULL};
+  unsigned int refused = 0;
+  if (passed == true) {
+    feed_lines(guest, commands);
+    fflush(out);
+    for (const char* at = output;
+         (at = strstr(at, "operator's console only")) != NULL; at++)
+      refused++;
+  }
+  passed = passed == true &&
+           refused == sizeof(commands) / sizeof(commands[0]) - 1 &&
+           bank->hot_quantity == 0 && bank->account.amount[1] == 7919;
+
+  // Send: The bulk commands of the binary protocol, each refused too
+  const int frames[] = {WIRE_IMPORT, WIRE_EXPORT, WIRE_INTEREST};
+  wire_request request;
+  wire_response response;
+  memset(&request, 0, sizeof(request));
+  request.magic = WIRE_MAGIC;
+  request.length = sizeof(request);
+  request.amount = 100;
+  request.text_length = snprintf(request.text, sizeof(request.text), "x");
+  for (unsigned int i = 0; i < 3 && passed == true; i++) {
+    request.command = frames[i];
+    session_request(guest, &request);
+    set_console(null_console());
+    fflush(out);
+    passed = size >= sizeof(response);
+    if (passed == true) {
+      memcpy(&response, output + size - sizeof(response), sizeof(response));
+      passed = response.result == WIRE_NOT_ALLOWED &&
+               bank->account.amount[1] == 7919;
+    }
+  }
+  delete_session(guest);
+  if (out != NULL) fclose(out);
+  free(output);
+  delete_bank(bank);
+  return passed;
+}
+
+/**
+ * @brief This function will check the session tokens: a PIN stored as is (of
+ * an older journal or checkpoint) gets hashed as it is loaded, a login is
+ * issued a token which resumes the login of the same account only (e.g. from
+ * a new connection), and a logout revokes it. Returns 'true' if so,
+ * otherwise returns 'false'.
+ */
+static bool check_tokens() {
+  BANK bank = create_bank("Check");
+  char* output = NULL;
+  size_t size = 0;
+  FILE* out = open_memstream(&output, &size);
+  SESSION first =
+      (bank != NULL && out != NULL) ? create_session(bank, out, false) : NULL;
+  SESSION second = (first != NULL) ? create_session(bank, out, false) : NULL;
+  long long unsigned int stored = 0;
+  bool passed = second != NULL && seal_pin(1234, &stored) == true &&
+                add_account(bank, 4321, "plain", 5, 10) == 0 &&
+                add_account(bank, stored, "other", 5, 10) == 1 &&
+                (bank->account.pin[0] & VAULT_HASHED) != 0 &&
+                check_pin(bank, 0, 4321) == true &&
+                check_pin(bank, 0, bank->account.pin[0]) == false;
+
+  // Login: With the PIN, the session gets a token of that account only
+  const char* const login[] = {"login", "plain", "4321", NULL};
+  long long unsigned int token = 0;
+  if (passed == true) {
+    feed_lines(first, login);
+    token = first->login_token;
+    passed = first->user_login_id == 0 && token != 0 &&
+             check_token(bank, 1, token) == false &&
+             check_token(bank, 0, token ^ 1) == false;
+  }
+
+  // Resume: Another session by the token, until the logout revokes it
+  char line[32];
+  snprintf(line, sizeof(line), "%llx", token);
+  const char* const resume[] = {"resume", "plain", line, NULL};
+  const char* const logout[] = {"logout", NULL};
+  if (passed == true) {
+    feed_lines(second, resume);
+    passed = second->user_login_id == 0 && second->login_token == token;
+  }
+  if (passed == true) {
+    feed_lines(second, logout);
+    feed_lines(first, resume);
+    passed = first->user_login_id == -1 &&
+             check_token(bank, 0, token) == false;
+  }
+  delete_session(first);
+  delete_session(second);
+  if (out != NULL) fclose(out);
+  free(output);
+  delete_bank(bank);
+  return passed;
+}
+
+/**
+ * @brief This function will check that a checkpoint trims the journal up to
+ * its position (most of the blocks of the journal are released), that the
+ * bank is still recovered from the checkpoint and the journal after it, and
+ * that the journal is refused (and left as is) without the checkpoint.
+ * Returns 'true' if so, otherwise returns 'false'.
+ */
+static bool check_trim() {
+  char directory[] = "/tmp/transaction-console-XXXXXX";
+  char image[64], journal[64];
+  bool made = mkdtemp(directory) != NULL;
+  snprintf(image, sizeof(image), "%s/image", directory);
+  snprintf(journal, sizeof(journal), "%s/journal", directory);
+  BANK bank = (made == true) ? create_bench_bank(64) : NULL;
+  bool passed = bank != NULL &&
+                (bank->journal = create_journal(journal)) != NULL &&
+                start_checkpoints(bank, image, 0) == true;
+
+  // Deposit: Enough to fill many blocks, then take a checkpoint
+  for (unsigned int i = 0; passed == true && i < 100000; i++)
+    passed = account_deposit(bank, i % 64, BANK_ANY_GENERATION, 1);
+  unsigned int finished = finished_checkpoints();
+  if (passed == true) passed = request_checkpoint();
+  for (unsigned int i = 0; passed == true && i < 1000 &&
+                           finished_checkpoints() == finished;
+       i++)
+    nanosleep(&(struct timespec){0, 10000000}, NULL);
+  stop_checkpoints();
+  struct stat trimmed;
+  passed = passed == true && finished_checkpoints() > finished &&
+           account_deposit(bank, 3, BANK_ANY_GENERATION, 5) == true &&
+           sync_journal(bank->journal) == true &&
+           stat(journal, &trimmed) == 0 &&
+           trimmed.st_blocks * 512 < trimmed.st_size / 2;
+
+  // Recover: From the checkpoint, otherwise refused and left as is
+  BANK copy = (passed == true) ? create_bank("Copy") : NULL;
+  BANK stale = (passed == true) ? create_bank("Stale") : NULL;
+  long long unsigned int position = 0;
+  struct stat left;
+  passed = copy != NULL && stale != NULL &&
+           load_checkpoint(copy, image, &position) == true &&
+           recover_accounts(copy, journal, position) == true &&
+           copy->accounts_quantity == 64 &&
+           memcmp(copy->account.amount, bank->account.amount,
+                  64 * sizeof(long long int)) == 0 &&
+           recover_accounts(stale, journal, 0) == false &&
+           stat(journal, &left) == 0 && left.st_size == trimmed.st_size;
+  delete_bank(stale);
+  delete_bank(copy);
+  delete_bank(bank);
+  unlink(image);
+  unlink(journal);
+  if (made == true) rmdir(directory);
+  return passed;
+}
+
+/**
+ * @brief This function will run the regression checks of the bank and print
+ * the outcome of each. Returns 'true' if every check passed, otherwise
+ * returns 'false'.
+ * @return 'true' or 'false'
+ */
+bool run_checks() {
+  // Configure: The checks, their own messages are not printed
+  struct {
+    const char* name;
+    bool (*check)();
+  } checks[] = {
+      {"A closed account reused meanwhile is out of a stale session's reach",
+       check_reuse},
+      {"A hot account can't be closed", check_hot_close},
+      {"The limits hold for every path of a withdrawal", check_limits},
+      {"The analytics count every path of a withdrawal", check_analytics},
+      {"A script runs on the pool just like line by line", check_script_runs},
+      {"A connection is refused the operator commands", check_guest},
+      {"A session token resumes the login of its account only",
+       check_tokens},
+      {"A checkpoint trims the journal, recovered from it only", check_trim},
+  };
+  set_console(null_console());
+
+  // Check: One after another
+  unsigned int failed = 0;
+  for (unsigned int i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+    if (checks[i].check() == true)
+      printf("\e[38;5;40mSuccess:\e[0m %s.\n", checks[i].name);
+    else {
+      printf("\e[38;5;196mFailure:\e[0m %s.\n", checks[i].name);
+      failed++;
+    }
+  }
+  return failed == 0;
 }
 
 /**
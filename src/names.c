@@ -0,0 +1,241 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file names.c
+ * @brief Implementation of name pool (string arena and interning) related
+ * functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "names.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief This function will hash the given bytes (FNV-1a).
+ */
+static unsigned int hash_bytes(const char* bytes, size_t length) {
+  unsigned int hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (unsigned char)bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * @brief This function will find the slot of the hash table holding the given
+ * name, otherwise the empty slot where it belongs.
+ */
+static unsigned int find_slot(NAMES pool, const char* name, size_t length,
+                              unsigned int hash) {
+  unsigned int mask = pool->table_size - 1;
+  unsigned int slot = hash & mask;
+  while (pool->table[slot] != 0) {
+    const char* text = pool->bytes + pool->table[slot] - 1;
+    if (memcmp(text, name, length) == 0 && text[length] == '\0') return slot;
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+/**
+ * @brief This function will double the hash table of the pool (or make the
+ * first one). Returns 'true' if done, otherwise returns 'false'.
+ */
+static bool grow_table(NAMES pool) {
+  unsigned int size = (pool->table_size == 0) ? 1024 : pool->table_size * 2;
+  unsigned int* table = (unsigned int*)calloc(size, sizeof(unsigned int));
+  if (table == NULL) return false;
+
+  // Move: Every entry, rehashing from the pool bytes
+  unsigned int* old = pool->table;
+  unsigned int old_size = pool->table_size;
+  pool->table = table;
+  pool->table_size = size;
+  for (unsigned int i = 0; i < old_size; i++) {
+    if (old[i] == 0) continue;
+    const char* text = pool->bytes + old[i] - 1;
+    size_t length = strlen(text);
+    unsigned int slot = hash_bytes(text, length) & (size - 1);
+    while (table[slot] != 0) slot = (slot + 1) & (size - 1);
+    table[slot] = old[i];
+  }
+  free(old);
+  return true;
+}
+
+/**
+ * @brief This function will create an empty name pool and return it as a
+ * reference (not copy, thus need to be freed after usage). If some error
+ * happens during creation, it will return NULL reference.
+ * @return NAMES (reference, not copy) or 'NULL'
+ */
+NAMES create_names() {
+  // Create: Make space for the pool, bytes and table grow on demand
+  NAMES pool = (NAMES)calloc(1, sizeof(name_pool_element));
+  if (pool == NULL) return NULL;
+  pool->bytes = NULL;
+  pool->used = 0;
+  pool->capacity = 0;
+  pool->table = NULL;
+  pool->table_size = 0;
+  pool->entries = 0;
+  pool->retire = NULL;
+  pool->retire_context = NULL;
+
+  // Status: Return the pool's structure reference
+  return pool;
+}
+
+/**
+ * @brief This function will take the name pool as an input and frees it along
+ * with every name. Returns 'true' if successfully deleted, otherwise returns
+ * 'false'.
+ * @param pool The name pool's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_names(NAMES pool) {
+  // Check: Whether the pool exist!
+  if (pool == NULL) return false;
+
+  // Clean: Bytes, table and the pool
+  free(pool->bytes);
+  free(pool->table);
+  free(pool);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will intern the first 'length' bytes of 'name' and fill
+ * 'ref' with its reference. Short names are kept inline in the reference,
+ * others are copied into the pool only if not interned yet. Returns 'true' if
+ * interned, otherwise returns 'false' if out of memory or the pool is full.
+ * @param pool The name pool's data structure reference
+ * @param name The name (need not to be terminated)
+ * @param length The number of bytes of the name
+ * @param ref The reference to be filled
+ * @return 'true' or 'false'
+ */
+bool intern_name(NAMES pool, const char* name, size_t length, name_ref* ref) {
+  // Check: Whether the pool, name and reference exist!
+  if (pool == NULL || name == NULL || ref == NULL) return false;
+
+  // Inline: Short names live in the reference itself
+  if (length < NAME_INLINE) {
+    ref->length = length;
+    memset(ref->small, 0, NAME_INLINE);
+    memcpy(ref->small, name, length);
+    return true;
+  }
+
+  // Check: Offsets must fit in 32 bits
+  if (length >= (unsigned int)-1 - pool->used) return false;
+
+  // Grow: Keep the table at most 70% full
+  if ((pool->entries + 1) * 10 >= pool->table_size * 7)
+    if (grow_table(pool) == false) return false;
+
+  // Find: The name among the interned ones
+  unsigned int slot = find_slot(pool, name, length, hash_bytes(name, length));
+  if (pool->table[slot] == 0) {
+    // Create: Make space for the bytes (and terminator) in the arena
+    if (pool->used + length + 1 > pool->capacity) {
+      size_t capacity = (pool->capacity == 0) ? (1 << 16) : pool->capacity;
+      while (capacity < pool->used + length + 1) capacity *= 2;
+      if (capacity > (unsigned int)-1) capacity = (unsigned int)-1;
+      if (pool->retire == NULL) {
+        char* bytes = (char*)realloc(pool->bytes, capacity);
+        if (bytes == NULL) return false;
+        pool->bytes = bytes;
+      } else {
+        // Move: Readers may still be inside the old arena
+        char* bytes = (char*)malloc(capacity);
+        if (bytes == NULL) return false;
+        char* old = pool->bytes;
+        if (old != NULL) memcpy(bytes, old, pool->used);
+        __atomic_store_n(&pool->bytes, bytes, __ATOMIC_RELEASE);
+        pool->retire(pool->retire_context, old);
+      }
+      pool->capacity = capacity;
+    }
+
+    // Copy: Into the arena and link into the table (offset plus one)
+    memcpy(pool->bytes + pool->used, name, length);
+    pool->bytes[pool->used + length] = '\0';
+    pool->table[slot] = pool->used + 1;
+    pool->used += length + 1;
+    pool->entries++;
+  }
+
+  // Configure: The reference to the interned name
+  ref->length = length;
+  ref->offset = pool->table[slot] - 1;
+  return true;
+}
+
+/**
+ * @brief This function will return the terminated text of the referenced name.
+ * The text is valid until the pool (or, for short names, the reference) moves.
+ * @param pool The name pool's data structure reference
+ * @param ref The reference of the name
+ * @return text of the name
+ */
+const char* name_text(NAMES pool, const name_ref* ref) {
+  if (ref->length < NAME_INLINE) return ref->small;
+  return pool->bytes + ref->offset;
+}
+
+/**
+ * @brief This function will compare two references of the same pool. Being
+ * interned, equal long names share the offset, thus no byte is compared.
+ * Returns 'true' if the names are equal, otherwise returns 'false'.
+ * @param a The reference of the first name
+ * @param b The reference of the second name
+ * @return 'true' or 'false'
+ */
+bool same_name(const name_ref* a, const name_ref* b) {
+  if (a->length != b->length) return false;
+  if (a->length < NAME_INLINE)
+    return memcmp(a->small, b->small, NAME_INLINE) == 0;
+  return a->offset == b->offset;
+}
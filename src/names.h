@@ -0,0 +1,141 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file names.h
+ * @brief Interface of name pool (string arena and interning) related
+ * functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef NAMES_H
+#define NAMES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Names shorter than this are stored inline in the reference itself
+ */
+#define NAME_INLINE 8
+
+/**
+ * @brief Structure of the reference to a name, either a 32-bit offset into
+ * the pool or (for short names) the terminated name itself
+ */
+typedef struct {
+  unsigned int length;
+  union {
+    unsigned int offset;
+    char small[NAME_INLINE];
+  };
+} name_ref;
+
+/**
+ * @brief Structure of the name pool, every name longer than the inline limit
+ * is kept once (interned) in a single contiguous byte arena and found back
+ * through an open addressing hash table of offsets. When the arena moves, the
+ * old one is handed over to 'retire' (if any, otherwise freed) so that
+ * concurrent readers may finish with it.
+ */
+typedef struct {
+  char* bytes;
+  unsigned int used;
+  unsigned int capacity;
+  unsigned int* table;
+  unsigned int table_size;
+  unsigned int entries;
+  void (*retire)(void* context, void* memory);
+  void* retire_context;
+} name_pool_element;
+
+/**
+ * @brief Name pool's Data structure Reference
+ */
+#define NAMES name_pool_element*
+
+/**
+ * @brief This function will create an empty name pool and return it as a
+ * reference (not copy, thus need to be freed after usage). If some error
+ * happens during creation, it will return NULL reference.
+ * @return NAMES (reference, not copy) or 'NULL'
+ */
+NAMES create_names();
+
+/**
+ * @brief This function will take the name pool as an input and frees it along
+ * with every name. Returns 'true' if successfully deleted, otherwise returns
+ * 'false'.
+ * @param pool The name pool's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_names(NAMES pool);
+
+/**
+ * @brief This function will intern the first 'length' bytes of 'name' and fill
+ * 'ref' with its reference. Short names are kept inline in the reference,
+ * others are copied into the pool only if not interned yet. Returns 'true' if
+ * interned, otherwise returns 'false' if out of memory or the pool is full.
+ * @param pool The name pool's data structure reference
+ * @param name The name (need not to be terminated)
+ * @param length The number of bytes of the name
+ * @param ref The reference to be filled
+ * @return 'true' or 'false'
+ */
+bool intern_name(NAMES pool, const char* name, size_t length, name_ref* ref);
+
+/**
+ * @brief This function will return the terminated text of the referenced name.
+ * The text is valid until the pool (or, for short names, the reference) moves.
+ * @param pool The name pool's data structure reference
+ * @param ref The reference of the name
+ * @return text of the name
+ */
+const char* name_text(NAMES pool, const name_ref* ref);
+
+/**
+ * @brief This function will compare two references of the same pool. Being
+ * interned, equal long names share the offset, thus no byte is compared.
+ * Returns 'true' if the names are equal, otherwise returns 'false'.
+ * @param a The reference of the first name
+ * @param b The reference of the second name
+ * @return 'true' or 'false'
+ */
+bool same_name(const name_ref* a, const name_ref* b);
+
+#endif
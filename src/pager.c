@@ -0,0 +1,385 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file pager.c
+ * @brief Implementation of the buffer pool of the pages of an on-disk store
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#include "pager.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "console.h"
+
+/**
+ * @brief Page held by a free frame
+ */
+#define PAGER_NONE ((long long unsigned int)-1)
+
+/**
+ * @brief End of a chain of the hash table
+ */
+#define PAGER_END ((unsigned int)-1)
+
+/**
+ * @brief This function will return the seconds of the monotonic clock.
+ */
+static double now_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief This function will return the bucket of the hash table of the given
+ * 'page'.
+ */
+static unsigned int bucket_of(PAGER pager, long long unsigned int page) {
+  return (page * 0x9E3779B97F4A7C15ull >> 32) & (pager->buckets - 1);
+}
+
+/**
+ * @brief This function will create (or truncate) the file of the given 'path'
+ * and a buffer pool of 'frames' pages over it, and return it as a reference
+ * (not copy, thus need to be freed after usage). Pages never written read as
+ * zeros. If some error happens during creation, it will return NULL
+ * reference.
+ * @param path The path of the file of the pages
+ * @param frames The number of frames of the buffer pool
+ * @return PAGER (reference, not copy) or 'NULL'
+ */
+PAGER create_pager(string path, unsigned int frames) {
+  // Check: Wether the path exist!
+  if (path == NULL) return NULL;
+  if (frames < PAGER_MIN_FRAMES) frames = PAGER_MIN_FRAMES;
+
+  // Create: Make space for the buffer pool, the frames are page aligned
+  PAGER pager = (PAGER)calloc(1, sizeof(pager_element));
+  if (pager == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    return NULL;
+  }
+  pager->count = frames;
+  pager->buckets = 1;
+  while (pager->buckets < frames) pager->buckets *= 2;
+  if (posix_memalign((void**)&pager->frames, PAGER_PAGE,
+                     (size_t)PAGER_PAGE * frames) != 0)
+    pager->frames = NULL;
+  pager->page = (long long unsigned int*)malloc(
+      sizeof(long long unsigned int) * frames);
+  pager->pins = (unsigned int*)calloc(frames, sizeof(unsigned int));
+  pager->referenced = (unsigned char*)calloc(frames, 1);
+  pager->dirty = (unsigned char*)calloc(frames, 1);
+  pager->next = (unsigned int*)malloc(sizeof(unsigned int) * frames);
+  pager->bucket = (unsigned int*)malloc(sizeof(unsigned int) * pager->buckets);
+  if (pager->frames == NULL || pager->page == NULL || pager->pins == NULL ||
+      pager->referenced == NULL || pager->dirty == NULL ||
+      pager->next == NULL || pager->bucket == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    pager->fd = -1;
+    delete_pager(pager);
+    return NULL;
+  }
+
+  // Open: The file starts empty, every page reads as zeros till written
+  pager->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (pager->fd == -1) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't create \e[38;5;214m%s\e[0m.\n", path);
+    delete_pager(pager);
+    return NULL;
+  }
+
+  // Configure: Every frame is free
+  for (unsigned int i = 0; i < frames; i++) pager->page[i] = PAGER_NONE;
+  for (unsigned int i = 0; i < pager->buckets; i++)
+    pager->bucket[i] = PAGER_END;
+  pthread_mutex_init(&pager->lock, NULL);
+
+  // Status: Return the buffer pool's structure reference
+  return pager;
+}
+
+/**
+ * @brief This function will write every dirty page back to the file, close it
+ * and free the buffer pool. Returns 'true' if successfully deleted,
+ * otherwise returns 'false'.
+ * @param pager The buffer pool's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_pager(PAGER pager) {
+  // Check: Wether the buffer pool exist!
+  if (pager == NULL) return false;
+
+  // Clean: Write back, then free every part of the buffer pool
+  bool status = true;
+  if (pager->fd != -1) {
+    status = flush_pager(pager);
+    close(pager->fd);
+    pthread_mutex_destroy(&pager->lock);
+  }
+  free(pager->frames);
+  free(pager->page);
+  free(pager->pins);
+  free(pager->referenced);
+  free(pager->dirty);
+  free(pager->next);
+  free(pager->bucket);
+  free(pager);
+  return status;
+}
+
+/**
+ * @brief This function will write the page of the given 'frame' back to the
+ * file. The lock must be held. Returns 'true' if written, otherwise returns
+ * 'false'.
+ */
+static bool write_back(PAGER pager, unsigned int frame) {
+  ssize_t written =
+      pwrite(pager->fd, pager->frames + (size_t)PAGER_PAGE * frame,
+             PAGER_PAGE, (off_t)(pager->page[frame] * PAGER_PAGE));
+  if (written != PAGER_PAGE) return false;
+  pager->dirty[frame] = 0;
+  pager->writes++;
+  return true;
+}
+
+/**
+ * @brief This function will take a frame for a new page, a free one if any,
+ * otherwise the first one under the clock hand which is neither pinned nor
+ * referenced (clearing the reference bits on the way), written back if
+ * dirty and unlinked from its chain (a frame whose read failed is free
+ * again). The lock must be held. Returns the frame, otherwise returns
+ * PAGER_END if every frame is pinned or the write back failed.
+ */
+static unsigned int take_frame(PAGER pager) {
+  // Check: Wether a frame was never used
+  if (pager->used < pager->count) return pager->used++;
+
+  // Find: Two sweeps at most, the first one may only clear the references
+  unsigned int frame = PAGER_END;
+  for (unsigned int step = 0; step < 2 * pager->count; step++) {
+    unsigned int candidate = pager->hand;
+    pager->hand = (pager->hand + 1) % pager->count;
+    if (pager->pins[candidate] > 0) continue;
+    if (pager->referenced[candidate]) {
+      pager->referenced[candidate] = 0;
+      continue;
+    }
+    frame = candidate;
+    break;
+  }
+  if (frame == PAGER_END || pager->page[frame] == PAGER_NONE) return frame;
+  if (pager->dirty[frame] && write_back(pager, frame) == false)
+    return PAGER_END;
+
+  // Unlink: The evicted page from its chain
+  unsigned int* link = &pager->bucket[bucket_of(pager, pager->page[frame])];
+  while (*link != frame) link = &pager->next[*link];
+  *link = pager->next[frame];
+  pager->page[frame] = PAGER_NONE;
+  pager->evictions++;
+  return frame;
+}
+
+/**
+ * @brief This function will count the latency of a pin into the histogram.
+ * The lock must be held.
+ */
+static void count_latency(PAGER pager, double seconds) {
+  long long unsigned int nanoseconds = seconds * 1e9;
+  unsigned int bucket = 0;
+  while (nanoseconds > 1 && bucket < PAGER_BUCKETS - 1) {
+    nanoseconds >>= 1;
+    bucket++;
+  }
+  pager->latency[bucket]++;
+}
+
+/**
+ * @brief This function will pin the given 'page' into a frame of the buffer
+ * pool, reading it from the file on a miss after evicting (and writing back,
+ * if dirty) the first unpinned and unreferenced frame under the clock hand.
+ * The frame stays put till unpinned. Returns the bytes of the page (of
+ * PAGER_PAGE), otherwise returns 'NULL' if every frame is pinned or the file
+ * failed.
+ * @param pager The buffer pool's data structure reference
+ * @param page The number of the page
+ * @return bytes of the page or 'NULL'
+ */
+char* pin_page(PAGER pager, long long unsigned int page) {
+  // Check: Wether the buffer pool exist!
+  if (pager == NULL || page == PAGER_NONE) return NULL;
+  double start = now_seconds();
+
+  // Find: The page in the pool
+  pthread_mutex_lock(&pager->lock);
+  unsigned int bucket = bucket_of(pager, page);
+  unsigned int frame = pager->bucket[bucket];
+  while (frame != PAGER_END && pager->page[frame] != page)
+    frame = pager->next[frame];
+  bool hit = frame != PAGER_END;
+
+  // Load: The page into a frame of its own, on a miss
+  if (hit == false) {
+    frame = take_frame(pager);
+    char* bytes = NULL;
+    ssize_t got = -1;
+    if (frame != PAGER_END) {
+      bytes = pager->frames + (size_t)PAGER_PAGE * frame;
+      got = pread(pager->fd, bytes, PAGER_PAGE, (off_t)(page * PAGER_PAGE));
+    }
+    if (got < 0) {
+      pager->failures++;
+      pthread_mutex_unlock(&pager->lock);
+      return NULL;
+    }
+    memset(bytes + got, 0, PAGER_PAGE - got);
+    pager->page[frame] = page;
+    pager->next[frame] = pager->bucket[bucket];
+    pager->bucket[bucket] = frame;
+  }
+
+  // Pin: The frame stays put till unpinned
+  pager->pins[frame]++;
+  pager->referenced[frame] = 1;
+  double elapsed = now_seconds() - start;
+  if (hit) {
+    pager->hits++;
+    pager->hit_seconds += elapsed;
+  } else {
+    pager->misses++;
+    pager->miss_seconds += elapsed;
+  }
+  count_latency(pager, elapsed);
+  pthread_mutex_unlock(&pager->lock);
+  return pager->frames + (size_t)PAGER_PAGE * frame;
+}
+
+/**
+ * @brief This function will unpin the page holding the given 'memory' (any
+ * byte within the page returned by pin_page()), marking it dirty if changed.
+ * @param pager The buffer pool's data structure reference
+ * @param memory Any byte of the pinned page
+ * @param dirty Whether the page is changed
+ */
+void unpin_page(PAGER pager, const void* memory, bool dirty) {
+  // Check: Wether the buffer pool and page exist!
+  if (pager == NULL || memory == NULL) return;
+
+  unsigned int frame = ((const char*)memory - pager->frames) / PAGER_PAGE;
+  pthread_mutex_lock(&pager->lock);
+  pager->pins[frame]--;
+  if (dirty) pager->dirty[frame] = 1;
+  pthread_mutex_unlock(&pager->lock);
+}
+
+/**
+ * @brief This function will write every dirty page back to the file. Returns
+ * 'true' if successfully written, otherwise returns 'false'.
+ * @param pager The buffer pool's data structure reference
+ * @return 'true' or 'false'
+ */
+bool flush_pager(PAGER pager) {
+  // Check: Wether the buffer pool exist!
+  if (pager == NULL) return false;
+
+  bool status = true;
+  pthread_mutex_lock(&pager->lock);
+  for (unsigned int i = 0; i < pager->used; i++)
+    if (pager->dirty[i] && write_back(pager, i) == false) status = false;
+  pthread_mutex_unlock(&pager->lock);
+  return status;
+}
+
+/**
+ * @brief This function will return the upper bound (in microseconds) of the
+ * bucket of the latency histogram holding the given 'fraction' of the pins.
+ */
+static double percentile(const long long unsigned int latency[],
+                         long long unsigned int total, double fraction) {
+  if (total == 0) return 0;
+  long long unsigned int seen = 0;
+  for (unsigned int i = 0; i < PAGER_BUCKETS; i++) {
+    seen += latency[i];
+    if (seen >= total * fraction) return (double)(2ull << i) / 1e3;
+  }
+  return 0;
+}
+
+/**
+ * @brief This function will display the metrics of the buffer pool, i.e. the
+ * hit rate, the evictions and write-backs, and the latency of a pin on a hit
+ * and on a miss along with its median and 99th percentile.
+ * @param pager The buffer pool's data structure reference
+ */
+void display_pager(PAGER pager) {
+  // Check: Wether the buffer pool exist!
+  if (pager == NULL) return;
+
+  // Copy: The metrics as of now
+  pthread_mutex_lock(&pager->lock);
+  long long unsigned int hits = pager->hits, misses = pager->misses;
+  long long unsigned int evictions = pager->evictions, writes = pager->writes;
+  double hit_seconds = pager->hit_seconds, miss_seconds = pager->miss_seconds;
+  long long unsigned int latency[PAGER_BUCKETS];
+  memcpy(latency, pager->latency, sizeof(latency));
+  unsigned int count = pager->count;
+  pthread_mutex_unlock(&pager->lock);
+
+  // Display: The metrics
+  long long unsigned int total = hits + misses;
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m \e[38;5;214m%llu\e[0m page pin(s) over %u "
+      "frame(s), hit rate \e[38;5;214m%.2f%%\e[0m\n"
+      "  %llu miss(es), %llu eviction(s), %llu write-back(s)\n"
+      "  a pin took %.2f us on a hit, %.2f us on a miss\n"
+      "  (median under %.2f us, 99%% under %.2f us).\n",
+      total, count, (total > 0) ? 100.0 * hits / total : 0.0, misses,
+      evictions, writes, (hits > 0) ? hit_seconds * 1e6 / hits : 0.0,
+      (misses > 0) ? miss_seconds * 1e6 / misses : 0.0,
+      percentile(latency, total, 0.5), percentile(latency, total, 0.99));
+}
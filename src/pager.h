@@ -0,0 +1,163 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file pager.h
+ * @brief Interface of the buffer pool of the pages of an on-disk store
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef PAGER_H
+#define PAGER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "cs50.h"
+
+/**
+ * @brief Bytes of a page of the file, so of a frame of the buffer pool
+ */
+#define PAGER_PAGE 4096
+
+/**
+ * @brief Least number of frames of the buffer pool
+ */
+#define PAGER_MIN_FRAMES 8
+
+/**
+ * @brief Number of buckets of the latency histogram (powers of two of ns)
+ */
+#define PAGER_BUCKETS 40
+
+/**
+ * @brief Structure of the buffer pool, i.e. a fixed number of frames caching
+ * the pages of the file, the page held by each frame along with its pins,
+ * reference and dirty bits (evicted by CLOCK), the chained hash table from a
+ * page to its frame and the metrics of the pins
+ */
+typedef struct {
+  int fd;
+  pthread_mutex_t lock;
+  char* frames;
+  long long unsigned int* page;
+  unsigned int* pins;
+  unsigned char* referenced;
+  unsigned char* dirty;
+  unsigned int* next;
+  unsigned int* bucket;
+  unsigned int buckets;
+  unsigned int count;
+  unsigned int used;
+  unsigned int hand;
+  long long unsigned int hits;
+  long long unsigned int misses;
+  long long unsigned int evictions;
+  long long unsigned int writes;
+  long long unsigned int failures;
+  double hit_seconds;
+  double miss_seconds;
+  long long unsigned int latency[PAGER_BUCKETS];
+} pager_element;
+
+/**
+ * @brief Buffer pool's Data structure Reference
+ */
+#define PAGER pager_element*
+
+/**
+ * @brief This function will create (or truncate) the file of the given 'path'
+ * and a buffer pool of 'frames' pages over it, and return it as a reference
+ * (not copy, thus need to be freed after usage). Pages never written read as
+ * zeros. If some error happens during creation, it will return NULL
+ * reference.
+ * @param path The path of the file of the pages
+ * @param frames The number of frames of the buffer pool
+ * @return PAGER (reference, not copy) or 'NULL'
+ */
+PAGER create_pager(string path, unsigned int frames);
+
+/**
+ * @brief This function will write every dirty page back to the file, close it
+ * and free the buffer pool. Returns 'true' if successfully deleted,
+ * otherwise returns 'false'.
+ * @param pager The buffer pool's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_pager(PAGER pager);
+
+/**
+ * @brief This function will pin the given 'page' into a frame of the buffer
+ * pool, reading it from the file on a miss after evicting (and writing back,
+ * if dirty) the first unpinned and unreferenced frame under the clock hand.
+ * The frame stays put till unpinned. Returns the bytes of the page (of
+ * PAGER_PAGE), otherwise returns 'NULL' if every frame is pinned or the file
+ * failed.
+ * @param pager The buffer pool's data structure reference
+ * @param page The number of the page
+ * @return bytes of the page or 'NULL'
+ */
+char* pin_page(PAGER pager, long long unsigned int page);
+
+/**
+ * @brief This function will unpin the page holding the given 'memory' (any
+ * byte within the page returned by pin_page()), marking it dirty if changed.
+ * @param pager The buffer pool's data structure reference
+ * @param memory Any byte of the pinned page
+ * @param dirty Whether the page is changed
+ */
+void unpin_page(PAGER pager, const void* memory, bool dirty);
+
+/**
+ * @brief This function will write every dirty page back to the file. Returns
+ * 'true' if successfully written, otherwise returns 'false'.
+ * @param pager The buffer pool's data structure reference
+ * @return 'true' or 'false'
+ */
+bool flush_pager(PAGER pager);
+
+/**
+ * @brief This function will display the metrics of the buffer pool, i.e. the
+ * hit rate, the evictions and write-backs, and the latency of a pin on a hit
+ * and on a miss along with its median and 99th percentile.
+ * @param pager The buffer pool's data structure reference
+ */
+void display_pager(PAGER pager);
+
+#endif
@@ -0,0 +1,347 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file radix.c
+ * @brief Implementation of radix tree (name index) related functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "radix.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Size of each block of the radix tree's arena
+ */
+#define RADIX_ARENA_BLOCK (1 << 20)
+
+/**
+ * @brief This function will make a new node (with its label copied) from the
+ * arena of the tree. Returns the node reference, otherwise returns 'NULL' if
+ * out of memory.
+ */
+static radix_node* make_node(RADIX tree, const char* label,
+                             unsigned int length, int id) {
+  // Create: Node and label both lives in the arena
+  radix_node* node = (radix_node*)arena_alloc(tree->arena, sizeof(radix_node));
+  char* copy = (char*)arena_alloc(tree->arena, length);
+  if (node == NULL || copy == NULL) return NULL;
+  memcpy(copy, label, length);
+
+  // Configure: Initialize variables of node
+  node->label = copy;
+  node->length = length;
+  node->id = id;
+  node->child = NULL;
+  node->sibling = NULL;
+  return node;
+}
+
+/**
+ * @brief This function will link the 'node' as a child of 'parent' keeping
+ * the children ordered by their first byte.
+ */
+static void link_child(radix_node* parent, radix_node* node) {
+  radix_node** slot = &parent->child;
+  while (*slot != NULL &&
+         (unsigned char)(*slot)->label[0] < (unsigned char)node->label[0])
+    slot = &(*slot)->sibling;
+  node->sibling = *slot;
+  *slot = node;
+}
+
+/**
+ * @brief This function will find the child of 'parent' whose label starts with
+ * the given byte. Returns the slot holding the child, otherwise returns 'NULL'.
+ */
+static radix_node** find_child(radix_node* parent, char first) {
+  radix_node** slot = &parent->child;
+  while (*slot != NULL) {
+    if ((*slot)->label[0] == first) return slot;
+    slot = &(*slot)->sibling;
+  }
+  return NULL;
+}
+
+/**
+ * @brief This function will create an empty radix tree whose nodes and labels
+ * are allocated from its own arena and return it as a reference (not copy,
+ * thus need to be freed after usage). If some error happens during creation,
+ * it will return NULL reference.
+ * @return RADIX (reference, not copy) or 'NULL'
+ */
+RADIX create_radix() {
+  // Create: Make space for the tree and its arena
+  RADIX tree = (RADIX)calloc(1, sizeof(radix_element));
+  if (tree == NULL) return NULL;
+  tree->arena = create_arena(RADIX_ARENA_BLOCK);
+  if (tree->arena == NULL) {
+    free(tree);
+    return NULL;
+  }
+
+  // Configure: The root holds the empty label
+  tree->root.label = "";
+  tree->root.length = 0;
+  tree->root.id = -1;
+  tree->root.child = NULL;
+  tree->root.sibling = NULL;
+  tree->quantity = 0;
+
+  // Status: Return the tree's structure reference
+  return tree;
+}
+
+/**
+ * @brief This function will take the radix tree as an input and frees it along
+ * with every node. Returns 'true' if successfully deleted, otherwise returns
+ * 'false'.
+ * @param tree The radix tree's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_radix(RADIX tree) {
+  // Check: Whether the tree exist!
+  if (tree == NULL) return false;
+
+  // Clean: Every node lives in the arena
+  delete_arena(tree->arena);
+  free(tree);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will insert the given 'key' into the radix tree and
+ * link it with the given 'id'. Returns 'true' if successfully inserted,
+ * otherwise returns 'false' if the key already exist or out of memory.
+ * @param tree The radix tree's data structure reference
+ * @param key The key (e.g. user name) which has to be inserted
+ * @param id The id (e.g. account id) linked with the key
+ * @return 'true' or 'false'
+ */
+bool radix_insert(RADIX tree, const char* key, int id) {
+  // Check: Whether the tree and key exist!
+  if (tree == NULL || key == NULL || id < 0) return false;
+
+  radix_node* node = &tree->root;
+  while (true) {
+    // Check: Reached the end of the key
+    if (*key == '\0') {
+      if (node->id != -1) return false;
+      node->id = id;
+      tree->quantity++;
+      return true;
+    }
+
+    // Find: The edge sharing the first byte
+    radix_node** slot = find_child(node, *key);
+
+    // IF NOT FOUND: Rest of the key becomes a new leaf
+    if (slot == NULL) {
+      radix_node* leaf = make_node(tree, key, strlen(key), id);
+      if (leaf == NULL) return false;
+      link_child(node, leaf);
+      tree->quantity++;
+      return true;
+    }
+
+    // Compare: Length of the common prefix of the edge and the key
+    radix_node* child = *slot;
+    unsigned int common = 0;
+    while (common < child->length && key[common] == child->label[common])
+      common++;
+
+    // IF WHOLE EDGE MATCHED: Go down
+    if (common == child->length) {
+      key += common;
+      node = child;
+      continue;
+    }
+
+    // IF PARTIALLY MATCHED: Split the edge, the labels are shared slices
+    radix_node* middle =
+        (radix_node*)arena_alloc(tree->arena, sizeof(radix_node));
+    if (middle == NULL) return false;
+    middle->label = child->label;
+    middle->length = common;
+    middle->id = -1;
+    middle->child = child;
+    middle->sibling = child->sibling;
+    child->label += common;
+    child->length -= common;
+    child->sibling = NULL;
+    *slot = middle;
+
+    key += common;
+    node = middle;
+  }
+}
+
+/**
+ * @brief This function will look the given 'key' up (case sensitive) in the
+ * radix tree. Returns the linked id if found, otherwise returns -1.
+ * @param tree The radix tree's data structure reference
+ * @param key The key (e.g. user name) which has to be found
+ * @return id or -1
+ */
+int radix_lookup(RADIX tree, const char* key) {
+  // Check: Whether the tree and key exist!
+  if (tree == NULL || key == NULL) return -1;
+
+  radix_node* node = &tree->root;
+  while (*key != '\0') {
+    // Find: The edge sharing the first byte, the whole edge must match
+    radix_node** slot = find_child(node, *key);
+    if (slot == NULL) return -1;
+    node = *slot;
+    if (strncmp(key, node->label, node->length) != 0) return -1;
+    key += node->length;
+  }
+  return node->id;
+}
+
+/**
+ * @brief This function will unlink the given 'key' (case sensitive) from its
+ * id in the radix tree, the nodes stay (till the tree is built again), thus
+ * the key can be linked again later. Returns 'true' if unlinked, otherwise
+ * returns 'false' if the key don't exist.
+ * @param tree The radix tree's data structure reference
+ * @param key The key (e.g. user name) which has to be unlinked
+ * @return 'true' or 'false'
+ */
+bool radix_remove(RADIX tree, const char* key) {
+  // Check: Whether the tree and key exist!
+  if (tree == NULL || key == NULL) return false;
+
+  radix_node* node = &tree->root;
+  while (*key != '\0') {
+    // Find: The edge sharing the first byte, the whole edge must match
+    radix_node** slot = find_child(node, *key);
+    if (slot == NULL) return false;
+    node = *slot;
+    if (strncmp(key, node->label, node->length) != 0) return false;
+    key += node->length;
+  }
+
+  // Unlink: The node stays as a branch
+  if (node->id == -1) return false;
+  node->id = -1;
+  tree->quantity--;
+  return true;
+}
+
+/**
+ * @brief This function will hand over every id of the subtree rooted at the
+ * given 'node' to 'emit' in lexicographic order. Returns the number of ids.
+ */
+static unsigned int emit_subtree(radix_node* node,
+                                 void (*emit)(int id, void* context),
+                                 void* context) {
+  unsigned int found = 0;
+  if (node->id != -1) {
+    emit(node->id, context);
+    found++;
+  }
+  for (radix_node* child = node->child; child != NULL; child = child->sibling)
+    found += emit_subtree(child, emit, context);
+  return found;
+}
+
+/**
+ * @brief This function will walk down the children of 'node' which agree with
+ * the remaining 'prefix' and emit the subtrees once the prefix is consumed.
+ * Case insensitive walk may branch into more than one child. Returns the
+ * number of matches.
+ */
+static unsigned int walk_prefix(radix_node* node, const char* prefix,
+                                size_t remain, bool ignore_case,
+                                void (*emit)(int id, void* context),
+                                void* context) {
+  // Check: Prefix consumed, whole subtree matches
+  if (remain == 0) return emit_subtree(node, emit, context);
+
+  unsigned int found = 0;
+  for (radix_node* child = node->child; child != NULL; child = child->sibling) {
+    // Compare: The overlapping part of the edge and the prefix
+    size_t overlap = (remain < child->length) ? remain : child->length;
+    bool match = true;
+    for (size_t i = 0; i < overlap && match; i++) {
+      if (ignore_case)
+        match = tolower((unsigned char)child->label[i]) ==
+                tolower((unsigned char)prefix[i]);
+      else
+        match = child->label[i] == prefix[i];
+    }
+    if (match == false) continue;
+
+    // Walk: The prefix may end in the middle of the edge
+    if (remain <= child->length)
+      found += emit_subtree(child, emit, context);
+    else
+      found += walk_prefix(child, prefix + overlap, remain - overlap,
+                           ignore_case, emit, context);
+  }
+  return found;
+}
+
+/**
+ * @brief This function will walk through every key of the radix tree starting
+ * with the given 'prefix' in lexicographic order and hand over the linked id
+ * of each match to 'emit' as soon as it is found, so nothing is collected in
+ * between. Returns the number of matches.
+ * @param tree The radix tree's data structure reference
+ * @param prefix The prefix which the keys has to start with
+ * @param ignore_case Whether the prefix is compared case insensitively
+ * @param emit The function called for every match with its id and 'context'
+ * @param context Anything the caller wants to be handed over to 'emit'
+ * @return number of matches
+ */
+unsigned int radix_find_prefix(RADIX tree, const char* prefix,
+                               bool ignore_case,
+                               void (*emit)(int id, void* context),
+                               void* context) {
+  // Check: Whether the tree, prefix and receiver exist!
+  if (tree == NULL || prefix == NULL || emit == NULL) return 0;
+
+  return walk_prefix(&tree->root, prefix, strlen(prefix), ignore_case, emit,
+                     context);
+}
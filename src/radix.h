@@ -0,0 +1,145 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file radix.h
+ * @brief Interface of radix tree (name index) related functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef RADIX_H
+#define RADIX_H
+
+#include <stdbool.h>
+
+#include "arena.h"
+
+/**
+ * @brief Structure of a node of the radix tree, the edge label from the parent
+ * is a slice of bytes kept in the arena. Children are kept in a sibling list
+ * ordered by their first byte.
+ */
+typedef struct radix_node {
+  const char* label;
+  unsigned int length;
+  int id;
+  struct radix_node* child;
+  struct radix_node* sibling;
+} radix_node;
+
+/**
+ * @brief Structure of the radix tree
+ */
+typedef struct {
+  radix_node root;
+  unsigned int quantity;
+  ARENA arena;
+} radix_element;
+
+/**
+ * @brief Radix tree's Data structure Reference
+ */
+#define RADIX radix_element*
+
+/**
+ * @brief This function will create an empty radix tree whose nodes and labels
+ * are allocated from its own arena and return it as a reference (not copy,
+ * thus need to be freed after usage). If some error happens during creation,
+ * it will return NULL reference.
+ * @return RADIX (reference, not copy) or 'NULL'
+ */
+RADIX create_radix();
+
+/**
+ * @brief This function will take the radix tree as an input and frees it along
+ * with every node. Returns 'true' if successfully deleted, otherwise returns
+ * 'false'.
+ * @param tree The radix tree's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_radix(RADIX tree);
+
+/**
+ * @brief This function will insert the given 'key' into the radix tree and
+ * link it with the given 'id'. Returns 'true' if successfully inserted,
+ * otherwise returns 'false' if the key already exist or out of memory.
+ * @param tree The radix tree's data structure reference
+ * @param key The key (e.g. user name) which has to be inserted
+ * @param id The id (e.g. account id) linked with the key
+ * @return 'true' or 'false'
+ */
+bool radix_insert(RADIX tree, const char* key, int id);
+
+/**
+ * @brief This function will look the given 'key' up (case sensitive) in the
+ * radix tree. Returns the linked id if found, otherwise returns -1.
+ * @param tree The radix tree's data structure reference
+ * @param key The key (e.g. user name) which has to be found
+ * @return id or -1
+ */
+int radix_lookup(RADIX tree, const char* key);
+
+/**
+ * @brief This function will unlink the given 'key' (case sensitive) from its
+ * id in the radix tree, the nodes stay (till the tree is built again), thus
+ * the key can be linked again later. Returns 'true' if unlinked, otherwise
+ * returns 'false' if the key don't exist.
+ * @param tree The radix tree's data structure reference
+ * @param key The key (e.g. user name) which has to be unlinked
+ * @return 'true' or 'false'
+ */
+bool radix_remove(RADIX tree, const char* key);
+
+/**
+ * @brief This function will walk through every key of the radix tree starting
+ * with the given 'prefix' in lexicographic order and hand over the linked id
+ * of each match to 'emit' as soon as it is found, so nothing is collected in
+ * between. Returns the number of matches.
+ * @param tree The radix tree's data structure reference
+ * @param prefix The prefix which the keys has to start with
+ * @param ignore_case Whether the prefix is compared case insensitively
+ * @param emit The function called for every match with its id and 'context'
+ * @param context Anything the caller wants to be handed over to 'emit'
+ * @return number of matches
+ */
+unsigned int radix_find_prefix(RADIX tree, const char* prefix,
+                               bool ignore_case,
+                               void (*emit)(int id, void* context),
+                               void* context);
+
+#endif
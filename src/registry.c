@@ -0,0 +1,492 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file registry.c
+ * @brief Implementation of the registry of banks owned by worker threads
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#include "registry.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "console.h"
+#include "vault.h"
+
+/**
+ * @brief The states of a run, the workers wait till every one is spawned
+ */
+enum { REGISTRY_WAIT, REGISTRY_GO, REGISTRY_CANCEL };
+
+/**
+ * @brief This function will return the current time of a monotonic clock in
+ * seconds.
+ */
+static double now_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief This function will create a registry of 'banks' banks (named "Bank
+ * 1", "Bank 2", ...) of 'accounts' accounts each, sharded over 'workers'
+ * worker threads (at most REGISTRY_MAX_WORKERS), and return it as a reference
+ * (not copy, thus need to be freed after usage). If some error happens during
+ * creation, it will return NULL reference.
+ * @param banks The number of banks
+ * @param accounts The number of accounts of every bank
+ * @param workers The number of worker threads
+ * @return REGISTRY (reference, not copy) or 'NULL'
+ */
+REGISTRY create_registry(unsigned int banks, unsigned int accounts,
+                         unsigned int workers) {
+  // Check: Wether there is any bank and account!
+  if (banks == 0 || accounts == 0) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m A network needs a bank and an account at "
+        "least.\n");
+    return NULL;
+  }
+  if (workers == 0) workers = 1;
+  if (workers > REGISTRY_MAX_WORKERS) workers = REGISTRY_MAX_WORKERS;
+  if (workers > banks) workers = banks;
+
+  // Create: Make space for the registry, the banks and the queues
+  REGISTRY registry = (REGISTRY)aligned_alloc(64, sizeof(registry_element));
+  if (registry != NULL) {
+    memset(registry, 0, sizeof(registry_element));
+    registry->banks = banks;
+    registry->accounts = accounts;
+    registry->workers = workers;
+    registry->bank = (BANK*)calloc(banks, sizeof(BANK));
+    registry->names = (char*)malloc((size_t)banks * REGISTRY_NAME);
+    registry->queue = (registry_queue*)aligned_alloc(
+        64, sizeof(registry_queue) * workers * workers);
+  }
+  if (registry == NULL || registry->bank == NULL || registry->names == NULL ||
+      registry->queue == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    delete_registry(registry);
+    return NULL;
+  }
+
+  // Configure: Empty queues, and the workers
+  for (unsigned int i = 0; i < workers * workers; i++) {
+    atomic_init(&registry->queue[i].head, 0);
+    atomic_init(&registry->queue[i].tail, 0);
+  }
+  for (unsigned int i = 0; i < workers; i++) {
+    registry->worker[i].registry = registry;
+    registry->worker[i].index = i;
+  }
+  atomic_init(&registry->in_flight, 0);
+  atomic_init(&registry->generating, 0);
+  atomic_init(&registry->state, REGISTRY_WAIT);
+
+  // Create: Every bank along with its accounts, sharing one hashed PIN
+  // (1234) as hashing every PIN would take longer than the simulation
+  char user[32];
+  long long unsigned int stored = 0;
+  bool sealed = seal_pin(1234, &stored);
+  for (unsigned int i = 0; i < banks; i++) {
+    char* name = registry->names + (size_t)i * REGISTRY_NAME;
+    snprintf(name, REGISTRY_NAME, "Bank %u", i + 1);
+    registry->bank[i] = create_bank(name);
+    bool created = sealed && registry->bank[i] != NULL &&
+                   reserve_accounts(registry->bank[i], accounts) == true;
+    for (unsigned int j = 0; created && j < accounts; j++) {
+      int length = snprintf(user, sizeof(user), "user%u", j);
+      created = add_account(registry->bank[i], stored, user, length, 3210) ==
+                (int)j;
+    }
+    if (created == false) {
+      console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+      delete_registry(registry);
+      return NULL;
+    }
+  }
+
+  // Status: Return the registry's structure reference
+  return registry;
+}
+
+/**
+ * @brief This function will take the registry as an input and frees it along
+ * with every bank. Returns 'true' if successfully deleted, otherwise returns
+ * 'false'.
+ * @param registry The registry's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_registry(REGISTRY registry) {
+  // Check: Whether the registry exist!
+  if (registry == NULL) return false;
+
+  // Clean: Every bank, the queues and the backlogs
+  if (registry->bank != NULL)
+    for (unsigned int i = 0; i < registry->banks; i++)
+      delete_bank(registry->bank[i]);
+  for (unsigned int i = 0; i < registry->workers; i++)
+    free(registry->worker[i].backlog);
+  free(registry->bank);
+  free(registry->names);
+  free(registry->queue);
+  free(registry);
+  return true;
+}
+
+/**
+ * @brief This function will return the worker owning the bank of the given
+ * 'index'.
+ * @param registry The registry's data structure reference
+ * @param index The index of the bank
+ * @return index of the worker
+ */
+unsigned int owner_of(REGISTRY registry, unsigned int index) {
+  return index % registry->workers;
+}
+
+/**
+ * @brief This function will push the message into the queue from the worker
+ * 'from' to the worker 'to', as its only producer. Returns 'true' if pushed,
+ * otherwise returns 'false' if the queue is full.
+ */
+static bool push_message(REGISTRY registry, unsigned int from, unsigned int to,
+                         const registry_message* message) {
+  registry_queue* queue = &registry->queue[from * registry->workers + to];
+  unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  unsigned int head = atomic_load_explicit(&queue->head, memory_order_acquire);
+  if (tail - head == REGISTRY_QUEUE) return false;
+  queue->message[tail % REGISTRY_QUEUE] = *message;
+  atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+  return true;
+}
+
+/**
+ * @brief This function will return the worker a message is for, the owner of
+ * the target bank for a credit and the owner of the source bank for a refund.
+ */
+static unsigned int target_of(REGISTRY registry,
+                              const registry_message* message) {
+  return owner_of(registry, (message->kind == REGISTRY_CREDIT)
+                                ? message->to_bank
+                                : message->from_bank);
+}
+
+/**
+ * @brief This function will push as many messages of the worker's backlog as
+ * their queues take, keeping the rest.
+ */
+static void flush_backlog(registry_worker* worker) {
+  REGISTRY registry = worker->registry;
+  size_t kept = 0;
+  for (size_t i = 0; i < worker->backlog_quantity; i++) {
+    registry_message* message = &worker->backlog[i];
+    if (push_message(registry, worker->index, target_of(registry, message),
+                     message) == false)
+      worker->backlog[kept++] = *message;
+  }
+  worker->backlog_quantity = kept;
+}
+
+static void send_message(registry_worker* worker, registry_message* message);
+
+/**
+ * @brief This function will handle the message on the worker owning its bank,
+ * crediting the target account (or sending the amount back as a refund if it
+ * doesn't exist) or the source account of a refund.
+ */
+static void handle_message(registry_worker* worker,
+                           registry_message* message) {
+  REGISTRY registry = worker->registry;
+  if (message->kind == REGISTRY_REFUND) {
+    account_deposit(registry->bank[message->from_bank], message->from_account,
+                    BANK_ANY_GENERATION, message->amount);
+    worker->refunds++;
+  } else if (account_deposit(registry->bank[message->to_bank],
+                             message->to_account, BANK_ANY_GENERATION,
+                             message->amount) == false) {
+    message->kind = REGISTRY_REFUND;
+    send_message(worker, message);
+  }
+}
+
+/**
+ * @brief This function will send the message to the worker it is for, handled
+ * right away if it is this one, otherwise pushed into the queue in between
+ * them (or the backlog, if the queue is full). The message is counted in
+ * flight before anyone can see it.
+ */
+static void send_message(registry_worker* worker, registry_message* message) {
+  REGISTRY registry = worker->registry;
+  unsigned int to = target_of(registry, message);
+  if (to == worker->index) {
+    handle_message(worker, message);
+    return;
+  }
+  atomic_fetch_add(&registry->in_flight, 1);
+  worker->sent++;
+  if (worker->backlog_quantity == 0 &&
+      push_message(registry, worker->index, to, message) == true)
+    return;
+
+  // Create: Make space for more messages in the backlog
+  if (worker->backlog_quantity == worker->backlog_capacity) {
+    size_t capacity =
+        (worker->backlog_capacity == 0) ? 1024 : worker->backlog_capacity * 2;
+    registry_message* backlog = (registry_message*)realloc(
+        worker->backlog, sizeof(registry_message) * capacity);
+    while (backlog == NULL) {
+      // Wait: For the queues to take the backlog, as memory is out
+      flush_backlog(worker);
+      if (worker->backlog_quantity < worker->backlog_capacity) break;
+      sched_yield();
+    }
+    if (backlog != NULL) {
+      worker->backlog = backlog;
+      worker->backlog_capacity = capacity;
+    }
+  }
+  worker->backlog[worker->backlog_quantity++] = *message;
+}
+
+/**
+ * @brief This function will take the messages waiting for the worker out of
+ * every queue into it (a batch per queue) and handle them. Returns the number
+ * of messages handled.
+ */
+static unsigned int receive_messages(registry_worker* worker) {
+  REGISTRY registry = worker->registry;
+  unsigned int handled = 0;
+  for (unsigned int from = 0; from < registry->workers; from++) {
+    if (from == worker->index) continue;
+    registry_queue* queue =
+        &registry->queue[from * registry->workers + worker->index];
+    unsigned int head =
+        atomic_load_explicit(&queue->head, memory_order_relaxed);
+    unsigned int tail =
+        atomic_load_explicit(&queue->tail, memory_order_acquire);
+    unsigned int count = 0;
+    for (; head != tail && count < REGISTRY_BATCH; head++, count++) {
+      registry_message message = queue->message[head % REGISTRY_QUEUE];
+      handle_message(worker, &message);
+    }
+    atomic_store_explicit(&queue->head, head, memory_order_release);
+
+    // Count: Out of flight once handled (refunds are in flight already)
+    if (count > 0) atomic_fetch_sub(&registry->in_flight, count);
+    handled += count;
+  }
+  return handled;
+}
+
+/**
+ * @brief This function will make a random transfer from an account of a bank
+ * owned by the worker to an account of any bank (a few of them don't exist,
+ * thus get refunded).
+ */
+static void make_transfer(registry_worker* worker) {
+  REGISTRY registry = worker->registry;
+  unsigned int owned =
+      (registry->banks - worker->index + registry->workers - 1) /
+      registry->workers;
+  registry_message message;
+  message.kind = REGISTRY_CREDIT;
+  message.from_bank =
+      worker->index + registry->workers * (rand_r(&worker->seed) % owned);
+  message.from_account = rand_r(&worker->seed) % registry->accounts;
+  message.to_bank = rand_r(&worker->seed) % registry->banks;
+  message.to_account = rand_r(&worker->seed) %
+                       (registry->accounts + registry->accounts / 64 + 1);
+  message.amount = 1 + rand_r(&worker->seed) % 100;
+
+  // Withdraw: From the source account, then pass the amount on
+  if (account_withdraw(registry->bank[message.from_bank],
+                       message.from_account, BANK_ANY_GENERATION,
+                       message.amount) != DEBIT_DONE) {
+    worker->declined++;
+    return;
+  }
+  worker->transfers++;
+  if (owner_of(registry, message.to_bank) == worker->index) worker->local++;
+  send_message(worker, &message);
+}
+
+/**
+ * @brief This function is the body of a worker thread, it makes its share of
+ * the transfers (handling the messages of the others meanwhile) and then
+ * handles the messages till none is left in flight anywhere.
+ */
+static void* work(void* argument) {
+  registry_worker* worker = (registry_worker*)argument;
+  REGISTRY registry = worker->registry;
+  set_console(null_console());
+
+  // Wait: For every worker to be spawned
+  int state;
+  while ((state = atomic_load(&registry->state)) == REGISTRY_WAIT)
+    sched_yield();
+  if (state == REGISTRY_CANCEL) return NULL;
+
+  // Transfer: The share of the worker
+  for (long long unsigned int made = 0; made < worker->quota; made++) {
+    make_transfer(worker);
+    if (made % 64 == 63) {
+      flush_backlog(worker);
+      receive_messages(worker);
+    }
+  }
+  atomic_fetch_sub(&registry->generating, 1);
+
+  // Handle: Every message left, till nothing is in flight
+  while (true) {
+    flush_backlog(worker);
+    if (receive_messages(worker) > 0) continue;
+    if (worker->backlog_quantity == 0 &&
+        atomic_load(&registry->generating) == 0 &&
+        atomic_load(&registry->in_flight) == 0)
+      break;
+    sched_yield();
+  }
+  set_console(NULL);
+  return NULL;
+}
+
+/**
+ * @brief This function will add up the money of every account of every bank
+ * of the registry.
+ */
+static long long int total_money(REGISTRY registry) {
+  long long int total = 0;
+  account_element account;
+  for (unsigned int i = 0; i < registry->banks; i++)
+    for (unsigned int j = 0; j < registry->bank[i]->accounts_quantity; j++)
+      if (get_account(registry->bank[i], j, &account) == true)
+        total += account.amount;
+  return total;
+}
+
+/**
+ * @brief This function will run 'transfers' random transfers in between the
+ * accounts of the banks of the registry, each worker starting its share from
+ * the banks it owns. The amount is withdrawn by the owner of the source bank
+ * and passed over a lock-free queue to the owner of the target bank as a
+ * message, which credits it (or sends it back as a refund if the target
+ * account doesn't exist). The run is over once every message is handled,
+ * then the money of every bank is added up (it must not have changed) and the
+ * throughput is displayed. Returns 'true' if the money adds up, otherwise
+ * returns 'false'.
+ * @param registry The registry's data structure reference
+ * @param transfers The number of transfers
+ * @return 'true' or 'false'
+ */
+bool run_transfers(REGISTRY registry, long long unsigned int transfers) {
+  // Check: Wether the registry exist!
+  if (registry == NULL) return false;
+  long long int before = total_money(registry);
+
+  // Configure: The share of every worker
+  unsigned int workers = registry->workers;
+  for (unsigned int i = 0; i < workers; i++) {
+    registry_worker* worker = &registry->worker[i];
+    worker->quota = transfers / workers + (i < transfers % workers);
+    worker->seed = 2022 + i;
+    worker->transfers = worker->local = worker->sent = 0;
+    worker->refunds = worker->declined = 0;
+  }
+  atomic_store(&registry->generating, workers);
+  atomic_store(&registry->in_flight, 0);
+  atomic_store(&registry->state, REGISTRY_WAIT);
+
+  // Spawn: A thread per worker (the first one runs on this thread), and go
+  // only once every one is there, as a worker waits for all of them
+  pthread_t thread[REGISTRY_MAX_WORKERS];
+  unsigned int spawned = 1;
+  while (spawned < workers &&
+         pthread_create(&thread[spawned], NULL, work,
+                        &registry->worker[spawned]) == 0)
+    spawned++;
+  if (spawned < workers) {
+    atomic_store(&registry->state, REGISTRY_CANCEL);
+    for (unsigned int i = 1; i < spawned; i++) pthread_join(thread[i], NULL);
+    console_printf("\e[38;5;196mError:\e[0m Can't spawn the workers.\n");
+    return false;
+  }
+  double start = now_seconds();
+  atomic_store(&registry->state, REGISTRY_GO);
+  work(&registry->worker[0]);
+  for (unsigned int i = 1; i < workers; i++) pthread_join(thread[i], NULL);
+  double elapsed = now_seconds() - start;
+
+  // Report: Throughput of the whole run
+  long long unsigned int done = 0, local = 0, sent = 0, refunds = 0,
+                         declined = 0;
+  for (unsigned int i = 0; i < workers; i++) {
+    done += registry->worker[i].transfers;
+    local += registry->worker[i].local;
+    sent += registry->worker[i].sent;
+    refunds += registry->worker[i].refunds;
+    declined += registry->worker[i].declined;
+  }
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Transferred \e[38;5;214m%llu\e[0m time(s) in "
+      "between %u bank(s) of %u account(s)\n"
+      "  on %u worker(s) in %.3f s (\e[38;5;214m%.0f\e[0m transfers/second),\n"
+      "  %llu message(s) over the queues, %llu within a worker, %llu "
+      "refund(s)\n"
+      "  and %llu declined for lack of funds.\n",
+      done, registry->banks, registry->accounts, workers, elapsed,
+      (elapsed > 0) ? done / elapsed : 0.0, sent, local, refunds, declined);
+
+  // Check: The money of the network didn't change
+  long long int after = total_money(registry);
+  if (after != before) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m The money of the banks doesn't add up (Rs. "
+        "%lld /- before, Rs. %lld /- after).\n",
+        before, after);
+    return false;
+  }
+  return true;
+}
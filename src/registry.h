@@ -0,0 +1,197 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file registry.h
+ * @brief Interface of the registry of banks owned by worker threads
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "bank.h"
+
+/**
+ * @brief Number of messages of a queue in between two workers
+ */
+#define REGISTRY_QUEUE 4096
+
+/**
+ * @brief Most number of worker threads of a registry
+ */
+#define REGISTRY_MAX_WORKERS 64
+
+/**
+ * @brief Most number of messages a worker takes out of a queue at a time
+ */
+#define REGISTRY_BATCH 256
+
+/**
+ * @brief Bytes of the name of a bank of the registry
+ */
+#define REGISTRY_NAME 32
+
+/**
+ * @brief The kinds of a message in between two workers
+ */
+enum { REGISTRY_CREDIT, REGISTRY_REFUND };
+
+/**
+ * @brief Structure of a message in between two workers, i.e. a transfer
+ * withdrawn from the account of the source bank to be credited to the account
+ * of the target bank (or refunded, if the target account doesn't exist)
+ */
+typedef struct {
+  unsigned int kind;
+  unsigned int from_bank;
+  unsigned int from_account;
+  unsigned int to_bank;
+  unsigned int to_account;
+  long long int amount;
+} registry_message;
+
+/**
+ * @brief Structure of the lock-free queue from a single worker to another one
+ * (single producer, single consumer), the producer moves the tail and the
+ * consumer moves the head, each on a cache line of its own
+ */
+typedef struct {
+  _Alignas(64) atomic_uint head;
+  _Alignas(64) atomic_uint tail;
+  registry_message message[REGISTRY_QUEUE];
+} registry_queue;
+
+/**
+ * @brief Structure of a worker thread, the owner of every bank whose index
+ * leaves its own index over the number of workers. The 'backlog' holds the
+ * messages which didn't fit in their queue yet, thus a worker never waits
+ * for another one.
+ */
+typedef struct {
+  struct registry_element* registry;
+  unsigned int index;
+  unsigned int seed;
+  long long unsigned int quota;
+  registry_message* backlog;
+  size_t backlog_quantity;
+  size_t backlog_capacity;
+  long long unsigned int transfers;
+  long long unsigned int local;
+  long long unsigned int sent;
+  long long unsigned int refunds;
+  long long unsigned int declined;
+} registry_worker;
+
+/**
+ * @brief Structure of the registry of banks, each one owned (used) by a single
+ * worker thread while running, along with the queues in between every pair
+ * of workers
+ */
+typedef struct registry_element {
+  BANK* bank;
+  char* names;
+  unsigned int banks;
+  unsigned int accounts;
+  unsigned int workers;
+  registry_worker worker[REGISTRY_MAX_WORKERS];
+  registry_queue* queue;
+  _Alignas(64) atomic_llong in_flight;
+  atomic_uint generating;
+  atomic_int state;
+} registry_element;
+
+/**
+ * @brief Registry's Data structure Reference
+ */
+#define REGISTRY registry_element*
+
+/**
+ * @brief This function will create a registry of 'banks' banks (named "Bank
+ * 1", "Bank 2", ...) of 'accounts' accounts each, sharded over 'workers'
+ * worker threads (at most REGISTRY_MAX_WORKERS), and return it as a reference
+ * (not copy, thus need to be freed after usage). If some error happens during
+ * creation, it will return NULL reference.
+ * @param banks The number of banks
+ * @param accounts The number of accounts of every bank
+ * @param workers The number of worker threads
+ * @return REGISTRY (reference, not copy) or 'NULL'
+ */
+REGISTRY create_registry(unsigned int banks, unsigned int accounts,
+                         unsigned int workers);
+
+/**
+ * @brief This function will take the registry as an input and frees it along
+ * with every bank. Returns 'true' if successfully deleted, otherwise returns
+ * 'false'.
+ * @param registry The registry's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_registry(REGISTRY registry);
+
+/**
+ * @brief This function will return the worker owning the bank of the given
+ * 'index'.
+ * @param registry The registry's data structure reference
+ * @param index The index of the bank
+ * @return index of the worker
+ */
+unsigned int owner_of(REGISTRY registry, unsigned int index);
+
+/**
+ * @brief This function will run 'transfers' random transfers in between the
+ * accounts of the banks of the registry, each worker starting its share from
+ * the banks it owns. The amount is withdrawn by the owner of the source bank
+ * and passed over a lock-free queue to the owner of the target bank as a
+ * message, which credits it (or sends it back as a refund if the target
+ * account doesn't exist). The run is over once every message is handled,
+ * then the money of every bank is added up (it must not have changed) and the
+ * throughput is displayed. Returns 'true' if the money adds up, otherwise
+ * returns 'false'.
+ * @param registry The registry's data structure reference
+ * @param transfers The number of transfers
+ * @return 'true' or 'false'
+ */
+bool run_transfers(REGISTRY registry, long long unsigned int transfers);
+
+#endif
@@ -0,0 +1,369 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file ring.c
+ * @brief Implementation of the shared memory command rings
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "ring.h"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "console.h"
+
+/**
+ * @brief Magic number of the shared memory ("TXCR")
+ */
+#define RING_MAGIC 0x52435854
+
+/**
+ * @brief Number of empty polls yielding the CPU before the engine starts to
+ * sleep in between polls
+ */
+#define RING_SPIN 4096
+
+/**
+ * @brief Whether the engine still has to serve
+ */
+static atomic_bool serving_ring = false;
+
+/**
+ * @brief This function will map the shared memory of the given 'name',
+ * creating (and clearing) it if 'owner'. Returns the rings, otherwise returns
+ * 'NULL'.
+ */
+static RING map_ring(const char* name, bool owner) {
+  // Check: Wether the name exist!
+  if (name == NULL || strlen(name) >= sizeof(((RING)0)->name)) return NULL;
+
+  // Open: The shared memory
+  int fd = owner ? shm_open(name, O_RDWR | O_CREAT | O_TRUNC, 0600)
+                 : shm_open(name, O_RDWR, 0);
+  if (fd == -1) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't open shared memory "
+        "\e[38;5;214m%s\e[0m.\n",
+        name);
+    return NULL;
+  }
+  if (owner && ftruncate(fd, sizeof(ring_shared)) == -1) {
+    close(fd);
+    shm_unlink(name);
+    return NULL;
+  }
+
+  // Map: Both rings, the file descriptor is not needed anymore
+  void* shared = mmap(NULL, sizeof(ring_shared), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+  close(fd);
+  RING ring = (RING)calloc(1, sizeof(ring_element));
+  if (shared == MAP_FAILED || ring == NULL) {
+    if (shared != MAP_FAILED) munmap(shared, sizeof(ring_shared));
+    if (owner) shm_unlink(name);
+    free(ring);
+    return NULL;
+  }
+  ring->shared = (ring_shared*)shared;
+  strcpy(ring->name, name);
+  ring->owner = owner;
+
+  // Check: The client only attaches to the rings of an engine
+  if (owner) {
+    ring->shared->frames = RING_FRAMES;
+    __atomic_store_n(&ring->shared->magic, RING_MAGIC, __ATOMIC_RELEASE);
+  } else if (__atomic_load_n(&ring->shared->magic, __ATOMIC_ACQUIRE) !=
+                 RING_MAGIC ||
+             ring->shared->frames != RING_FRAMES) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Shared memory \e[38;5;214m%s\e[0m isn't "
+        "a ring.\n",
+        name);
+    delete_ring(ring);
+    return NULL;
+  }
+  return ring;
+}
+
+/**
+ * @brief This function will create the (empty) rings in the shared memory of
+ * the given 'name' (e.g. "/bank"), readable and writable by the owner only,
+ * on the engine's side. Returns the rings as a reference (not copy, thus need
+ * to be freed after usage), otherwise returns 'NULL'.
+ * @param name The name of the shared memory
+ * @return RING (reference, not copy) or 'NULL'
+ */
+RING create_ring(const char* name) { return map_ring(name, true); }
+
+/**
+ * @brief This function will attach to the rings in the shared memory of the
+ * given 'name' on the client's side. Returns the rings as a reference (not
+ * copy, thus need to be freed after usage), otherwise returns 'NULL'.
+ * @param name The name of the shared memory
+ * @return RING (reference, not copy) or 'NULL'
+ */
+RING attach_ring(const char* name) { return map_ring(name, false); }
+
+/**
+ * @brief This function will detach from the rings, the engine's side removes
+ * the shared memory as well. Returns 'true' if deleted, otherwise returns
+ * 'false'.
+ * @param ring The ring's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_ring(RING ring) {
+  // Check: Wether the ring exist!
+  if (ring == NULL) return false;
+
+  // Clean: The mapping, and the shared memory of the owner
+  munmap(ring->shared, sizeof(ring_shared));
+  if (ring->owner) shm_unlink(ring->name);
+  free(ring);
+  return true;
+}
+
+/**
+ * @brief This function will put the command into the command ring (client's
+ * side, single producer). Returns 'true' if submitted, otherwise returns
+ * 'false' if the ring is full.
+ * @param ring The ring's data structure reference
+ * @param command The command frame
+ * @return 'true' or 'false'
+ */
+bool ring_submit(RING ring, const ring_command* command) {
+  // Check: Wether there is space, reading the engine's head only when needed
+  ring_index* index = &ring->shared->command_index;
+  unsigned int tail = atomic_load_explicit(&index->tail, memory_order_relaxed);
+  if (tail == ring->command_limit) {
+    ring->command_limit =
+        atomic_load_explicit(&index->head, memory_order_acquire) + RING_FRAMES;
+    if (tail == ring->command_limit) return false;
+  }
+
+  // Publish: The frame, then the position
+  ring->shared->command[tail & (RING_FRAMES - 1)] = *command;
+  atomic_store_explicit(&index->tail, tail + 1, memory_order_release);
+  return true;
+}
+
+/**
+ * @brief This function will take the next reply out of the reply ring
+ * (client's side, single consumer). Returns 'true' if received, otherwise
+ * returns 'false' if the ring is empty.
+ * @param ring The ring's data structure reference
+ * @param reply The space for the reply frame
+ * @return 'true' or 'false'
+ */
+bool ring_receive(RING ring, ring_reply* reply) {
+  // Check: Wether there is a reply, reading the engine's tail only when needed
+  ring_index* index = &ring->shared->reply_index;
+  unsigned int head = atomic_load_explicit(&index->head, memory_order_relaxed);
+  if (head == ring->reply_limit) {
+    ring->reply_limit =
+        atomic_load_explicit(&index->tail, memory_order_acquire);
+    if (head == ring->reply_limit) return false;
+  }
+
+  // Take: The frame, then free its space
+  *reply = ring->shared->reply[head & (RING_FRAMES - 1)];
+  atomic_store_explicit(&index->head, head + 1, memory_order_release);
+  return true;
+}
+
+/**
+ * @brief This function will ask serve_ring() to return, it is safe to call
+ * from a signal handler. The function returns nothing.
+ * @return void (nothing)
+ */
+void stop_ring() { atomic_store(&serving_ring, false); }
+
+/**
+ * @brief This function will apply the commands of 'count' frames starting at
+ * the command ring position 'head' and write their replies starting at the
+ * reply ring position 'tail'. Consecutive deposits and withdrawals are
+ * applied as a single batch, a balance command first applies the ones before
+ * it.
+ */
+static void apply_commands(BANK bank, ring_shared* shared, unsigned int head,
+                           unsigned int tail, unsigned int count) {
+  batch_op ops[RING_BATCH];
+  int results[RING_BATCH];
+  unsigned int frame_of[RING_BATCH];
+  unsigned int pending = 0;
+
+  for (unsigned int i = 0; i <= count; i++) {
+    const ring_command* command =
+        (i < count) ? &shared->command[(head + i) & (RING_FRAMES - 1)] : NULL;
+    ring_reply* reply = &shared->reply[(tail + i) & (RING_FRAMES - 1)];
+
+    // Apply: The pending batch, before a balance and at the end
+    if (pending > 0 &&
+        (command == NULL || command->operation == RING_BALANCE)) {
+      bank_apply_batch(bank, ops, pending, results);
+      for (unsigned int j = 0; j < pending; j++) {
+        ring_reply* done =
+            &shared->reply[(tail + frame_of[j]) & (RING_FRAMES - 1)];
+        done->result = results[j];
+        if (results[j] != BATCH_DONE)
+          memset(done->notes, 0, sizeof(done->notes));
+      }
+      pending = 0;
+    }
+    if (command == NULL) break;
+
+    // Reply: Everything but the result of the batch
+    memset(reply, 0, sizeof(ring_reply));
+    reply->tag = command->tag;
+    reply->amount = command->amount;
+    switch (command->operation) {
+      case RING_DEPOSIT:
+      case RING_WITHDRAW:
+        ops[pending].id = command->account;
+        ops[pending].type = (command->operation == RING_DEPOSIT)
+                                ? BATCH_DEPOSIT
+                                : BATCH_WITHDRAW;
+        ops[pending].amount = command->amount;
+        frame_of[pending++] = i;
+        break;
+      case RING_WITHDRAW_CASH: {
+        cash_element cash;
+        if (prefer_cash(&cash, command->amount, command->denominations,
+                        RING_DENOMINATIONS) == false) {
+          reply->result = RING_BAD_DENOMINATION;
+          break;
+        }
+        reply->notes[0] = cash._Rs1_coins;
+        reply->notes[1] = cash._Rs2_coins;
+        reply->notes[2] = cash._Rs5_coins;
+        reply->notes[3] = cash._Rs10_notes;
+        reply->notes[4] = cash._Rs50_notes;
+        reply->notes[5] = cash._Rs100_notes;
+        reply->notes[6] = cash._Rs500_notes;
+        reply->notes[7] = cash._Rs2000_notes;
+        ops[pending].id = command->account;
+        ops[pending].type = BATCH_WITHDRAW_CASH;
+        ops[pending].amount = command->amount;
+        frame_of[pending++] = i;
+        break;
+      }
+      case RING_BALANCE: {
+        account_element account;
+        char name[1];
+        reply->result = (snapshot_account(bank, command->account, &account,
+                                          name, sizeof(name)) == true)
+                            ? BATCH_DONE
+                            : BATCH_NO_ACCOUNT;
+        reply->amount = (reply->result == BATCH_DONE) ? account.amount : 0;
+        break;
+      }
+      default:
+        reply->result = RING_BAD_OPERATION;
+    }
+  }
+}
+
+/**
+ * @brief This function will serve the commands of the ring (engine's side)
+ * till stop_ring() is called. The commands at hand are taken at once, their
+ * deposits and withdrawals applied as a single batch and the replies
+ * published at once, thus the positions are written once per batch. The
+ * commands name the account directly, the shared memory is trusted. Returns
+ * the number of commands served.
+ * @param bank The bank's data struture reference
+ * @param ring The ring's data structure reference
+ * @return number of commands
+ */
+long long unsigned int serve_ring(BANK bank, RING ring) {
+  // Check: Wether the bank and ring exist!
+  if (bank == NULL || ring == NULL) return 0;
+
+  ring_shared* shared = ring->shared;
+  long long unsigned int served = 0;
+  unsigned int idle = 0;
+  atomic_store(&serving_ring, true);
+  while (atomic_load_explicit(&serving_ring, memory_order_relaxed) == true) {
+    // Check: The commands at hand, and the space for their replies
+    unsigned int head = atomic_load_explicit(&shared->command_index.head,
+                                             memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&shared->reply_index.tail,
+                                             memory_order_relaxed);
+    unsigned int commands =
+        atomic_load_explicit(&shared->command_index.tail,
+                             memory_order_acquire) -
+        head;
+    unsigned int space =
+        RING_FRAMES - (tail - atomic_load_explicit(&shared->reply_index.head,
+                                                   memory_order_acquire));
+    unsigned int count = (commands < space) ? commands : space;
+    if (count > RING_BATCH) count = RING_BATCH;
+
+    // Wait: Yield, then sleep a little while idle
+    if (count == 0) {
+      if (++idle < RING_SPIN)
+        sched_yield();
+      else {
+        struct timespec nap = {0, 50000};
+        nanosleep(&nap, NULL);
+      }
+      continue;
+    }
+    idle = 0;
+
+    // Serve: The batch, make it durable, then publish both positions
+    apply_commands(bank, shared, head, tail, count);
+    sync_journal(bank->journal);
+    atomic_store_explicit(&shared->reply_index.tail, tail + count,
+                          memory_order_release);
+    atomic_store_explicit(&shared->command_index.head, head + count,
+                          memory_order_release);
+    served += count;
+  }
+
+  // Status: Number of commands served
+  return served;
+}
@@ -0,0 +1,212 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file ring.h
+ * @brief Interface of the shared memory command rings
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef RING_H
+#define RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "bank.h"
+
+/**
+ * @brief Number of frames of each ring (a power of two)
+ */
+#define RING_FRAMES 4096
+
+/**
+ * @brief Maximum number of commands taken (and applied as a batch) at once
+ */
+#define RING_BATCH 256
+
+/**
+ * @brief Number of denominations of a cash withdrawal
+ */
+#define RING_DENOMINATIONS 8
+
+/**
+ * @brief The operations of a command frame
+ */
+enum { RING_DEPOSIT, RING_WITHDRAW, RING_WITHDRAW_CASH, RING_BALANCE };
+
+/**
+ * @brief The results of a reply frame, beyond the ones of a batch (BATCH_DONE,
+ * BATCH_NO_ACCOUNT, BATCH_BAD_AMOUNT, BATCH_NOT_ENOUGH, BATCH_NO_MEMORY and
+ * BATCH_LIMITED)
+ */
+enum { RING_BAD_OPERATION = 16, RING_BAD_DENOMINATION };
+
+/**
+ * @brief Structure of a command frame. The denominations of a cash withdrawal
+ * are given in the order of preference (0 ends them), the 'tag' is copied
+ * into the reply.
+ */
+typedef struct {
+  long long unsigned int tag;
+  unsigned int operation;
+  unsigned int account;
+  long long int amount;
+  unsigned short denominations[RING_DENOMINATIONS];
+} ring_command;
+
+/**
+ * @brief Structure of a reply frame, the 'amount' is the balance of a balance
+ * command and the 'notes' are the counts of Rs. 1, 2, 5, 10, 50, 100, 500 and
+ * 2000 of a cash withdrawal
+ */
+typedef struct {
+  long long unsigned int tag;
+  int result;
+  long long int amount;
+  int notes[RING_DENOMINATIONS];
+} ring_reply;
+
+/**
+ * @brief Structure of the positions of a ring, each written by a single side
+ * (thus on a cache line of its own)
+ */
+typedef struct {
+  _Alignas(64) atomic_uint head;
+  _Alignas(64) atomic_uint tail;
+} ring_index;
+
+/**
+ * @brief Structure of the shared memory, i.e. the command ring (client to
+ * engine) and the reply ring (engine to client)
+ */
+typedef struct {
+  unsigned int magic;
+  unsigned int frames;
+  ring_index command_index;
+  ring_command command[RING_FRAMES];
+  ring_index reply_index;
+  ring_reply reply[RING_FRAMES];
+} ring_shared;
+
+/**
+ * @brief Structure of a side's view of the rings, the last seen position of
+ * the other side is cached thus the shared one is read only when needed
+ */
+typedef struct {
+  ring_shared* shared;
+  char name[256];
+  bool owner;
+  unsigned int command_limit;
+  unsigned int reply_limit;
+} ring_element;
+
+/**
+ * @brief Ring's Data structure Reference
+ */
+#define RING ring_element*
+
+/**
+ * @brief This function will create the (empty) rings in the shared memory of
+ * the given 'name' (e.g. "/bank"), readable and writable by the owner only,
+ * on the engine's side. Returns the rings as a reference (not copy, thus need
+ * to be freed after usage), otherwise returns 'NULL'.
+ * @param name The name of the shared memory
+ * @return RING (reference, not copy) or 'NULL'
+ */
+RING create_ring(const char* name);
+
+/**
+ * @brief This function will attach to the rings in the shared memory of the
+ * given 'name' on the client's side. Returns the rings as a reference (not
+ * copy, thus need to be freed after usage), otherwise returns 'NULL'.
+ * @param name The name of the shared memory
+ * @return RING (reference, not copy) or 'NULL'
+ */
+RING attach_ring(const char* name);
+
+/**
+ * @brief This function will detach from the rings, the engine's side removes
+ * the shared memory as well. Returns 'true' if deleted, otherwise returns
+ * 'false'.
+ * @param ring The ring's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_ring(RING ring);
+
+/**
+ * @brief This function will put the command into the command ring (client's
+ * side, single producer). Returns 'true' if submitted, otherwise returns
+ * 'false' if the ring is full.
+ * @param ring The ring's data structure reference
+ * @param command The command frame
+ * @return 'true' or 'false'
+ */
+bool ring_submit(RING ring, const ring_command* command);
+
+/**
+ * @brief This function will take the next reply out of the reply ring
+ * (client's side, single consumer). Returns 'true' if received, otherwise
+ * returns 'false' if the ring is empty.
+ * @param ring The ring's data structure reference
+ * @param reply The space for the reply frame
+ * @return 'true' or 'false'
+ */
+bool ring_receive(RING ring, ring_reply* reply);
+
+/**
+ * @brief This function will serve the commands of the ring (engine's side)
+ * till stop_ring() is called. The commands at hand are taken at once, their
+ * deposits and withdrawals applied as a single batch and the replies
+ * published at once, thus the positions are written once per batch. The
+ * commands name the account directly, the shared memory is trusted. Returns
+ * the number of commands served.
+ * @param bank The bank's data struture reference
+ * @param ring The ring's data structure reference
+ * @return number of commands
+ */
+long long unsigned int serve_ring(BANK bank, RING ring);
+
+/**
+ * @brief This function will ask serve_ring() to return, it is safe to call
+ * from a signal handler. The function returns nothing.
+ * @return void (nothing)
+ */
+void stop_ring();
+
+#endif
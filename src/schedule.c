@@ -0,0 +1,474 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file schedule.c
+ * @brief Timers of the idle sessions and the standing orders
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#include "schedule.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "console.h"
+#include "journal.h"
+
+/**
+ * @brief Structure of the state of the timers, a tick is a second since the
+ * start. The data of a timer is the index of its order shifted left with the
+ * lowest bit set, otherwise the address of the flag of an idle session.
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_t thread;
+  bool running;
+  BANK bank;
+  WHEEL wheel;
+  unsigned int idle;
+  double start;
+  schedule_order* order;
+  unsigned int order_quantity;
+  unsigned int order_capacity;
+  unsigned int* due;
+  unsigned int due_quantity;
+  unsigned int runs;
+  unsigned int skipped;
+  unsigned int dropped;
+  unsigned int expired;
+} schedule_state;
+
+/**
+ * @brief The timers of the bank
+ */
+static schedule_state schedule = {.lock = PTHREAD_MUTEX_INITIALIZER,
+                                  .wake = PTHREAD_COND_INITIALIZER};
+
+/**
+ * @brief This function will return the current time of a monotonic clock in
+ * seconds.
+ */
+static double now_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief This function will return the current tick (the state must be
+ * held).
+ */
+static long long unsigned int now_tick() {
+  return (long long unsigned int)(now_seconds() - schedule.start);
+}
+
+/**
+ * @brief This function will take the data of an expired timer, either
+ * flagging the idle session or collecting the order due (the state is held).
+ */
+static void expire_timer(void* context, long long unsigned int data) {
+  (void)context;
+  if ((data & 1) == 0) {
+    atomic_store((atomic_int*)(uintptr_t)data, 1);
+    schedule.expired++;
+    return;
+  }
+  unsigned int index = (unsigned int)(data >> 1);
+  schedule.order[index].timer = WHEEL_NONE;
+  schedule.due[schedule.due_quantity++] = index;
+}
+
+/**
+ * @brief The outcomes of a standing order being run
+ */
+enum { ORDER_DROPPED, ORDER_SKIPPED, ORDER_RUN };
+
+/**
+ * @brief This function will run a single standing order (copied out of the
+ * state), i.e. its transfer, and return its outcome.
+ */
+static int run_order(BANK bank, const schedule_order* order) {
+  // Check: The account paying is still the owner's
+  if (check_owner(bank, order->from, order->owner, order->generation) ==
+      false)
+    return ORDER_DROPPED;
+
+  // Transfer: Skipped while the balance is not enough
+  if (account_withdraw(bank, order->from, order->generation, order->amount) !=
+      DEBIT_DONE)
+    return ORDER_SKIPPED;
+  if (account_deposit(bank, order->to, BANK_ANY_GENERATION, order->amount) ==
+      false) {
+    account_deposit(bank, order->from, order->generation, order->amount);
+    return ORDER_DROPPED;
+  }
+  return ORDER_RUN;
+}
+
+/**
+ * @brief This function is the body of the timer thread, it moves the wheel
+ * every second and runs the orders due till the timers are stopped.
+ */
+static void* run_schedule(void* argument) {
+  (void)argument;
+  set_console(null_console());
+  pthread_mutex_lock(&schedule.lock);
+  while (schedule.running == true) {
+    // Wait: For the next tick or the stop
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += 1;
+    int waited = 0;
+    while (schedule.running == true && waited != ETIMEDOUT)
+      waited = pthread_cond_timedwait(&schedule.wake, &schedule.lock,
+                                      &deadline);
+    if (schedule.running == false) break;
+
+    // Advance: The wheel, the idle sessions are flagged on the way
+    schedule.due_quantity = 0;
+    wheel_advance(schedule.wheel, now_tick(), expire_timer, NULL);
+    unsigned int quantity = schedule.due_quantity;
+    if (quantity == 0) continue;
+
+    // Copy: The orders due, thus they are run without holding the state
+    schedule_order* due =
+        (schedule_order*)malloc(quantity * sizeof(schedule_order));
+    int* outcome = (int*)malloc(quantity * sizeof(int));
+    if (due == NULL || outcome == NULL) {
+      for (unsigned int i = 0; i < quantity; i++) {
+        unsigned int index = schedule.due[i];
+        schedule.order[index].timer =
+            wheel_add(schedule.wheel, schedule.order[index].next,
+                      ((long long unsigned int)index << 1) | 1);
+      }
+      free(due);
+      free(outcome);
+      continue;
+    }
+    for (unsigned int i = 0; i < quantity; i++)
+      due[i] = schedule.order[schedule.due[i]];
+    pthread_mutex_unlock(&schedule.lock);
+
+    // Run: Every order due, then the journal is made durable once
+    for (unsigned int i = 0; i < quantity; i++)
+      outcome[i] = run_order(schedule.bank, &due[i]);
+    sync_journal(schedule.bank->journal);
+
+    // Rearm: The orders still active for their next period
+    pthread_mutex_lock(&schedule.lock);
+    for (unsigned int i = 0; i < quantity; i++) {
+      unsigned int index = schedule.due[i];
+      schedule_order* order = &schedule.order[index];
+      if (outcome[i] == ORDER_DROPPED) {
+        order->active = false;
+        schedule.dropped++;
+        continue;
+      }
+      if (outcome[i] == ORDER_RUN) {
+        order->runs++;
+        schedule.runs++;
+      } else {
+        order->skipped++;
+        schedule.skipped++;
+      }
+      order->next += order->seconds;
+      order->timer = wheel_add(schedule.wheel, order->next,
+                               ((long long unsigned int)index << 1) | 1);
+    }
+    free(due);
+    free(outcome);
+  }
+  pthread_mutex_unlock(&schedule.lock);
+  return NULL;
+}
+
+/**
+ * @brief This function will start the timers of the bank on a background
+ * thread ticking every second: the sessions idle for 'idle' seconds (never
+ * if 0) are logged out, and the standing orders are run when due. Every
+ * timer lies in a hierarchical timer wheel, thus a tick costs O(1) per
+ * timer expiring whatever the number of timers. Returns 'true' if started,
+ * otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param idle The seconds a session may stay idle (0 for ever)
+ * @return 'true' or 'false'
+ */
+bool start_schedule(BANK bank, unsigned int idle) {
+  // Check: Whether the bank exist, and not started yet!
+  if (bank == NULL) return false;
+  pthread_mutex_lock(&schedule.lock);
+  if (schedule.running == true) {
+    pthread_mutex_unlock(&schedule.lock);
+    return false;
+  }
+
+  // Configure: The state, then start the thread
+  schedule.wheel = create_wheel();
+  if (schedule.wheel == NULL) {
+    pthread_mutex_unlock(&schedule.lock);
+    console_printf("\e[38;5;196mError:\e[0m Can't start the timers.\n");
+    return false;
+  }
+  schedule.bank = bank;
+  schedule.idle = idle;
+  schedule.start = now_seconds();
+  schedule.running = true;
+  if (pthread_create(&schedule.thread, NULL, run_schedule, NULL) != 0) {
+    schedule.running = false;
+    delete_wheel(schedule.wheel);
+    schedule.wheel = NULL;
+    pthread_mutex_unlock(&schedule.lock);
+    console_printf("\e[38;5;196mError:\e[0m Can't start the timers.\n");
+    return false;
+  }
+  pthread_mutex_unlock(&schedule.lock);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will stop the timers, waiting for the orders being
+ * run (if any), and drop every standing order. The function returns nothing.
+ * @return void (nothing)
+ */
+void stop_schedule() {
+  pthread_mutex_lock(&schedule.lock);
+  bool running = schedule.running;
+  schedule.running = false;
+  pthread_cond_signal(&schedule.wake);
+  pthread_mutex_unlock(&schedule.lock);
+  if (running == false) return;
+  pthread_join(schedule.thread, NULL);
+
+  // Clean: The wheel and every order
+  pthread_mutex_lock(&schedule.lock);
+  for (unsigned int i = 0; i < schedule.order_quantity; i++)
+    free(schedule.order[i].owner);
+  free(schedule.order);
+  free(schedule.due);
+  delete_wheel(schedule.wheel);
+  schedule.order = NULL;
+  schedule.due = NULL;
+  schedule.wheel = NULL;
+  schedule.order_quantity = schedule.order_capacity = 0;
+  pthread_mutex_unlock(&schedule.lock);
+}
+
+/**
+ * @brief This function will add a standing order transferring the 'amount'
+ * from the account 'from' of the user 'owner' to the account 'to' every
+ * 'seconds', the first one is due in 'seconds'. The order is dropped once
+ * the account 'from' is closed or the account 'to' is gone, and skipped
+ * while the balance is not enough. Returns 'true' if added, otherwise
+ * returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param from The account paying
+ * @param owner The user name owning the account paying
+ * @param generation The generation of the account paying (see get_generation)
+ * @param to The account paid
+ * @param amount The amount of every transfer
+ * @param seconds The period of the transfers
+ * @return 'true' or 'false'
+ */
+bool add_order(BANK bank, int from, const char* owner,
+               unsigned int generation, int to, long long int amount,
+               unsigned int seconds) {
+  // Check: Wether somebody is logged in, the order makes sense and the
+  // accounts exist!
+  account_element account;
+  if (bank == NULL) return false;
+  if (from < 0 || owner == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Login required.\n");
+    return false;
+  }
+  if (amount <= 0 || seconds == 0 ||
+      from == to || to < 0 ||
+      check_owner(bank, from, owner, generation) == false ||
+      get_account(bank, to, &account) == false)
+    return false;
+  char* name = strdup(owner);
+  if (name == NULL) return false;
+
+  // Check: Whether the timers are started
+  pthread_mutex_lock(&schedule.lock);
+  if (schedule.running == false) {
+    pthread_mutex_unlock(&schedule.lock);
+    free(name);
+    console_printf("\e[38;5;196mError:\e[0m The timers are not started.\n");
+    return false;
+  }
+
+  // Grow: The orders, and the orders due along (every order may be due)
+  if (schedule.order_quantity == schedule.order_capacity) {
+    unsigned int capacity =
+        (schedule.order_capacity == 0) ? 64 : schedule.order_capacity * 2;
+    schedule_order* order = (schedule_order*)realloc(
+        schedule.order, capacity * sizeof(schedule_order));
+    if (order != NULL) schedule.order = order;
+    unsigned int* due =
+        (order != NULL)
+            ? (unsigned int*)realloc(schedule.due,
+                                     capacity * sizeof(unsigned int))
+            : NULL;
+    if (due != NULL) schedule.due = due;
+    if (order == NULL || due == NULL) {
+      pthread_mutex_unlock(&schedule.lock);
+      free(name);
+      return false;
+    }
+    schedule.order_capacity = capacity;
+  }
+
+  // Add: The order and its first timer
+  unsigned int index = schedule.order_quantity;
+  schedule_order* order = &schedule.order[index];
+  order->from = from;
+  order->generation = generation;
+  order->to = to;
+  order->amount = amount;
+  order->seconds = seconds;
+  order->owner = name;
+  order->next = schedule.wheel->now + seconds;
+  order->timer = wheel_add(schedule.wheel, order->next,
+                           ((long long unsigned int)index << 1) | 1);
+  order->runs = order->skipped = 0;
+  order->active = order->timer != WHEEL_NONE;
+  if (order->active == false) {
+    pthread_mutex_unlock(&schedule.lock);
+    free(name);
+    return false;
+  }
+  schedule.order_quantity++;
+  pthread_mutex_unlock(&schedule.lock);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will (re)arm the idle timer of a session after its
+ * command, so that 'expired' is set once the session stays idle for too
+ * long. The previous timer (held in 'timer', WHEEL_NONE if none) is
+ * cancelled unless expired already, and a new one is added only if 'armed'
+ * (e.g. somebody is logged in). The function returns nothing.
+ * @param expired The flag of the session set on expiry
+ * @param timer The idle timer of the session
+ * @param armed Whether to add a new timer
+ * @return void (nothing)
+ */
+void watch_idle(atomic_int* expired, unsigned int* timer, bool armed) {
+  pthread_mutex_lock(&schedule.lock);
+
+  // Cancel: The previous timer, unless it is gone by expiring meanwhile
+  if (atomic_exchange(expired, 0) == 0 && *timer != WHEEL_NONE &&
+      schedule.wheel != NULL)
+    wheel_cancel(schedule.wheel, *timer);
+  *timer = WHEEL_NONE;
+
+  // Add: The timer of the next idle period
+  if (armed == true && schedule.running == true && schedule.idle != 0)
+    *timer = wheel_add(schedule.wheel, schedule.wheel->now + schedule.idle,
+                       (long long unsigned int)(uintptr_t)expired);
+  pthread_mutex_unlock(&schedule.lock);
+}
+
+/**
+ * @brief This function will tell whether the idle timer of a session has
+ * expired (once per expiry), the timer is then gone. Returns 'true' if
+ * expired, otherwise returns 'false'.
+ * @param expired The flag of the session set on expiry
+ * @param timer The idle timer of the session
+ * @return 'true' or 'false'
+ */
+bool idle_expired(atomic_int* expired, unsigned int* timer) {
+  if (atomic_exchange(expired, 0) == 0) return false;
+  *timer = WHEEL_NONE;
+  return true;
+}
+
+/**
+ * @brief This function will display the standing orders and the metrics of
+ * the timers, i.e. the timers pending, the orders run and skipped, and the
+ * sessions logged out for being idle. The function returns nothing.
+ * @return void (nothing)
+ */
+void display_schedule() {
+  pthread_mutex_lock(&schedule.lock);
+
+  // Check: Whether the timers are started
+  if (schedule.running == false) {
+    pthread_mutex_unlock(&schedule.lock);
+    console_printf(
+        "\e[38;5;196mFailure:\e[0m The timers are not started.\n");
+    return;
+  }
+
+  // Display: The metrics, then the orders still active
+  unsigned int active = 0;
+  for (unsigned int i = 0; i < schedule.order_quantity; i++)
+    if (schedule.order[i].active == true) active++;
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Tick \e[38;5;214m%llu\e[0m, "
+      "\e[38;5;214m%u\e[0m timer(s) pending, idle sessions expire after "
+      "%u s (0 for never)\n"
+      "  \e[38;5;214m%u\e[0m of %u standing order(s) active, %u run(s), "
+      "%u skip(s), %u dropped, %u idle session(s) expired\n",
+      schedule.wheel->now, schedule.wheel->pending, schedule.idle, active,
+      schedule.order_quantity, schedule.runs, schedule.skipped,
+      schedule.dropped, schedule.expired);
+  for (unsigned int i = 0, shown = 0; i < schedule.order_quantity && shown < 16;
+       i++) {
+    schedule_order* order = &schedule.order[i];
+    if (order->active == false) continue;
+    console_printf(
+        "  %d -> %d  Rs. %lld every %u s, due at tick %llu (%u run(s), %u "
+        "skip(s))\n",
+        order->from, order->to, order->amount, order->seconds, order->next,
+        order->runs, order->skipped);
+    shown++;
+  }
+  pthread_mutex_unlock(&schedule.lock);
+}
@@ -0,0 +1,146 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file schedule.h
+ * @brief Interface of the timers of the idle sessions and the standing orders
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "bank.h"
+#include "wheel.h"
+
+/**
+ * @brief Structure of a standing order, i.e. the transfer of the 'amount'
+ * from the account 'from' (as long as its owner is still 'owner') to the
+ * account 'to' every 'seconds'. 'timer' is its pending timer and 'next' the
+ * tick it is due at.
+ */
+typedef struct {
+  int from;
+  unsigned int generation;
+  int to;
+  long long int amount;
+  unsigned int seconds;
+  char* owner;
+  unsigned int timer;
+  long long unsigned int next;
+  unsigned int runs;
+  unsigned int skipped;
+  bool active;
+} schedule_order;
+
+/**
+ * @brief This function will start the timers of the bank on a background
+ * thread ticking every second: the sessions idle for 'idle' seconds (never
+ * if 0) are logged out, and the standing orders are run when due. Every
+ * timer lies in a hierarchical timer wheel, thus a tick costs O(1) per
+ * timer expiring whatever the number of timers. Returns 'true' if started,
+ * otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param idle The seconds a session may stay idle (0 for ever)
+ * @return 'true' or 'false'
+ */
+bool start_schedule(BANK bank, unsigned int idle);
+
+/**
+ * @brief This function will stop the timers, waiting for the orders being
+ * run (if any), and drop every standing order. The function returns nothing.
+ * @return void (nothing)
+ */
+void stop_schedule();
+
+/**
+ * @brief This function will add a standing order transferring the 'amount'
+ * from the account 'from' of the user 'owner' to the account 'to' every
+ * 'seconds', the first one is due in 'seconds'. The order is dropped once
+ * the account 'from' is closed or the account 'to' is gone, and skipped
+ * while the balance is not enough. Returns 'true' if added, otherwise
+ * returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param from The account paying
+ * @param owner The user name owning the account paying
+ * @param generation The generation of the account paying (see get_generation)
+ * @param to The account paid
+ * @param amount The amount of every transfer
+ * @param seconds The period of the transfers
+ * @return 'true' or 'false'
+ */
+bool add_order(BANK bank, int from, const char* owner,
+               unsigned int generation, int to, long long int amount,
+               unsigned int seconds);
+
+/**
+ * @brief This function will (re)arm the idle timer of a session after its
+ * command, so that 'expired' is set once the session stays idle for too
+ * long. The previous timer (held in 'timer', WHEEL_NONE if none) is
+ * cancelled unless expired already, and a new one is added only if 'armed'
+ * (e.g. somebody is logged in). The function returns nothing.
+ * @param expired The flag of the session set on expiry
+ * @param timer The idle timer of the session
+ * @param armed Whether to add a new timer
+ * @return void (nothing)
+ */
+void watch_idle(atomic_int* expired, unsigned int* timer, bool armed);
+
+/**
+ * @brief This function will tell whether the idle timer of a session has
+ * expired (once per expiry), the timer is then gone. Returns 'true' if
+ * expired, otherwise returns 'false'.
+ * @param expired The flag of the session set on expiry
+ * @param timer The idle timer of the session
+ * @return 'true' or 'false'
+ */
+bool idle_expired(atomic_int* expired, unsigned int* timer);
+
+/**
+ * @brief This function will display the standing orders and the metrics of
+ * the timers, i.e. the timers pending, the orders run and skipped, and the
+ * sessions logged out for being idle. The function returns nothing.
+ * @return void (nothing)
+ */
+void display_schedule();
+
+#endif
@@ -0,0 +1,615 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file script.c
+ * @brief Parallel executor of the batch scripts, partitioned by account
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "script.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "console.h"
+#include "snapshot.h"
+
+/**
+ * @brief Structure of a parsed script. The operations are partitioned by
+ * account, i.e. 'order' lists the operations of the partition 'p' from
+ * 'first[p]' to 'first[p + 1]', in the order of the script.
+ */
+typedef struct {
+  batch_op* ops;
+  unsigned int n;
+  unsigned int capacity;
+  size_t invalid;
+  unsigned int* order;
+  unsigned int* first;
+  unsigned int partitions;
+} script_plan;
+
+struct script_pool;
+
+/**
+ * @brief Structure of a worker of the pool, 'range' packs the partitions the
+ * worker still owns as head (low half) and tail (high half). The owner takes
+ * them from the head and the thieves from the tail.
+ */
+typedef struct {
+  _Alignas(64) long long unsigned int range;
+  struct script_pool* pool;
+  unsigned int index;
+  unsigned int steals;
+} script_worker;
+
+/**
+ * @brief Structure of the work-stealing pool running a plan, either on the
+ * bank (holding the stripes) or on a private copy of the balances
+ */
+typedef struct script_pool {
+  const script_plan* plan;
+  BANK bank;
+  long long int* balance;
+  int* results;
+  unsigned int workers;
+  script_worker worker[SCRIPT_MAX_WORKERS];
+} script_pool;
+
+/**
+ * @brief This function will return the current time of a monotonic clock in
+ * seconds.
+ */
+static double now_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief This function will parse the unsigned decimal number in between
+ * 'begin' and 'end' into 'value'. Returns 'true' if the field is a number that
+ * fits in 18 digits, otherwise returns 'false'.
+ */
+static bool parse_number(const char* begin, const char* end,
+                         long long unsigned int* value) {
+  // Check: Non empty and can't overflow
+  if (begin == end || end - begin > 18) return false;
+
+  // Parse: Digit by digit
+  long long unsigned int result = 0;
+  for (const char* c = begin; c < end; c++) {
+    if (*c < '0' || *c > '9') return false;
+    result = result * 10 + (*c - '0');
+  }
+  *value = result;
+  return true;
+}
+
+/**
+ * @brief This function will return the first character from 'c' (till 'end')
+ * which is not a blank, or the first one which is a blank if 'blank' is false.
+ */
+static const char* skip(const char* c, const char* end, bool blank) {
+  while (c < end && (*c == ' ' || *c == '\t') == blank) c++;
+  return c;
+}
+
+/**
+ * @brief This function will parse a single "deposit|withdraw (account-id)
+ * (amount)" line in between 'begin' and 'end' into 'op'. Returns 'true' if
+ * parsed, otherwise returns 'false' for invalid lines.
+ */
+static bool parse_line(const char* begin, const char* end, batch_op* op) {
+  // Split: Into the operation, account and amount
+  const char* word = skip(begin, end, true);
+  const char* word_end = skip(word, end, false);
+  const char* id = skip(word_end, end, true);
+  const char* id_end = skip(id, end, false);
+  const char* amount = skip(id_end, end, true);
+  const char* amount_end = skip(amount, end, false);
+  if (skip(amount_end, end, true) != end) return false;
+
+  // Parse: Type of the operation
+  size_t length = word_end - word;
+  if (length == 7 && memcmp(word, "deposit", 7) == 0)
+    op->type = BATCH_DEPOSIT;
+  else if (length == 8 && memcmp(word, "withdraw", 8) == 0)
+    op->type = BATCH_WITHDRAW;
+  else
+    return false;
+
+  // Parse: Account and amount, too large accounts never exist
+  long long unsigned int account, value;
+  if (parse_number(id, id_end, &account) == false ||
+      parse_number(amount, amount_end, &value) == false)
+    return false;
+  op->id = (account > UINT_MAX) ? UINT_MAX : account;
+  op->amount = (long long int)value;
+  return true;
+}
+
+/**
+ * @brief This function will load the script at the given 'path' into 'plan',
+ * one operation per valid line. Returns 'true' if loaded, otherwise returns
+ * 'false' (and frees what was loaded).
+ */
+static bool load_script(string path, script_plan* plan) {
+  memset(plan, 0, sizeof(script_plan));
+
+  // Map: The whole file, read only
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't open \e[38;5;214m%s\e[0m.\n", path);
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) == -1 || info.st_size == 0) {
+    console_printf("\e[38;5;196mError:\e[0m Nothing to run.\n");
+    close(fd);
+    return false;
+  }
+  size_t size = info.st_size;
+  const char* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't map \e[38;5;214m%s\e[0m.\n", path);
+    return false;
+  }
+  madvise((void*)data, size, MADV_SEQUENTIAL);
+
+  // Parse: Line by line, skipping the blank lines and comments
+  const char* line = data;
+  const char* stop = data + size;
+  bool failed = false;
+  while (line < stop && failed == false) {
+    const char* next = memchr(line, '\n', stop - line);
+    const char* end = (next == NULL) ? stop : next;
+    const char* trim = (end > line && end[-1] == '\r') ? end - 1 : end;
+    const char* first = skip(line, trim, true);
+    line = end + 1;
+    if (first == trim || *first == '#') continue;
+
+    // Create: Make space for more operations
+    if (plan->n == plan->capacity) {
+      unsigned int capacity = (plan->capacity == 0) ? 4096 : plan->capacity * 2;
+      batch_op* ops =
+          (capacity > plan->capacity)
+              ? (batch_op*)realloc(plan->ops, sizeof(batch_op) * capacity)
+              : NULL;
+      if (ops == NULL) {
+        failed = true;
+        continue;
+      }
+      plan->ops = ops;
+      plan->capacity = capacity;
+    }
+
+    // Parse: Single operation
+    if (parse_line(first, trim, &plan->ops[plan->n]) == true)
+      plan->n++;
+    else
+      plan->invalid++;
+  }
+  munmap((void*)data, size);
+
+  // Check: Whether every line is parsed
+  if (failed) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    free(plan->ops);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief This function will partition the operations of the plan by account,
+ * SCRIPT_SPAN consecutive accounts (out of the 'quantity' existing) per
+ * partition, with a stable counting sort. Operations of accounts which don't
+ * exist get their result right away. Returns 'true' if partitioned,
+ * otherwise returns 'false' if out of memory.
+ */
+static bool partition_script(script_plan* plan, unsigned int quantity,
+                             int results[]) {
+  // Create: The offsets and the order
+  plan->partitions = quantity / SCRIPT_SPAN + 1;
+  plan->first =
+      (unsigned int*)calloc(plan->partitions + 1, sizeof(unsigned int));
+  plan->order = (unsigned int*)malloc(sizeof(unsigned int) * (plan->n + 1));
+  unsigned int* cursor =
+      (unsigned int*)malloc(sizeof(unsigned int) * plan->partitions);
+  if (plan->first == NULL || plan->order == NULL || cursor == NULL) {
+    free(plan->first);
+    free(plan->order);
+    free(cursor);
+    plan->first = plan->order = NULL;
+    return false;
+  }
+
+  // Count: Operations of every partition
+  for (unsigned int i = 0; i < plan->n; i++) {
+    results[i] = BATCH_NO_ACCOUNT;
+    if (plan->ops[i].id < quantity)
+      plan->first[plan->ops[i].id / SCRIPT_SPAN + 1]++;
+  }
+  for (unsigned int p = 0; p < plan->partitions; p++) {
+    plan->first[p + 1] += plan->first[p];
+    cursor[p] = plan->first[p];
+  }
+
+  // Scatter: In the order of the script
+  for (unsigned int i = 0; i < plan->n; i++)
+    if (plan->ops[i].id < quantity)
+      plan->order[cursor[plan->ops[i].id / SCRIPT_SPAN]++] = i;
+  free(cursor);
+  return true;
+}
+
+/**
+ * @brief This function will free what the plan holds.
+ */
+static void free_plan(script_plan* plan) {
+  free(plan->ops);
+  free(plan->order);
+  free(plan->first);
+}
+
+/**
+ * @brief This function will apply a single operation to the given balances,
+ * exactly as a line of the script would be, withdrawals within the limits of
+ * the accounts too if the balances are the 'bank''s (otherwise 'NULL').
+ * Returns the result of the operation (BATCH_DONE, ...).
+ */
+static int apply_op(BANK bank, long long int balance[], const batch_op* op) {
+  // Check: Whether the amount is valid
+  if (op->amount <= 0) return BATCH_BAD_AMOUNT;
+
+  // Apply: Withdraw only the available funds, never overflow a deposit
+  long long int amount = balance[op->id];
+  if (op->type == BATCH_WITHDRAW) {
+    if (bank != NULL)
+      return batch_withdraw(bank, op->id, &balance[op->id], op->amount,
+                            false);
+    if (amount < op->amount) return BATCH_NOT_ENOUGH;
+    balance[op->id] = amount - op->amount;
+  } else {
+    if (amount > LLONG_MAX - op->amount) return BATCH_BAD_AMOUNT;
+    balance[op->id] = amount + op->amount;
+  }
+  return BATCH_DONE;
+}
+
+/**
+ * @brief This function will run the operations of the partition 'p' in the
+ * order of the script, holding the stripe of the partition (and journaling
+ * every change) if run on the bank.
+ */
+static void run_partition(script_pool* pool, unsigned int p) {
+  const script_plan* plan = pool->plan;
+  unsigned int from = plan->first[p], to = plan->first[p + 1];
+  if (from == to) return;
+
+  // Lock: The column can't move while the stripe is held
+  long long int* balance = pool->balance;
+  unsigned int stripe = stripe_of(p * SCRIPT_SPAN);
+  if (pool->bank != NULL) {
+    write_begin(pool->bank->sync, stripe);
+    balance = pool->bank->account.amount;
+  }
+
+  // Apply: Operation by operation, none to a closed account
+  for (unsigned int k = from; k < to; k++) {
+    unsigned int i = plan->order[k];
+    if (pool->bank != NULL &&
+        pool->bank->account.id[plan->ops[i].id] == BANK_CLOSED) {
+      pool->results[i] = BATCH_NO_ACCOUNT;
+      continue;
+    }
+    if (pool->bank != NULL) fold_balance(pool->bank, plan->ops[i].id);
+    pool->results[i] = apply_op(pool->bank, balance, &plan->ops[i]);
+    if (pool->bank != NULL && pool->results[i] == BATCH_DONE)
+      journal_balances(pool->bank->journal, plan->ops[i].id,
+                       &balance[plan->ops[i].id], 1);
+  }
+
+  if (pool->bank != NULL) write_end(pool->bank->sync, stripe);
+}
+
+/**
+ * @brief This function will take a partition of the given worker, from the
+ * head if the caller is the 'owner', otherwise from the tail. Returns the
+ * partition, otherwise returns '-1' if the worker has none left.
+ */
+static long long int take_partition(script_worker* worker, bool owner) {
+  long long unsigned int range =
+      __atomic_load_n(&worker->range, __ATOMIC_ACQUIRE);
+  while (true) {
+    long long unsigned int head = range & 0xFFFFFFFF, tail = range >> 32;
+    if (head >= tail) return -1;
+    long long unsigned int next =
+        (owner == true) ? (tail << 32) | (head + 1) : ((tail - 1) << 32) | head;
+    if (__atomic_compare_exchange_n(&worker->range, &range, next, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+      return (owner == true) ? head : tail - 1;
+  }
+}
+
+/**
+ * @brief This function is the body of a worker thread, it runs its own
+ * partitions and then steals the remaining ones of the others till every
+ * worker has run out of them. Partitions are never added, thus a single pass
+ * over empty workers means the plan is done.
+ */
+static void* work(void* argument) {
+  script_worker* worker = (script_worker*)argument;
+  script_pool* pool = worker->pool;
+
+  // Run: Own partitions, from the head
+  long long int p;
+  while ((p = take_partition(worker, true)) != -1) run_partition(pool, p);
+
+  // Steal: From the tail of the others, one victim after another
+  for (unsigned int k = 1; k < pool->workers;) {
+    script_worker* victim = &pool->worker[(worker->index + k) % pool->workers];
+    if ((p = take_partition(victim, false)) == -1) {
+      k++;
+      continue;
+    }
+    run_partition(pool, p);
+    worker->steals++;
+  }
+  return NULL;
+}
+
+/**
+ * @brief This function will run the plan of the pool on its workers, every
+ * worker owns a contiguous range of the partitions at first (the first one
+ * runs on this thread). A worker that can't be spawned is simply robbed by
+ * the others. Returns the number of partitions stolen.
+ */
+static unsigned int run_pool(script_pool* pool) {
+  // Split: Partitions into one range per worker
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned int partitions = pool->plan->partitions;
+  pool->workers = (online > 0) ? online : 1;
+  if (pool->workers > SCRIPT_MAX_WORKERS) pool->workers = SCRIPT_MAX_WORKERS;
+  if (pool->workers > partitions) pool->workers = partitions;
+  for (unsigned int i = 0; i < pool->workers; i++) {
+    long long unsigned int head =
+        (long long unsigned int)partitions * i / pool->workers;
+    long long unsigned int tail =
+        (long long unsigned int)partitions * (i + 1) / pool->workers;
+    pool->worker[i].range = (tail << 32) | head;
+    pool->worker[i].pool = pool;
+    pool->worker[i].index = i;
+    pool->worker[i].steals = 0;
+  }
+
+  // Run: Every worker in parallel
+  pthread_t thread[SCRIPT_MAX_WORKERS];
+  bool spawned[SCRIPT_MAX_WORKERS] = {false};
+  for (unsigned int i = 1; i < pool->workers; i++)
+    spawned[i] =
+        pthread_create(&thread[i], NULL, work, &pool->worker[i]) == 0;
+  work(&pool->worker[0]);
+  unsigned int steals = pool->worker[0].steals;
+  for (unsigned int i = 1; i < pool->workers; i++) {
+    if (spawned[i]) pthread_join(thread[i], NULL);
+    steals += pool->worker[i].steals;
+  }
+  return steals;
+}
+
+/**
+ * @brief This function will load and partition the script at the given
+ * 'path' for the 'quantity' existing accounts, with space for the result of
+ * every operation. Returns 'true' if prepared, otherwise returns 'false'.
+ */
+static bool prepare_script(string path, unsigned int quantity,
+                           script_plan* plan, int** results) {
+  if (load_script(path, plan) == false) return false;
+  *results = (int*)malloc(sizeof(int) * (plan->n + 1));
+  if (*results == NULL || partition_script(plan, quantity, *results) == false) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    free(*results);
+    free_plan(plan);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief This function will run the script at the given 'path' against the
+ * bank, one "deposit (account-id) (amount)" or "withdraw (account-id)
+ * (amount)" operation per line (blank lines and lines starting with '#' are
+ * skipped). The operations are partitioned by account, keeping the order of
+ * the script within an account, and the partitions are run by a pool of
+ * worker threads which steal partitions from each other once they run out of
+ * their own. Every partition holds the stripe of its accounts while it runs,
+ * thus the final state is the same as running the script line by line.
+ * Returns 'true' if the script is run, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the script file
+ * @return 'true' or 'false'
+ */
+bool run_script(BANK bank, string path) {
+  // Check: Whether the bank and path exist, and every balance is in memory!
+  if (bank == NULL || path == NULL || resident_accounts(bank) == false)
+    return false;
+  double start = now_seconds();
+
+  // Prepare: Accounts added from now on are not known to the script
+  script_plan plan;
+  int* results;
+  unsigned int quantity = refresh_accounts(bank);
+  if (prepare_script(path, quantity, &plan, &results) == false) return false;
+
+  // Run: Straight on the bank
+  script_pool pool;
+  pool.plan = &plan;
+  pool.bank = bank;
+  pool.balance = NULL;
+  pool.results = results;
+  unsigned int steals = run_pool(&pool);
+
+  // Count: Operations done
+  unsigned int done = 0;
+  for (unsigned int i = 0; i < plan.n; i++) done += results[i] == BATCH_DONE;
+
+  // Report: Throughput of the whole script
+  double elapsed = now_seconds() - start;
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Done \e[38;5;214m%u\e[0m operation(s), "
+      "rejected \e[38;5;214m%u\e[0m operation(s) and \e[38;5;214m%zu\e[0m "
+      "line(s)\n"
+      "  over %u partition(s) using %u thread(s) (%u steal(s))\n"
+      "  in %.3f s (\e[38;5;214m%.0f\e[0m operations/second).\n",
+      done, plan.n - done, plan.invalid, plan.partitions, pool.workers, steals,
+      elapsed, (elapsed > 0) ? plan.n / elapsed : 0.0);
+  free(results);
+  free_plan(&plan);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will check the determinism of the executor, i.e. run
+ * the script at the given 'path' line by line on a copy of the balances and
+ * by the work-stealing pool on another copy, then compare the final balances
+ * and the result of every operation. The bank itself is left untouched.
+ * Returns 'true' if both runs match, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the script file
+ * @return 'true' or 'false'
+ */
+bool check_script(BANK bank, string path) {
+  // Check: Whether the bank and path exist, and every balance is in memory!
+  if (bank == NULL || path == NULL || resident_accounts(bank) == false)
+    return false;
+
+  // Prepare: The plan, both copies of the balances and their results
+  script_plan plan;
+  int* results;
+  unsigned int quantity = refresh_accounts(bank);
+  if (prepare_script(path, quantity, &plan, &results) == false) return false;
+  size_t bytes = sizeof(long long int) * quantity;
+  long long int* expected = (long long int*)malloc(bytes + 1);
+  long long int* balance = (long long int*)malloc(bytes + 1);
+  int* sequential = (int*)malloc(sizeof(int) * (plan.n + 1));
+  if (expected == NULL || balance == NULL || sequential == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    free(expected);
+    free(balance);
+    free(sequential);
+    free(results);
+    free_plan(&plan);
+    return false;
+  }
+
+  // Copy: Balances as of now, writers are held out meanwhile
+  write_begin_all(bank->sync);
+  if (quantity > 0) memcpy(expected, bank->account.amount, bytes);
+  write_end_all(bank->sync);
+  if (quantity > 0) memcpy(balance, expected, bytes);
+
+  // Run: Line by line on the first copy
+  double start = now_seconds();
+  for (unsigned int i = 0; i < plan.n; i++)
+    sequential[i] = (plan.ops[i].id < quantity)
+                        ? apply_op(NULL, expected, &plan.ops[i])
+                        : BATCH_NO_ACCOUNT;
+  double middle = now_seconds();
+
+  // Run: By the pool on the second copy
+  script_pool pool;
+  pool.plan = &plan;
+  pool.bank = NULL;
+  pool.balance = balance;
+  pool.results = results;
+  unsigned int steals = run_pool(&pool);
+  double end = now_seconds();
+
+  // Compare: Every result and every balance
+  long long int operation = -1, account = -1;
+  for (unsigned int i = 0; i < plan.n && operation == -1; i++)
+    if (sequential[i] != results[i]) operation = i;
+  for (unsigned int i = 0; i < quantity && account == -1; i++)
+    if (expected[i] != balance[i]) account = i;
+
+  // Report: The first difference, otherwise both runs
+  if (operation != -1 || account != -1) {
+    if (operation != -1)
+      console_printf(
+          "\e[38;5;196mError:\e[0m Operation \e[38;5;214m%lld\e[0m has a "
+          "different result in parallel.\n",
+          operation + 1);
+    if (account != -1)
+      console_printf(
+          "\e[38;5;196mError:\e[0m Account \e[38;5;214m%lld\e[0m has a "
+          "different balance in parallel.\n",
+          account);
+  } else
+    console_printf(
+        "\e[38;5;214mInfo:\e[0m Both runs of \e[38;5;214m%u\e[0m "
+        "operation(s) match over %u account(s)\n"
+        "  line by line in %.3f s, over %u partition(s) using %u thread(s)\n"
+        "  (%u steal(s)) in %.3f s.\n",
+        plan.n, quantity, middle - start, plan.partitions, pool.workers,
+        steals, end - middle);
+  free(expected);
+  free(balance);
+  free(sequential);
+  free(results);
+  free_plan(&plan);
+
+  // Status: Whether the runs match
+  return operation == -1 && account == -1;
+}
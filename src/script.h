@@ -0,0 +1,93 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file script.h
+ * @brief Interface of the parallel executor of the batch scripts
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <stdbool.h>
+
+#include "bank.h"
+#include "cs50.h"
+
+/**
+ * @brief Number of consecutive accounts in a partition of a script, every
+ * partition lies within a single stripe
+ */
+#define SCRIPT_SPAN 256
+
+/**
+ * @brief Maximum number of worker threads used for a script
+ */
+#define SCRIPT_MAX_WORKERS 64
+
+/**
+ * @brief This function will run the script at the given 'path' against the
+ * bank, one "deposit (account-id) (amount)" or "withdraw (account-id)
+ * (amount)" operation per line (blank lines and lines starting with '#' are
+ * skipped). The operations are partitioned by account, keeping the order of
+ * the script within an account, and the partitions are run by a pool of
+ * worker threads which steal partitions from each other once they run out of
+ * their own. Every partition holds the stripe of its accounts while it runs,
+ * thus the final state is the same as running the script line by line.
+ * Returns 'true' if the script is run, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the script file
+ * @return 'true' or 'false'
+ */
+bool run_script(BANK bank, string path);
+
+/**
+ * @brief This function will check the determinism of the executor, i.e. run
+ * the script at the given 'path' line by line on a copy of the balances and
+ * by the work-stealing pool on another copy, then compare the final balances
+ * and the result of every operation. The bank itself is left untouched.
+ * Returns 'true' if both runs match, otherwise returns 'false'.
+ * @param bank The bank's data struture reference
+ * @param path The path of the script file
+ * @return 'true' or 'false'
+ */
+bool check_script(BANK bank, string path);
+
+#endif
@@ -0,0 +1,875 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file server.c
+ * @brief Implementation of the socket front end (io_uring, epoll or blocking)
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#define _GNU_SOURCE
+
+#include "server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "console.h"
+#include "session.h"
+#include "wire.h"
+
+/**
+ * @brief Milliseconds a worker waits for events before checking whether it
+ * still has to serve
+ */
+#define SERVER_TICK 250
+
+/**
+ * @brief Tags of the io_uring completions which are not of a connection
+ */
+#define SERVER_ACCEPTED 1
+#define SERVER_TICKED 2
+
+/**
+ * @brief Whether the workers still have to serve
+ */
+static atomic_bool serving = false;
+
+/**
+ * @brief Structure of a connection, i.e. a session and its socket. The input
+ * buffer holds (at most) one incomplete line (or frame) in between two reads,
+ * the session prints its replies into the output stream which is written at
+ * once.
+ */
+typedef struct connection {
+  int fd;
+  SESSION session;
+  FILE* out;
+  char* output;
+  size_t output_size;
+  size_t sent;
+  char* input;
+  unsigned int used;
+  int slot;
+  bool binary;
+  bool closing;
+  struct connection* prev;
+  struct connection* next;
+} connection;
+
+/**
+ * @brief Structure of the io_uring of a worker, the rings are shared with the
+ * kernel (mapped) and the heads and tails are updated atomically
+ */
+typedef struct {
+  int fd;
+  unsigned int* sq_head;
+  unsigned int* sq_tail;
+  unsigned int* sq_mask;
+  unsigned int* sq_array;
+  unsigned int sq_entries;
+  struct io_uring_sqe* sqes;
+  unsigned int* cq_head;
+  unsigned int* cq_tail;
+  unsigned int* cq_mask;
+  struct io_uring_cqe* cqes;
+  void* sq_ring;
+  size_t sq_size;
+  void* cq_ring;
+  size_t cq_size;
+  size_t sqes_size;
+  unsigned int queued;
+} uring;
+
+/**
+ * @brief Structure of a worker thread and everything it serves
+ */
+typedef struct {
+  BANK bank;
+  int listener;
+  int model;
+  pthread_t thread;
+  char* slots;
+  unsigned int* free_slots;
+  unsigned int free_count;
+  bool fixed;
+  uring ring;
+  struct __kernel_timespec tick;
+  connection* connections;
+  atomic_uint* alive;
+} server_worker;
+
+/**
+ * @brief This function will ask serve() to return, it is safe to call from a
+ * signal handler. The function returns nothing.
+ * @return void (nothing)
+ */
+void stop_serving() { atomic_store(&serving, false); }
+
+/**
+ * @brief This function will create a connection (and its session) for the
+ * accepted socket 'fd', taking a registered input buffer if any is left.
+ * Returns the connection, otherwise returns 'NULL' (the socket is closed).
+ */
+static connection* create_connection(server_worker* worker, int fd) {
+  // Create: Make space for the connection
+  connection* c = (connection*)calloc(1, sizeof(connection));
+  if (c == NULL) {
+    close(fd);
+    return NULL;
+  }
+  c->fd = fd;
+  c->slot = -1;
+
+  // Configure: The input buffer, registered one if any is left
+  if (worker->free_count > 0) {
+    c->slot = worker->free_slots[--worker->free_count];
+    c->input = worker->slots + (size_t)c->slot * SERVER_LINE;
+  } else
+    c->input = (char*)malloc(SERVER_LINE);
+
+  // Configure: The session, printing into the output buffer
+  if (c->input != NULL)
+    c->out = open_memstream(&c->output, &c->output_size);
+  if (c->out != NULL) c->session = create_session(worker->bank, c->out, false);
+  if (c->session == NULL) {
+    if (c->out != NULL) fclose(c->out);
+    free(c->output);
+    if (c->slot != -1)
+      worker->free_slots[worker->free_count++] = c->slot;
+    else
+      free(c->input);
+    free(c);
+    close(fd);
+    return NULL;
+  }
+
+  // Configure: Greet with the prompt and link among the worker's connections
+  session_prompt(c->session);
+  fflush(c->out);
+  c->next = worker->connections;
+  if (c->next != NULL) c->next->prev = c;
+  worker->connections = c;
+  return c;
+}
+
+/**
+ * @brief This function will delete the connection, its session (an open
+ * transaction is aborted) and close its socket.
+ */
+static void delete_connection(server_worker* worker, connection* c) {
+  if (c->prev != NULL) c->prev->next = c->next;
+  if (c->next != NULL) c->next->prev = c->prev;
+  if (worker->connections == c) worker->connections = c->next;
+  delete_session(c->session);
+  fclose(c->out);
+  free(c->output);
+  if (c->slot != -1)
+    worker->free_slots[worker->free_count++] = c->slot;
+  else
+    free(c->input);
+  close(c->fd);
+  free(c);
+}
+
+/**
+ * @brief This function will take the complete request frames out of the input
+ * buffer and perform each of them right where it lies in the buffer, thus
+ * many pipelined requests are served by a single read. Returns the number of
+ * bytes taken, a broken frame closes the connection.
+ */
+static unsigned int serve_frames(connection* c) {
+  unsigned int start = 0;
+  while (c->closing == false && c->used - start >= 4) {
+    unsigned short length;
+    memcpy(&length, c->input + start + 2, sizeof(length));
+    if ((unsigned char)c->input[start] != WIRE_MAGIC ||
+        length != sizeof(wire_request)) {
+      session_feed(c->session, NULL);
+      c->closing = true;
+      break;
+    }
+    if (c->used - start < length) break;
+    c->closing = !session_request(c->session, c->input + start);
+    start += length;
+  }
+  return start;
+}
+
+/**
+ * @brief This function will take the 'received' bytes appended to the input
+ * buffer and feed every complete line to the session, right where it lies in
+ * the buffer. The incomplete line (if any) is moved to the front, a line
+ * longer than the buffer is fed as it is. Afterwards the next prompt is
+ * printed and the output is ready to be written. A connection whose input
+ * starts with the magic byte speaks the binary protocol instead.
+ */
+static void serve_input(connection* c, unsigned int received) {
+  // Check: The protocol, a binary one starts with a frame
+  if (c->used == 0 && (unsigned char)c->input[0] == WIRE_MAGIC)
+    c->binary = true;
+  c->used += received;
+  if (c->binary == true) {
+    unsigned int taken = serve_frames(c);
+    memmove(c->input, c->input + taken, c->used - taken);
+    c->used -= taken;
+    fflush(c->out);
+    return;
+  }
+
+  // Feed: Every complete line, in place
+  unsigned int start = 0;
+  for (unsigned int i = start; i < c->used && c->closing == false; i++) {
+    if (c->input[i] != '\n') continue;
+    c->input[i] = '\0';
+    if (i > start && c->input[i - 1] == '\r') c->input[i - 1] = '\0';
+    c->closing = !session_feed(c->session, c->input + start);
+    start = i + 1;
+  }
+
+  // Move: The incomplete line, unless it fills the buffer
+  if (c->closing == false && start == 0 && c->used == SERVER_LINE - 1) {
+    c->input[c->used] = '\0';
+    c->closing = !session_feed(c->session, c->input);
+    start = c->used;
+  }
+  memmove(c->input, c->input + start, c->used - start);
+  c->used -= start;
+
+  // Prompt: For the next line
+  if (c->closing == false) session_prompt(c->session);
+  fflush(c->out);
+}
+
+/**
+ * @brief This function will take the input is over (or broken) of the
+ * connection, the session is closed.
+ */
+static void end_input(connection* c) {
+  session_feed(c->session, NULL);
+  c->closing = true;
+  fflush(c->out);
+}
+
+/**
+ * @brief This function will take the output is written, the output stream
+ * starts over.
+ */
+static void reset_output(connection* c) {
+  rewind(c->out);
+  fflush(c->out);
+  c->sent = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// io_uring
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief This function will set up the io_uring of the worker and register
+ * its input buffers (if possible). Returns 'true' if set up, otherwise
+ * returns 'false' (e.g. io_uring is not available).
+ */
+static bool create_uring(server_worker* worker) {
+  uring* ring = &worker->ring;
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = SERVER_QUEUE * 16;
+  ring->fd = syscall(__NR_io_uring_setup, SERVER_QUEUE, &params);
+  if (ring->fd < 0) return false;
+
+  // Map: The submission and completion rings, and the submission entries
+  ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    if (ring->cq_size > ring->sq_size) ring->sq_size = ring->cq_size;
+    ring->cq_size = ring->sq_size;
+  }
+  ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sq_ring = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+  ring->cq_ring =
+      (params.features & IORING_FEAT_SINGLE_MMAP)
+          ? ring->sq_ring
+          : mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+  ring->sqes = (struct io_uring_sqe*)mmap(
+      NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+      ring->fd, IORING_OFF_SQES);
+  if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED ||
+      ring->sqes == MAP_FAILED) {
+    if (ring->sq_ring != MAP_FAILED) munmap(ring->sq_ring, ring->sq_size);
+    if (ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring)
+      munmap(ring->cq_ring, ring->cq_size);
+    if (ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+    close(ring->fd);
+    return false;
+  }
+  char* sq = (char*)ring->sq_ring;
+  char* cq = (char*)ring->cq_ring;
+  ring->sq_head = (unsigned int*)(sq + params.sq_off.head);
+  ring->sq_tail = (unsigned int*)(sq + params.sq_off.tail);
+  ring->sq_mask = (unsigned int*)(sq + params.sq_off.ring_mask);
+  ring->sq_array = (unsigned int*)(sq + params.sq_off.array);
+  ring->sq_entries = params.sq_entries;
+  ring->cq_head = (unsigned int*)(cq + params.cq_off.head);
+  ring->cq_tail = (unsigned int*)(cq + params.cq_off.tail);
+  ring->cq_mask = (unsigned int*)(cq + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+  ring->queued = 0;
+
+  // Register: The input buffers as a single region, read with no mapping
+  struct iovec region = {worker->slots, (size_t)SERVER_SLOTS * SERVER_LINE};
+  worker->fixed = syscall(__NR_io_uring_register, ring->fd,
+                          IORING_REGISTER_BUFFERS, &region, 1) == 0;
+  return true;
+}
+
+/**
+ * @brief This function will tear down the io_uring of the worker, every
+ * operation still in flight is cancelled.
+ */
+static void delete_uring(server_worker* worker) {
+  uring* ring = &worker->ring;
+  munmap(ring->sqes, ring->sqes_size);
+  if (ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_size);
+  munmap(ring->sq_ring, ring->sq_size);
+  close(ring->fd);
+}
+
+/**
+ * @brief This function will submit the queued entries to the kernel and wait
+ * for (at least) 'wait' completions.
+ */
+static void submit_uring(uring* ring, unsigned int wait) {
+  int done = syscall(__NR_io_uring_enter, ring->fd, ring->queued, wait,
+                     (wait > 0) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+  if (done > 0) ring->queued -= (unsigned int)done;
+}
+
+/**
+ * @brief This function will return the next free submission entry (cleared),
+ * the queued entries are submitted first if the ring is full.
+ */
+static struct io_uring_sqe* next_entry(uring* ring) {
+  unsigned int tail = *ring->sq_tail;
+  while (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) ==
+         ring->sq_entries)
+    submit_uring(ring, 0);
+  unsigned int index = tail & *ring->sq_mask;
+  struct io_uring_sqe* sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  ring->sq_array[index] = index;
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ring->queued++;
+  return sqe;
+}
+
+/**
+ * @brief This function will queue the read of the connection's input, into
+ * its registered buffer if it has one.
+ */
+static void queue_read(server_worker* worker, connection* c) {
+  struct io_uring_sqe* sqe = next_entry(&worker->ring);
+  sqe->opcode = (worker->fixed && c->slot != -1) ? IORING_OP_READ_FIXED
+                                                 : IORING_OP_RECV;
+  sqe->fd = c->fd;
+  sqe->addr = (unsigned long)(c->input + c->used);
+  sqe->len = SERVER_LINE - 1 - c->used;
+  sqe->buf_index = 0;
+  sqe->user_data = (unsigned long)c;
+}
+
+/**
+ * @brief This function will queue the write of the connection's output, i.e.
+ * whatever is not sent yet.
+ */
+static void queue_write(server_worker* worker, connection* c) {
+  struct io_uring_sqe* sqe = next_entry(&worker->ring);
+  sqe->opcode = IORING_OP_SEND;
+  sqe->fd = c->fd;
+  sqe->addr = (unsigned long)(c->output + c->sent);
+  sqe->len = c->output_size - c->sent;
+  sqe->msg_flags = MSG_NOSIGNAL;
+  sqe->user_data = (unsigned long)c | 1;
+}
+
+/**
+ * @brief This function will queue the next operation of the connection: the
+ * write of its output if any, otherwise the read of its input. A closing
+ * connection without output is deleted.
+ */
+static void queue_next(server_worker* worker, connection* c) {
+  if (c->sent < c->output_size)
+    queue_write(worker, c);
+  else if (c->closing == true)
+    delete_connection(worker, c);
+  else
+    queue_read(worker, c);
+}
+
+/**
+ * @brief This function will queue the accept of the next connection.
+ */
+static void queue_accept(server_worker* worker) {
+  struct io_uring_sqe* sqe = next_entry(&worker->ring);
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = worker->listener;
+  sqe->user_data = SERVER_ACCEPTED << 1;
+}
+
+/**
+ * @brief This function will queue the tick, i.e. a timeout which wakes the
+ * worker up to check whether it still has to serve.
+ */
+static void queue_tick(server_worker* worker) {
+  struct io_uring_sqe* sqe = next_entry(&worker->ring);
+  sqe->opcode = IORING_OP_TIMEOUT;
+  sqe->addr = (unsigned long)&worker->tick;
+  sqe->len = 1;
+  sqe->user_data = SERVER_TICKED << 1;
+}
+
+/**
+ * @brief This function will serve the connections of the worker with its
+ * io_uring: every completion queues the next operation of its connection and
+ * all of them are submitted together with a single system call.
+ */
+static void serve_uring(server_worker* worker) {
+  uring* ring = &worker->ring;
+  worker->tick.tv_sec = 0;
+  worker->tick.tv_nsec = SERVER_TICK * 1000000LL;
+  queue_accept(worker);
+  queue_tick(worker);
+
+  while (atomic_load(&serving) == true) {
+    submit_uring(ring, 1);
+
+    // Reap: Every completion at hand
+    unsigned int head = *ring->cq_head;
+    unsigned int tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+      struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+      unsigned long tag = cqe->user_data;
+      int result = cqe->res;
+
+      // Accepted: A new connection, greet it
+      if (tag == SERVER_ACCEPTED << 1) {
+        if (result >= 0) {
+          connection* c = create_connection(worker, result);
+          if (c != NULL) queue_next(worker, c);
+        }
+        queue_accept(worker);
+      }
+
+      // Ticked: Keep ticking
+      else if (tag == SERVER_TICKED << 1)
+        queue_tick(worker);
+
+      // Written: Continue the output, otherwise read again
+      else if (tag & 1) {
+        connection* c = (connection*)(tag & ~1UL);
+        if (result <= 0) {
+          delete_connection(worker, c);
+          continue;
+        }
+        c->sent += result;
+        if (c->sent == c->output_size) reset_output(c);
+        queue_next(worker, c);
+      }
+
+      // Read: Serve the complete lines
+      else {
+        connection* c = (connection*)tag;
+        if (result > 0)
+          serve_input(c, result);
+        else
+          end_input(c);
+        queue_next(worker, c);
+      }
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// epoll
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief This function will write as much of the connection's output as the
+ * socket takes, then wait for the socket (the output is not complete) or for
+ * the input (the output is complete). A closing connection is deleted once
+ * its output is complete.
+ */
+static void flush_epoll(server_worker* worker, int epoll, connection* c) {
+  while (c->sent < c->output_size) {
+    ssize_t sent = send(c->fd, c->output + c->sent, c->output_size - c->sent,
+                        MSG_NOSIGNAL);
+    if (sent < 0 && errno == EAGAIN) break;
+    if (sent <= 0) {
+      delete_connection(worker, c);
+      return;
+    }
+    c->sent += sent;
+  }
+  struct epoll_event event = {0};
+  event.data.ptr = c;
+  if (c->sent < c->output_size) {
+    event.events = EPOLLOUT;
+    epoll_ctl(epoll, EPOLL_CTL_MOD, c->fd, &event);
+    return;
+  }
+  reset_output(c);
+  if (c->closing == true) {
+    delete_connection(worker, c);
+    return;
+  }
+  event.events = EPOLLIN;
+  epoll_ctl(epoll, EPOLL_CTL_MOD, c->fd, &event);
+}
+
+/**
+ * @brief This function will serve the connections of the worker with epoll,
+ * a connection waits for its input or (while the output is not complete) for
+ * its socket to be writable.
+ */
+static void serve_epoll(server_worker* worker) {
+  int epoll = epoll_create1(0);
+  if (epoll == -1) return;
+  struct epoll_event event = {0};
+  event.events = EPOLLIN | EPOLLEXCLUSIVE;
+  event.data.ptr = NULL;
+  epoll_ctl(epoll, EPOLL_CTL_ADD, worker->listener, &event);
+
+  struct epoll_event events[256];
+  while (atomic_load(&serving) == true) {
+    int ready = epoll_wait(epoll, events, 256, SERVER_TICK);
+    for (int i = 0; i < ready; i++) {
+      connection* c = (connection*)events[i].data.ptr;
+
+      // Accepted: Every new connection, greet it
+      if (c == NULL) {
+        int fd;
+        while ((fd = accept4(worker->listener, NULL, NULL, SOCK_NONBLOCK)) !=
+               -1) {
+          connection* accepted = create_connection(worker, fd);
+          if (accepted == NULL) continue;
+          struct epoll_event added = {0};
+          added.events = EPOLLOUT;
+          added.data.ptr = accepted;
+          epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &added);
+          flush_epoll(worker, epoll, accepted);
+        }
+        continue;
+      }
+
+      // Written: Continue the output
+      if (c->sent < c->output_size) {
+        flush_epoll(worker, epoll, c);
+        continue;
+      }
+
+      // Read: Serve the complete lines
+      ssize_t received = recv(c->fd, c->input + c->used,
+                              SERVER_LINE - 1 - c->used, 0);
+      if (received < 0 && errno == EAGAIN) continue;
+      if (received > 0)
+        serve_input(c, received);
+      else
+        end_input(c);
+      flush_epoll(worker, epoll, c);
+    }
+  }
+  close(epoll);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Blocking (a thread per connection)
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Structure of a blocking connection's thread
+ */
+typedef struct {
+  server_worker worker;
+  int fd;
+} blocking_thread;
+
+/**
+ * @brief This function will serve a single connection, waiting for its input
+ * and writing its output in turn. The 'argument' is the thread's structure.
+ */
+static void* serve_blocking(void* argument) {
+  blocking_thread* thread = (blocking_thread*)argument;
+  server_worker* worker = &thread->worker;
+  connection* c = create_connection(worker, thread->fd);
+  while (c != NULL) {
+    // Write: The whole output
+    while (c->sent < c->output_size) {
+      ssize_t sent = send(c->fd, c->output + c->sent,
+                          c->output_size - c->sent, MSG_NOSIGNAL);
+      if (sent <= 0) break;
+      c->sent += sent;
+    }
+    if (c->sent < c->output_size || c->closing == true) break;
+    reset_output(c);
+
+    // Read: Serve the complete lines
+    struct pollfd input = {c->fd, POLLIN, 0};
+    if (poll(&input, 1, SERVER_TICK) == 0) {
+      if (atomic_load(&serving) == false) break;
+      continue;
+    }
+    ssize_t received =
+        recv(c->fd, c->input + c->used, SERVER_LINE - 1 - c->used, 0);
+    if (received > 0)
+      serve_input(c, received);
+    else
+      end_input(c);
+  }
+  if (c != NULL) delete_connection(worker, c);
+  atomic_fetch_sub(worker->alive, 1);
+  free(thread);
+  return NULL;
+}
+
+/**
+ * @brief This function will accept the connections and start a thread for
+ * each of them, waiting for every one of them to finish at the end.
+ */
+static void accept_blocking(server_worker* worker) {
+  while (atomic_load(&serving) == true) {
+    struct pollfd listener = {worker->listener, POLLIN, 0};
+    if (poll(&listener, 1, SERVER_TICK) <= 0) continue;
+    int fd = accept(worker->listener, NULL, NULL);
+    if (fd == -1) continue;
+
+    // Create: A thread of its own, sharing nothing but the bank
+    blocking_thread* thread =
+        (blocking_thread*)calloc(1, sizeof(blocking_thread));
+    pthread_t id;
+    if (thread == NULL) {
+      close(fd);
+      continue;
+    }
+    thread->worker.bank = worker->bank;
+    thread->worker.alive = worker->alive;
+    thread->fd = fd;
+    atomic_fetch_add(worker->alive, 1);
+    if (pthread_create(&id, NULL, serve_blocking, thread) != 0) {
+      atomic_fetch_sub(worker->alive, 1);
+      close(fd);
+      free(thread);
+      continue;
+    }
+    pthread_detach(id);
+  }
+  while (atomic_load(worker->alive) > 0) usleep(SERVER_TICK * 1000);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Serve
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief This function will run a worker thread of the chosen model, the
+ * 'argument' is the worker's structure. Its connections are deleted at the
+ * end.
+ */
+static void* run_worker(void* argument) {
+  server_worker* worker = (server_worker*)argument;
+  if (worker->model == SERVER_URING)
+    serve_uring(worker);
+  else if (worker->model == SERVER_EPOLL)
+    serve_epoll(worker);
+  else
+    accept_blocking(worker);
+  return NULL;
+}
+
+/**
+ * @brief This function will serve the bank to the terminals connecting to the
+ * local (unix domain) socket of the given 'path', each connection being a
+ * session of its own, till stop_serving() is called. With io_uring or epoll
+ * every worker thread multiplexes many sessions, a line of input is fed to
+ * its session as soon as it is complete (straight out of the input buffer)
+ * and every reply is written at once. The blocking model (a thread per
+ * connection) is kept as the baseline. If io_uring is not available, epoll
+ * is used. A line or frame is performed inline by its worker, thus a login
+ * by PIN holds up the other sessions of the worker for the hash (about half
+ * a millisecond, see seal_pin), a burst of logins as many times. A resume by
+ * session token doesn't hash (see grant_token), and the bulk operator
+ * commands (import, export, interest and script) are refused to a
+ * connection, thus never run on a worker. Returns 'true' once served,
+ * otherwise returns 'false' if the socket can't be served.
+ * @param bank The bank's data struture reference
+ * @param path The path of the socket
+ * @param model The model of serving (SERVER_URING, SERVER_EPOLL or
+ * SERVER_BLOCKING)
+ * @param threads The number of worker threads (0 means one per CPU)
+ * @return 'true' or 'false'
+ */
+bool serve(BANK bank, const char* path, int model, unsigned int threads) {
+  // Check: Wether the bank and path exist!
+  if (bank == NULL || path == NULL) return false;
+  struct sockaddr_un address = {0};
+  address.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address.sun_path)) {
+    console_printf("\e[38;5;196mError:\e[0m Socket path is too long.\n");
+    return false;
+  }
+  strcpy(address.sun_path, path);
+
+  // Create: The listening socket, the stale one (if any) is replaced
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(path);
+  if (listener == -1 ||
+      bind(listener, (struct sockaddr*)&address, sizeof(address)) == -1 ||
+      listen(listener, SOMAXCONN) == -1) {
+    console_printf("\e[38;5;196mError:\e[0m Can't serve \e[38;5;214m%s\e[0m.\n",
+                   path);
+    if (listener != -1) close(listener);
+    return false;
+  }
+
+  // Configure: The workers, every multiplexing worker owns its buffers
+  if (model == SERVER_BLOCKING) threads = 1;
+  if (threads == 0) threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads == 0) threads = 1;
+  server_worker* workers =
+      (server_worker*)calloc(threads, sizeof(server_worker));
+  atomic_uint alive = 0;
+  if (workers == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    close(listener);
+    unlink(path);
+    return false;
+  }
+  unsigned int created = 0;
+  for (; created < threads; created++) {
+    server_worker* worker = &workers[created];
+    worker->bank = bank;
+    worker->listener = listener;
+    worker->model = model;
+    worker->alive = &alive;
+    if (model == SERVER_BLOCKING) continue;
+    worker->slots = (char*)mmap(NULL, (size_t)SERVER_SLOTS * SERVER_LINE,
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    worker->free_slots =
+        (unsigned int*)malloc(sizeof(unsigned int) * SERVER_SLOTS);
+    if (worker->slots == MAP_FAILED || worker->free_slots == NULL) {
+      if (worker->slots != MAP_FAILED)
+        munmap(worker->slots, (size_t)SERVER_SLOTS * SERVER_LINE);
+      free(worker->free_slots);
+      break;
+    }
+    for (unsigned int i = 0; i < SERVER_SLOTS; i++)
+      worker->free_slots[i] = SERVER_SLOTS - 1 - i;
+    worker->free_count = SERVER_SLOTS;
+    if (worker->model == SERVER_URING && create_uring(worker) == false) {
+      console_printf(
+          "\e[38;5;214mWarning:\e[0m io_uring is not available, using "
+          "epoll.\n");
+      for (unsigned int i = 0; i < created; i++) delete_uring(&workers[i]);
+      for (unsigned int i = 0; i <= created; i++)
+        workers[i].model = SERVER_EPOLL;
+      model = SERVER_EPOLL;
+    }
+  }
+  if (created < threads) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    threads = created;
+  }
+
+  // Configure: The epoll workers never wait in accept
+  if (model == SERVER_EPOLL)
+    fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+
+  // Serve: Till stopped
+  const char* models[] = {"io_uring", "epoll", "thread per connection"};
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Serving \e[38;5;214m%s\e[0m at "
+      "\e[38;5;214m%s\e[0m using %u thread(s) (%s).\n",
+      bank->name, path, threads, models[model]);
+  fflush(console());
+  atomic_store(&serving, true);
+  unsigned int started = 0;
+  for (; started < threads; started++)
+    if (pthread_create(&workers[started].thread, NULL, run_worker,
+                       &workers[started]) != 0)
+      break;
+  if (started == 0) atomic_store(&serving, false);
+  for (unsigned int i = 0; i < started; i++)
+    pthread_join(workers[i].thread, NULL);
+
+  // Clean: Every worker, its connections and buffers
+  for (unsigned int i = 0; i < threads; i++) {
+    server_worker* worker = &workers[i];
+    if (worker->model == SERVER_URING) delete_uring(worker);
+    while (worker->connections != NULL)
+      delete_connection(worker, worker->connections);
+    if (worker->slots != NULL) {
+      munmap(worker->slots, (size_t)SERVER_SLOTS * SERVER_LINE);
+      free(worker->free_slots);
+    }
+  }
+  free(workers);
+  close(listener);
+  unlink(path);
+
+  // Status: Served
+  return started > 0;
+}
@@ -0,0 +1,104 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file server.h
+ * @brief Interface of the socket front end (io_uring, epoll or blocking)
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdbool.h>
+
+#include "bank.h"
+
+/**
+ * @brief Bytes of the input buffer of a connection (the longest line)
+ */
+#define SERVER_LINE 2048
+
+/**
+ * @brief Number of registered input buffers of a worker, connections beyond
+ * them get an unregistered buffer
+ */
+#define SERVER_SLOTS 2048
+
+/**
+ * @brief Number of submission queue entries of a worker's io_uring
+ */
+#define SERVER_QUEUE 1024
+
+/**
+ * @brief The models of serving the connections
+ */
+enum { SERVER_URING, SERVER_EPOLL, SERVER_BLOCKING };
+
+/**
+ * @brief This function will serve the bank to the terminals connecting to the
+ * local (unix domain) socket of the given 'path', each connection being a
+ * session of its own, till stop_serving() is called. With io_uring or epoll
+ * every worker thread multiplexes many sessions, a line of input is fed to
+ * its session as soon as it is complete (straight out of the input buffer)
+ * and every reply is written at once. The blocking model (a thread per
+ * connection) is kept as the baseline. If io_uring is not available, epoll
+ * is used. A line or frame is performed inline by its worker, thus a login
+ * by PIN holds up the other sessions of the worker for the hash (about half
+ * a millisecond, see seal_pin), a burst of logins as many times. A resume by
+ * session token doesn't hash (see grant_token), and the bulk operator
+ * commands (import, export, interest and script) are refused to a
+ * connection, thus never run on a worker. Returns 'true' once served,
+ * otherwise returns 'false' if the socket can't be served.
+ * @param bank The bank's data struture reference
+ * @param path The path of the socket
+ * @param model The model of serving (SERVER_URING, SERVER_EPOLL or
+ * SERVER_BLOCKING)
+ * @param threads The number of worker threads (0 means one per CPU)
+ * @return 'true' or 'false'
+ */
+bool serve(BANK bank, const char* path, int model, unsigned int threads);
+
+/**
+ * @brief This function will ask serve() to return, it is safe to call from a
+ * signal handler. The function returns nothing.
+ * @return void (nothing)
+ */
+void stop_serving();
+
+#endif
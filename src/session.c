@@ -0,0 +1,1089 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file session.c
+ * @brief Implementation of the resumable console sessions
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "session.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch.h"
+#include "bulk.h"
+#include "checkpoint.h"
+#include "console.h"
+#include "schedule.h"
+#include "script.h"
+
+/**
+ * @brief The environments of a command being scanned, i.e. what the next
+ * token is about
+ */
+enum {
+  FREE,
+  HOLD_BY_DEPOSIT,
+  HOLD_BY_WITHDRAW,
+  HOLD_BY_WITHDRAW_CASH,
+  HOLD_BY_WITHDRAW_CASH_MAXIMIZE,
+  HOLD_BY_FIND,
+  HOLD_BY_EXPORT,
+  HOLD_BY_INTEREST,
+  HOLD_BY_INTEREST_FEE,
+  HOLD_BY_SCRIPT,
+  HOLD_BY_HOT,
+  HOLD_BY_ORDER,
+  HOLD_BY_ORDER_AMOUNT,
+  HOLD_BY_ORDER_SECONDS
+};
+
+/**
+ * @brief This function will create a session of the given 'bank' which prints
+ * its messages to the given 'out' stream, nobody is logged in. Only an
+ * 'operator' session (i.e. the local console) may use the operator commands
+ * (see perform). Returns the session as a reference (not copy, thus need to
+ * be freed after usage), otherwise returns 'NULL' if out of memory.
+ * @param bank The bank's data struture reference
+ * @param out The stream where the session's messages are printed
+ * @param operator Whether the session may use the operator commands
+ * @return SESSION (reference, not copy) or 'NULL'
+ */
+SESSION create_session(BANK bank, FILE* out, bool operator) {
+  // Check: Wether the bank exist!
+  if (bank == NULL) return NULL;
+
+  // Create: Make space for the session
+  SESSION session = (SESSION)calloc(1, sizeof(session_element));
+  if (session == NULL) return NULL;
+
+  // Configure: Waiting for a command, nobody is logged in
+  session->bank = bank;
+  session->out = (out == NULL) ? stdout : out;
+  session->operator = operator;
+  session->state = SESSION_COMMAND;
+  session->user_login_id = -1;
+  session->user_generation = BANK_ANY_GENERATION;
+  session->login_token = 0;
+  session->list = NULL;
+  session->scanned_token = 0;
+  session->environment = FREE;
+  session->cash = NULL;
+  session->rate = 0;
+  session->transaction = NULL;
+  session->user = NULL;
+  session->found = -1;
+  session->pin = 0;
+  session->format = NULL;
+  session->target = -1;
+  session->amount = 0;
+  atomic_init(&session->idle, 0);
+  session->idle_timer = WHEEL_NONE;
+
+  // Status: Return the session's structure reference
+  return session;
+}
+
+/**
+ * @brief This function will clean up the command being scanned (if any), i.e.
+ * the token list and the cash in making.
+ */
+static void finish_command(SESSION session) {
+  if (session->cash != NULL) {
+    free(session->cash);
+    session->cash = NULL;
+  }
+  if (session->list != NULL) {
+    free_tokens(session->list);
+    session->list = NULL;
+  }
+  session->scanned_token = 0;
+  session->environment = FREE;
+}
+
+/**
+ * @brief This function will delete the given session, an open transaction (if
+ * any) is aborted. Returns 'true' if deleted, otherwise returns 'false'.
+ * @param session The session's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_session(SESSION session) {
+  // Check: Wether the session exist!
+  if (session == NULL) return false;
+
+  // Clean: Everything the session is holding, the idle timer too
+  finish_command(session);
+  watch_idle(&session->idle, &session->idle_timer, false);
+  abort_transaction(session->transaction);
+  free(session->user);
+  free(session->format);
+  free(session);
+  return true;
+}
+
+/**
+ * @brief This function will read a PIN out of the given 'line' into 'pin',
+ * just like get_long_long() accepts it. Returns 'true' if the line is a PIN,
+ * otherwise returns 'false' (the prompt is repeated).
+ */
+static bool read_pin(const char* line, long long unsigned int* pin) {
+  if (line[0] == '\0' || isspace((unsigned char)line[0])) return false;
+  char* tail;
+  errno = 0;
+  long long int number = strtoll(line, &tail, 10);
+  if (errno != 0 || *tail != '\0' || number == LLONG_MAX) return false;
+  *pin = number;
+  return true;
+}
+
+/**
+ * @brief This function will read a session token (hexadecimal, as displayed
+ * at login) out of the given 'line' into 'token'. Returns 'true' if the line
+ * is a token, otherwise returns 'false' (the prompt is repeated).
+ */
+static bool read_token(const char* line, long long unsigned int* token) {
+  if (line[0] == '\0' || isspace((unsigned char)line[0])) return false;
+  char* tail;
+  errno = 0;
+  *token = strtoull(line, &tail, 16);
+  return errno == 0 && *tail == '\0';
+}
+
+/**
+ * @brief The operator commands, i.e. the ones acting on the whole bank or on
+ * the host (not on the account logged in), only for the operator's session
+ */
+static const char* const operator_commands[] = {
+    "import", "export", "interest", "script", "compact", "hot", "checkpoint",
+    "schedule", NULL};
+
+/**
+ * @brief This function will tell whether the given 'command' is an operator
+ * command. Returns 'true' if so, otherwise returns 'false'.
+ */
+static bool is_operator_command(const char* command) {
+  for (unsigned int i = 0; operator_commands[i] != NULL; i++)
+    if (strcmp(command, operator_commands[i]) == 0) return true;
+  return false;
+}
+
+/**
+ * @brief This function will scan the session's token list from where it was
+ * left and perform the various computational task by creating the
+ * environment. The scan is paused (and the function returns) when a command
+ * needs a prompt answer, otherwise the list is finished at its end.
+ */
+static void perform(SESSION session) {
+  BANK my_bank = session->bank;
+  TOKEN_LIST list = session->list;
+  while (session->state == SESSION_COMMAND &&
+         session->scanned_token <= list->quantity) {
+    TOKEN* token = &list->tokens[session->scanned_token];
+
+    /////////////////////////////////////////////////////////////////////////
+    // At end, inform correction for previous incomplete commands
+    /////////////////////////////////////////////////////////////////////////
+    if (session->scanned_token == list->quantity) {
+      int environment = session->environment;
+      if (environment != FREE)
+        console_printf(
+            "\e[38;5;196mFailure:\e[0m Incomplete operation and command.\n");
+      if (environment == HOLD_BY_DEPOSIT)
+        console_printf("Usage \e[38;5;214m$: deposit (amount)\e[0m\n");
+      if (environment == HOLD_BY_WITHDRAW)
+        console_printf("Usage \e[38;5;214m$: withdraw (amount)\e[0m\n");
+      if (environment == HOLD_BY_FIND)
+        console_printf("Usage \e[38;5;214m$: find (prefix)\e[0m\n");
+      if (environment == HOLD_BY_EXPORT)
+        console_printf("Usage \e[38;5;214m$: export (csv|bin)\e[0m\n");
+      if (environment == HOLD_BY_SCRIPT)
+        console_printf("Usage \e[38;5;214m$: script (run|check)\e[0m\n");
+      if (environment == HOLD_BY_ORDER || environment == HOLD_BY_ORDER_AMOUNT ||
+          environment == HOLD_BY_ORDER_SECONDS)
+        console_printf(
+            "Usage \e[38;5;214m$: order (account-id) (amount) "
+            "(seconds)\e[0m\n");
+      if (environment == HOLD_BY_INTEREST ||
+          environment == HOLD_BY_INTEREST_FEE)
+        console_printf(
+            "Usage \e[38;5;214m$: interest (basis-points) (fee)\e[0m\n");
+      if (environment == HOLD_BY_WITHDRAW_CASH ||
+          environment == HOLD_BY_WITHDRAW_CASH_MAXIMIZE)
+        console_printf(
+            "Usage \e[38;5;214m$: withdraw cash (amount) (note-denom...) "
+            "done\e[0m\n");
+      break;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: exit
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "exit") == 0 && session->environment == FREE) {
+      if (session->transaction != NULL) {
+        console_printf(
+            "\e[38;5;214mWarning:\e[0m Open transaction is aborted.\n");
+        abort_transaction(session->transaction);
+        session->transaction = NULL;
+      }
+      session->state = SESSION_CLOSED;
+      break;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: help
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "help") == 0 && session->environment == FREE) {
+      help();
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: begin
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "begin") == 0 && session->environment == FREE) {
+      if (session->transaction != NULL)
+        console_printf(
+            "\e[38;5;196mFailure:\e[0m Transaction is already open!\n");
+      else if (resident_accounts(session->bank) == true &&
+               (session->transaction = begin_transaction()) != NULL)
+        console_printf(
+            "\e[38;5;40mSuccess:\e[0m Operations are buffered till "
+            "commit!\n");
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: commit
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "commit") == 0 && session->environment == FREE) {
+      if (session->transaction == NULL)
+        console_printf(
+            "\e[38;5;196mFailure:\e[0m No open transaction! Use begin.\n");
+      else if (commit_transaction(session->transaction, my_bank) == true)
+        console_printf(
+            "\e[38;5;40mSuccess:\e[0m You have committed the operations!\n");
+      else
+        console_printf(
+            "\e[38;5;196mFailure:\e[0m Nothing committed! Try again.\n");
+      session->transaction = NULL;
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: abort
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "abort") == 0 && session->environment == FREE) {
+      if (abort_transaction(session->transaction) == true)
+        console_printf(
+            "\e[38;5;40mSuccess:\e[0m You have aborted the operations!\n");
+      else
+        console_printf(
+            "\e[38;5;196mFailure:\e[0m No open transaction! Use begin.\n");
+      session->transaction = NULL;
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Operator commands are refused, unless the session is the operator's
+    /////////////////////////////////////////////////////////////////////////
+    if (session->operator == false && session->environment == FREE &&
+        is_operator_command(token->get) == true) {
+      console_printf(
+          "\e[38;5;196mFailure:\e[0m Command \e[38;5;214m%s\e[0m is for the "
+          "operator's console only.\n",
+          token->get);
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // In between $: begin ... commit, bulk commands are not allowed
+    /////////////////////////////////////////////////////////////////////////
+    if (session->transaction != NULL && session->environment == FREE &&
+        (strcmp(token->get, "import") == 0 ||
+         strcmp(token->get, "export") == 0 ||
+         strcmp(token->get, "interest") == 0 ||
+         strcmp(token->get, "script") == 0 ||
+         strcmp(token->get, "close") == 0 ||
+         strcmp(token->get, "compact") == 0 ||
+         strcmp(token->get, "order") == 0)) {
+      console_printf(
+          "\e[38;5;196mFailure:\e[0m Command \e[38;5;214m%s\e[0m can't be "
+          "used in between begin and commit.\n",
+          token->get);
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: login
+    // The user name and PIN are the next lines, the scan resumes after them
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "login") == 0 && session->environment == FREE) {
+      session->user_login_id = -1;
+      session->state = SESSION_USER_NAME;
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: resume
+    // The user name and session token are the next lines, just like login
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "resume") == 0 && session->environment == FREE) {
+      session->user_login_id = -1;
+      session->state = SESSION_RESUME_NAME;
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: import
+    // The file path is the next line, the scan resumes after it
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "import") == 0 && session->environment == FREE) {
+      session->state = SESSION_IMPORT_PATH;
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: export (csv|bin)
+    // The file path is the next line, the scan resumes after it
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "export") == 0 && session->environment == FREE) {
+      session->environment = HOLD_BY_EXPORT;
+      session->scanned_token++;
+      continue;
+    }
+    if (session->environment == HOLD_BY_EXPORT) {
+      if (token->is_alpha == true) {
+        free(session->format);
+        session->format = strdup(token->get);
+        session->state = SESSION_EXPORT_PATH;
+        session->environment = FREE;
+      }
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: script (run|check)
+    // The file path is the next line, the scan resumes after it
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "script") == 0 && session->environment == FREE) {
+      session->environment = HOLD_BY_SCRIPT;
+      session->scanned_token++;
+      continue;
+    }
+    if (session->environment == HOLD_BY_SCRIPT) {
+      if (strcmp(token->get, "run") == 0 || strcmp(token->get, "check") == 0) {
+        free(session->format);
+        session->format = strdup(token->get);
+        session->state = SESSION_SCRIPT_PATH;
+        session->environment = FREE;
+      }
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: checkpoint
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "checkpoint") == 0 &&
+        session->environment == FREE) {
+      if (request_checkpoint() == true) {
+        console_printf(
+            "\e[38;5;40mSuccess:\e[0m A checkpoint is being taken in the "
+            "background!\n");
+        display_checkpoints();
+      } else
+        console_printf(
+            "\e[38;5;196mFailure:\e[0m Checkpoints are not enabled.\n");
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: pages
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "pages") == 0 && session->environment == FREE) {
+      if (session->bank->pager != NULL)
+        display_pager(session->bank->pager);
+      else
+        console_printf(
+            "\e[38;5;196mFailure:\e[0m The accounts are not paged.\n");
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: hot (account-id)
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "hot") == 0 && session->environment == FREE) {
+      session->environment = HOLD_BY_HOT;
+      session->scanned_token++;
+      continue;
+    }
+    if (session->environment == HOLD_BY_HOT) {
+      if (token->is_numeric == true) {
+        if (mark_hot_account(my_bank, atoi(token->get)) == true) {
+          console_printf(
+              "\e[38;5;40mSuccess:\e[0m The account takes deposits on its "
+              "striped balance!\n");
+          display_hot(my_bank);
+        } else
+          console_printf(
+              "\e[38;5;196mFailure:\e[0m Something went wrong! Try "
+              "again.\n");
+        session->environment = FREE;
+      }
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: order (account-id) (amount) (seconds)
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "order") == 0 && session->environment == FREE) {
+      session->environment = HOLD_BY_ORDER;
+      session->scanned_token++;
+      continue;
+    }
+    if (session->environment == HOLD_BY_ORDER) {
+      if (token->is_numeric == true) {
+        session->target = atoi(token->get);
+        session->environment = HOLD_BY_ORDER_AMOUNT;
+      }
+      session->scanned_token++;
+      continue;
+    }
+    if (session->environment == HOLD_BY_ORDER_AMOUNT) {
+      if (token->is_numeric == true) {
+        session->amount = atoll(token->get);
+        session->environment = HOLD_BY_ORDER_SECONDS;
+      }
+      session->scanned_token++;
+      continue;
+    }
+    if (session->environment == HOLD_BY_ORDER_SECONDS) {
+      if (token->is_numeric == true) {
+        if (add_order(my_bank, session->user_login_id, session->user,
+                      session->user_generation, session->target,
+                      session->amount, atoi(token->get)) == true)
+          console_printf(
+              "\e[38;5;40mSuccess:\e[0m You have set up the standing "
+              "order!\n");
+        else
+          console_printf(
+              "\e[38;5;196mFailure:\e[0m Something went wrong! Try "
+              "again.\n");
+        session->environment = FREE;
+      }
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: limits
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "limits") == 0 && session->environment == FREE) {
+      display_limits(my_bank, session->user_login_id);
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: analytics
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "analytics") == 0 &&
+        session->environment == FREE) {
+      display_sketch(my_bank->sketch);
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: schedule
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "schedule") == 0 && session->environment == FREE) {
+      display_schedule();
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: close
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "close") == 0 && session->environment == FREE) {
+      if (close_account(my_bank, session->user_login_id,
+                        session->user_generation) == true) {
+        session->user_login_id = -1;
+        console_printf(
+            "\e[38;5;40mSuccess:\e[0m You have closed the account!\n");
+      } else
+        console_printf(
+            "\e[38;5;196mFailure:\e[0m Not closed! Try again.\n");
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: compact
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "compact") == 0 && session->environment == FREE) {
+      if (compact_accounts(my_bank) == true)
+        console_printf(
+            "\e[38;5;40mSuccess:\e[0m You have compacted the accounts!\n");
+      else
+        console_printf(
+            "\e[38;5;196mFailure:\e[0m Not compacted! Try again.\n");
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: logout
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "logout") == 0 && session->environment == FREE) {
+      session->user_login_id = -1;
+      revoke_token(session->bank->vault, session->login_token);
+      session->login_token = 0;
+      console_printf(
+          "\e[38;5;40mSuccess:\e[0m You have logged out of the account!\n");
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: deposit (amount)
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "deposit") == 0 && session->environment == FREE) {
+      session->environment = HOLD_BY_DEPOSIT;
+      session->scanned_token++;
+      continue;
+    }
+    if (session->environment == HOLD_BY_DEPOSIT) {
+      if (token->is_numeric == true) {
+        if (session->transaction != NULL) {
+          if (txn_deposit(session->transaction, my_bank,
+                          session->user_login_id, session->user_generation,
+                          atoll(token->get)) == true)
+            console_printf("\e[38;5;40mSuccess:\e[0m Deposit is buffered!\n");
+          else
+            console_printf(
+                "\e[38;5;196mFailure:\e[0m Something went wrong! Try "
+                "again.\n");
+        } else if (account_deposit(my_bank, session->user_login_id,
+                                   session->user_generation,
+                                   atoll(token->get)) == true)
+          console_printf(
+              "\e[38;5;40mSuccess:\e[0m You have deposited into the "
+              "account!\n");
+        else
+          console_printf(
+              "\e[38;5;196mFailure:\e[0m Something went wrong! Try again.\n");
+        session->environment = FREE;
+      }
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: withdraw (amount)
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "withdraw") == 0 && session->environment == FREE) {
+      session->environment = HOLD_BY_WITHDRAW;
+
+      // Continue
+      session->scanned_token++;
+      continue;
+    }
+
+    if (session->environment == HOLD_BY_WITHDRAW) {
+      // If numeric
+      if (token->is_numeric == true) {
+        if (session->transaction != NULL) {
+          if (txn_withdraw(session->transaction, my_bank,
+                           session->user_login_id, session->user_generation,
+                           atoll(token->get), false) == true)
+            console_printf(
+                "\e[38;5;40mSuccess:\e[0m Withdrawal is buffered!\n");
+          else
+            console_printf(
+                "\e[38;5;196mFailure:\e[0m Something went wrong! Try "
+                "again.\n");
+        } else if (account_withdraw(my_bank, session->user_login_id,
+                                    session->user_generation,
+                                    atoll(token->get)) == DEBIT_DONE)
+          console_printf(
+              "\e[38;5;40mSuccess:\e[0m You have withdrawn from the "
+              "account!\n");
+        else
+          console_printf(
+              "\e[38;5;196mFailure:\e[0m Something went wrong! Try again.\n");
+        session->environment = FREE;
+      }
+
+      // If alphabetic
+      if (token->is_alpha == true) {
+        if (strcmp(token->get, "cash") == 0) {
+          session->environment = HOLD_BY_WITHDRAW_CASH;
+        }
+      }
+
+      // Continue
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: withdraw cash (amount) (note-denom...) done
+    /////////////////////////////////////////////////////////////////////////
+    if (session->environment == HOLD_BY_WITHDRAW_CASH) {
+      // If numeric
+      if (token->is_numeric == true) {
+        session->cash = account_cash_withdraw(
+            my_bank, session->user_login_id, atoll(token->get));
+        session->environment = HOLD_BY_WITHDRAW_CASH_MAXIMIZE;
+      }
+
+      // Continue
+      session->scanned_token++;
+      continue;
+    }
+
+    if (session->environment == HOLD_BY_WITHDRAW_CASH_MAXIMIZE) {
+      CASH cash = session->cash;
+
+      // If numeric
+      if (token->is_numeric == true) {
+        if (maximize(cash, atoi(token->get)) == true)
+          console_printf("\e[38;5;40mSuccess:\e[0m maximized Rs. %d/- notes!\n",
+                         atoi(token->get));
+      }
+
+      // If alphabetic
+      if (token->is_alpha == true) {
+        if (strcmp(token->get, "done") == 0) {
+          if (session->transaction != NULL) {
+            if (complete_cash(cash) == true &&
+                txn_withdraw(session->transaction, my_bank,
+                             session->user_login_id, session->user_generation,
+                             cash->amount, true) == true) {
+              console_printf(
+                  "\e[38;5;40mSuccess:\e[0m Withdrawal is buffered!\n");
+              display_cash(cash);
+            } else {
+              fail_transaction(session->transaction);
+              console_printf(
+                  "\e[38;5;196mFailure:\e[0m Something went wrong! Try "
+                  "again.\n");
+            }
+          } else if (account_withdraw_cash(my_bank, session->user_login_id,
+                                           session->user_generation,
+                                           cash) == DEBIT_DONE) {
+            console_printf(
+                "\e[38;5;40mSuccess:\e[0m You have withdrawn from the "
+                "account!\n");
+            display_cash(cash);
+          } else
+            console_printf(
+                "\e[38;5;196mFailure:\e[0m Something went wrong! Try "
+                "again.\n");
+
+          free(session->cash);
+          session->cash = NULL;
+          session->environment = FREE;
+        }
+      }
+
+      // Continue
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: find (prefix)
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "find") == 0 && session->environment == FREE) {
+      session->environment = HOLD_BY_FIND;
+      session->scanned_token++;
+      continue;
+    }
+    if (session->environment == HOLD_BY_FIND) {
+      if (token->get[0] != '\0') {
+        find(my_bank, token->get);
+        session->environment = FREE;
+      }
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: interest (basis-points) (fee)
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "interest") == 0 && session->environment == FREE) {
+      session->environment = HOLD_BY_INTEREST;
+      session->scanned_token++;
+      continue;
+    }
+    if (session->environment == HOLD_BY_INTEREST) {
+      if (token->is_numeric == true) {
+        session->rate = atoll(token->get);
+        session->environment = HOLD_BY_INTEREST_FEE;
+      }
+      session->scanned_token++;
+      continue;
+    }
+    if (session->environment == HOLD_BY_INTEREST_FEE) {
+      if (token->is_numeric == true) {
+        if (apply_interest(my_bank, session->rate, atoll(token->get)) == true)
+          console_printf(
+              "\e[38;5;40mSuccess:\e[0m You have applied the end-of-day "
+              "batch!\n");
+        else
+          console_printf(
+              "\e[38;5;196mFailure:\e[0m Something went wrong! Try again.\n");
+        session->environment = FREE;
+      }
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: show
+    /////////////////////////////////////////////////////////////////////////
+    if (strcmp(token->get, "show") == 0 && session->environment == FREE) {
+      display_account(my_bank, session->user_login_id);
+      session->scanned_token++;
+      continue;
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    // Command $: (any, not listed above))
+    // Just ignore them!
+    /////////////////////////////////////////////////////////////////////////
+    session->scanned_token++;
+  }
+
+  // Clean up remainder, unless paused for a prompt answer
+  if (session->state != SESSION_COMMAND && session->state != SESSION_CLOSED)
+    return;
+  finish_command(session);
+}
+
+/**
+ * @brief This function will take the answer of the login prompts (user name,
+ * PIN, new PIN and its confirmation, or the session token of resume) one
+ * line at a time, just like login() does in a single call. The login result
+ * is displayed once it is known, with a new session token if the PIN was
+ * hashed.
+ */
+static void answer_login(SESSION session, const char* line) {
+  BANK bank = session->bank;
+  long long unsigned int pin;
+  bool hashed = session->state != SESSION_TOKEN;
+
+  switch (session->state) {
+    // Get: The username, and find it from the bank's name index
+    case SESSION_USER_NAME:
+      free(session->user);
+      session->user = strdup(line);
+      if (session->user == NULL) {
+        console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+        break;
+      }
+      session->found = find_account(bank, session->user);
+      if (session->found != -1) {
+        session->state = SESSION_PIN;
+        return;
+      }
+
+      // Warn: About creating new space
+      console_printf("\e[38;5;214mWarning:\e[0m Account does't exist!\n");
+      console_printf(
+          "\e[38;5;214mInfo:\e[0m Creating new account with User Name "
+          "\e[38;5;214m%s\e[0m.\n",
+          session->user);
+      session->state = SESSION_NEW_PIN;
+      return;
+
+    // Authorize: Get the user access to bank account
+    case SESSION_PIN:
+      if (read_pin(line, &pin) == false) return;
+      session->user_generation = get_generation(bank, session->found);
+      if (check_pin(bank, session->found, pin) == true)
+        session->user_login_id = session->found;
+      else
+        console_printf("\e[38;5;196mError:\e[0m Wrong PIN.\n");
+      break;
+
+    // Find: The username of resume, it must exist
+    case SESSION_RESUME_NAME:
+      free(session->user);
+      session->user = strdup(line);
+      session->found = (session->user != NULL)
+                           ? find_account(bank, session->user)
+                           : -1;
+      if (session->found != -1) {
+        session->state = SESSION_TOKEN;
+        return;
+      }
+      console_printf("\e[38;5;196mError:\e[0m Account does't exist!\n");
+      break;
+
+    // Authorize: By the session token of an earlier login, nothing hashed
+    case SESSION_TOKEN:
+      if (read_token(line, &pin) == false) return;
+      session->user_generation = get_generation(bank, session->found);
+      if (check_token(bank, session->found, pin) == true) {
+        session->user_login_id = session->found;
+        session->login_token = pin;
+      } else
+        console_printf(
+            "\e[38;5;196mError:\e[0m Session token expired or wrong.\n");
+      break;
+
+    // Get: The passwords for new user
+    case SESSION_NEW_PIN:
+      if (read_pin(line, &session->pin) == false) return;
+      session->state = SESSION_CONFIRM_PIN;
+      return;
+
+    // Create: Make space for new user's bank account, its PIN is hashed
+    case SESSION_CONFIRM_PIN:
+      if (read_pin(line, &pin) == false) return;
+      if (pin != session->pin) {
+        console_printf("\e[38;5;196mError:\e[0m Passwords don't match.\n");
+        break;
+      }
+      session->user_login_id =
+          (seal_pin(session->pin, &pin) == true)
+              ? add_account(bank, pin, session->user, strlen(session->user),
+                            3210)
+              : -1;
+      if (session->user_login_id == -1)
+        console_printf(
+            "\e[38;5;196mError:\e[0m Couldn't create the account.\n");
+      session->user_generation =
+          get_generation(bank, session->user_login_id);
+      break;
+  }
+
+  // Status: Login is over, either way (the user name is kept to tell whether
+  // the account is closed meanwhile)
+  if (session->user_login_id != -1) {
+    sketch_user(bank->sketch, session->user_login_id);
+    console_printf(
+        "\e[38;5;40mSuccess:\e[0m You have logged into the account!\n");
+    if (hashed == true &&
+        grant_token(bank, session->user_login_id, &session->login_token) ==
+            true)
+      console_printf(
+          "\e[38;5;214mInfo:\e[0m Session token \e[38;5;214m%016llx\e[0m "
+          "(see resume).\n",
+          session->login_token);
+  } else {
+    console_printf("\e[38;5;196mFailure:\e[0m Not logged in! Try again.\n");
+    free(session->user);
+    session->user = NULL;
+  }
+  session->state = SESSION_COMMAND;
+}
+
+/**
+ * @brief This function will feed a single line of input (without the line
+ * ending) to the session and perform as much as the line allows, never
+ * waiting for more input: when a command needs a prompt answer (e.g. the
+ * PIN) the rest of the line is resumed by the feed of the answer. 'NULL'
+ * means the input is over. Returns 'true' while the session is open,
+ * otherwise returns 'false' (e.g. after exit).
+ * @param session The session's data structure reference
+ * @param line The line of input or 'NULL'
+ * @return 'true' or 'false'
+ */
+bool session_feed(SESSION session, const char* line) {
+  // Check: Wether the session is open!
+  if (session == NULL || session->state == SESSION_CLOSED) return false;
+
+  // Configure: Every message goes to the session's stream
+  set_console(session->out);
+
+  // Check: The input is over, just like exit
+  if (line == NULL) {
+    finish_command(session);
+    abort_transaction(session->transaction);
+    session->transaction = NULL;
+    session->state = SESSION_CLOSED;
+  }
+
+  // Answer: The prompt of the paused command
+  else if (session->state == SESSION_IMPORT_PATH) {
+    if (import_accounts(session->bank, (string)line) == true)
+      console_printf(
+          "\e[38;5;40mSuccess:\e[0m You have imported the accounts!\n");
+    else
+      console_printf("\e[38;5;196mFailure:\e[0m Not imported! Try again.\n");
+    session->state = SESSION_COMMAND;
+  } else if (session->state == SESSION_EXPORT_PATH) {
+    if (export_accounts(session->bank, (string)line, session->format) == true)
+      console_printf(
+          "\e[38;5;40mSuccess:\e[0m You have exported the accounts!\n");
+    else
+      console_printf("\e[38;5;196mFailure:\e[0m Not exported! Try again.\n");
+    free(session->format);
+    session->format = NULL;
+    session->state = SESSION_COMMAND;
+  } else if (session->state == SESSION_SCRIPT_PATH) {
+    bool run = strcmp(session->format, "run") == 0;
+    if (((run == true) ? run_script(session->bank, (string)line)
+                       : check_script(session->bank, (string)line)) == true)
+      console_printf("\e[38;5;40mSuccess:\e[0m You have %s the script!\n",
+                     (run == true) ? "run" : "checked");
+    else
+      console_printf("\e[38;5;196mFailure:\e[0m Script failed! Try again.\n");
+    free(session->format);
+    session->format = NULL;
+    session->state = SESSION_COMMAND;
+  } else if (session->state != SESSION_COMMAND)
+    answer_login(session, line);
+
+  // Scan: A new command, otherwise resume the paused one
+  else if (session->list == NULL)
+    session->list = get_tokens((string)line);
+
+  // Check: The session has not been idle for too long
+  if (idle_expired(&session->idle, &session->idle_timer) == true &&
+      session->user_login_id != -1) {
+    console_printf(
+        "\e[38;5;214mWarning:\e[0m Idle for too long, you are logged "
+        "out.\n");
+    session->user_login_id = -1;
+    abort_transaction(session->transaction);
+    session->transaction = NULL;
+  }
+
+  // Check: The account is not closed (nor reused) by another session
+  if (session->user_login_id != -1 && session->state == SESSION_COMMAND &&
+      check_owner(session->bank, session->user_login_id, session->user,
+                  session->user_generation) == false) {
+    console_printf(
+        "\e[38;5;214mWarning:\e[0m The account is closed, you are logged "
+        "out.\n");
+    session->user_login_id = -1;
+    abort_transaction(session->transaction);
+    session->transaction = NULL;
+  }
+  if (session->state == SESSION_COMMAND && session->list != NULL)
+    perform(session);
+
+  // Watch: The session staying idle from now on, while logged in
+  watch_idle(&session->idle, &session->idle_timer,
+             session->user_login_id != -1 && session->state != SESSION_CLOSED);
+
+  // Sync: The journal, thus the line is answered once its changes are durable
+  sync_journal(session->bank->journal);
+
+  // Status: Whether the session is still open
+  fflush(session->out);
+  set_console(NULL);
+  return session->state != SESSION_CLOSED;
+}
+
+/**
+ * @brief This function will print the prompt of the session's state, i.e.
+ * what the next line of input is about. The function returns nothing.
+ * @param session The session's data structure reference
+ * @return void (nothing)
+ */
+void session_prompt(SESSION session) {
+  // Check: Wether the session is open!
+  if (session == NULL || session->state == SESSION_CLOSED) return;
+
+  // Display: The prompt of the state
+  account_element account;
+  char name[256];
+  switch (session->state) {
+    case SESSION_COMMAND:
+      if (session->user_login_id != -1 &&
+          snapshot_account(session->bank, session->user_login_id, &account,
+                           name, sizeof(name)) == true)
+        fprintf(session->out, "\e[38;5;32m%s@%s $: \e[0m", account.name,
+                session->bank->name);
+      else
+        fprintf(session->out, "\e[38;5;32mGuest@%s $: \e[0m",
+                session->bank->name);
+      break;
+    case SESSION_USER_NAME:
+    case SESSION_RESUME_NAME:
+      fprintf(session->out,
+              "\e[38;5;214m>\e[0m Enter User Name (case sensitive) : "
+              "\e[38;5;214m");
+      break;
+    case SESSION_PIN:
+    case SESSION_NEW_PIN:
+      fprintf(session->out, "\e[38;5;214m>\e[0m Enter PIN: ");
+      break;
+    case SESSION_CONFIRM_PIN:
+      fprintf(session->out, "\e[38;5;214m>\e[0m Re-Enter PIN: ");
+      break;
+    case SESSION_TOKEN:
+      fprintf(session->out, "\e[38;5;214m>\e[0m Enter Session Token: ");
+      break;
+    case SESSION_IMPORT_PATH:
+      fprintf(session->out, "\e[38;5;214m>\e[0m Enter CSV file path: ");
+      break;
+    case SESSION_EXPORT_PATH:
+      fprintf(session->out, "\e[38;5;214m>\e[0m Enter export file path: ");
+      break;
+    case SESSION_SCRIPT_PATH:
+      fprintf(session->out, "\e[38;5;214m>\e[0m Enter script file path: ");
+      break;
+  }
+  fflush(session->out);
+}
@@ -0,0 +1,156 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file session.h
+ * @brief Interface of the resumable console sessions
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "bank.h"
+#include "token.h"
+#include "txn.h"
+
+/**
+ * @brief The states of a session, i.e. what the next line of input is
+ */
+enum {
+  SESSION_COMMAND,
+  SESSION_USER_NAME,
+  SESSION_PIN,
+  SESSION_NEW_PIN,
+  SESSION_CONFIRM_PIN,
+  SESSION_RESUME_NAME,
+  SESSION_TOKEN,
+  SESSION_IMPORT_PATH,
+  SESSION_EXPORT_PATH,
+  SESSION_SCRIPT_PATH,
+  SESSION_CLOSED
+};
+
+/**
+ * @brief Structure of a session (a single terminal) of the bank. Everything
+ * an interactive flow (e.g. login, PIN confirmation, withdraw cash) has to
+ * remember in between two lines of input lives here instead of the stack,
+ * thus a thread never waits for the input of a session and one thread can
+ * serve many of them, one line at a time. The 'idle' flag is set by the
+ * timers (see schedule.c) once the session stays idle for too long. The
+ * 'operator' flag allows the bank-wide commands and the files of the host,
+ * thus it is set for the local console only (never for a connection). The
+ * 'login_token' is the session token of the last login (0 if none), see
+ * grant_token.
+ */
+typedef struct {
+  BANK bank;
+  FILE* out;
+  bool operator;
+  int state;
+  int user_login_id;
+  unsigned int user_generation;
+  long long unsigned int login_token;
+  TOKEN_LIST list;
+  int scanned_token;
+  int environment;
+  CASH cash;
+  long long int rate;
+  TXN transaction;
+  string user;
+  int found;
+  long long unsigned int pin;
+  string format;
+  int target;
+  long long int amount;
+  atomic_int idle;
+  unsigned int idle_timer;
+} session_element;
+
+/**
+ * @brief Session's Data structure Reference
+ */
+#define SESSION session_element*
+
+/**
+ * @brief This function will create a session of the given 'bank' which prints
+ * its messages to the given 'out' stream, nobody is logged in. Only an
+ * 'operator' session (i.e. the local console) may use the operator commands
+ * (see perform). Returns the session as a reference (not copy, thus need to
+ * be freed after usage), otherwise returns 'NULL' if out of memory.
+ * @param bank The bank's data struture reference
+ * @param out The stream where the session's messages are printed
+ * @param operator Whether the session may use the operator commands
+ * @return SESSION (reference, not copy) or 'NULL'
+ */
+SESSION create_session(BANK bank, FILE* out, bool operator);
+
+/**
+ * @brief This function will delete the given session, an open transaction (if
+ * any) is aborted. Returns 'true' if deleted, otherwise returns 'false'.
+ * @param session The session's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_session(SESSION session);
+
+/**
+ * @brief This function will feed a single line of input (without the line
+ * ending) to the session and perform as much as the line allows, never
+ * waiting for more input: when a command needs a prompt answer (e.g. the
+ * PIN) the rest of the line is resumed by the feed of the answer. 'NULL'
+ * means the input is over. Returns 'true' while the session is open,
+ * otherwise returns 'false' (e.g. after exit).
+ * @param session The session's data structure reference
+ * @param line The line of input or 'NULL'
+ * @return 'true' or 'false'
+ */
+bool session_feed(SESSION session, const char* line);
+
+/**
+ * @brief This function will print the prompt of the session's state, i.e.
+ * what the next line of input is about. The function returns nothing.
+ * @param session The session's data structure reference
+ * @return void (nothing)
+ */
+void session_prompt(SESSION session);
+
+#endif
@@ -0,0 +1,243 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file shared.c
+ * @brief Implementation of the bank's account store shared by processes through
+ * a file
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "shared.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "console.h"
+
+/**
+ * @brief Number of milliseconds an attaching process waits for the creator of
+ * the shared bank file to finish its initialization
+ */
+#define SHARED_WAIT 2000
+
+/**
+ * @brief This function will return the bytes of the header of a shared bank
+ * file, i.e. rounded up to pages thus every column is aligned.
+ */
+static size_t header_size() {
+  long page = sysconf(_SC_PAGESIZE);
+  size_t size = (page > 0) ? page : 4096;
+  return (sizeof(shared_header) + size - 1) / size * size;
+}
+
+/**
+ * @brief This function will return the bytes of a shared bank file holding
+ * (at most) 'capacity' accounts.
+ */
+static size_t file_size(size_t header, unsigned int capacity) {
+  return header + (size_t)capacity * (sizeof(long long int) +
+                                      sizeof(long long unsigned int) +
+                                      sizeof(unsigned int) + SHARED_NAME);
+}
+
+/**
+ * @brief This function will initialize the given process-shared and robust
+ * mutex. Returns 'true' if initialized, otherwise returns 'false'.
+ */
+static bool init_lock(pthread_mutex_t* lock) {
+  pthread_mutexattr_t attributes;
+  if (pthread_mutexattr_init(&attributes) != 0) return false;
+  bool status =
+      pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED) == 0 &&
+      pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST) == 0 &&
+      pthread_mutex_init(lock, &attributes) == 0;
+  pthread_mutexattr_destroy(&attributes);
+  return status;
+}
+
+/**
+ * @brief This function will initialize the header of a new shared bank file
+ * of 'capacity' accounts, the magic is stored last thus other processes wait
+ * till everything else is there. Returns 'true' if initialized, otherwise
+ * returns 'false'.
+ */
+static bool init_header(shared_header* header, size_t size,
+                        unsigned int capacity) {
+  header->version = SHARED_VERSION;
+  header->header_size = size;
+  header->capacity = capacity;
+  atomic_init(&header->quantity, 0);
+  if (init_lock(&header->append_lock) == false) return false;
+  for (int i = 0; i < SNAPSHOT_STRIPES; i++) {
+    atomic_init(&header->stripe[i].sequence, 0);
+    if (init_lock(&header->stripe[i].lock) == false) return false;
+  }
+  atomic_store_explicit(&header->magic, SHARED_MAGIC, memory_order_release);
+  return true;
+}
+
+/**
+ * @brief This function will wait (a while) for the creator of the shared bank
+ * file to size and initialize it, then map it. Returns the mapping of 'size'
+ * bytes, otherwise returns 'MAP_FAILED'.
+ */
+static void* wait_header(int file, size_t* size) {
+  struct timespec nap = {0, 1000000};
+  struct stat status;
+  for (int waited = 0; waited < SHARED_WAIT; waited++) {
+    if (fstat(file, &status) != 0) return MAP_FAILED;
+    if (status.st_size >= (off_t)sizeof(shared_header)) break;
+    nanosleep(&nap, NULL);
+  }
+  if (status.st_size < (off_t)sizeof(shared_header)) return MAP_FAILED;
+  *size = status.st_size;
+  shared_header* header =
+      mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  if (header == MAP_FAILED) return MAP_FAILED;
+  for (int waited = 0; waited < SHARED_WAIT; waited++) {
+    if (atomic_load_explicit(&header->magic, memory_order_acquire) ==
+        SHARED_MAGIC)
+      return header;
+    nanosleep(&nap, NULL);
+  }
+  munmap(header, *size);
+  return MAP_FAILED;
+}
+
+/**
+ * @brief This function will map the shared bank file of the given 'path' into
+ * this process. If the file don't exist, it is created for (at most)
+ * 'capacity' accounts and its locks are initialized, otherwise the layout
+ * of the existing file is used (whatever the 'capacity'). Returns the shared
+ * bank file's reference (not copy, thus need to be detached after usage),
+ * otherwise returns 'NULL' if it can't be created or is not a shared bank
+ * file.
+ * @param path The path of the shared bank file
+ * @param capacity The number of accounts a new file can hold (0 for default)
+ * @return SHARED (reference, not copy) or 'NULL'
+ */
+SHARED attach_shared(string path, unsigned int capacity) {
+  // Check: Wether the path exist!
+  if (path == NULL) return NULL;
+  if (capacity == 0) capacity = SHARED_CAPACITY;
+
+  // Create: Make space for the mapping's details
+  SHARED shared = (SHARED)calloc(1, sizeof(shared_element));
+  if (shared == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    return NULL;
+  }
+
+  // Open: Create the file, unless some process did already
+  size_t header = header_size();
+  shared_header* mapping = MAP_FAILED;
+  bool created = true;
+  int file = open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (file < 0 && errno == EEXIST) {
+    created = false;
+    file = open(path, O_RDWR);
+  }
+  if (file >= 0 && created) {
+    // Configure: The file is sparse, thus only the touched pages take space
+    shared->size = file_size(header, capacity);
+    if (ftruncate(file, shared->size) == 0)
+      mapping = mmap(NULL, shared->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     file, 0);
+    if (mapping != MAP_FAILED &&
+        init_header(mapping, header, capacity) == false) {
+      munmap(mapping, shared->size);
+      mapping = MAP_FAILED;
+    }
+    if (mapping == MAP_FAILED) unlink(path);
+  } else if (file >= 0)
+    mapping = wait_header(file, &shared->size);
+  if (file >= 0) close(file);
+
+  // Check: Whether the file is a shared bank file of this layout
+  if (mapping != MAP_FAILED &&
+      (mapping->version != SHARED_VERSION ||
+       mapping->header_size != header || mapping->capacity == 0 ||
+       shared->size != file_size(header, mapping->capacity))) {
+    munmap(mapping, shared->size);
+    mapping = MAP_FAILED;
+    errno = EINVAL;
+  }
+  if (mapping == MAP_FAILED) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Can't attach the shared bank file %s (%s).\n",
+        path, strerror(errno));
+    free(shared);
+    return NULL;
+  }
+
+  // Configure: Every column follows the previous one
+  char* base = (char*)mapping;
+  shared->header = mapping;
+  shared->capacity = mapping->capacity;
+  shared->amount = (long long int*)(base + header);
+  shared->pin = (long long unsigned int*)(shared->amount + shared->capacity);
+  shared->id = (unsigned int*)(shared->pin + shared->capacity);
+  shared->name = (char(*)[SHARED_NAME])(shared->id + shared->capacity);
+
+  // Status: Return the mapping's structure reference
+  return shared;
+}
+
+/**
+ * @brief This function will unmap the shared bank file from this process, the
+ * file and its accounts stay for the other processes. Returns 'true' if
+ * successfully detached, otherwise returns 'false'.
+ * @param shared The shared bank file's data structure reference
+ * @return 'true' or 'false'
+ */
+bool detach_shared(SHARED shared) {
+  // Check: Wether the mapping exist!
+  if (shared == NULL) return false;
+
+  // Clean: Unmap and free the mapping's details
+  bool status = munmap(shared->header, shared->size) == 0;
+  free(shared);
+  return status;
+}
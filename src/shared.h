@@ -0,0 +1,138 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file shared.h
+ * @brief Interface of the bank's account store shared by processes through a
+ * file
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef SHARED_H
+#define SHARED_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cs50.h"
+#include "snapshot.h"
+
+/**
+ * @brief Magic of the shared bank file ("TCXS"), stored last by the creator
+ */
+#define SHARED_MAGIC 0x53584354
+
+/**
+ * @brief Version of the layout of the shared bank file (2 since the PINs are
+ * hashed, a file of an older version may hold them as typed, thus refused)
+ */
+#define SHARED_VERSION 2
+
+/**
+ * @brief Bytes of the slot of a user name (terminated) in the shared bank file
+ */
+#define SHARED_NAME 64
+
+/**
+ * @brief Default number of accounts a new shared bank file can hold
+ */
+#define SHARED_CAPACITY (1 << 20)
+
+/**
+ * @brief Structure of the header of the shared bank file, i.e. the layout of
+ * the file, the number of published accounts and the process-shared (and
+ * robust) locks of the bank. The columns of the account store follow it, at
+ * 'header_size': the balances, the PINs, the ids and the user names, each of
+ * 'capacity' entries.
+ */
+typedef struct {
+  atomic_uint magic;
+  unsigned int version;
+  unsigned int header_size;
+  unsigned int capacity;
+  _Alignas(64) atomic_uint quantity;
+  pthread_mutex_t append_lock;
+  stripe_element stripe[SNAPSHOT_STRIPES];
+} shared_header;
+
+/**
+ * @brief Structure of the shared bank file mapped into this process, i.e. the
+ * header and the columns living in the mapping
+ */
+typedef struct {
+  shared_header* header;
+  size_t size;
+  unsigned int capacity;
+  long long int* amount;
+  long long unsigned int* pin;
+  unsigned int* id;
+  char (*name)[SHARED_NAME];
+} shared_element;
+
+/**
+ * @brief Shared bank file's Data structure Reference
+ */
+#define SHARED shared_element*
+
+/**
+ * @brief This function will map the shared bank file of the given 'path' into
+ * this process. If the file don't exist, it is created for (at most)
+ * 'capacity' accounts and its locks are initialized, otherwise the layout
+ * of the existing file is used (whatever the 'capacity'). Returns the shared
+ * bank file's reference (not copy, thus need to be detached after usage),
+ * otherwise returns 'NULL' if it can't be created or is not a shared bank
+ * file.
+ * @param path The path of the shared bank file
+ * @param capacity The number of accounts a new file can hold (0 for default)
+ * @return SHARED (reference, not copy) or 'NULL'
+ */
+SHARED attach_shared(string path, unsigned int capacity);
+
+/**
+ * @brief This function will unmap the shared bank file from this process, the
+ * file and its accounts stay for the other processes. Returns 'true' if
+ * successfully detached, otherwise returns 'false'.
+ * @param shared The shared bank file's data structure reference
+ * @return 'true' or 'false'
+ */
+bool detach_shared(SHARED shared);
+
+#endif
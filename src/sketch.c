@@ -0,0 +1,547 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file sketch.c
+ * @brief Streaming sketches of the analytics
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#include "sketch.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "console.h"
+
+/**
+ * @brief The shard of the calling thread (-1 till its first update)
+ */
+static _Thread_local int shard_of_thread = -1;
+
+/**
+ * @brief The shard of the next thread making its first update
+ */
+static atomic_uint next_shard = 0;
+
+/**
+ * @brief This function will return the seconds of the monotonic clock.
+ */
+static double now_seconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief This function will return the hours since the epoch.
+ */
+static long long unsigned int current_hour() {
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME_COARSE, &now);
+  return (long long unsigned int)now.tv_sec / 3600;
+}
+
+/**
+ * @brief This function will lock and return the shard of the calling thread.
+ */
+static sketch_shard* lock_shard(SKETCH sketch) {
+  if (shard_of_thread < 0)
+    shard_of_thread = (int)(atomic_fetch_add(&next_shard, 1) % SKETCH_SHARDS);
+  sketch_shard* shard = &sketch->shard[shard_of_thread];
+  pthread_mutex_lock(&shard->lock);
+  shard->updates++;
+  return shard;
+}
+
+/**
+ * @brief This function will return the next pseudo random number of a shard
+ * (xorshift).
+ */
+static unsigned int next_random(sketch_shard* shard) {
+  unsigned int x = shard->random;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return shard->random = x;
+}
+
+/**
+ * @brief This function will mix the bits of an id (splitmix64 finalizer).
+ */
+static long long unsigned int mix(long long unsigned int x) {
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+/**
+ * @brief This function will compare two amounts (for qsort).
+ */
+static int compare_amount(const void* a, const void* b) {
+  long long int x = *(const long long int*)a, y = *(const long long int*)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * @brief This function will merge two sorted runs of amounts into 'out',
+ * without branching on the comparisons (they are unpredictable).
+ */
+static void merge_runs(const long long int* a, unsigned int a_count,
+                       const long long int* b, unsigned int b_count,
+                       long long int* out) {
+  unsigned int i = 0, j = 0, k = 0;
+  while (i < a_count && j < b_count) {
+    long long int x = a[i], y = b[j];
+    bool second = y < x;
+    out[k++] = second ? y : x;
+    j += second;
+    i += !second;
+  }
+  while (i < a_count) out[k++] = a[i++];
+  while (j < b_count) out[k++] = b[j++];
+}
+
+/**
+ * @brief This function will sort the runs of 8 amounts (the rest, if any, is
+ * left as runs of 1) by a sorting network of 19 branchless exchanges.
+ */
+static void sort_eights(long long int* item, unsigned int count) {
+  static const unsigned char pair[19][2] = {
+      {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6},
+      {3, 7}, {0, 1}, {2, 3}, {4, 5}, {6, 7}, {2, 4}, {3, 5},
+      {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}};
+  for (unsigned int start = 0; start + 8 <= count; start += 8) {
+    long long int* run = item + start;
+    for (unsigned int k = 0; k < 19; k++) {
+      long long int x = run[pair[k][0]], y = run[pair[k][1]];
+      run[pair[k][0]] = (x < y) ? x : y;
+      run[pair[k][1]] = (x < y) ? y : x;
+    }
+  }
+}
+
+/**
+ * @brief This function will sort the amounts of a level made of sorted runs
+ * of 'width' amounts (bottom-up merge sort, runs of 1 are sorted by eights
+ * first), e.g. 1 for the first level and half a level for the others, as
+ * they are filled by two sorted halves.
+ */
+static void sort_amounts(long long int* item, unsigned int count,
+                         unsigned int width) {
+  long long int buffer[SKETCH_LEVEL];
+  long long int *from = item, *to = buffer;
+  if (width == 1 && count % 8 == 0) {
+    sort_eights(item, count);
+    width = 8;
+  }
+  for (; width < count; width *= 2) {
+    for (unsigned int start = 0; start < count; start += 2 * width) {
+      unsigned int middle = (start + width < count) ? start + width : count;
+      unsigned int end = (middle + width < count) ? middle + width : count;
+      merge_runs(from + start, middle - start, from + middle, end - middle,
+                 to + start);
+    }
+    long long int* swap = from;
+    from = to;
+    to = swap;
+  }
+  if (from != item) memcpy(item, from, count * sizeof(long long int));
+}
+
+/**
+ * @brief This function will add the user of the given 'id' to the HyperLogLog
+ * of the current hour of a shard, moving the hours on first.
+ */
+static void add_user(sketch_shard* shard, unsigned int id) {
+  // Check: Whether the hour moved on since the last user
+  long long unsigned int hour = current_hour();
+  if (shard->users[0].hour != hour) {
+    if (shard->users[0].hour + 1 == hour)
+      memcpy(&shard->users[1], &shard->users[0], sizeof(sketch_hll));
+    else
+      memset(&shard->users[1], 0, sizeof(sketch_hll));
+    memset(&shard->users[0], 0, sizeof(sketch_hll));
+    shard->users[0].hour = hour;
+  }
+
+  // Configure: The register of the top bits keeps the longest run of zeros
+  long long unsigned int hash = mix(id);
+  unsigned int index = (unsigned int)(hash >> (64 - SKETCH_HLL_BITS));
+  long long unsigned int rest = hash << SKETCH_HLL_BITS;
+  unsigned char rank = (rest == 0) ? 64 - SKETCH_HLL_BITS + 1
+                                   : (unsigned char)(__builtin_clzll(rest) + 1);
+  if (shard->users[0].rank[index] < rank) shard->users[0].rank[index] = rank;
+}
+
+/**
+ * @brief This function will sort a full level of a quantile sketch and
+ * promote every other item to the next level (compacting it first if full).
+ */
+static void compact(sketch_shard* shard, sketch_quantiles* quantiles,
+                    unsigned int level) {
+  // Check: The top level is never reached in practice (2^31 full levels)
+  unsigned int next = level + 1;
+  if (next == SKETCH_LEVELS ||
+      (quantiles->item[next] == NULL &&
+       (quantiles->item[next] = (long long int*)malloc(
+            SKETCH_LEVEL * sizeof(long long int))) == NULL)) {
+    quantiles->size[level] = 0;
+    return;
+  }
+  if (quantiles->size[next] == SKETCH_LEVEL) compact(shard, quantiles, next);
+
+  // Configure: Every other item, starting at random, stands for two now
+  long long int* item = quantiles->item[level];
+  sort_amounts(item, quantiles->size[level],
+               (level == 0) ? 1 : SKETCH_LEVEL / 2);
+  for (unsigned int i = next_random(shard) & 1; i < quantiles->size[level];
+       i += 2)
+    quantiles->item[next][quantiles->size[next]++] = item[i];
+  quantiles->size[level] = 0;
+}
+
+/**
+ * @brief This function will add a value to a quantile sketch of a shard.
+ */
+static void add_value(sketch_shard* shard, sketch_quantiles* quantiles,
+                      long long int value) {
+  if (quantiles->item[0] == NULL &&
+      (quantiles->item[0] = (long long int*)malloc(
+           SKETCH_LEVEL * sizeof(long long int))) == NULL)
+    return;
+  quantiles->item[0][quantiles->size[0]++] = value;
+  quantiles->count++;
+  if (quantiles->size[0] == SKETCH_LEVEL) compact(shard, quantiles, 0);
+}
+
+/**
+ * @brief This function will create empty sketches and return them as a
+ * reference (not copy, thus need to be freed after usage). If some error
+ * happens during creation, it will return NULL reference.
+ * @return SKETCH (reference, not copy) or 'NULL'
+ */
+SKETCH create_sketch() {
+  // Create: Make space for the shards, the levels are allocated on demand
+  SKETCH sketch = (SKETCH)calloc(1, sizeof(sketch_element));
+  if (sketch == NULL) return NULL;
+
+  // Configure: Every shard has a lock and a random seed of its own
+  for (unsigned int i = 0; i < SKETCH_SHARDS; i++) {
+    pthread_mutex_init(&sketch->shard[i].lock, NULL);
+    sketch->shard[i].random = 0x9E3779B9u * (i + 1);
+  }
+  return sketch;
+}
+
+/**
+ * @brief This function will take the sketches as an input and frees them.
+ * Returns 'true' if successfully deleted, otherwise returns 'false'.
+ * @param sketch The sketches' data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_sketch(SKETCH sketch) {
+  // Check: Whether the sketches exist
+  if (sketch == NULL) return false;
+
+  // Free: The levels of the quantile sketches, then the shards
+  for (unsigned int i = 0; i < SKETCH_SHARDS; i++) {
+    for (unsigned int l = 0; l < SKETCH_LEVELS; l++) {
+      free(sketch->shard[i].balances.item[l]);
+      free(sketch->shard[i].withdrawals.item[l]);
+    }
+    pthread_mutex_destroy(&sketch->shard[i].lock);
+  }
+  free(sketch);
+  return true;
+}
+
+/**
+ * @brief This function will count the user of the account of the given 'id'
+ * as active in the current hour (e.g. on login). The function returns
+ * nothing.
+ * @param sketch The sketches' data structure reference
+ * @param id The id of the account
+ * @return void (nothing)
+ */
+void sketch_user(SKETCH sketch, unsigned int id) {
+  if (sketch == NULL) return;
+  sketch_shard* shard = lock_shard(sketch);
+  add_user(shard, id);
+  pthread_mutex_unlock(&shard->lock);
+}
+
+/**
+ * @brief This function will add a withdrawal of the given 'amount' from the
+ * account of the given 'id', leaving the given 'balance', to the sketches.
+ * The function returns nothing.
+ * @param sketch The sketches' data structure reference
+ * @param id The id of the account
+ * @param amount The amount withdrawn
+ * @param balance The balance left
+ * @return void (nothing)
+ */
+void sketch_withdrawal(SKETCH sketch, unsigned int id, long long int amount,
+                       long long int balance) {
+  if (sketch == NULL) return;
+  sketch_shard* shard = lock_shard(sketch);
+  add_user(shard, id);
+  add_value(shard, &shard->withdrawals, amount);
+  add_value(shard, &shard->balances, balance);
+  pthread_mutex_unlock(&shard->lock);
+}
+
+/**
+ * @brief This function will add a cash withdrawal of the given 'amount' to
+ * the heavy hitters. The function returns nothing.
+ * @param sketch The sketches' data structure reference
+ * @param amount The cash amount withdrawn
+ * @return void (nothing)
+ */
+void sketch_cash(SKETCH sketch, long long int amount) {
+  if (sketch == NULL) return;
+  sketch_shard* shard = lock_shard(sketch);
+
+  // Check: Whether the amount is counted already, else find the least counted
+  sketch_counter* least = &shard->cash[0];
+  for (unsigned int i = 0; i < SKETCH_COUNTERS; i++) {
+    sketch_counter* counter = &shard->cash[i];
+    if (counter->count > 0 && counter->amount == amount) {
+      counter->count++;
+      pthread_mutex_unlock(&shard->lock);
+      return;
+    }
+    if (counter->count < least->count) least = counter;
+  }
+
+  // Configure: The least counted amount is replaced, inheriting its count
+  least->amount = amount;
+  least->error = least->count;
+  least->count++;
+  pthread_mutex_unlock(&shard->lock);
+}
+
+/**
+ * @brief This function will add the items of a quantile sketch of a shard,
+ * with their weights, to the given arrays. Returns the new number of items.
+ */
+static unsigned int gather_values(const sketch_quantiles* quantiles,
+                                  long long int* value,
+                                  long long unsigned int* weight,
+                                  unsigned int count) {
+  for (unsigned int l = 0; l < SKETCH_LEVELS; l++)
+    for (unsigned int i = 0; i < quantiles->size[l]; i++) {
+      value[count] = quantiles->item[l][i];
+      weight[count++] = 1ULL << l;
+    }
+  return count;
+}
+
+/**
+ * @brief This function will sort the weighted items (by their values) and
+ * write the quantiles 0.5, 0.9 and 0.99 of them.
+ */
+static void find_quantiles(long long int* value,
+                           long long unsigned int* weight, unsigned int count,
+                           long long int quantile[3]) {
+  // Configure: Sort the pairs by value (the weight rides along)
+  long long int* pair =
+      (long long int*)malloc((size_t)count * 2 * sizeof(long long int));
+  if (pair == NULL) return;
+  for (unsigned int i = 0; i < count; i++) {
+    pair[2 * i] = value[i];
+    pair[2 * i + 1] = (long long int)weight[i];
+  }
+  qsort(pair, count, 2 * sizeof(long long int), compare_amount);
+
+  // Configure: The first value whose cumulative weight reaches the rank
+  long long unsigned int total = 0;
+  for (unsigned int i = 0; i < count; i++) total += pair[2 * i + 1];
+  const double rank[3] = {0.5, 0.9, 0.99};
+  long long unsigned int seen = 0;
+  for (unsigned int i = 0, q = 0; i < count && q < 3; i++) {
+    seen += pair[2 * i + 1];
+    while (q < 3 && seen >= rank[q] * total) quantile[q++] = pair[2 * i];
+  }
+  free(pair);
+}
+
+/**
+ * @brief This function will return the natural logarithm of x >= 1 (no libm
+ * needed), i.e. k ln 2 + 2 atanh((y - 1) / (y + 1)) for x = 2^k y.
+ */
+static double natural_log(double x) {
+  unsigned int k = 0;
+  for (; x >= 2; x /= 2) k++;
+  double t = (x - 1) / (x + 1), power = t, sum = 0;
+  for (unsigned int i = 1; i < 40; i += 2, power *= t * t) sum += power / i;
+  return k * 0.69314718055994531 + 2 * sum;
+}
+
+/**
+ * @brief This function will return the estimate of a merged HyperLogLog.
+ */
+static double estimate_users(const unsigned char* rank) {
+  double sum = 0, m = SKETCH_HLL_REGISTERS;
+  unsigned int zeros = 0;
+  for (unsigned int i = 0; i < SKETCH_HLL_REGISTERS; i++) {
+    sum += 1.0 / (double)(1ULL << rank[i]);
+    if (rank[i] == 0) zeros++;
+  }
+  double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+
+  // Check: Few users are counted better by the empty registers
+  if (estimate <= 2.5 * m && zeros > 0) estimate = m * natural_log(m / zeros);
+  return estimate;
+}
+
+/**
+ * @brief This function will merge the shards and display the figures, i.e.
+ * the distinct users of the current and previous hour, the quantiles of the
+ * balances and withdrawals, the cash amounts withdrawn the most, and how many
+ * microseconds it took. The function returns nothing.
+ * @param sketch The sketches' data structure reference
+ * @return void (nothing)
+ */
+void display_sketch(SKETCH sketch) {
+  // Check: Whether the sketches exist
+  if (sketch == NULL) {
+    console_printf("\e[38;5;196mFailure:\e[0m There are no analytics.\n");
+    return;
+  }
+  double start = now_seconds();
+  long long unsigned int hour = current_hour();
+
+  // Create: Make space for the merged registers and items of every shard
+  static const unsigned int most = SKETCH_SHARDS * SKETCH_LEVELS * SKETCH_LEVEL;
+  unsigned char* users = (unsigned char*)calloc(2, SKETCH_HLL_REGISTERS);
+  long long int* value = (long long int*)malloc(2 * most * sizeof(long long));
+  long long unsigned int* weight = (long long unsigned int*)malloc(
+      2 * most * sizeof(long long unsigned int));
+  sketch_counter* cash = (sketch_counter*)calloc(
+      SKETCH_SHARDS * SKETCH_COUNTERS, sizeof(sketch_counter));
+  if (users == NULL || value == NULL || weight == NULL || cash == NULL) {
+    free(users);
+    free(value);
+    free(weight);
+    free(cash);
+    console_printf(
+        "\e[38;5;196mFailure:\e[0m Could not allocate the analytics.\n");
+    return;
+  }
+
+  // Copy: Merge the shards, the registers by maximum, the items side by side
+  // (the balances first, the withdrawals after 'most') and the counters of
+  // the same amount by sum
+  long long unsigned int updates = 0, balances = 0, withdrawals = 0;
+  unsigned int balance_items = 0, withdrawal_items = 0, amounts = 0;
+  for (unsigned int s = 0; s < SKETCH_SHARDS; s++) {
+    sketch_shard* shard = &sketch->shard[s];
+    pthread_mutex_lock(&shard->lock);
+    updates += shard->updates;
+    for (unsigned int h = 0; h < 2; h++) {
+      long long unsigned int age = hour - shard->users[h].hour;
+      if (age > 1) continue;
+      for (unsigned int i = 0; i < SKETCH_HLL_REGISTERS; i++)
+        if (users[age * SKETCH_HLL_REGISTERS + i] < shard->users[h].rank[i])
+          users[age * SKETCH_HLL_REGISTERS + i] = shard->users[h].rank[i];
+    }
+    balances += shard->balances.count;
+    withdrawals += shard->withdrawals.count;
+    balance_items =
+        gather_values(&shard->balances, value, weight, balance_items);
+    withdrawal_items = gather_values(&shard->withdrawals, value + most,
+                                     weight + most, withdrawal_items);
+    for (unsigned int i = 0; i < SKETCH_COUNTERS; i++) {
+      sketch_counter* counter = &shard->cash[i];
+      if (counter->count == 0) continue;
+      unsigned int k = 0;
+      while (k < amounts && cash[k].amount != counter->amount) k++;
+      if (k == amounts) cash[amounts++].amount = counter->amount;
+      cash[k].count += counter->count;
+      cash[k].error += counter->error;
+    }
+    pthread_mutex_unlock(&shard->lock);
+  }
+
+  // Configure: The estimates, and the amounts counted the most first
+  double current = estimate_users(users);
+  double previous = estimate_users(users + SKETCH_HLL_REGISTERS);
+  long long int balance[3] = {0}, withdrawal[3] = {0};
+  find_quantiles(value, weight, balance_items, balance);
+  find_quantiles(value + most, weight + most, withdrawal_items, withdrawal);
+  for (unsigned int i = 1; i < amounts; i++) {
+    sketch_counter counter = cash[i];
+    unsigned int k = i;
+    for (; k > 0 && cash[k - 1].count < counter.count; k--)
+      cash[k] = cash[k - 1];
+    cash[k] = counter;
+  }
+  double elapsed = (now_seconds() - start) * 1e6;
+
+  // Display: The figures, then the time they took
+  console_printf(
+      "\e[38;5;214mInfo:\e[0m Approximate figures of \e[38;5;214m%llu\e[0m "
+      "update(s), computed in \e[38;5;214m%.1f us\e[0m\n",
+      updates, elapsed);
+  console_printf(
+      "\e[38;5;214m>\e[0m Distinct users: ~%.0f this hour, ~%.0f the "
+      "previous hour (+- 2.3%%)\n",
+      current, previous);
+  console_printf(
+      "\e[38;5;214m>\e[0m Balances left by %llu withdrawal(s): p50 Rs. %lld, "
+      "p90 Rs. %lld, p99 Rs. %lld\n",
+      balances, balance[0], balance[1], balance[2]);
+  console_printf(
+      "\e[38;5;214m>\e[0m Amounts of %llu withdrawal(s): p50 Rs. %lld, p90 "
+      "Rs. %lld, p99 Rs. %lld\n",
+      withdrawals, withdrawal[0], withdrawal[1], withdrawal[2]);
+  console_printf("\e[38;5;214m>\e[0m Cash amounts withdrawn the most:\n");
+  if (amounts == 0) console_printf("  None yet\n");
+  for (unsigned int k = 0; k < amounts && k < 5; k++)
+    console_printf("  Rs. %lld about %llu time(s) (at most %llu less)\n",
+                   cash[k].amount, cash[k].count, cash[k].error);
+  free(users);
+  free(value);
+  free(weight);
+  free(cash);
+}
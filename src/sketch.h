@@ -0,0 +1,195 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file sketch.h
+ * @brief Interface of the streaming sketches of the analytics
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+/**
+ * @brief Number of shards of the sketches, each having a lock of its own
+ * (the threads are spread over the shards in turn)
+ */
+#define SKETCH_SHARDS 4
+
+/**
+ * @brief Bits of the index of a register of a HyperLogLog, and its registers
+ * (about 2.3% standard error)
+ */
+#define SKETCH_HLL_BITS 11
+#define SKETCH_HLL_REGISTERS (1 << SKETCH_HLL_BITS)
+
+/**
+ * @brief Items of a level of a quantile sketch, and its levels (an item of
+ * level 'l' stands for 2^l values)
+ */
+#define SKETCH_LEVEL 128
+#define SKETCH_LEVELS 32
+
+/**
+ * @brief Counters of a heavy hitter sketch
+ */
+#define SKETCH_COUNTERS 32
+
+/**
+ * @brief Structure of a HyperLogLog of the users active in an 'hour' (hours
+ * since the epoch)
+ */
+typedef struct {
+  long long unsigned int hour;
+  unsigned char rank[SKETCH_HLL_REGISTERS];
+} sketch_hll;
+
+/**
+ * @brief Structure of a quantile sketch (KLL with levels of equal size). A
+ * level is sorted and every other item (starting at random) is promoted to
+ * the next level when full, thus the memory grows with the logarithm of the
+ * values seen. The levels are allocated when first reached.
+ */
+typedef struct {
+  long long int* item[SKETCH_LEVELS];
+  unsigned int size[SKETCH_LEVELS];
+  long long unsigned int count;
+} sketch_quantiles;
+
+/**
+ * @brief Structure of a counter of a heavy hitter sketch, 'error' is how much
+ * of the 'count' may belong to the amounts it replaced
+ */
+typedef struct {
+  long long int amount;
+  long long unsigned int count;
+  long long unsigned int error;
+} sketch_counter;
+
+/**
+ * @brief Structure of a shard of the sketches
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  unsigned int random;
+  sketch_hll users[2];
+  sketch_quantiles balances;
+  sketch_quantiles withdrawals;
+  sketch_counter cash[SKETCH_COUNTERS];
+  long long unsigned int updates;
+} sketch_shard;
+
+/**
+ * @brief Structure of the streaming sketches of a bank: the distinct users
+ * active in the current and previous hour (HyperLogLog), the quantiles of
+ * the balances seen by withdrawals and of the amounts withdrawn (KLL), and
+ * the cash amounts withdrawn the most (Space-Saving). The memory is bounded
+ * whatever the number of accounts and operations.
+ */
+typedef struct {
+  sketch_shard shard[SKETCH_SHARDS];
+} sketch_element;
+
+/**
+ * @brief Streaming sketches' Data structure Reference
+ */
+#define SKETCH sketch_element*
+
+/**
+ * @brief This function will create empty sketches and return them as a
+ * reference (not copy, thus need to be freed after usage). If some error
+ * happens during creation, it will return NULL reference.
+ * @return SKETCH (reference, not copy) or 'NULL'
+ */
+SKETCH create_sketch();
+
+/**
+ * @brief This function will take the sketches as an input and frees them.
+ * Returns 'true' if successfully deleted, otherwise returns 'false'.
+ * @param sketch The sketches' data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_sketch(SKETCH sketch);
+
+/**
+ * @brief This function will count the user of the account of the given 'id'
+ * as active in the current hour (e.g. on login). The function returns
+ * nothing.
+ * @param sketch The sketches' data structure reference
+ * @param id The id of the account
+ * @return void (nothing)
+ */
+void sketch_user(SKETCH sketch, unsigned int id);
+
+/**
+ * @brief This function will add a withdrawal of the given 'amount' from the
+ * account of the given 'id', leaving the given 'balance', to the sketches.
+ * The function returns nothing.
+ * @param sketch The sketches' data structure reference
+ * @param id The id of the account
+ * @param amount The amount withdrawn
+ * @param balance The balance left
+ * @return void (nothing)
+ */
+void sketch_withdrawal(SKETCH sketch, unsigned int id, long long int amount,
+                       long long int balance);
+
+/**
+ * @brief This function will add a cash withdrawal of the given 'amount' to
+ * the heavy hitters. The function returns nothing.
+ * @param sketch The sketches' data structure reference
+ * @param amount The cash amount withdrawn
+ * @return void (nothing)
+ */
+void sketch_cash(SKETCH sketch, long long int amount);
+
+/**
+ * @brief This function will merge the shards and display the figures, i.e.
+ * the distinct users of the current and previous hour, the quantiles of the
+ * balances and withdrawals, the cash amounts withdrawn the most, and how many
+ * microseconds it took. The function returns nothing.
+ * @param sketch The sketches' data structure reference
+ * @return void (nothing)
+ */
+void display_sketch(SKETCH sketch);
+
+#endif
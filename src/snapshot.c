@@ -0,0 +1,326 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file snapshot.c
+ * @brief Implementation of snapshot (seqlock and epoch) related functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "snapshot.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief This function will free every retired memory no reader can see
+ * anymore. The retire lock must be held.
+ */
+static void reclaim(SNAPSHOT snapshot) {
+  // Find: The oldest epoch of the readers inside
+  long long unsigned int oldest = (long long unsigned int)-1;
+  for (int i = 0; i < SNAPSHOT_READERS; i++) {
+    long long unsigned int epoch = atomic_load(&snapshot->reader[i]);
+    if (epoch != 0 && epoch < oldest) oldest = epoch;
+  }
+
+  // Clean: Memory retired before the oldest reader got in
+  retired_element** link = &snapshot->retired;
+  while (*link != NULL) {
+    retired_element* entry = *link;
+    if (entry->epoch < oldest) {
+      *link = entry->next;
+      free(entry->memory);
+      free(entry);
+    } else {
+      link = &entry->next;
+    }
+  }
+}
+
+/**
+ * @brief This function will create a snapshot (structure) and return it as a
+ * reference (not copy, thus need to be freed after usage). If some error
+ * happens during creation, it will return NULL reference.
+ * @return SNAPSHOT (reference, not copy) or 'NULL'
+ */
+SNAPSHOT create_snapshot() {
+  // Create: Make space for the snapshot (aligned for the stripes)
+  SNAPSHOT snapshot = NULL;
+  if (posix_memalign((void**)&snapshot, 64, sizeof(snapshot_element)) != 0)
+    return NULL;
+
+  // Configure: Every stripe is free and every reader is out
+  for (int i = 0; i < SNAPSHOT_STRIPES; i++) {
+    atomic_init(&snapshot->own_stripe[i].sequence, 0);
+    pthread_mutex_init(&snapshot->own_stripe[i].lock, NULL);
+  }
+  pthread_mutex_init(&snapshot->own_append_lock, NULL);
+  snapshot->stripe = snapshot->own_stripe;
+  snapshot->append_lock = &snapshot->own_append_lock;
+  atomic_init(&snapshot->epoch, 1);
+  for (int i = 0; i < SNAPSHOT_READERS; i++)
+    atomic_init(&snapshot->reader[i], 0);
+  pthread_mutex_init(&snapshot->retire_lock, NULL);
+  snapshot->retired = NULL;
+
+  // Status: Return the snapshot's structure reference
+  return snapshot;
+}
+
+/**
+ * @brief This function will take the snapshot as an input and frees it along
+ * with every retired memory. No reader may be inside. Returns 'true' if
+ * successfully deleted, otherwise returns 'false'.
+ * @param snapshot The snapshot's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_snapshot(SNAPSHOT snapshot) {
+  // Check: Whether the snapshot exist!
+  if (snapshot == NULL) return false;
+
+  // Clean: Retired memory, locks and the snapshot
+  pthread_mutex_lock(&snapshot->retire_lock);
+  reclaim(snapshot);
+  pthread_mutex_unlock(&snapshot->retire_lock);
+  for (int i = 0; i < SNAPSHOT_STRIPES; i++)
+    pthread_mutex_destroy(&snapshot->own_stripe[i].lock);
+  pthread_mutex_destroy(&snapshot->own_append_lock);
+  pthread_mutex_destroy(&snapshot->retire_lock);
+  free(snapshot);
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will lock the given mutex. If it is a robust one whose
+ * owner died inside, the mutex is made consistent and the (odd) 'sequence' of
+ * the stripe, if any, is closed. Writes are single stores of whole fields,
+ * thus whatever the owner wrote is kept as it is.
+ */
+static void lock_robust(pthread_mutex_t* lock, atomic_uint* sequence) {
+  if (pthread_mutex_lock(lock) != EOWNERDEAD) return;
+  if (sequence != NULL && atomic_load(sequence) % 2 == 1)
+    atomic_fetch_add(sequence, 1);
+  pthread_mutex_consistent(lock);
+}
+
+/**
+ * @brief This function will make the snapshot use the given 'stripes' and
+ * 'append_lock' instead of its own, e.g. the process-shared (and robust) ones
+ * of a memory-mapped file. A writer that died while holding one of them is
+ * recovered by the next writer. No writer may be inside.
+ * @param snapshot The snapshot's data structure reference
+ * @param stripes The stripes to be used (SNAPSHOT_STRIPES of them)
+ * @param append_lock The append lock to be used
+ */
+void share_snapshot(SNAPSHOT snapshot, stripe_element stripes[],
+                    pthread_mutex_t* append_lock) {
+  snapshot->stripe = stripes;
+  snapshot->append_lock = append_lock;
+}
+
+/**
+ * @brief This function will let the caller append to the account store (and
+ * change what goes along, e.g. the name index), waiting for other appenders.
+ * @param snapshot The snapshot's data structure reference
+ */
+void append_begin(SNAPSHOT snapshot) {
+  lock_robust(snapshot->append_lock, NULL);
+}
+
+/**
+ * @brief This function will let the next appender in.
+ * @param snapshot The snapshot's data structure reference
+ */
+void append_end(SNAPSHOT snapshot) {
+  pthread_mutex_unlock(snapshot->append_lock);
+}
+
+/**
+ * @brief This function will return the stripe of the given account id.
+ * @param id The id of the account
+ * @return stripe
+ */
+unsigned int stripe_of(unsigned int id) {
+  return (id / SNAPSHOT_SPAN) % SNAPSHOT_STRIPES;
+}
+
+/**
+ * @brief This function will let the caller write into the accounts of the
+ * given 'stripe', waiting only for other writers of the same stripe. Readers
+ * are never waited for.
+ * @param snapshot The snapshot's data structure reference
+ * @param stripe The stripe to be written
+ */
+void write_begin(SNAPSHOT snapshot, unsigned int stripe) {
+  lock_robust(&snapshot->stripe[stripe].lock,
+              &snapshot->stripe[stripe].sequence);
+  atomic_fetch_add_explicit(&snapshot->stripe[stripe].sequence, 1,
+                            memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * @brief This function will publish the writes into the given 'stripe' to the
+ * readers and let the next writer in.
+ * @param snapshot The snapshot's data structure reference
+ * @param stripe The stripe written
+ */
+void write_end(SNAPSHOT snapshot, unsigned int stripe) {
+  atomic_fetch_add_explicit(&snapshot->stripe[stripe].sequence, 1,
+                            memory_order_release);
+  pthread_mutex_unlock(&snapshot->stripe[stripe].lock);
+}
+
+/**
+ * @brief This function will let the caller write into every stripe, e.g. for
+ * moving the whole account store.
+ * @param snapshot The snapshot's data structure reference
+ */
+void write_begin_all(SNAPSHOT snapshot) {
+  for (unsigned int i = 0; i < SNAPSHOT_STRIPES; i++)
+    write_begin(snapshot, i);
+}
+
+/**
+ * @brief This function will publish the writes into every stripe.
+ * @param snapshot The snapshot's data structure reference
+ */
+void write_end_all(SNAPSHOT snapshot) {
+  for (unsigned int i = SNAPSHOT_STRIPES; i > 0; i--)
+    write_end(snapshot, i - 1);
+}
+
+/**
+ * @brief This function will enter the reader into the current epoch, thus any
+ * memory seen from now on stays alive until read_exit(). Returns the slot of
+ * the reader to be handed over to read_exit().
+ * @param snapshot The snapshot's data structure reference
+ * @return slot
+ */
+int read_enter(SNAPSHOT snapshot) {
+  // Find: A free slot, starting from one picked by the thread
+  static _Thread_local char anchor;
+  int slot = ((uintptr_t)&anchor >> 6) % SNAPSHOT_READERS;
+  while (true) {
+    for (int i = 0; i < SNAPSHOT_READERS; i++) {
+      int probe = (slot + i) % SNAPSHOT_READERS;
+      long long unsigned int idle = 0;
+      long long unsigned int epoch = atomic_load(&snapshot->epoch);
+      if (atomic_compare_exchange_strong(&snapshot->reader[probe], &idle,
+                                         epoch))
+        return probe;
+    }
+    sched_yield();
+  }
+}
+
+/**
+ * @brief This function will take the reader of the given 'slot' out of its
+ * epoch.
+ * @param snapshot The snapshot's data structure reference
+ * @param slot The slot returned by read_enter()
+ */
+void read_exit(SNAPSHOT snapshot, int slot) {
+  atomic_store_explicit(&snapshot->reader[slot], 0, memory_order_release);
+}
+
+/**
+ * @brief This function will start an optimistic read of the given 'stripe',
+ * waiting while a writer is inside. Returns the sequence to be handed over to
+ * read_retry().
+ * @param snapshot The snapshot's data structure reference
+ * @param stripe The stripe to be read
+ * @return sequence
+ */
+unsigned int read_begin(SNAPSHOT snapshot, unsigned int stripe) {
+  unsigned int sequence;
+  while ((sequence = atomic_load_explicit(&snapshot->stripe[stripe].sequence,
+                                          memory_order_acquire)) &
+         1)
+    sched_yield();
+  return sequence;
+}
+
+/**
+ * @brief This function will check whether a writer got into the given
+ * 'stripe' since read_begin(). Returns 'true' if the read has to be retried,
+ * otherwise returns 'false' when the read is consistent.
+ * @param snapshot The snapshot's data structure reference
+ * @param stripe The stripe read
+ * @param sequence The sequence returned by read_begin()
+ * @return 'true' or 'false'
+ */
+bool read_retry(SNAPSHOT snapshot, unsigned int stripe,
+                unsigned int sequence) {
+  atomic_thread_fence(memory_order_acquire);
+  return atomic_load_explicit(&snapshot->stripe[stripe].sequence,
+                              memory_order_relaxed) != sequence;
+}
+
+/**
+ * @brief This function will free the given 'memory' (already replaced, thus
+ * unreachable for new readers) as soon as no reader of an earlier epoch is
+ * left. The writer never waits for the readers.
+ * @param snapshot The snapshot's data structure reference
+ * @param memory The memory to be freed
+ */
+void retire(SNAPSHOT snapshot, void* memory) {
+  // Check: Whether there is something to retire
+  if (memory == NULL) return;
+
+  // Create: Entry tagged with the current epoch, then move the epoch on
+  retired_element* entry = (retired_element*)malloc(sizeof(retired_element));
+  if (entry == NULL) {
+    // Leak rather than free memory a reader may still see
+    return;
+  }
+  entry->memory = memory;
+  pthread_mutex_lock(&snapshot->retire_lock);
+  entry->epoch = atomic_fetch_add(&snapshot->epoch, 1);
+  entry->next = snapshot->retired;
+  snapshot->retired = entry;
+
+  // Clean: Whatever no reader can see anymore
+  reclaim(snapshot);
+  pthread_mutex_unlock(&snapshot->retire_lock);
+}
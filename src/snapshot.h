@@ -0,0 +1,234 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file snapshot.h
+ * @brief Interface of snapshot (seqlock and epoch) related functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/**
+ * @brief Number of stripes (seqlocks) the accounts are spread over
+ */
+#define SNAPSHOT_STRIPES 64
+
+/**
+ * @brief Number of consecutive account ids sharing a stripe, thus a batch over
+ * a block of ids holds a single stripe
+ */
+#define SNAPSHOT_SPAN 4096
+
+/**
+ * @brief Maximum number of readers inside an epoch at the same time
+ */
+#define SNAPSHOT_READERS 64
+
+/**
+ * @brief Structure of a stripe, the sequence is odd while a writer is inside
+ * and the lock serializes the writers of the stripe
+ */
+typedef struct {
+  _Alignas(64) atomic_uint sequence;
+  pthread_mutex_t lock;
+} stripe_element;
+
+/**
+ * @brief Structure of a memory block waiting until no reader can see it
+ */
+typedef struct retired_element {
+  void* memory;
+  long long unsigned int epoch;
+  struct retired_element* next;
+} retired_element;
+
+/**
+ * @brief Structure of the snapshot, i.e. the seqlocks of the stripes, the
+ * lock serializing appends to the store and the epochs of the readers used
+ * for deferring the free of replaced memory. The stripes and the append lock
+ * are its own, unless shared with other processes (see share_snapshot()).
+ */
+typedef struct {
+  stripe_element* stripe;
+  pthread_mutex_t* append_lock;
+  stripe_element own_stripe[SNAPSHOT_STRIPES];
+  pthread_mutex_t own_append_lock;
+  _Alignas(64) atomic_ullong epoch;
+  atomic_ullong reader[SNAPSHOT_READERS];
+  pthread_mutex_t retire_lock;
+  retired_element* retired;
+} snapshot_element;
+
+/**
+ * @brief Snapshot's Data structure Reference
+ */
+#define SNAPSHOT snapshot_element*
+
+/**
+ * @brief This function will create a snapshot (structure) and return it as a
+ * reference (not copy, thus need to be freed after usage). If some error
+ * happens during creation, it will return NULL reference.
+ * @return SNAPSHOT (reference, not copy) or 'NULL'
+ */
+SNAPSHOT create_snapshot();
+
+/**
+ * @brief This function will take the snapshot as an input and frees it along
+ * with every retired memory. No reader may be inside. Returns 'true' if
+ * successfully deleted, otherwise returns 'false'.
+ * @param snapshot The snapshot's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_snapshot(SNAPSHOT snapshot);
+
+/**
+ * @brief This function will make the snapshot use the given 'stripes' and
+ * 'append_lock' instead of its own, e.g. the process-shared (and robust) ones
+ * of a memory-mapped file. A writer that died while holding one of them is
+ * recovered by the next writer. No writer may be inside.
+ * @param snapshot The snapshot's data structure reference
+ * @param stripes The stripes to be used (SNAPSHOT_STRIPES of them)
+ * @param append_lock The append lock to be used
+ */
+void share_snapshot(SNAPSHOT snapshot, stripe_element stripes[],
+                    pthread_mutex_t* append_lock);
+
+/**
+ * @brief This function will let the caller append to the account store (and
+ * change what goes along, e.g. the name index), waiting for other appenders.
+ * @param snapshot The snapshot's data structure reference
+ */
+void append_begin(SNAPSHOT snapshot);
+
+/**
+ * @brief This function will let the next appender in.
+ * @param snapshot The snapshot's data structure reference
+ */
+void append_end(SNAPSHOT snapshot);
+
+/**
+ * @brief This function will return the stripe of the given account id.
+ * @param id The id of the account
+ * @return stripe
+ */
+unsigned int stripe_of(unsigned int id);
+
+/**
+ * @brief This function will let the caller write into the accounts of the
+ * given 'stripe', waiting only for other writers of the same stripe. Readers
+ * are never waited for.
+ * @param snapshot The snapshot's data structure reference
+ * @param stripe The stripe to be written
+ */
+void write_begin(SNAPSHOT snapshot, unsigned int stripe);
+
+/**
+ * @brief This function will publish the writes into the given 'stripe' to the
+ * readers and let the next writer in.
+ * @param snapshot The snapshot's data structure reference
+ * @param stripe The stripe written
+ */
+void write_end(SNAPSHOT snapshot, unsigned int stripe);
+
+/**
+ * @brief This function will let the caller write into every stripe, e.g. for
+ * moving the whole account store.
+ * @param snapshot The snapshot's data structure reference
+ */
+void write_begin_all(SNAPSHOT snapshot);
+
+/**
+ * @brief This function will publish the writes into every stripe.
+ * @param snapshot The snapshot's data structure reference
+ */
+void write_end_all(SNAPSHOT snapshot);
+
+/**
+ * @brief This function will enter the reader into the current epoch, thus any
+ * memory seen from now on stays alive until read_exit(). Returns the slot of
+ * the reader to be handed over to read_exit().
+ * @param snapshot The snapshot's data structure reference
+ * @return slot
+ */
+int read_enter(SNAPSHOT snapshot);
+
+/**
+ * @brief This function will take the reader of the given 'slot' out of its
+ * epoch.
+ * @param snapshot The snapshot's data structure reference
+ * @param slot The slot returned by read_enter()
+ */
+void read_exit(SNAPSHOT snapshot, int slot);
+
+/**
+ * @brief This function will start an optimistic read of the given 'stripe',
+ * waiting while a writer is inside. Returns the sequence to be handed over to
+ * read_retry().
+ * @param snapshot The snapshot's data structure reference
+ * @param stripe The stripe to be read
+ * @return sequence
+ */
+unsigned int read_begin(SNAPSHOT snapshot, unsigned int stripe);
+
+/**
+ * @brief This function will check whether a writer got into the given
+ * 'stripe' since read_begin(). Returns 'true' if the read has to be retried,
+ * otherwise returns 'false' when the read is consistent.
+ * @param snapshot The snapshot's data structure reference
+ * @param stripe The stripe read
+ * @param sequence The sequence returned by read_begin()
+ * @return 'true' or 'false'
+ */
+bool read_retry(SNAPSHOT snapshot, unsigned int stripe, unsigned int sequence);
+
+/**
+ * @brief This function will free the given 'memory' (already replaced, thus
+ * unreachable for new readers) as soon as no reader of an earlier epoch is
+ * left. The writer never waits for the readers.
+ * @param snapshot The snapshot's data structure reference
+ * @param memory The memory to be freed
+ */
+void retire(SNAPSHOT snapshot, void* memory);
+
+#endif
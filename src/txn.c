@@ -0,0 +1,439 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file txn.c
+ * @brief Implementation of transaction (begin/commit) related functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "txn.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "console.h"
+#include "snapshot.h"
+
+/**
+ * @brief The outcomes of touching an account
+ */
+enum { TOUCH_DONE, TOUCH_CLOSED, TOUCH_NO_MEMORY };
+
+/**
+ * @brief This function will find the account of the given 'id' among the
+ * touched ones, touching it (with the committed balance) if needed, into
+ * 'touched'. Returns TOUCH_DONE, otherwise returns TOUCH_CLOSED if the
+ * account is closed (or reused) since the user logged in, or
+ * TOUCH_NO_MEMORY.
+ */
+static int touch_account(TXN txn, BANK bank, unsigned int id,
+                         unsigned int generation, txn_account** touched) {
+  // Find: Among the touched accounts
+  for (unsigned int i = 0; i < txn->touched; i++)
+    if (txn->accounts[i].id == id) {
+      *touched = &txn->accounts[i];
+      return (generation == (*touched)->generation) ? TOUCH_DONE
+                                                    : TOUCH_CLOSED;
+    }
+
+  // Create: Make space for one more account
+  if (txn->touched == txn->capacity) {
+    unsigned int capacity = (txn->capacity == 0) ? 8 : txn->capacity * 2;
+    txn_account* accounts = (txn_account*)realloc(
+        txn->accounts, sizeof(txn_account) * capacity);
+    if (accounts == NULL) return TOUCH_NO_MEMORY;
+    txn->accounts = accounts;
+    txn->capacity = capacity;
+  }
+
+  // Read: The committed balance, without blocking the writers (the commit
+  // checks the generation again, holding the stripe)
+  account_element account;
+  char name[1];
+  if (snapshot_account(bank, id, &account, name, sizeof(name)) == false ||
+      (generation != BANK_ANY_GENERATION &&
+       get_generation(bank, id) != generation))
+    return TOUCH_CLOSED;
+  *touched = &txn->accounts[txn->touched++];
+  (*touched)->id = id;
+  (*touched)->generation = generation;
+  (*touched)->change = 0;
+  (*touched)->balance = account.amount;
+  return TOUCH_DONE;
+}
+
+/**
+ * @brief This function will print why the account can't be touched, and mark
+ * the transaction as failed.
+ */
+static void touch_failed(TXN txn, int touch) {
+  if (touch == TOUCH_CLOSED)
+    console_printf("\e[38;5;196mError:\e[0m Login required.\n");
+  else
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+  txn->failed = true;
+}
+
+/**
+ * @brief This function will append the record to the redo log and coalesce it
+ * into the change of its account. Returns 'true' if done, otherwise returns
+ * 'false' if out of memory.
+ */
+static bool append_record(TXN txn, txn_account* account, long long int amount,
+                          bool cash) {
+  // Create: Make space for one more record
+  if (txn->records == txn->log_capacity) {
+    unsigned int capacity =
+        (txn->log_capacity == 0) ? 16 : txn->log_capacity * 2;
+    txn_record* log =
+        (txn_record*)realloc(txn->log, sizeof(txn_record) * capacity);
+    if (log == NULL) return false;
+    txn->log = log;
+    txn->log_capacity = capacity;
+  }
+
+  // Record: In order, and coalesced per account
+  txn->log[txn->records].id = account->id;
+  txn->log[txn->records].slot = account - txn->accounts;
+  txn->log[txn->records].amount = amount;
+  txn->log[txn->records].cash = cash;
+  txn->records++;
+  account->change += amount;
+  account->balance += amount;
+  return true;
+}
+
+/**
+ * @brief This function will begin an empty transaction and return it as a
+ * reference (not copy, thus need to be freed by commit or abort). If some
+ * error happens during creation, it will return NULL reference.
+ * @return TXN (reference, not copy) or 'NULL'
+ */
+TXN begin_transaction() {
+  // Create: Make space for the transaction, logs grow on demand
+  TXN txn = (TXN)calloc(1, sizeof(txn_element));
+  if (txn == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    return NULL;
+  }
+  txn->log = NULL;
+  txn->records = 0;
+  txn->log_capacity = 0;
+  txn->accounts = NULL;
+  txn->touched = 0;
+  txn->capacity = 0;
+  txn->failed = false;
+
+  // Status: Return the transaction's structure reference
+  return txn;
+}
+
+/**
+ * @brief This function will buffer the deposit of the given 'amount' into the
+ * bank account of the given 'id'. Nothing is applied before commit. Returns
+ * 'true' if buffered, otherwise returns 'false'.
+ * @param txn The transaction's data structure reference
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account (-1 if nobody)
+ * @param generation The generation of the account (see get_generation)
+ * @param amount The amount which has to be deposited
+ * @return 'true' or 'false'
+ */
+bool txn_deposit(TXN txn, BANK bank, int id, unsigned int generation,
+                 long long int amount) {
+  // Check: Whether the transaction and bank exist!
+  if (txn == NULL || bank == NULL) return false;
+
+  // Check: Whether the user is logged in
+  if (id < 0 || (unsigned int)id >= __atomic_load_n(&bank->accounts_quantity,
+                                                    __ATOMIC_ACQUIRE)) {
+    console_printf("\e[38;5;196mError:\e[0m Login required.\n");
+    txn->failed = true;
+    return false;
+  }
+
+  // Check: Whether the amount is positive
+  if (amount <= 0) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Amount must be in positive numeric.\n");
+    txn->failed = true;
+    return false;
+  }
+
+  // Record: Into the redo log
+  txn_account* account;
+  int touch = touch_account(txn, bank, id, generation, &account);
+  if (touch != TOUCH_DONE) {
+    touch_failed(txn, touch);
+    return false;
+  }
+  if (append_record(txn, account, amount, false) == false) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    txn->failed = true;
+    return false;
+  }
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will buffer the withdrawal of the given 'amount' from
+ * the bank account of the given 'id', checked against the working balance
+ * (i.e. including the earlier records of the transaction). Nothing is applied
+ * before commit. Returns 'true' if buffered, otherwise returns 'false' and
+ * the transaction is failed.
+ * @param txn The transaction's data structure reference
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account (-1 if nobody)
+ * @param generation The generation of the account (see get_generation)
+ * @param amount The amount which has to be withdrawn
+ * @param cash Whether the amount is withdrawn as cash
+ * @return 'true' or 'false'
+ */
+bool txn_withdraw(TXN txn, BANK bank, int id, unsigned int generation,
+                  long long int amount, bool cash) {
+  // Check: Whether the transaction and bank exist!
+  if (txn == NULL || bank == NULL) return false;
+
+  // Check: Whether the user is logged in
+  if (id < 0 || (unsigned int)id >= __atomic_load_n(&bank->accounts_quantity,
+                                                    __ATOMIC_ACQUIRE)) {
+    console_printf("\e[38;5;196mError:\e[0m Login required.\n");
+    txn->failed = true;
+    return false;
+  }
+
+  // Check: Whether the amount is positive
+  if (amount <= 0) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m Amount must be in positive numeric.\n");
+    txn->failed = true;
+    return false;
+  }
+
+  // Check: Whether the working balance is enough
+  txn_account* account;
+  int touch = touch_account(txn, bank, id, generation, &account);
+  if (touch != TOUCH_DONE) {
+    touch_failed(txn, touch);
+    return false;
+  }
+  if (amount > account->balance) {
+    console_printf("\e[38;5;196mError:\e[0m You don't have enough amount.\n");
+    txn->failed = true;
+    return false;
+  }
+
+  // Record: Into the redo log
+  if (append_record(txn, account, -amount, cash) == false) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    txn->failed = true;
+    return false;
+  }
+
+  // Status: Reached success
+  return true;
+}
+
+/**
+ * @brief This function will mark the transaction as failed, e.g. when an
+ * operation in between begin and commit is rejected, thus the commit applies
+ * nothing. Returns 'true' if marked, otherwise returns 'false'.
+ * @param txn The transaction's data structure reference
+ * @return 'true' or 'false'
+ */
+bool fail_transaction(TXN txn) {
+  if (txn == NULL) return false;
+  txn->failed = true;
+  return true;
+}
+
+/**
+ * @brief This function will apply the transaction atomically: the stripes of
+ * every touched account are held, the redo log is replayed once in order on
+ * the working balances of the accounts (every withdrawal debited within the
+ * balance and the limits, see debit_balance) and, only if every record is
+ * taken, each account is written once with its final balance and the
+ * withdrawals are counted in the analytics. A failed
+ * transaction applies nothing, the limits are rolled back from the undo
+ * image. The transaction is freed in any case. Returns 'true' if committed,
+ * otherwise returns 'false'.
+ * @param txn The transaction's data structure reference
+ * @param bank The bank's data struture reference
+ * @return 'true' or 'false'
+ */
+bool commit_transaction(TXN txn, BANK bank) {
+  // Check: Whether the transaction and bank exist!
+  if (txn == NULL) return false;
+  if (bank == NULL || resident_accounts(bank) == false) {
+    abort_transaction(txn);
+    return false;
+  }
+
+  // Check: Whether an operation in between failed
+  if (txn->failed) {
+    console_printf(
+        "\e[38;5;196mError:\e[0m An operation in between begin and commit "
+        "failed, nothing is committed.\n");
+    abort_transaction(txn);
+    return false;
+  }
+
+  // Create: Space for the journal's group of the new balances
+  journal_entry* entries = NULL;
+  if (bank->journal != NULL &&
+      (entries = (journal_entry*)malloc(sizeof(journal_entry) *
+                                        (txn->touched + 1))) == NULL) {
+    console_printf("\e[38;5;196mError:\e[0m Out of memory.\n");
+    abort_transaction(txn);
+    return false;
+  }
+
+  // Lock: Every touched stripe, in order so that commits can't deadlock
+  bool held[SNAPSHOT_STRIPES] = {false};
+  for (unsigned int i = 0; i < txn->touched; i++)
+    held[stripe_of(txn->accounts[i].id)] = true;
+  for (unsigned int i = 0; i < SNAPSHOT_STRIPES; i++)
+    if (held[i]) write_begin(bank->sync, i);
+
+  // Check: Every account is still of its generation, before any is written
+  int debited = DEBIT_DONE;
+  for (unsigned int i = 0; i < txn->touched && debited == DEBIT_DONE; i++)
+    if (check_generation(bank, txn->accounts[i].id,
+                         txn->accounts[i].generation) == false)
+      debited = DEBIT_NO_ACCOUNT;
+
+  // Prepare: The working balance of every account, from the committed one,
+  // and the undo image of its limits
+  for (unsigned int i = 0; i < txn->touched && debited == DEBIT_DONE; i++) {
+    txn_account* account = &txn->accounts[i];
+    fold_balance(bank, account->id);
+    account->balance = bank->account.amount[account->id];
+    account->undo_limit = bank->account.limit[account->id];
+  }
+
+  // Replay: The redo log once, in order, each record on its account's
+  // working balance
+  for (unsigned int i = 0; i < txn->records && debited == DEBIT_DONE; i++) {
+    txn_account* account = &txn->accounts[txn->log[i].slot];
+    if (txn->log[i].amount > 0)
+      account->balance += txn->log[i].amount;
+    else if ((debited = debit_balance(bank, account->id, &account->balance,
+                                      -txn->log[i].amount)) == DEBIT_DONE)
+      txn->log[i].left = account->balance;
+  }
+  bool committed = debited == DEBIT_DONE;
+
+  // Write: Every account once, otherwise roll the limits back (the
+  // withdrawals refused by the limits stay counted)
+  for (unsigned int i = 0; i < txn->touched; i++) {
+    txn_account* account = &txn->accounts[i];
+    limit_element* limit = &bank->account.limit[account->id];
+    if (committed == true)
+      bank->account.amount[account->id] = account->balance;
+    else if (debited != DEBIT_NO_ACCOUNT) {
+      unsigned short blocked = limit->blocked;
+      *limit = account->undo_limit;
+      limit->blocked = blocked;
+    }
+  }
+
+  // Journal: Every new balance as a single group
+  if (committed == true && entries != NULL) {
+    for (unsigned int i = 0; i < txn->touched; i++) {
+      entries[i].id = txn->accounts[i].id;
+      entries[i].amount = bank->account.amount[txn->accounts[i].id];
+    }
+    journal_accounts(bank->journal, entries, txn->touched);
+  }
+  free(entries);
+
+  // Unlock: Publish every stripe at once
+  for (unsigned int i = SNAPSHOT_STRIPES; i > 0; i--)
+    if (held[i - 1]) write_end(bank->sync, i - 1);
+
+  // Update: The analytics with the committed withdrawals only, outside of
+  // the locks of the accounts
+  for (unsigned int i = 0; committed == true && i < txn->records; i++)
+    if (txn->log[i].amount < 0)
+      count_withdrawal(bank, txn->log[i].id, -txn->log[i].amount,
+                       txn->log[i].left, txn->log[i].cash);
+
+  if (debited == DEBIT_NO_ACCOUNT)
+    console_printf("\e[38;5;196mError:\e[0m Login required.\n");
+  else if (debited == DEBIT_LIMITED)
+    console_printf(
+        "\e[38;5;196mError:\e[0m Too many withdrawals, nothing is "
+        "committed.\n");
+  else if (committed == false)
+    console_printf(
+        "\e[38;5;196mError:\e[0m Balance changed since begin, nothing is "
+        "committed.\n");
+  else
+    console_printf(
+        "\e[38;5;214mInfo:\e[0m Committed \e[38;5;214m%u\e[0m operation(s) "
+        "on \e[38;5;214m%u\e[0m account(s).\n",
+        txn->records, txn->touched);
+
+  // Clean: The transaction is done
+  abort_transaction(txn);
+
+  // Status: Whether committed
+  return committed;
+}
+
+/**
+ * @brief This function will drop every buffered record of the transaction and
+ * free it. Returns 'true' if aborted, otherwise returns 'false'.
+ * @param txn The transaction's data structure reference
+ * @return 'true' or 'false'
+ */
+bool abort_transaction(TXN txn) {
+  // Check: Whether the transaction exist!
+  if (txn == NULL) return false;
+
+  // Clean: Logs and the transaction
+  free(txn->log);
+  free(txn->accounts);
+  free(txn);
+
+  // Status: Reached success
+  return true;
+}
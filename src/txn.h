@@ -0,0 +1,171 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file txn.h
+ * @brief Interface of transaction (begin/commit) related functionalities
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef TXN_H
+#define TXN_H
+
+#include <stdbool.h>
+
+#include "bank.h"
+
+/**
+ * @brief Structure of a record of the redo log, i.e. a single deposit
+ * (positive amount) or withdrawal (negative amount, in cash or not) in the
+ * order given. The 'slot' is the index of its account among the touched
+ * ones, thus the commit finds it without a search, and 'left' is the balance
+ * a withdrawal left on commit (counted in the analytics once committed).
+ */
+typedef struct {
+  unsigned int id;
+  unsigned int slot;
+  long long int amount;
+  long long int left;
+  bool cash;
+} txn_record;
+
+/**
+ * @brief Structure of an account touched by the transaction, all of its
+ * records coalesced into a single change. The balance is the working balance
+ * seen by the transaction (replayed again on the committed balance by the
+ * commit) and the undo is the limits before commit.
+ */
+typedef struct {
+  unsigned int id;
+  unsigned int generation;
+  long long int change;
+  long long int balance;
+  limit_element undo_limit;
+} txn_account;
+
+/**
+ * @brief Structure of the transaction
+ */
+typedef struct {
+  txn_record* log;
+  unsigned int records;
+  unsigned int log_capacity;
+  txn_account* accounts;
+  unsigned int touched;
+  unsigned int capacity;
+  bool failed;
+} txn_element;
+
+/**
+ * @brief Transaction's Data structure Reference
+ */
+#define TXN txn_element*
+
+/**
+ * @brief This function will begin an empty transaction and return it as a
+ * reference (not copy, thus need to be freed by commit or abort). If some
+ * error happens during creation, it will return NULL reference.
+ * @return TXN (reference, not copy) or 'NULL'
+ */
+TXN begin_transaction();
+
+/**
+ * @brief This function will buffer the deposit of the given 'amount' into the
+ * bank account of the given 'id'. Nothing is applied before commit. Returns
+ * 'true' if buffered, otherwise returns 'false'.
+ * @param txn The transaction's data structure reference
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account (-1 if nobody)
+ * @param generation The generation of the account (see get_generation)
+ * @param amount The amount which has to be deposited
+ * @return 'true' or 'false'
+ */
+bool txn_deposit(TXN txn, BANK bank, int id, unsigned int generation,
+                 long long int amount);
+
+/**
+ * @brief This function will buffer the withdrawal of the given 'amount' from
+ * the bank account of the given 'id', checked against the working balance
+ * (i.e. including the earlier records of the transaction). Nothing is applied
+ * before commit. Returns 'true' if buffered, otherwise returns 'false' and
+ * the transaction is failed.
+ * @param txn The transaction's data structure reference
+ * @param bank The bank's data struture reference
+ * @param id The id of the logged in user's account (-1 if nobody)
+ * @param generation The generation of the account (see get_generation)
+ * @param amount The amount which has to be withdrawn
+ * @param cash Whether the amount is withdrawn as cash
+ * @return 'true' or 'false'
+ */
+bool txn_withdraw(TXN txn, BANK bank, int id, unsigned int generation,
+                  long long int amount, bool cash);
+
+/**
+ * @brief This function will mark the transaction as failed, e.g. when an
+ * operation in between begin and commit is rejected, thus the commit applies
+ * nothing. Returns 'true' if marked, otherwise returns 'false'.
+ * @param txn The transaction's data structure reference
+ * @return 'true' or 'false'
+ */
+bool fail_transaction(TXN txn);
+
+/**
+ * @brief This function will apply the transaction atomically: the stripes of
+ * every touched account are held, the redo log is replayed once in order on
+ * the working balances of the accounts (every withdrawal debited within the
+ * balance and the limits, see debit_balance) and, only if every record is
+ * taken, each account is written once with its final balance and the
+ * withdrawals are counted in the analytics. A failed
+ * transaction applies nothing, the limits are rolled back from the undo
+ * image. The transaction is freed in any case. Returns 'true' if committed,
+ * otherwise returns 'false'.
+ * @param txn The transaction's data structure reference
+ * @param bank The bank's data struture reference
+ * @return 'true' or 'false'
+ */
+bool commit_transaction(TXN txn, BANK bank);
+
+/**
+ * @brief This function will drop every buffered record of the transaction and
+ * free it. Returns 'true' if aborted, otherwise returns 'false'.
+ * @param txn The transaction's data structure reference
+ * @return 'true' or 'false'
+ */
+bool abort_transaction(TXN txn);
+
+#endif
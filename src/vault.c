@@ -0,0 +1,311 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file vault.c
+ * @brief Hashed PINs and the session tokens of the logins
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#include "vault.h"
+
+#include <stdlib.h>
+#include <sys/random.h>
+#include <time.h>
+
+/**
+ * @brief This function will return the current time of a monotonic clock in
+ * seconds.
+ */
+static double now_seconds() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief This function will rotate the word left by 'bits'.
+ */
+static inline long long unsigned int rotate(long long unsigned int word,
+                                            int bits) {
+  return (word << bits) | (word >> (64 - bits));
+}
+
+/**
+ * @brief This function will return the SipHash-2-4 of the two words 'a' and
+ * 'b' under the given 'key'.
+ */
+static long long unsigned int sip(const long long unsigned int key[2],
+                                  long long unsigned int a,
+                                  long long unsigned int b) {
+  long long unsigned int v0 = key[0] ^ 0x736f6d6570736575ULL;
+  long long unsigned int v1 = key[1] ^ 0x646f72616e646f6dULL;
+  long long unsigned int v2 = key[0] ^ 0x6c7967656e657261ULL;
+  long long unsigned int v3 = key[1] ^ 0x7465646279746573ULL;
+#define SIP_ROUND()                                               \
+  do {                                                            \
+    v0 += v1, v1 = rotate(v1, 13), v1 ^= v0, v0 = rotate(v0, 32); \
+    v2 += v3, v3 = rotate(v3, 16), v3 ^= v2;                      \
+    v0 += v3, v3 = rotate(v3, 21), v3 ^= v0;                      \
+    v2 += v1, v1 = rotate(v1, 17), v1 ^= v2, v2 = rotate(v2, 32); \
+  } while (0)
+  long long unsigned int message[3] = {a, b, 16ULL << 56};
+  for (int i = 0; i < 3; i++) {
+    v3 ^= message[i];
+    SIP_ROUND();
+    SIP_ROUND();
+    v0 ^= message[i];
+  }
+  v2 ^= 0xff;
+  for (int i = 0; i < 4; i++) SIP_ROUND();
+#undef SIP_ROUND
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/**
+ * @brief This function will hash the 'pin' with the 'salt' through the
+ * memory-hard function, filling the memory sequentially and then reading and
+ * rewriting it in an order depending on the PIN. Returns 'true' if hashed,
+ * otherwise returns 'false' if out of memory.
+ */
+static bool hash_pin(long long unsigned int pin, long long unsigned int salt,
+                     long long unsigned int* hash) {
+  long long unsigned int* memory =
+      (long long unsigned int*)malloc(VAULT_WORDS * sizeof(*memory));
+  if (memory == NULL) return false;
+
+  // Fill: Every word out of the previous one
+  long long unsigned int key[2] = {salt, pin};
+  long long unsigned int word = sip(key, pin, salt);
+  for (unsigned int i = 0; i < VAULT_WORDS; i++)
+    memory[i] = word = sip(key, word, i);
+
+  // Mix: Every step reads and rewrites a word picked by the previous one
+  for (unsigned int i = 0; i < VAULT_WORDS; i++) {
+    unsigned int j = word % VAULT_WORDS;
+    memory[j] = word = sip(key, word ^ memory[j], i);
+  }
+  free(memory);
+  *hash = word;
+  return true;
+}
+
+/**
+ * @brief This function will hash the given 'pin' with a random salt through
+ * a memory-hard function (VAULT_WORDS words of memory read and written in a
+ * data dependent order), thus guessing a PIN out of a stolen account store
+ * costs as much memory and time per guess, and fill 'stored' with the stored
+ * PIN, i.e. VAULT_HASHED, the salt and the hash. Returns 'true' if hashed,
+ * otherwise returns 'false' if out of memory.
+ * @param pin The PIN
+ * @param stored The stored PIN to be filled
+ * @return 'true' or 'false'
+ */
+bool seal_pin(long long unsigned int pin, long long unsigned int* stored) {
+  // Create: A random salt (the clock is the last resort)
+  long long unsigned int salt = 0;
+  if (getrandom(&salt, sizeof(salt), 0) != sizeof(salt))
+    salt = (long long unsigned int)(now_seconds() * 1e9) ^ (pin << 17);
+  salt &= (1ULL << VAULT_SALT_BITS) - 1;
+
+  // Hash: The PIN with the salt
+  long long unsigned int hash;
+  if (hash_pin(pin, salt, &hash) == false) return false;
+  *stored = VAULT_HASHED | (salt << VAULT_HASH_BITS) |
+            (hash & ((1ULL << VAULT_HASH_BITS) - 1));
+  return true;
+}
+
+/**
+ * @brief This function will check the given 'pin' against the 'stored' PIN,
+ * hashing it with the stored salt (unless stored as is). Returns 'true' if
+ * matches, otherwise returns 'false'.
+ * @param stored The stored PIN
+ * @param pin The PIN to be checked
+ * @return 'true' or 'false'
+ */
+bool match_pin(long long unsigned int stored, long long unsigned int pin) {
+  // Check: The PIN stored as is, never compared (see VAULT_HASHED)
+  if ((stored & VAULT_HASHED) == 0) return false;
+
+  // Hash: The PIN with the stored salt
+  long long unsigned int salt =
+      (stored >> VAULT_HASH_BITS) & ((1ULL << VAULT_SALT_BITS) - 1);
+  long long unsigned int hash;
+  if (hash_pin(pin, salt, &hash) == false) return false;
+  return (hash & ((1ULL << VAULT_HASH_BITS) - 1)) ==
+         (stored & ((1ULL << VAULT_HASH_BITS) - 1));
+}
+
+/**
+ * @brief This function will create an empty set of session tokens and return
+ * it as a reference (not copy, thus need to be freed after usage). If some
+ * error happens during creation, it will return NULL reference.
+ * @return VAULT (reference, not copy) or 'NULL'
+ */
+VAULT create_vault() {
+  // Create: Make space for the tokens, every entry expired
+  VAULT vault = (VAULT)calloc(1, sizeof(vault_element));
+  if (vault == NULL) return NULL;
+
+  // Configure: The clock of the expiries
+  pthread_mutex_init(&vault->lock, NULL);
+  vault->start = now_seconds();
+
+  // Status: Return the tokens' structure reference
+  return vault;
+}
+
+/**
+ * @brief This function will take the session tokens as an input and frees
+ * them. Returns 'true' if successfully deleted, otherwise returns 'false'.
+ * @param vault The session tokens' data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_vault(VAULT vault) {
+  // Check: Wether the tokens exist!
+  if (vault == NULL) return false;
+
+  pthread_mutex_destroy(&vault->lock);
+  free(vault);
+  return true;
+}
+
+/**
+ * @brief This function will return the set of entries of the given 'token',
+ * the tokens are random thus their sets are spread evenly.
+ */
+static vault_entry* token_set(VAULT vault, long long unsigned int token) {
+  return &vault->entry[token % (VAULT_ENTRIES / VAULT_WAYS) * VAULT_WAYS];
+}
+
+/**
+ * @brief This function will issue a random token to a login of the account
+ * of the given 'id' (its PIN just matched the 'stored' PIN) and fill 'token'
+ * with it, in place of the token of its set expiring first. Returns 'true'
+ * if issued, otherwise returns 'false' if no randomness is available.
+ * @param vault The session tokens' data structure reference
+ * @param id The id of the account
+ * @param stored The stored PIN of the account
+ * @param token The token to be filled
+ * @return 'true' or 'false'
+ */
+bool issue_token(VAULT vault, unsigned int id, long long unsigned int stored,
+                 long long unsigned int* token) {
+  // Create: A random token, never 0 (no token), the clock won't do here
+  if (vault == NULL || token == NULL) return false;
+  *token = 0;
+  while (*token == 0)
+    if (getrandom(token, sizeof(*token), 0) != sizeof(*token)) return false;
+
+  // Store: In place of the entry of its set expiring first
+  vault_entry* set = token_set(vault, *token);
+  unsigned int now = (unsigned int)(now_seconds() - vault->start);
+  pthread_mutex_lock(&vault->lock);
+  vault_entry* entry = &set[0];
+  for (unsigned int i = 1; i < VAULT_WAYS; i++)
+    if (set[i].expiry < entry->expiry) entry = &set[i];
+  entry->token = *token;
+  entry->stored = stored;
+  entry->id = id;
+  entry->expiry = now + VAULT_SECONDS;
+  pthread_mutex_unlock(&vault->lock);
+  return true;
+}
+
+/**
+ * @brief This function will check the given 'token' against the tokens
+ * issued to the account of the given 'id': it matches if used in the last
+ * VAULT_SECONDS and the PIN is not changed since (the account is not
+ * reopened), and then stays valid for VAULT_SECONDS more. Nothing is hashed.
+ * Returns 'true' if matches, otherwise returns 'false'.
+ * @param vault The session tokens' data structure reference
+ * @param id The id of the account
+ * @param stored The stored PIN of the account
+ * @param token The token to be checked
+ * @return 'true' or 'false'
+ */
+bool match_token(VAULT vault, unsigned int id, long long unsigned int stored,
+                 long long unsigned int token) {
+  // Check: Wether the tokens exist, 0 is no token!
+  if (vault == NULL || token == 0) return false;
+
+  // Find: The token in its set, a hit renews its expiry
+  vault_entry* set = token_set(vault, token);
+  unsigned int now = (unsigned int)(now_seconds() - vault->start);
+  bool hit = false;
+  pthread_mutex_lock(&vault->lock);
+  for (unsigned int i = 0; i < VAULT_WAYS && hit == false; i++) {
+    hit = set[i].token == token && set[i].id == id &&
+          set[i].stored == stored && set[i].expiry > now;
+    if (hit == true) set[i].expiry = now + VAULT_SECONDS;
+  }
+  if (hit == true)
+    vault->hits++;
+  else
+    vault->misses++;
+  pthread_mutex_unlock(&vault->lock);
+  return hit;
+}
+
+/**
+ * @brief This function will revoke the given 'token' (e.g. at logout), it
+ * matches no more. Returns 'true' if revoked, otherwise returns 'false' if
+ * not valid anyway.
+ * @param vault The session tokens' data structure reference
+ * @param token The token to be revoked
+ * @return 'true' or 'false'
+ */
+bool revoke_token(VAULT vault, long long unsigned int token) {
+  // Check: Wether the tokens exist, 0 is no token!
+  if (vault == NULL || token == 0) return false;
+
+  // Find: The token in its set, and expire it
+  vault_entry* set = token_set(vault, token);
+  bool revoked = false;
+  pthread_mutex_lock(&vault->lock);
+  for (unsigned int i = 0; i < VAULT_WAYS; i++)
+    if (set[i].token == token) {
+      set[i].token = 0;
+      set[i].expiry = 0;
+      revoked = true;
+    }
+  pthread_mutex_unlock(&vault->lock);
+  return revoked;
+}
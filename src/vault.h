@@ -0,0 +1,191 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file vault.h
+ * @brief Interface of the hashed PINs and the session tokens of the logins
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef VAULT_H
+#define VAULT_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+/**
+ * @brief The bit telling a stored PIN is hashed, otherwise it is the PIN
+ * itself (accounts of an older journal or checkpoint, sealed as loaded)
+ */
+#define VAULT_HASHED (1ULL << 63)
+
+/**
+ * @brief Bits of the salt and of the hash of a stored PIN
+ */
+#define VAULT_SALT_BITS 23
+#define VAULT_HASH_BITS 40
+
+/**
+ * @brief Words (8 bytes) of the memory of a single hashing (64 KB)
+ */
+#define VAULT_WORDS (1 << 13)
+
+/**
+ * @brief Number of entries of the session tokens, in sets of VAULT_WAYS
+ * entries (a token may lie in any entry of its set)
+ */
+#define VAULT_ENTRIES 16384
+#define VAULT_WAYS 4
+
+/**
+ * @brief Seconds a session token stays valid once last used
+ */
+#define VAULT_SECONDS 900
+
+/**
+ * @brief Structure of an entry of the session tokens, the random 'token'
+ * issued at a login of the account 'id', valid till 'expiry' (seconds) and as
+ * long as the stored PIN is still 'stored'
+ */
+typedef struct {
+  long long unsigned int token;
+  long long unsigned int stored;
+  unsigned int id;
+  unsigned int expiry;
+} vault_entry;
+
+/**
+ * @brief Structure of the session tokens. A login hashes the PIN (half a
+ * millisecond) and is issued a random token, then the client logging in
+ * again (e.g. after a reconnection) with the token is let in by a lookup (a
+ * few nanoseconds) instead. Nothing kept here is derived from the PIN, thus
+ * a token neither tells nor helps to guess it.
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  double start;
+  long long unsigned int hits;
+  long long unsigned int misses;
+  vault_entry entry[VAULT_ENTRIES];
+} vault_element;
+
+/**
+ * @brief Session tokens' Data structure Reference
+ */
+#define VAULT vault_element*
+
+/**
+ * @brief This function will hash the given 'pin' with a random salt through
+ * a memory-hard function (VAULT_WORDS words of memory read and written in a
+ * data dependent order), thus guessing a PIN out of a stolen account store
+ * costs as much memory and time per guess, and fill 'stored' with the stored
+ * PIN, i.e. VAULT_HASHED, the salt and the hash. Returns 'true' if hashed,
+ * otherwise returns 'false' if out of memory.
+ * @param pin The PIN
+ * @param stored The stored PIN to be filled
+ * @return 'true' or 'false'
+ */
+bool seal_pin(long long unsigned int pin, long long unsigned int* stored);
+
+/**
+ * @brief This function will check the given 'pin' against the 'stored' PIN,
+ * hashing it with the stored salt (a PIN stored as is never matches, see
+ * VAULT_HASHED). Returns 'true' if matches, otherwise returns 'false'.
+ * @param stored The stored PIN
+ * @param pin The PIN to be checked
+ * @return 'true' or 'false'
+ */
+bool match_pin(long long unsigned int stored, long long unsigned int pin);
+
+/**
+ * @brief This function will create an empty set of session tokens and return
+ * it as a reference (not copy, thus need to be freed after usage). If some
+ * error happens during creation, it will return NULL reference.
+ * @return VAULT (reference, not copy) or 'NULL'
+ */
+VAULT create_vault();
+
+/**
+ * @brief This function will take the session tokens as an input and frees
+ * them. Returns 'true' if successfully deleted, otherwise returns 'false'.
+ * @param vault The session tokens' data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_vault(VAULT vault);
+
+/**
+ * @brief This function will issue a random token to a login of the account
+ * of the given 'id' (its PIN just matched the 'stored' PIN) and fill 'token'
+ * with it, in place of the token of its set expiring first. Returns 'true'
+ * if issued, otherwise returns 'false' if no randomness is available.
+ * @param vault The session tokens' data structure reference
+ * @param id The id of the account
+ * @param stored The stored PIN of the account
+ * @param token The token to be filled
+ * @return 'true' or 'false'
+ */
+bool issue_token(VAULT vault, unsigned int id, long long unsigned int stored,
+                 long long unsigned int* token);
+
+/**
+ * @brief This function will check the given 'token' against the tokens
+ * issued to the account of the given 'id': it matches if used in the last
+ * VAULT_SECONDS and the PIN is not changed since (the account is not
+ * reopened), and then stays valid for VAULT_SECONDS more. Nothing is hashed.
+ * Returns 'true' if matches, otherwise returns 'false'.
+ * @param vault The session tokens' data structure reference
+ * @param id The id of the account
+ * @param stored The stored PIN of the account
+ * @param token The token to be checked
+ * @return 'true' or 'false'
+ */
+bool match_token(VAULT vault, unsigned int id, long long unsigned int stored,
+                 long long unsigned int token);
+
+/**
+ * @brief This function will revoke the given 'token' (e.g. at logout), it
+ * matches no more. Returns 'true' if revoked, otherwise returns 'false' if
+ * not valid anyway.
+ * @param vault The session tokens' data structure reference
+ * @param token The token to be revoked
+ * @return 'true' or 'false'
+ */
+bool revoke_token(VAULT vault, long long unsigned int token);
+
+#endif
@@ -0,0 +1,254 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file wheel.c
+ * @brief Implementation of the hierarchical timer wheel
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#include "wheel.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief This function will link the timer into the slot of the lowest level
+ * spanning its expiry from the current tick on.
+ */
+static void place_timer(WHEEL wheel, unsigned int index) {
+  wheel_timer* timer = &wheel->timer[index];
+
+  // Find: The level, by the highest bit the expiry differs from now in
+  long long unsigned int delta = timer->expiry ^ wheel->now;
+  unsigned int level = 0;
+  while (level < WHEEL_LEVELS - 1 &&
+         delta >> (WHEEL_BITS * (level + 1)) != 0)
+    level++;
+  long long unsigned int slot_tick = timer->expiry;
+  if (delta >> (WHEEL_BITS * WHEEL_LEVELS) != 0)
+    // Clamp: Beyond the last level, parked in its last slot to be placed again
+    slot_tick = wheel->now - 1;
+  unsigned int slot = level * WHEEL_SLOTS +
+                      ((slot_tick >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+
+  // Link: At the head of the slot
+  timer->slot = slot;
+  timer->prev = WHEEL_NONE;
+  timer->next = wheel->head[slot];
+  if (timer->next != WHEEL_NONE) wheel->timer[timer->next].prev = index;
+  wheel->head[slot] = index;
+}
+
+/**
+ * @brief This function will unlink the timer out of its slot.
+ */
+static void unlink_timer(WHEEL wheel, unsigned int index) {
+  wheel_timer* timer = &wheel->timer[index];
+  if (timer->prev != WHEEL_NONE)
+    wheel->timer[timer->prev].next = timer->next;
+  else
+    wheel->head[timer->slot] = timer->next;
+  if (timer->next != WHEEL_NONE) wheel->timer[timer->next].prev = timer->prev;
+}
+
+/**
+ * @brief This function will create an empty timer wheel at tick 0 and return
+ * it as a reference (not copy, thus need to be freed after usage). If some
+ * error happens during creation, it will return NULL reference.
+ * @return WHEEL (reference, not copy) or 'NULL'
+ */
+WHEEL create_wheel() {
+  // Create: Make space for the wheel, the timers grow on demand
+  WHEEL wheel = (WHEEL)malloc(sizeof(wheel_element));
+  if (wheel == NULL) return NULL;
+
+  // Configure: Every slot is empty
+  wheel->timer = NULL;
+  wheel->capacity = 0;
+  wheel->free = WHEEL_NONE;
+  wheel->pending = 0;
+  wheel->now = 0;
+  for (unsigned int i = 0; i < WHEEL_LEVELS * WHEEL_SLOTS; i++)
+    wheel->head[i] = WHEEL_NONE;
+
+  // Status: Return the wheel's structure reference
+  return wheel;
+}
+
+/**
+ * @brief This function will take the timer wheel as an input and frees it
+ * along with every timer. Returns 'true' if successfully deleted, otherwise
+ * returns 'false'.
+ * @param wheel The timer wheel's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_wheel(WHEEL wheel) {
+  // Check: Whether the wheel exist!
+  if (wheel == NULL) return false;
+
+  // Clean: The timers and the wheel
+  free(wheel->timer);
+  free(wheel);
+  return true;
+}
+
+/**
+ * @brief This function will add a timer expiring at the given tick (the next
+ * tick, if already past) and carrying the given 'data'. Returns the timer,
+ * valid till it expires or is cancelled, otherwise returns WHEEL_NONE if out
+ * of memory.
+ * @param wheel The timer wheel's data structure reference
+ * @param expiry The tick of the expiry
+ * @param data The data handed over when the timer expires
+ * @return timer or WHEEL_NONE
+ */
+unsigned int wheel_add(WHEEL wheel, long long unsigned int expiry,
+                       long long unsigned int data) {
+  // Check: Whether the wheel exist!
+  if (wheel == NULL) return WHEEL_NONE;
+
+  // Create: More free timers, linked in order
+  if (wheel->free == WHEEL_NONE) {
+    if (wheel->capacity >= WHEEL_NONE / 2) return WHEEL_NONE;
+    unsigned int capacity = (wheel->capacity == 0) ? 1024 : wheel->capacity * 2;
+    wheel_timer* timer =
+        (wheel_timer*)realloc(wheel->timer, sizeof(wheel_timer) * capacity);
+    if (timer == NULL) return WHEEL_NONE;
+    for (unsigned int i = wheel->capacity; i < capacity; i++) {
+      timer[i].slot = WHEEL_NONE;
+      timer[i].next = (i + 1 < capacity) ? i + 1 : WHEEL_NONE;
+    }
+    wheel->free = wheel->capacity;
+    wheel->timer = timer;
+    wheel->capacity = capacity;
+  }
+
+  // Place: The first free timer
+  unsigned int index = wheel->free;
+  wheel->free = wheel->timer[index].next;
+  wheel->timer[index].expiry = (expiry > wheel->now) ? expiry : wheel->now + 1;
+  wheel->timer[index].data = data;
+  place_timer(wheel, index);
+  wheel->pending++;
+  return index;
+}
+
+/**
+ * @brief This function will cancel the given (pending) timer. Returns 'true'
+ * if cancelled, otherwise returns 'false'.
+ * @param wheel The timer wheel's data structure reference
+ * @param timer The timer
+ * @return 'true' or 'false'
+ */
+bool wheel_cancel(WHEEL wheel, unsigned int timer) {
+  // Check: Whether the timer is pending!
+  if (wheel == NULL || timer >= wheel->capacity ||
+      wheel->timer[timer].slot == WHEEL_NONE)
+    return false;
+
+  // Free: The timer
+  unlink_timer(wheel, timer);
+  wheel->timer[timer].slot = WHEEL_NONE;
+  wheel->timer[timer].next = wheel->free;
+  wheel->free = timer;
+  wheel->pending--;
+  return true;
+}
+
+/**
+ * @brief This function will move the wheel tick by tick up to the given 'now',
+ * handing the data of every timer expiring on the way over to 'expire' (the
+ * timer is free by then, thus 'expire' may add timers but not cancel any).
+ * Returns the number of timers expired.
+ * @param wheel The timer wheel's data structure reference
+ * @param now The current tick
+ * @param expire The function taking the data of an expired timer
+ * @param context The context handed over to 'expire'
+ * @return number of timers expired
+ */
+unsigned int wheel_advance(WHEEL wheel, long long unsigned int now,
+                           void (*expire)(void* context,
+                                          long long unsigned int data),
+                           void* context) {
+  // Check: Whether the wheel exist!
+  if (wheel == NULL) return 0;
+
+  unsigned int expired = 0;
+  while (wheel->now < now) {
+    // Tick: Skip ahead at once while nothing is pending
+    if (wheel->pending == 0) {
+      wheel->now = now;
+      break;
+    }
+    wheel->now++;
+
+    // Cascade: The slot of every upper level whose lower levels wrapped
+    for (unsigned int level = 1; level < WHEEL_LEVELS; level++) {
+      if ((wheel->now & ((1ULL << (WHEEL_BITS * level)) - 1)) != 0) break;
+      unsigned int slot =
+          level * WHEEL_SLOTS +
+          ((wheel->now >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+      unsigned int index = wheel->head[slot];
+      wheel->head[slot] = WHEEL_NONE;
+      while (index != WHEEL_NONE) {
+        unsigned int next = wheel->timer[index].next;
+        place_timer(wheel, index);
+        index = next;
+      }
+    }
+
+    // Expire: Every timer of the slot of the tick
+    unsigned int slot = wheel->now & (WHEEL_SLOTS - 1);
+    unsigned int index = wheel->head[slot];
+    wheel->head[slot] = WHEEL_NONE;
+    while (index != WHEEL_NONE) {
+      wheel_timer* timer = &wheel->timer[index];
+      unsigned int next = timer->next;
+      long long unsigned int data = timer->data;
+      timer->slot = WHEEL_NONE;
+      timer->next = wheel->free;
+      wheel->free = index;
+      wheel->pending--;
+      expired++;
+      expire(context, data);
+      index = next;
+    }
+  }
+  return expired;
+}
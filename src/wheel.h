@@ -0,0 +1,160 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file wheel.h
+ * @brief Interface of the hierarchical timer wheel
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+
+#ifndef WHEEL_H
+#define WHEEL_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Bits of the ticks of a level of the wheel
+ */
+#define WHEEL_BITS 8
+
+/**
+ * @brief Number of slots of a level of the wheel
+ */
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+
+/**
+ * @brief Number of levels of the wheel, the last one spans 2^32 ticks
+ */
+#define WHEEL_LEVELS 4
+
+/**
+ * @brief The timer (or link) of none
+ */
+#define WHEEL_NONE ((unsigned int)-1)
+
+/**
+ * @brief Structure of a timer, a node of the list of its slot (linked by
+ * index, thus the timers may move as they grow). 'slot' is the slot of the
+ * wheel holding it (level * WHEEL_SLOTS + slot) or WHEEL_NONE if free.
+ */
+typedef struct {
+  long long unsigned int expiry;
+  long long unsigned int data;
+  unsigned int prev;
+  unsigned int next;
+  unsigned int slot;
+} wheel_timer;
+
+/**
+ * @brief Structure of the hierarchical timer wheel. A timer lies in the slot
+ * of the lowest level spanning its expiry from now on, and is moved down a
+ * level (cascaded) when the lower levels wrap around, thus adding,
+ * cancelling and expiring a timer are all O(1) whatever the number of
+ * timers. The free timers are linked from 'free'.
+ */
+typedef struct {
+  wheel_timer* timer;
+  unsigned int capacity;
+  unsigned int free;
+  unsigned int pending;
+  long long unsigned int now;
+  unsigned int head[WHEEL_LEVELS * WHEEL_SLOTS];
+} wheel_element;
+
+/**
+ * @brief Timer wheel's Data structure Reference
+ */
+#define WHEEL wheel_element*
+
+/**
+ * @brief This function will create an empty timer wheel at tick 0 and return
+ * it as a reference (not copy, thus need to be freed after usage). If some
+ * error happens during creation, it will return NULL reference.
+ * @return WHEEL (reference, not copy) or 'NULL'
+ */
+WHEEL create_wheel();
+
+/**
+ * @brief This function will take the timer wheel as an input and frees it
+ * along with every timer. Returns 'true' if successfully deleted, otherwise
+ * returns 'false'.
+ * @param wheel The timer wheel's data structure reference
+ * @return 'true' or 'false'
+ */
+bool delete_wheel(WHEEL wheel);
+
+/**
+ * @brief This function will add a timer expiring at the given tick (the next
+ * tick, if already past) and carrying the given 'data'. Returns the timer,
+ * valid till it expires or is cancelled, otherwise returns WHEEL_NONE if out
+ * of memory.
+ * @param wheel The timer wheel's data structure reference
+ * @param expiry The tick of the expiry
+ * @param data The data handed over when the timer expires
+ * @return timer or WHEEL_NONE
+ */
+unsigned int wheel_add(WHEEL wheel, long long unsigned int expiry,
+                       long long unsigned int data);
+
+/**
+ * @brief This function will cancel the given (pending) timer. Returns 'true'
+ * if cancelled, otherwise returns 'false'.
+ * @param wheel The timer wheel's data structure reference
+ * @param timer The timer
+ * @return 'true' or 'false'
+ */
+bool wheel_cancel(WHEEL wheel, unsigned int timer);
+
+/**
+ * @brief This function will move the wheel tick by tick up to the given 'now',
+ * handing the data of every timer expiring on the way over to 'expire' (the
+ * timer is free by then, thus 'expire' may add timers but not cancel any).
+ * Returns the number of timers expired.
+ * @param wheel The timer wheel's data structure reference
+ * @param now The current tick
+ * @param expire The function taking the data of an expired timer
+ * @param context The context handed over to 'expire'
+ * @return number of timers expired
+ */
+unsigned int wheel_advance(WHEEL wheel, long long unsigned int now,
+                           void (*expire)(void* context,
+                                          long long unsigned int data),
+                           void* context);
+
+#endif
@@ -0,0 +1,413 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file wire.c
+ * @brief Implementation of the binary wire protocol of the sessions
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#include "wire.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch.h"
+#include "bulk.h"
+#include "console.h"
+#include "schedule.h"
+
+/**
+ * @brief Structure of the context of the matches of find
+ */
+typedef struct {
+  SESSION session;
+  wire_response* response;
+} wire_matches;
+
+/**
+ * @brief This function will write the response frame into the session's
+ * output.
+ */
+static void respond(SESSION session, wire_response* response) {
+  fwrite(response, sizeof(wire_response), 1, session->out);
+}
+
+/**
+ * @brief This function will fill the user name, account and balance of the
+ * logged in user (if any) into the response.
+ */
+static void respond_account(SESSION session, wire_response* response) {
+  account_element account;
+  response->account = session->user_login_id;
+  if (session->user_login_id == -1 ||
+      snapshot_account(session->bank, session->user_login_id, &account,
+                       response->text, sizeof(response->text)) == false)
+    return;
+  response->balance = account.amount;
+  response->text_length = strlen(response->text);
+}
+
+/**
+ * @brief This function will write a single match of find as a response of its
+ * own, the 'context' is the matches' structure.
+ */
+static void respond_match(int id, void* context) {
+  wire_matches* matches = (wire_matches*)context;
+  BANK bank = matches->session->bank;
+  wire_response match = *matches->response;
+  const name_ref* ref = &bank->account.name[id];
+  match.result = WIRE_MORE;
+  match.account = bank->account.id[id];
+  match.text_length = (ref->length < WIRE_TEXT) ? ref->length : WIRE_TEXT;
+  memcpy(match.text, name_text(bank->names, ref), match.text_length);
+  respond(matches->session, &match);
+}
+
+/**
+ * @brief This function will check the login and the amount of a deposit or a
+ * withdrawal. Returns WIRE_OK, otherwise the result explaining why not.
+ */
+static int check_operation(SESSION session, long long int amount) {
+  account_element account;
+  char name[1];
+  if (session->user_login_id == -1 ||
+      snapshot_account(session->bank, session->user_login_id, &account, name,
+                       sizeof(name)) == false)
+    return WIRE_LOGIN_REQUIRED;
+  if (amount <= 0) return WIRE_BAD_AMOUNT;
+  return WIRE_OK;
+}
+
+/**
+ * @brief This function will withdraw the given 'amount' (buffered if a
+ * transaction is open), as the given 'cash' if any. Returns the result.
+ */
+static int withdraw_amount(SESSION session, long long int amount,
+                           CASH cash) {
+  int result = check_operation(session, amount);
+  if (result != WIRE_OK) {
+    if (session->transaction != NULL) fail_transaction(session->transaction);
+    return result;
+  }
+  if (session->transaction != NULL)
+    return (txn_withdraw(session->transaction, session->bank,
+                         session->user_login_id, session->user_generation,
+                         amount, cash != NULL) == true)
+               ? WIRE_OK
+               : WIRE_NOT_ENOUGH;
+
+  // Withdraw: Right away, telling why not
+  int debited = (cash != NULL)
+                    ? account_withdraw_cash(session->bank,
+                                            session->user_login_id,
+                                            session->user_generation, cash)
+                    : account_withdraw(session->bank, session->user_login_id,
+                                       session->user_generation, amount);
+  switch (debited) {
+    case DEBIT_DONE:
+      return WIRE_OK;
+    case DEBIT_NO_ACCOUNT:
+      return WIRE_LOGIN_REQUIRED;
+    case DEBIT_BAD_AMOUNT:
+      return WIRE_BAD_AMOUNT;
+    case DEBIT_NOT_ENOUGH:
+      return WIRE_NOT_ENOUGH;
+    case DEBIT_LIMITED:
+      return WIRE_LIMITED;
+    default:
+      return WIRE_FAILED;
+  }
+}
+
+/**
+ * @brief This function will log the user of the request in, creating the
+ * account (with the confirmed PIN) if the user name don't exist, and issue
+ * a session token to the login. Returns the result.
+ */
+static int login_request(SESSION session, const wire_request* request,
+                         const char* user) {
+  // Find: The user, the name is kept to tell whether the account is closed
+  session->user_login_id = -1;
+  free(session->user);
+  session->user = strdup(user);
+  if (session->user == NULL) return WIRE_FAILED;
+  int found = find_account(session->bank, user);
+  if (found != -1) {
+    session->user_generation = get_generation(session->bank, found);
+    if (check_pin(session->bank, found, request->amount) == false)
+      return WIRE_WRONG_PIN;
+    session->user_login_id = found;
+    grant_token(session->bank, found, &session->login_token);
+    sketch_user(session->bank->sketch, found);
+    return WIRE_OK;
+  }
+
+  // Create: The account of the new user, its PIN is hashed
+  if (request->amount != request->extra) return WIRE_PIN_MISMATCH;
+  long long unsigned int stored;
+  if (seal_pin(request->amount, &stored) == false) return WIRE_FAILED;
+  session->user_login_id =
+      add_account(session->bank, stored, user, strlen(user), 3210);
+  session->user_generation =
+      get_generation(session->bank, session->user_login_id);
+  if (session->user_login_id == -1) return WIRE_FAILED;
+  grant_token(session->bank, session->user_login_id, &session->login_token);
+  sketch_user(session->bank->sketch, session->user_login_id);
+  return WIRE_OK;
+}
+
+/**
+ * @brief This function will log the user of the request in by the session
+ * token of an earlier login (see login_request), nothing is hashed. Returns
+ * the result.
+ */
+static int resume_request(SESSION session, const wire_request* request,
+                          const char* user) {
+  // Find: The user, the name is kept to tell whether the account is closed
+  session->user_login_id = -1;
+  free(session->user);
+  session->user = strdup(user);
+  if (session->user == NULL) return WIRE_FAILED;
+  int found = find_account(session->bank, user);
+  if (found == -1) return WIRE_WRONG_PIN;
+
+  // Authorize: By the token
+  session->user_generation = get_generation(session->bank, found);
+  long long unsigned int token = (long long unsigned int)request->amount;
+  if (check_token(session->bank, found, token) == false)
+    return WIRE_WRONG_PIN;
+  session->user_login_id = found;
+  session->login_token = token;
+  sketch_user(session->bank->sketch, found);
+  return WIRE_OK;
+}
+
+/**
+ * @brief This function will perform the command of the request frame (lying
+ * in the input buffer, possibly unaligned) on the session, just like the
+ * same command of the text protocol, and write the response frame(s) into
+ * the session's output. Nothing is allocated (but the user name of a login)
+ * and no text is printed.
+ * Returns 'true' while the session is open, otherwise returns 'false' (e.g.
+ * after exit).
+ * @param session The session's data structure reference
+ * @param frame The bytes of the request frame (sizeof(wire_request))
+ * @return 'true' or 'false'
+ */
+bool session_request(SESSION session, const void* frame) {
+  // Check: Wether the session is open!
+  if (session == NULL || session->state == SESSION_CLOSED) return false;
+
+  // Decode: Into the stack, the text gets terminated
+  wire_request request;
+  char text[WIRE_TEXT + 1];
+  memcpy(&request, frame, sizeof(request));
+  unsigned int length =
+      (request.text_length < WIRE_TEXT) ? request.text_length : WIRE_TEXT;
+  memcpy(text, request.text, length);
+  text[length] = '\0';
+
+  // Configure: The response, and no text is printed meanwhile
+  wire_response response;
+  memset(&response, 0, sizeof(response));
+  response.magic = WIRE_MAGIC;
+  response.command = request.command;
+  response.length = sizeof(response);
+  response.tag = request.tag;
+  response.result = WIRE_OK;
+  set_console(null_console());
+
+  // Check: The session has not been idle for too long, nor the account
+  // closed (nor reused) by another session
+  if (idle_expired(&session->idle, &session->idle_timer) == true ||
+      (session->user_login_id != -1 &&
+       check_owner(session->bank, session->user_login_id, session->user,
+                   session->user_generation) == false)) {
+    session->user_login_id = -1;
+    abort_transaction(session->transaction);
+    session->transaction = NULL;
+  }
+
+  // Check: Bulk commands are for the operator only (a connection never is),
+  // and not allowed in between begin and commit
+  bool bulk = request.command == WIRE_IMPORT ||
+              request.command == WIRE_EXPORT ||
+              request.command == WIRE_INTEREST;
+  if (bulk == true &&
+      (session->operator == false || session->transaction != NULL))
+    response.result = WIRE_NOT_ALLOWED;
+
+  // Perform: Just like the text protocol
+  else
+    switch (request.command) {
+      case WIRE_LOGIN:
+        response.result = login_request(session, &request, text);
+        if (response.result == WIRE_OK) response.token = session->login_token;
+        break;
+
+      case WIRE_RESUME:
+        response.result = resume_request(session, &request, text);
+        if (response.result == WIRE_OK) response.token = session->login_token;
+        break;
+
+      case WIRE_LOGOUT:
+        session->user_login_id = -1;
+        revoke_token(session->bank->vault, session->login_token);
+        session->login_token = 0;
+        break;
+
+      case WIRE_DEPOSIT:
+        response.result = check_operation(session, request.amount);
+        if (response.result != WIRE_OK) {
+          if (session->transaction != NULL)
+            fail_transaction(session->transaction);
+        } else if (((session->transaction != NULL)
+                        ? txn_deposit(session->transaction, session->bank,
+                                      session->user_login_id,
+                                      session->user_generation,
+                                      request.amount)
+                        : account_deposit(session->bank,
+                                          session->user_login_id,
+                                          session->user_generation,
+                                          request.amount)) == false)
+          response.result = WIRE_FAILED;
+        break;
+
+      case WIRE_WITHDRAW:
+        response.result = withdraw_amount(session, request.amount, NULL);
+        break;
+
+      case WIRE_WITHDRAW_CASH: {
+        cash_element cash;
+        if (prefer_cash(&cash, request.amount, request.denominations,
+                        WIRE_DENOMINATIONS) == false) {
+          response.result = WIRE_BAD_DENOMINATION;
+          if (session->transaction != NULL)
+            fail_transaction(session->transaction);
+          break;
+        }
+        response.result = withdraw_amount(session, request.amount, &cash);
+        if (response.result != WIRE_OK) break;
+        response.notes[0] = cash._Rs1_coins;
+        response.notes[1] = cash._Rs2_coins;
+        response.notes[2] = cash._Rs5_coins;
+        response.notes[3] = cash._Rs10_notes;
+        response.notes[4] = cash._Rs50_notes;
+        response.notes[5] = cash._Rs100_notes;
+        response.notes[6] = cash._Rs500_notes;
+        response.notes[7] = cash._Rs2000_notes;
+        break;
+      }
+
+      case WIRE_FIND: {
+        wire_matches matches = {session, &response};
+        lock_accounts(session->bank);
+        response.count = radix_find_prefix(session->bank->index, text, true,
+                                           respond_match, &matches);
+        unlock_accounts(session->bank);
+        break;
+      }
+
+      case WIRE_INTEREST:
+        if (apply_interest(session->bank, request.amount, request.extra) ==
+            false)
+          response.result = WIRE_BAD_AMOUNT;
+        break;
+
+      case WIRE_SHOW:
+        if (session->user_login_id == -1)
+          response.result = WIRE_LOGIN_REQUIRED;
+        break;
+
+      case WIRE_BEGIN:
+        if (session->transaction != NULL || session->bank->pager != NULL)
+          response.result = WIRE_NOT_ALLOWED;
+        else if ((session->transaction = begin_transaction()) == NULL)
+          response.result = WIRE_FAILED;
+        break;
+
+      case WIRE_COMMIT:
+        if (session->transaction == NULL)
+          response.result = WIRE_NOT_ALLOWED;
+        else if (commit_transaction(session->transaction, session->bank) ==
+                 false)
+          response.result = WIRE_FAILED;
+        session->transaction = NULL;
+        break;
+
+      case WIRE_ABORT:
+        if (abort_transaction(session->transaction) == false)
+          response.result = WIRE_NOT_ALLOWED;
+        session->transaction = NULL;
+        break;
+
+      case WIRE_IMPORT:
+        if (import_accounts(session->bank, text) == false)
+          response.result = WIRE_FAILED;
+        break;
+
+      case WIRE_EXPORT:
+        if (export_accounts(session->bank, text,
+                            (request.extra == 0) ? "csv" : "bin") == false)
+          response.result = WIRE_FAILED;
+        break;
+
+      case WIRE_EXIT:
+        abort_transaction(session->transaction);
+        session->transaction = NULL;
+        session->state = SESSION_CLOSED;
+        break;
+
+      default:
+        response.result = WIRE_BAD_COMMAND;
+    }
+
+  // Watch: The session staying idle from now on, while logged in
+  watch_idle(&session->idle, &session->idle_timer,
+             session->user_login_id != -1 && session->state != SESSION_CLOSED);
+
+  // Sync: The journal, thus the response is sent once the change is durable
+  sync_journal(session->bank->journal);
+
+  // Respond: With the logged in user's account (find has its matches)
+  if (request.command != WIRE_FIND) respond_account(session, &response);
+  respond(session, &response);
+  set_console(NULL);
+  return session->state != SESSION_CLOSED;
+}
@@ -0,0 +1,165 @@
+/******************************************************************************
+
+///////////////////////////////////////////////////////////////////////////////
+ * @file wire.h
+ * @brief Interface of the binary wire protocol of the sessions
+ * @author Syed Minnatullah - Quadri
+ * @copyright Copyright (c) 2022, Syed Minnatullah - Quadri Under BSD 3-Clause
+ * License
+ * @date Last updated on July 2022
+///////////////////////////////////////////////////////////////////////////////
+
+BSD 3-Clause License
+
+Copyright (c) 2022, Syed Minnatullah - Quadri
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+******************************************************************************/
+
+
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <stdbool.h>
+
+#include "session.h"
+
+/**
+ * @brief First byte of every frame, never a byte of the text protocol
+ */
+#define WIRE_MAGIC 0xB7
+
+/**
+ * @brief Bytes of the text of a frame (user name, prefix or path)
+ */
+#define WIRE_TEXT 192
+
+/**
+ * @brief Number of denominations of a frame
+ */
+#define WIRE_DENOMINATIONS 8
+
+/**
+ * @brief The commands of a frame, one per command of the text protocol
+ */
+enum {
+  WIRE_LOGIN = 1,
+  WIRE_LOGOUT,
+  WIRE_DEPOSIT,
+  WIRE_WITHDRAW,
+  WIRE_WITHDRAW_CASH,
+  WIRE_FIND,
+  WIRE_INTEREST,
+  WIRE_SHOW,
+  WIRE_BEGIN,
+  WIRE_COMMIT,
+  WIRE_ABORT,
+  WIRE_IMPORT,
+  WIRE_EXPORT,
+  WIRE_EXIT,
+  WIRE_RESUME
+};
+
+/**
+ * @brief The results of a response frame
+ */
+enum {
+  WIRE_OK,
+  WIRE_MORE,
+  WIRE_LOGIN_REQUIRED,
+  WIRE_BAD_AMOUNT,
+  WIRE_NOT_ENOUGH,
+  WIRE_WRONG_PIN,
+  WIRE_PIN_MISMATCH,
+  WIRE_BAD_DENOMINATION,
+  WIRE_NOT_ALLOWED,
+  WIRE_FAILED,
+  WIRE_BAD_COMMAND,
+  WIRE_LIMITED
+};
+
+/**
+ * @brief Structure of a request frame (host byte order). The 'length' is the
+ * size of the frame, the 'tag' is copied into the responses. The 'amount' is
+ * the amount, the PIN (login), the session token (resume) or the rate
+ * (interest), the 'extra' is the
+ * confirmed PIN (login of a new user), the fee (interest) or the format
+ * (export, 0 for csv and 1 for bin). The 'text' (not terminated) is the user
+ * name, the prefix (find) or the path (import and export).
+ */
+typedef struct {
+  unsigned char magic;
+  unsigned char command;
+  unsigned short length;
+  unsigned int tag;
+  long long int amount;
+  long long int extra;
+  unsigned short denominations[WIRE_DENOMINATIONS];
+  unsigned int text_length;
+  char text[WIRE_TEXT];
+} wire_request;
+
+/**
+ * @brief Structure of a response frame (host byte order). The 'account' and
+ * 'balance' are the logged in user's after the command, the 'notes' are the
+ * counts of Rs. 1, 2, 5, 10, 50, 100, 500 and 2000 of a cash withdrawal,
+ * the 'token' is the session token of a login (see grant_token) and the
+ * 'count' is the number of matches of find. Every match of find is a
+ * response of its own (WIRE_MORE) having the account and the user name as
+ * 'text', before the final response.
+ */
+typedef struct {
+  unsigned char magic;
+  unsigned char command;
+  unsigned short length;
+  unsigned int tag;
+  int result;
+  int account;
+  long long int balance;
+  long long unsigned int token;
+  int notes[WIRE_DENOMINATIONS];
+  unsigned int count;
+  unsigned int text_length;
+  char text[WIRE_TEXT];
+} wire_response;
+
+/**
+ * @brief This function will perform the command of the request frame (lying
+ * in the input buffer, possibly unaligned) on the session, just like the
+ * same command of the text protocol, and write the response frame(s) into
+ * the session's output. Nothing is allocated (but the user name of a login)
+ * and no text is printed.
+ * Returns 'true' while the session is open, otherwise returns 'false' (e.g.
+ * after exit).
+ * @param session The session's data structure reference
+ * @param frame The bytes of the request frame (sizeof(wire_request))
+ * @return 'true' or 'false'
+ */
+bool session_request(SESSION session, const void* frame);
+
+#endif